@@ -11,19 +11,17 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    // Read CAS file into memory
-    size_t file_size;
-    uint8_t *data = readFileIntoMemory(argv[1], &file_size);
-    if (!data) {
-        fprintf(stderr, "Failed to read file: %s\n", argv[1]);
+    // Load CAS file (mapped when it is a regular file)
+    cas_Input input;
+    if (!openCasInput(argv[1], &input)) {
         return 1;
     }
 
     // Parse the CAS container
     cas_Container container;
-    if (!parseCasContainer(data, &container, file_size)) {
+    if (!parseCasContainer(input.data, &container, input.size)) {
         fprintf(stderr, "Failed to parse CAS file\n");
-        free(data);
+        closeCasInput(&input);
         return 1;
     }
 
@@ -31,7 +29,7 @@ int main(int argc, char *argv[]) {
     printDetailedContainer(&container);
 
     // Cleanup
-    free(container.files);
-    free(data);
+    freeCasContainer(&container);
+    closeCasInput(&input);
     return 0;
 }
\ No newline at end of file
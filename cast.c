@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <unistd.h>
 #include <stdbool.h>
 #include "lib/presetlib.h"
 #include "commands/commands.h"
@@ -10,8 +11,15 @@
 static int cmd_list(int argc, char *argv[]);
 static int cmd_info(int argc, char *argv[]);
 static int cmd_export(int argc, char *argv[]);
+static int cmd_index(int argc, char *argv[]);
 
 static int cmd_convert(int argc, char *argv[]);
+static int cmd_decode(int argc, char *argv[]);
+static int cmd_analyze(int argc, char *argv[]);
+static int cmd_record(int argc, char *argv[]);
+static int cmd_scan(int argc, char *argv[]);
+static int cmd_hash(int argc, char *argv[]);
+static int cmd_dedup(int argc, char *argv[]);
 static int cmd_profile(int argc, char *argv[]);
 static int cmd_play(int argc, char *argv[]);
 
@@ -27,9 +35,16 @@ static const Command commands[] = {
     {"list", cmd_list, "List files in a CAS container"},
     {"info", cmd_info, "Show container statistics"},
     {"export", cmd_export, "Export file(s) from container"},
+    {"index", cmd_index, "Write a sidecar index for fast file lookup"},
     {"convert", cmd_convert, "Convert CAS to WAV audio"},
+    {"decode", cmd_decode, "Decode WAV audio (tape rips) to CAS"},
+    {"analyze", cmd_analyze, "Show half-period lengths and tape speed of a WAV"},
+    {"record", cmd_record, "Record a tape from an audio input straight to CAS"},
+    {"scan", cmd_scan, "Catalog CAS files in directories (NDJSON/CSV)"},
+    {"hash", cmd_hash, "Hash the content of every tape file (NDJSON)"},
+    {"dedup", cmd_dedup, "Find identical programs across CAS files"},
     {"profile", cmd_profile, "List or show audio profiles"},
-    {"play", cmd_play, "Play WAV file with marker display"},
+    {"play", cmd_play, "Play WAV or CAS file with marker display"},
     {NULL, NULL, NULL}
 };
 
@@ -47,6 +62,7 @@ static void print_list_help(void) {
     printf("Options:\n");
     printf("  -e, --extended      Show extended information (sizes, headers, data, etc..)\n");
     printf("  -i, --index <num>   Show only specific file by index (1-based, requires -e/--extended)\n");
+    printf("                      Reads just that file when 'cast index' has written file.cas.idx\n");
     printf("  -m, --markers       List WAV file markers with timing\n");
     printf("  -v, --verbose       Verbose output\n");
     printf("  -h, --help          Show this help message\n");
@@ -59,8 +75,9 @@ static void print_list_help(void) {
 static void print_info_help(void) {
     printf("Usage: cast info <file.cas> [options]\n\n");
     printf("Options:\n");
-    printf("  -v, --verbose     Verbose output\n");
-    printf("  -h, --help        Show this help message\n");
+    printf("  -p, --profile <name>  Also show exact duration and WAV size for a profile\n");
+    printf("  -v, --verbose         Verbose output\n");
+    printf("  -h, --help            Show this help message\n");
 }
 
 static void print_export_help(void) {
@@ -69,18 +86,37 @@ static void print_export_help(void) {
     printf("By default, exports all files with auto-generated names.\n\n");
     printf("Options:\n");
     printf("  -i, --index <num>   Export only specific file by index (1-based)\n");
+    printf("                      Reads just that file when 'cast index' has written file.cas.idx\n");
     printf("  -d, --dir <dir>     Output directory (default: current directory)\n");
     printf("  -D, --disk-format   Add MSX-DOS disk format markers for Binary files (0xFE/0xFF prefix and postfix)\n");
     printf("  -f, --force         Overwrite existing files\n");
+    printf("  -j, --threads <num> Files written at once: 1-256 [default: number of CPUs]\n");
     printf("  -v, --verbose       Verbose output\n");
     printf("  -h, --help          Show this help message\n");
+    printf("\n");
+    printf("File data is copied from the CAS file inside the kernel (copy_file_range)\n");
+    printf("where the file systems allow it.\n");
+}
+
+static void print_index_help(void) {
+    printf("Usage: cast index <file.cas> [options]\n\n");
+    printf("Write a sidecar index (file.cas.idx) with the offset and size of every\n");
+    printf("file and block. 'list -e -i' and 'export -i' then read only the file\n");
+    printf("they need. The index is ignored once the CAS file's size or\n");
+    printf("modification time changes; run 'cast index' again to refresh it.\n\n");
+    printf("Options:\n");
+    printf("  -v, --verbose       List the indexed files\n");
+    printf("  -h, --help          Show this help message\n");
 }
 
 static void print_convert_help(void) {
-    printf("Usage: cast convert <input.cas> [options]\n\n");
-    printf("Convert CAS file to MSX cassette tape WAV audio.\n\n");
+    printf("Usage: cast convert <input.cas> [options]\n");
+    printf("       cast convert --batch <dir|list> [options]\n\n");
+    printf("Convert CAS file to MSX cassette tape WAV audio.\n");
+    printf("Use - as the input to read the CAS file from stdin (needs --output).\n\n");
     printf("Options:\n");
     printf("  -o, --output <file>     Output WAV file [default: input name with .wav extension]\n");
+    printf("                          Use - to stream the WAV to stdout (pipes, FIFOs)\n");
     printf("  -b, --baud <rate>       Baud rate: 1200 (standard) or 2400 (turbo) [default: 1200]\n");
     printf("  -s, --sample <rate>     Sample rate in Hz [default: 43200]\n");
     printf("                          Common: 43200, 44100, 48000, 88200, 96000\n");
@@ -105,6 +141,21 @@ static void print_convert_help(void) {
     printf("                          Useful frequencies: 5000-7000 Hz (above max 4800 Hz signal)\n");
     printf("  -m, --markers           Add cue point markers to WAV file for timeline tracking\n");
     printf("                          Markers show file boundaries, silence, and sync signals\n");
+    printf("  -B, --buffer <KiB>      Output write buffer size in KiB [default: 1024]\n");
+    printf("                          Larger buffers mean fewer, bigger writes (e.g. 1024-8192)\n");
+    printf("  -j, --threads <num>     Render with worker threads: 1-256 [default: 1]\n");
+    printf("                          Output is identical to single-threaded conversion\n");
+    printf("                          (ignored when streaming to stdout)\n");
+    printf("  -M, --mmap              Preallocate the output file and render into a memory map\n");
+    printf("                          Avoids fragmented, seek-patched writes on large outputs\n");
+    printf("  -L, --batch <dir|list>  Convert every .cas in a directory, or every path in a\n");
+    printf("                          list file (one per line); replaces <input.cas>\n");
+    printf("                          Files are spread over --threads workers\n");
+    printf("  -D, --out-dir <dir>     Batch output directory [default: next to each input]\n");
+    printf("                          Inputs that would write the same WAV name are refused\n");
+    printf("  -V, --verify            Decode the audio while it renders and check it gives back\n");
+    printf("                          the original bytes; reports the first difference\n");
+    printf("                          (renders serially with buffered writes)\n");
     printf("  -v, --verbose           Verbose output\n");
     printf("  -h, --help              Show this help message\n\n");
     printf("Examples:\n");
@@ -118,6 +169,137 @@ static void print_convert_help(void) {
     printf("  cast convert game.cas --profile computer-direct\n");
     printf("  cast convert game.cas --profile default --baud 2400\n");
     printf("  cast convert game.cas -o output.wav --lowpass 5500 --wave trapezoid\n");
+    printf("  cast convert game.cas --threads 8\n");
+    printf("  cast convert game.cas -s 192000 --mmap --threads 4\n");
+    printf("  cast convert game.cas -o - | aplay\n");
+    printf("  cast convert game.cas --profile turbo-3600 --verify\n");
+    printf("  cast convert --batch library/ --out-dir wav/ --threads 8 -p computer-direct\n");
+}
+
+static void print_scan_help(void) {
+    printf("Usage: cast scan <dir|file.cas>... [options]\n\n");
+    printf("Walk directories (recursively, in parallel) and write one record per\n");
+    printf("tape file in every *.cas found: path, index, file count, type, name,\n");
+    printf("load/end/exec addresses, size, blocks and estimated duration in seconds.\n");
+    printf("Records are written as each CAS file finishes; the throughput summary\n");
+    printf("goes to stderr.\n\n");
+    printf("Options:\n");
+    printf("  -f, --format <fmt>    Record format: ndjson or csv [default: ndjson]\n");
+    printf("  -o, --output <file>   Write records to a file [default: stdout]\n");
+    printf("  -j, --threads <num>   Worker threads: 1-256 [default: number of CPUs]\n");
+    printf("  -b, --baud <rate>     Baud rate for the duration estimates [default: 1200]\n");
+    printf("  -v, --verbose         Report every CAS file on stderr\n");
+    printf("  -h, --help            Show this help message\n\n");
+    printf("Examples:\n");
+    printf("  cast scan archive/ > catalog.ndjson\n");
+    printf("  cast scan archive/ more/ -f csv -o catalog.csv -j 16\n");
+}
+
+static void print_decode_help(void) {
+    printf("Usage: cast decode <input.wav> [options]\n\n");
+    printf("Decode MSX cassette audio back into a CAS file. Works on rips of real\n");
+    printf("tapes as well as WAVs written by 'cast convert': the baud rate (1200,\n");
+    printf("2400 or faster) is measured from each block's leader, and tape speed\n");
+    printf("drift, DC offset, inverted polarity and low levels are followed.\n");
+    printf("Reads 8/16/24/32-bit integer and 32-bit float PCM WAV files.\n");
+    printf("Use - as the input to read the WAV from stdin (needs --output).\n\n");
+    printf("Options:\n");
+    printf("  -o, --output <file>   Output CAS file [default: input name with .cas extension]\n");
+    printf("                        Use - to write the CAS file to stdout\n");
+    printf("  -c, --channel <num>   Channel to decode in multi-channel WAVs: 1 = left,\n");
+    printf("                        2 = right, ... [default: 1]\n");
+    printf("  -j, --threads <num>   Worker threads: 1-256 [default: number of CPUs]\n");
+    printf("                        A WAV file is split at its silences and the parts\n");
+    printf("                        decoded at once (stdin is decoded as it is read)\n");
+    printf("  -v, --verbose         List the decoded blocks and files\n");
+    printf("  -h, --help            Show this help message\n\n");
+    printf("Blocks cut short by a framing error are kept up to the error and\n");
+    printf("reported; the exit status is then 1.\n\n");
+    printf("Examples:\n");
+    printf("  cast decode game.wav\n");
+    printf("  cast decode rip.wav -c 2 -o game.cas -v\n");
+    printf("  cast decode long-rip.wav -j 8\n");
+}
+
+static void print_analyze_help(void) {
+    printf("Usage: cast analyze <input.wav> [options]\n\n");
+    printf("Measure every half-period (time between zero crossings) of a WAV, as\n");
+    printf("'cast decode' sees them, and show their lengths as a histogram. A tape\n");
+    printf("has two peaks, SHORT (1-bit) and LONG (0-bit) half-periods; their\n");
+    printf("lengths give the tape speed. Spread-out peaks point at wow, flutter or\n");
+    printf("noise. Also reports the zero-crossing kernel's speed.\n\n");
+    printf("Options:\n");
+    printf("  -c, --channel <num>   Channel to analyze: 1 = left, 2 = right, ... [default: 1]\n");
+    printf("  -k, --kernel <name>   Zero-crossing kernel: scalar, sse2 or avx2\n");
+    printf("                        [default: fastest this CPU runs]\n");
+    printf("  -v, --verbose         Show every histogram bin\n");
+    printf("  -h, --help            Show this help message\n\n");
+    printf("Examples:\n");
+    printf("  cast analyze rip.wav\n");
+    printf("  cast analyze rip.wav -c 2 -k scalar\n");
+}
+
+static void print_record_help(void) {
+    printf("Usage: cast record -o <output.cas> [options]\n\n");
+    printf("Record an MSX saving to tape (CSAVE, BSAVE, SAVE\"CAS:\") through an audio\n");
+    printf("input and decode it as it plays. Each block is shown and appended to the\n");
+    printf("CAS file as soon as it ends; Ctrl+C stops recording. The baud rate is\n");
+    printf("measured from each block's leader, as in 'cast decode'.\n\n");
+    printf("Options:\n");
+    printf("  -o, --output <file>   Output CAS file (required; - writes to stdout)\n");
+    printf("  -l, --list            List the capture devices and exit\n");
+    printf("  -d, --device <num>    Capture device from --list [default: system default]\n");
+    printf("  -c, --channel <num>   Channel to decode: 1 = left, 2 = right [default: 1]\n");
+    printf("  -s, --sample <rate>   Capture sample rate in Hz [default: 44100]\n");
+    printf("  -t, --time <seconds>  Stop after this much audio [default: until Ctrl+C]\n");
+    printf("  -i, --input <file>    Play a WAV file into the decoder instead of a device,\n");
+    printf("                        in real time (for trying out a setup)\n");
+    printf("  -f, --fast            With --input: read the WAV as fast as it decodes\n");
+    printf("  -v, --verbose         Show how far decoding trailed the input\n");
+    printf("  -h, --help            Show this help message\n\n");
+    printf("Examples:\n");
+    printf("  cast record -o game.cas\n");
+    printf("  cast record --list\n");
+    printf("  cast record -d 2 -c 2 -o game.cas -v\n");
+}
+
+static void print_hash_help(void) {
+    printf("Usage: cast hash <dir|file.cas>... [options]\n\n");
+    printf("Walk directories (recursively, in parallel) and write one NDJSON record\n");
+    printf("per tape file: path, index, type, name, payload size and a 64-bit\n");
+    printf("content hash. The hash covers the file's type, the load/end/exec\n");
+    printf("addresses of binary files and the data, but not the name, CAS headers,\n");
+    printf("block padding or bytes after an ASCII end-of-file marker, so the same\n");
+    printf("program hashes the same in any container. CRC32C runs on the CPU's\n");
+    printf("CRC32 instruction when there is one.\n\n");
+    printf("Options:\n");
+    printf("  -B, --blocks          Add the hash of every data block's payload\n");
+    printf("  -o, --output <file>   Write records to a file [default: stdout]\n");
+    printf("  -j, --threads <num>   Worker threads: 1-256 [default: number of CPUs]\n");
+    printf("  -v, --verbose         Report every CAS file on stderr\n");
+    printf("  -h, --help            Show this help message\n\n");
+    printf("Examples:\n");
+    printf("  cast hash game.cas\n");
+    printf("  cast hash archive/ -B -o hashes.ndjson\n");
+}
+
+static void print_dedup_help(void) {
+    printf("Usage: cast dedup <dir|file.cas>... [options]\n\n");
+    printf("Hash every CAS file, tape file and (with -B) data block found, as\n");
+    printf("'cast hash' does, and write one NDJSON record per group of identical\n");
+    printf("content: kind (container, file or block), hash, size, count and the\n");
+    printf("copies sorted by path. Containers match when they hold the same files\n");
+    printf("under the same names in the same order; a CAS file in such a group\n");
+    printf("converts like the first one. Totals go to stderr.\n\n");
+    printf("Options:\n");
+    printf("  -B, --blocks          Also report identical data blocks\n");
+    printf("  -o, --output <file>   Write groups to a file [default: stdout]\n");
+    printf("  -j, --threads <num>   Worker threads: 1-256 [default: number of CPUs]\n");
+    printf("  -v, --verbose         Report every CAS file and the index size on stderr\n");
+    printf("  -h, --help            Show this help message\n\n");
+    printf("Examples:\n");
+    printf("  cast dedup archive/ > duplicates.ndjson\n");
+    printf("  cast dedup archive/ more/ -B -j 16\n");
 }
 
 static int cmd_list(int argc, char *argv[]) {
@@ -179,9 +361,11 @@ static int cmd_list(int argc, char *argv[]) {
 
 static int cmd_info(int argc, char *argv[]) {
     const char *input_file = NULL;
+    const char *profile_name = NULL;
     bool verbose = false;
 
     struct option long_options[] = {
+        {"profile", required_argument, 0, 'p'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
@@ -189,8 +373,11 @@ static int cmd_info(int argc, char *argv[]) {
 
     int opt;
     optind = 1;
-    while ((opt = getopt_long(argc, argv, "vh", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "p:vh", long_options, NULL)) != -1) {
         switch (opt) {
+            case 'p':
+                profile_name = optarg;
+                break;
             case 'v':
                 verbose = true;
                 break;
@@ -209,7 +396,7 @@ static int cmd_info(int argc, char *argv[]) {
 
     input_file = argv[optind];
 
-    return execute_info(input_file, verbose);
+    return execute_info(input_file, profile_name, verbose);
 }
 
 static int cmd_export(int argc, char *argv[]) {
@@ -219,12 +406,15 @@ static int cmd_export(int argc, char *argv[]) {
     bool force = false;
     bool verbose = false;
     bool disk_format = false;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint16_t threads = (cpus < 1) ? 1 : (cpus > 256) ? 256 : (uint16_t)cpus;
 
     struct option long_options[] = {
         {"index", required_argument, 0, 'i'},
         {"dir", required_argument, 0, 'd'},
         {"disk-format", no_argument, 0, 'D'},
         {"force", no_argument, 0, 'f'},
+        {"threads", required_argument, 0, 'j'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
@@ -232,7 +422,7 @@ static int cmd_export(int argc, char *argv[]) {
 
     int opt;
     optind = 1;
-    while ((opt = getopt_long(argc, argv, "i:d:Dfvh", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "i:d:Dfj:vh", long_options, NULL)) != -1) {
         switch (opt) {
             case 'i':
                 index = atoi(optarg);
@@ -246,6 +436,15 @@ static int cmd_export(int argc, char *argv[]) {
             case 'f':
                 force = true;
                 break;
+            case 'j': {
+                int count = atoi(optarg);
+                if (count < 1 || count > 256) {
+                    fprintf(stderr, "Error: Thread count must be between 1 and 256\n");
+                    return 1;
+                }
+                threads = (uint16_t)count;
+                break;
+            }
             case 'v':
                 verbose = true;
                 break;
@@ -265,7 +464,391 @@ static int cmd_export(int argc, char *argv[]) {
     input_file = argv[optind];
 
     // Call the execute_export implementation
-    return execute_export(input_file, index, output_dir, force, verbose, disk_format);
+    return execute_export(input_file, index, output_dir, force, verbose, disk_format, threads);
+}
+
+static int cmd_index(int argc, char *argv[]) {
+    bool verbose = false;
+
+    struct option long_options[] = {
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "vh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'v':
+                verbose = true;
+                break;
+            case 'h':
+                print_index_help();
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        print_index_help();
+        return 0;
+    }
+
+    return execute_index(argv[optind], verbose);
+}
+
+static int cmd_decode(int argc, char *argv[]) {
+    const char *output_file = NULL;
+    uint16_t channel = 0;
+    bool verbose = false;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint16_t threads = (cpus < 1) ? 1 : (cpus > 256) ? 256 : (uint16_t)cpus;
+
+    struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"channel", required_argument, 0, 'c'},
+        {"threads", required_argument, 0, 'j'},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "o:c:j:vh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'c': {
+                int number = atoi(optarg);
+                if (number < 1 || number > 256) {
+                    fprintf(stderr, "Error: Channel must be between 1 and 256\n");
+                    return 1;
+                }
+                channel = (uint16_t)(number - 1);
+                break;
+            }
+            case 'j': {
+                int count = atoi(optarg);
+                if (count < 1 || count > 256) {
+                    fprintf(stderr, "Error: Thread count must be between 1 and 256\n");
+                    return 1;
+                }
+                threads = (uint16_t)count;
+                break;
+            }
+            case 'v':
+                verbose = true;
+                break;
+            case 'h':
+                print_decode_help();
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "Error: Missing input WAV file\n\n");
+        print_decode_help();
+        return 1;
+    }
+
+    return execute_decode(argv[optind], output_file, channel, threads, verbose);
+}
+
+static int cmd_analyze(int argc, char *argv[]) {
+    const char *kernel_name = NULL;
+    uint16_t channel = 0;
+    bool verbose = false;
+
+    struct option long_options[] = {
+        {"channel", required_argument, 0, 'c'},
+        {"kernel", required_argument, 0, 'k'},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "c:k:vh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'c': {
+                int number = atoi(optarg);
+                if (number < 1 || number > 256) {
+                    fprintf(stderr, "Error: Channel must be between 1 and 256\n");
+                    return 1;
+                }
+                channel = (uint16_t)(number - 1);
+                break;
+            }
+            case 'k':
+                kernel_name = optarg;
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            case 'h':
+                print_analyze_help();
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "Error: Missing input WAV file\n\n");
+        print_analyze_help();
+        return 1;
+    }
+
+    return execute_analyze(argv[optind], channel, kernel_name, verbose);
+}
+
+static int cmd_record(int argc, char *argv[]) {
+    const char *output_file = NULL;
+    const char *input_file = NULL;
+    int device_index = -1;
+    uint16_t channel = 0;
+    uint32_t sample_rate = 44100;
+    double duration = 0;
+    bool fast = false;
+    bool list_devices = false;
+    bool verbose = false;
+
+    struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"list", no_argument, 0, 'l'},
+        {"device", required_argument, 0, 'd'},
+        {"channel", required_argument, 0, 'c'},
+        {"sample", required_argument, 0, 's'},
+        {"time", required_argument, 0, 't'},
+        {"input", required_argument, 0, 'i'},
+        {"fast", no_argument, 0, 'f'},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "o:ld:c:s:t:i:fvh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'l':
+                list_devices = true;
+                break;
+            case 'd': {
+                int number = atoi(optarg);
+                if (number < 1) {
+                    fprintf(stderr, "Error: Device number must be 1 or more (see --list)\n");
+                    return 1;
+                }
+                device_index = number - 1;
+                break;
+            }
+            case 'c': {
+                int number = atoi(optarg);
+                if (number < 1 || number > 32) {
+                    fprintf(stderr, "Error: Channel must be between 1 and 32\n");
+                    return 1;
+                }
+                channel = (uint16_t)(number - 1);
+                break;
+            }
+            case 's': {
+                int rate = atoi(optarg);
+                if (rate < 8000 || rate > 384000) {
+                    fprintf(stderr, "Error: Sample rate must be between 8000 and 384000 Hz\n");
+                    return 1;
+                }
+                sample_rate = (uint32_t)rate;
+                break;
+            }
+            case 't':
+                duration = atof(optarg);
+                if (duration <= 0) {
+                    fprintf(stderr, "Error: Recording time must be more than 0 seconds\n");
+                    return 1;
+                }
+                break;
+            case 'i':
+                input_file = optarg;
+                break;
+            case 'f':
+                fast = true;
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            case 'h':
+                print_record_help();
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (!output_file && !list_devices) {
+        fprintf(stderr, "Error: Missing output CAS file (-o)\n\n");
+        print_record_help();
+        return 1;
+    }
+    if (fast && !input_file) {
+        fprintf(stderr, "Error: --fast needs a WAV file to read (--input)\n");
+        return 1;
+    }
+
+    return execute_record(output_file, input_file, device_index, channel, sample_rate,
+                          duration, fast, list_devices, verbose);
+}
+
+static int cmd_scan(int argc, char *argv[]) {
+    const char *output_file = NULL;
+    bool csv = false;
+    bool verbose = false;
+    uint16_t baud_rate = 1200;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint16_t threads = (cpus < 1) ? 1 : (cpus > 256) ? 256 : (uint16_t)cpus;
+
+    struct option long_options[] = {
+        {"format", required_argument, 0, 'f'},
+        {"output", required_argument, 0, 'o'},
+        {"threads", required_argument, 0, 'j'},
+        {"baud", required_argument, 0, 'b'},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "f:o:j:b:vh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'f':
+                if (strcmp(optarg, "csv") == 0) {
+                    csv = true;
+                } else if (strcmp(optarg, "ndjson") == 0) {
+                    csv = false;
+                } else {
+                    fprintf(stderr, "Error: Unknown format '%s' (use ndjson or csv)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'j': {
+                int count = atoi(optarg);
+                if (count < 1 || count > 256) {
+                    fprintf(stderr, "Error: Thread count must be between 1 and 256\n");
+                    return 1;
+                }
+                threads = (uint16_t)count;
+                break;
+            }
+            case 'b': {
+                int baud = atoi(optarg);
+                if (baud < 1200 || baud > 9600) {
+                    fprintf(stderr, "Error: Baud rate must be between 1200-9600\n");
+                    return 1;
+                }
+                baud_rate = (uint16_t)baud;
+                break;
+            }
+            case 'v':
+                verbose = true;
+                break;
+            case 'h':
+                print_scan_help();
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "Error: Missing directory or CAS file\n\n");
+        print_scan_help();
+        return 1;
+    }
+
+    return execute_scan(argv + optind, (size_t)(argc - optind), csv, output_file,
+                        threads, baud_rate, verbose);
+}
+
+// Shared by 'cast hash' and 'cast dedup': same options, different output
+static int run_hash_command(int argc, char *argv[], bool dedup) {
+    const char *output_file = NULL;
+    bool blocks = false;
+    bool verbose = false;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint16_t threads = (cpus < 1) ? 1 : (cpus > 256) ? 256 : (uint16_t)cpus;
+    void (*print_help)(void) = dedup ? print_dedup_help : print_hash_help;
+
+    struct option long_options[] = {
+        {"blocks", no_argument, 0, 'B'},
+        {"output", required_argument, 0, 'o'},
+        {"threads", required_argument, 0, 'j'},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    optind = 1;
+    while ((opt = getopt_long(argc, argv, "Bo:j:vh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'B':
+                blocks = true;
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'j': {
+                int count = atoi(optarg);
+                if (count < 1 || count > 256) {
+                    fprintf(stderr, "Error: Thread count must be between 1 and 256\n");
+                    return 1;
+                }
+                threads = (uint16_t)count;
+                break;
+            }
+            case 'v':
+                verbose = true;
+                break;
+            case 'h':
+                print_help();
+                return 0;
+            default:
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "Error: Missing directory or CAS file\n\n");
+        print_help();
+        return 1;
+    }
+
+    char **paths = argv + optind;
+    size_t path_count = (size_t)(argc - optind);
+    return dedup ? execute_dedup(paths, path_count, output_file, threads, blocks, verbose)
+                 : execute_hash(paths, path_count, output_file, threads, blocks, verbose);
+}
+
+static int cmd_hash(int argc, char *argv[]) {
+    return run_hash_command(argc, argv, false);
+}
+
+static int cmd_dedup(int argc, char *argv[]) {
+    return run_hash_command(argc, argv, true);
 }
 
 static int cmd_convert(int argc, char *argv[]) {
@@ -284,6 +867,12 @@ static int cmd_convert(int argc, char *argv[]) {
     bool enable_lowpass = false;
     uint16_t lowpass_cutoff_hz = 6000;
     bool enable_markers = false;
+    size_t buffer_size = 0;  // 0 = library default
+    uint16_t threads = 1;
+    bool map_output = false;
+    const char *batch_source = NULL;
+    const char *out_dir = NULL;
+    bool verify = false;
     bool verbose = false;
     
     // Track which options were explicitly set (for profile override)
@@ -308,13 +897,19 @@ static int cmd_convert(int argc, char *argv[]) {
         {"profile", required_argument, 0, 'p'},
         {"lowpass", optional_argument, 0, 'l'},
         {"markers", no_argument, 0, 'm'},
+        {"buffer", required_argument, 0, 'B'},
+        {"threads", required_argument, 0, 'j'},
+        {"mmap", no_argument, 0, 'M'},
+        {"batch", required_argument, 0, 'L'},
+        {"out-dir", required_argument, 0, 'D'},
+        {"verify", no_argument, 0, 'V'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
 
     int opt;
-    while ((opt = getopt_long(argc, argv, "o:b:s:w:c:d:a:r:t:p:l::mvh", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "o:b:s:w:c:d:a:r:t:p:l::mB:j:ML:D:Vvh", long_options, NULL)) != -1) {
         switch (opt) {
             case 'o':
                 output_file = optarg;
@@ -395,6 +990,36 @@ static int cmd_convert(int argc, char *argv[]) {
             case 'm':
                 enable_markers = true;
                 break;
+            case 'B': {
+                long kib = atol(optarg);
+                if (kib < 4 || kib > 1024 * 1024) {
+                    fprintf(stderr, "Error: Buffer size must be between 4 and 1048576 KiB\n");
+                    return 1;
+                }
+                buffer_size = (size_t)kib * 1024;
+                break;
+            }
+            case 'j': {
+                int count = atoi(optarg);
+                if (count < 1 || count > 256) {
+                    fprintf(stderr, "Error: Thread count must be between 1 and 256\n");
+                    return 1;
+                }
+                threads = (uint16_t)count;
+                break;
+            }
+            case 'M':
+                map_output = true;
+                break;
+            case 'L':
+                batch_source = optarg;
+                break;
+            case 'D':
+                out_dir = optarg;
+                break;
+            case 'V':
+                verify = true;
+                break;
             case 'v':
                 verbose = true;
                 break;
@@ -407,15 +1032,27 @@ static int cmd_convert(int argc, char *argv[]) {
         }
     }
 
-    // Get input file (required positional argument)
-    if (optind >= argc) {
+    // Get input file (required positional argument, unless converting a batch)
+    if (batch_source) {
+        if (optind < argc || output_file) {
+            fprintf(stderr, "Error: --batch takes no input file or --output (use --out-dir)\n");
+            return 1;
+        }
+        if (verify) {
+            fprintf(stderr, "Error: --verify checks a single conversion, not a batch\n");
+            return 1;
+        }
+    } else if (optind >= argc) {
         fprintf(stderr, "Error: Missing input file\n\n");
         print_convert_help();
         return 1;
+    } else if (out_dir) {
+        fprintf(stderr, "Error: --out-dir requires --batch\n");
+        return 1;
+    } else {
+        input_file = argv[optind];
     }
 
-    input_file = argv[optind];
-
     // Apply profile if specified
     if (profile_name) {
         const AudioProfile *profile = findProfile(profile_name);
@@ -441,8 +1078,10 @@ static int cmd_convert(int argc, char *argv[]) {
         }
         
         if (verbose) {
-            printf("Using preset: %s\n", profile->name);
-            printf("  %s\n\n", profile->short_desc);
+            // Keep stdout clean when the WAV is streamed there
+            FILE *out = (output_file && strcmp(output_file, "-") == 0) ? stderr : stdout;
+            fprintf(out, "Using preset: %s\n", profile->name);
+            fprintf(out, "  %s\n\n", profile->short_desc);
         }
     }
 
@@ -457,7 +1096,8 @@ static int cmd_convert(int argc, char *argv[]) {
                           trapezoid_rise_percent,
                           long_silence, short_silence,
                           enable_lowpass, lowpass_cutoff_hz,
-                          enable_markers, verbose);
+                          enable_markers, buffer_size, threads, map_output,
+                          batch_source, out_dir, verify, verbose);
 }
 
 int main(int argc, char *argv[]) {
@@ -541,12 +1181,14 @@ static int cmd_profile(int argc, char *argv[]) {
 }
 
 static void print_play_help(void) {
-    printf("Usage: cast play <file.wav> [options]\n\n");
+    printf("Usage: cast play <file.wav|file.cas> [options]\n\n");
     printf("Play a WAV file with real-time marker display.\n");
+    printf("CAS files are synthesized on the fly (no WAV file is written).\n");
     printf("Shows loading progress, current file/block, and activity log.\n\n");
     printf("Options:\n");
-    printf("  -v, --verbose     Verbose output\n");
-    printf("  -h, --help        Show this help message\n\n");
+    printf("  -p, --profile <name>  Audio profile for CAS playback [default: default]\n");
+    printf("  -v, --verbose         Verbose output\n");
+    printf("  -h, --help            Show this help message\n\n");
     printf("Interactive Controls:\n");
     printf("  Space       - Play/Pause\n");
     printf("  Left/Right  - Seek -5s/+5s\n");
@@ -556,12 +1198,15 @@ static void print_play_help(void) {
     printf("Examples:\n");
     printf("  cast play output.wav              # Play WAV file\n");
     printf("  cast play disc.wav -v             # Play with verbose output\n");
+    printf("  cast play game.cas -p turbo-3600  # Play CAS directly with a profile\n");
 }
 
 static int cmd_play(int argc, char *argv[]) {
+    const char *profile_name = NULL;
     bool verbose = false;
     
     struct option long_options[] = {
+        {"profile", required_argument, 0, 'p'},
         {"verbose", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
@@ -569,8 +1214,11 @@ static int cmd_play(int argc, char *argv[]) {
     
     int opt;
     optind = 1;  // Reset getopt
-    while ((opt = getopt_long(argc, argv, "vh", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "p:vh", long_options, NULL)) != -1) {
         switch (opt) {
+            case 'p':
+                profile_name = optarg;
+                break;
             case 'v':
                 verbose = true;
                 break;
@@ -585,12 +1233,12 @@ static int cmd_play(int argc, char *argv[]) {
     
     // Check for input file
     if (optind >= argc) {
-        fprintf(stderr, "Error: WAV file required\n\n");
+        fprintf(stderr, "Error: WAV or CAS file required\n\n");
         print_play_help();
         return 1;
     }
     
     const char *filename = argv[optind];
-    return execute_play(filename, verbose);
+    return execute_play(filename, profile_name, verbose);
 }
 
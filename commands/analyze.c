@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "../lib/crossinglib.h"
+#include "../lib/decodelib.h"
+#include "../lib/cmdlib.h"
+
+#define BIN_US          10      // Histogram bin width in microseconds
+#define BIN_COUNT       200     // Bins up to 2 ms; longer half-periods are gaps
+#define BAR_WIDTH       40
+#define MIN_HALF_US     50      // Half-periods of tapes from about 9000 Hz
+#define MAX_HALF_US     700     // down to 700 Hz (LONG at 1200 baud, slow)
+#define READ_FRAMES     (64 * 1024)
+
+static double elapsedSeconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Mean length of the half-periods in the bins around peak, in microseconds
+static double peakCenter(const uint64_t *bins, const double *lengths, size_t peak) {
+    double sum = 0, weight = 0;
+    for (size_t i = peak > 0 ? peak - 1 : 0; i <= peak + 1 && i < BIN_COUNT; i++) {
+        sum += lengths[i];
+        weight += bins[i];
+    }
+    return weight > 0 ? sum / weight : 0;
+}
+
+// Fullest bin for half-periods from from_us to to_us long
+static size_t findPeak(const uint64_t *bins, double from_us, double to_us) {
+    size_t peak = BIN_COUNT;
+    for (size_t i = 0; i < BIN_COUNT; i++) {
+        double length = (i + 0.5) * BIN_US;
+        if (length >= from_us && length <= to_us && (peak == BIN_COUNT || bins[i] > bins[peak])) {
+            peak = i;
+        }
+    }
+    return peak;
+}
+
+int execute_analyze(const char *input_file, uint16_t channel, const char *kernel_name, bool verbose) {
+    CrossingDetector detector;
+    initCrossingDetector(&detector);
+    if (kernel_name) {
+        const CrossingKernel kernels[] = {CROSSING_SCALAR, CROSSING_SSE2, CROSSING_AVX2};
+        bool found = false;
+        for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]) && !found; i++) {
+            if (strcasecmp(kernel_name, getCrossingKernelName(kernels[i])) == 0) {
+                detector.kernel = kernels[i];
+                found = true;
+            }
+        }
+        if (!found || !hasCrossingKernel(detector.kernel)) {
+            fprintf(stderr, "Error: Kernel '%s' is not available (this CPU runs up to %s)\n",
+                    kernel_name, getCrossingKernelName(getBestCrossingKernel()));
+            return 1;
+        }
+    }
+
+    WavReader reader;
+    if (!openWavReader(input_file, channel, &reader)) {
+        return 1;
+    }
+
+    // 8 and 16-bit files go to the kernel as stored
+    PcmFormat format;
+    bool native = getWavReaderPcmFormat(&reader, &format);
+    if (!native) {
+        format = PCM_S16;
+    }
+    size_t sample_size = getPcmSampleSize(format);
+    uint8_t *samples = malloc(READ_FRAMES * sample_size);
+    double *halves = malloc(CROSSING_WINDOW * sizeof(double));
+    if (!samples || !halves) {
+        fprintf(stderr, "Error: Failed to allocate analysis buffers\n");
+        free(samples);
+        free(halves);
+        closeWavReader(&reader);
+        return 1;
+    }
+
+    uint64_t bins[BIN_COUNT] = {0};
+    double lengths[BIN_COUNT] = {0};  // Sum of the lengths in each bin
+    uint64_t half_count = 0, gaps = 0;
+    double us_per_sample = 1e6 / reader.sample_rate;
+    double kernel_time = 0;
+    bool first = true;
+
+    size_t count;
+    while ((count = native ? readWavReaderPcm(&reader, samples, READ_FRAMES)
+                           : readWavReader(&reader, (int16_t *)samples, READ_FRAMES)) > 0) {
+        for (size_t offset = 0; offset < count; offset += CROSSING_WINDOW) {
+            size_t window = count - offset < CROSSING_WINDOW ? count - offset : CROSSING_WINDOW;
+            const uint8_t *p = samples + offset * sample_size;
+
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            updateCrossingLevel(&detector, p, format, window);
+            size_t found = findHalfPeriods(&detector, p, format, window, halves);
+            kernel_time += elapsedSeconds(&start);
+
+            // The first crossing closes no whole half-period
+            for (size_t i = first && found > 0 ? 1 : 0; i < found; i++) {
+                double length = halves[i] * us_per_sample;
+                size_t bin = (size_t)(length / BIN_US);
+                if (bin < BIN_COUNT) {
+                    bins[bin]++;
+                    lengths[bin] += length;
+                } else {
+                    gaps++;
+                }
+                half_count++;
+            }
+            first = first && found == 0;
+        }
+    }
+    bool read_error = ferror(reader.file) != 0;
+    double duration = (double)detector.position / reader.sample_rate;
+
+    if (read_error) {
+        fprintf(stderr, "Error: Failed to read %s\n", input_file);
+    } else {
+        char audio[32];
+        formatDuration(duration, audio, sizeof(audio));
+        printf("=== Half-Period Analysis ===\n");
+        printf("File:         %s\n", input_file);
+        printf("Format:       %u Hz, %u-bit%s, %u channel(s), reading channel %u\n",
+               reader.sample_rate, reader.bits_per_sample, reader.is_float ? " float" : "",
+               reader.channels, channel + 1);
+        printf("Duration:     %s (%.1f seconds)\n", audio, duration);
+        printf("Kernel:       %s, %s samples", getCrossingKernelName(detector.kernel),
+               native ? "stored" : "converted 16-bit");
+        if (kernel_time > 0) {
+            printf(", %.1f M samples/s", detector.position / kernel_time / 1e6);
+        }
+        printf("\n");
+        printf("Half-periods: %llu (%llu gaps over %d ms)\n\n", (unsigned long long)half_count,
+               (unsigned long long)gaps, BIN_COUNT * BIN_US / 1000);
+
+        // Histogram: every bin with verbose, otherwise those holding at
+        // least 0.1% of the half-periods
+        uint64_t most = 0;
+        for (size_t i = 0; i < BIN_COUNT; i++) {
+            most = bins[i] > most ? bins[i] : most;
+        }
+        if (most > 0) {
+            uint64_t shown_min = verbose ? 1 : (half_count / 1000 > 0 ? half_count / 1000 : 1);
+            printf("  Length (µs) |    Count\n");
+            printf("  ------------+----------\n");
+            for (size_t i = 0; i < BIN_COUNT; i++) {
+                if (bins[i] < shown_min) {
+                    continue;
+                }
+                int bar = (int)((bins[i] * BAR_WIDTH + most - 1) / most);
+                printf("  %5zu-%-5zu | %8llu %.*s\n", i * BIN_US, (i + 1) * BIN_US,
+                       (unsigned long long)bins[i], bar,
+                       "########################################");
+            }
+            printf("\n");
+
+            // A tape shows two peaks: SHORT (1-bit) and LONG (0-bit) halves,
+            // one about twice the other. The fullest bin in the range of
+            // tape speeds is one of them; its partner is the fullest bin at
+            // half or twice its length
+            size_t main_bin = findPeak(bins, MIN_HALF_US, MAX_HALF_US);
+            double main_us = peakCenter(bins, lengths, main_bin);
+            size_t longer = findPeak(bins, main_us * 1.6, main_us * 2.4);
+            size_t shorter = findPeak(bins, main_us / 2.4, main_us / 1.6);
+            uint64_t longer_count = longer < BIN_COUNT ? bins[longer] : 0;
+            uint64_t shorter_count = shorter < BIN_COUNT ? bins[shorter] : 0;
+            size_t partner = longer_count >= shorter_count ? longer : shorter;
+            uint64_t partner_count = partner < BIN_COUNT ? bins[partner] : 0;
+            double short_us = main_us, long_us = 0;
+
+            // Noise spreads over all lengths: the peaks need a valley between them
+            size_t valley = (main_bin + partner) / 2;
+            if (partner_count * 100 >= bins[main_bin] && bins[valley] * 2 < partner_count) {
+                double partner_us = peakCenter(bins, lengths, partner);
+                short_us = partner == longer ? main_us : partner_us;
+                long_us = partner == longer ? partner_us : main_us;
+            }
+
+            if (long_us > 0) {
+                printf("Peaks:        %.0f µs (SHORT), %.0f µs (LONG), ratio %.2f\n",
+                       short_us, long_us, long_us / short_us);
+                printf("Tape speed:   about %.0f baud (%.0f Hz / %.0f Hz)\n",
+                       1e6 / (4 * short_us), 1e6 / (2 * short_us), 1e6 / (2 * long_us));
+            } else {
+                printf("Peaks:        %.0f µs, no SHORT/LONG pair found\n", main_us);
+            }
+        } else {
+            printf("No signal found\n");
+        }
+    }
+
+    free(samples);
+    free(halves);
+    closeWavReader(&reader);
+    return read_error ? 1 : 0;
+}
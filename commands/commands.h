@@ -3,11 +3,14 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 #include "../lib/wavlib.h"
 
 int execute_list(const char *input_file, bool extended, int filter_index, bool show_markers, bool verbose);
-int execute_info(const char *input_file, bool verbose);
-int execute_export(const char *input_file, int filter_index, const char *output_dir, bool force, bool verbose, bool disk_format);
+int execute_info(const char *input_file, const char *profile_name, bool verbose);
+int execute_index(const char *input_file, bool verbose);
+int execute_export(const char *input_file, int filter_index, const char *output_dir, bool force,
+                   bool verbose, bool disk_format, uint16_t threads);
 int execute_convert(const char *input_file, const char *output_file,
                     uint16_t baud_rate, uint32_t sample_rate,
                     WaveformType waveform_type, uint16_t channels,
@@ -15,8 +18,22 @@ int execute_convert(const char *input_file, const char *output_file,
                     uint8_t trapezoid_rise_percent,
                     float long_silence, float short_silence,
                     bool enable_lowpass, uint16_t lowpass_cutoff_hz,
-                    bool enable_markers, bool verbose);
+                    bool enable_markers, size_t buffer_size, uint16_t threads,
+                    bool map_output, const char *batch_source, const char *out_dir,
+                    bool verify, bool verbose);
+int execute_decode(const char *input_file, const char *output_file, uint16_t channel,
+                   uint16_t threads, bool verbose);
+int execute_record(const char *output_file, const char *input_file, int device_index,
+                   uint16_t channel, uint32_t sample_rate, double duration, bool fast,
+                   bool list_devices, bool verbose);
+int execute_analyze(const char *input_file, uint16_t channel, const char *kernel_name, bool verbose);
+int execute_scan(char **paths, size_t path_count, bool csv, const char *output_file,
+                 uint16_t threads, uint16_t baud_rate, bool verbose);
+int execute_hash(char **paths, size_t path_count, const char *output_file,
+                 uint16_t threads, bool blocks, bool verbose);
+int execute_dedup(char **paths, size_t path_count, const char *output_file,
+                  uint16_t threads, bool blocks, bool verbose);
 int execute_profile(const char *profile_name, bool verbose);
-int execute_play(const char *filename, bool verbose);
+int execute_play(const char *filename, const char *profile_name, bool verbose);
 
 #endif // COMMANDS_H
@@ -1,10 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 #include "../lib/caslib.h"
 #include "../lib/wavlib.h"
+#include "../lib/verifylib.h"
 #include "../lib/cmdlib.h"
 
 // Validate sample rate (must be divisible by 1200)
@@ -67,6 +72,450 @@ static bool validateChannels(uint16_t channels) {
     return true;
 }
 
+// =============================================================================
+// Batch Conversion - Worker Pool Over Many CAS Files
+// =============================================================================
+
+// Inputs to convert and the shared state of the workers
+typedef struct {
+    char **inputs;
+    char **outputs;                   // WAV path planned for each input
+    size_t count;
+    const char *out_dir;              // NULL: write each WAV next to its input
+    const WaveformConfig *config;
+    const WaveformCache *cache;       // Read-only tables shared by all workers
+    bool verbose;
+    FILE *out;
+    pthread_mutex_t lock;             // Guards everything below and the output
+    size_t next;
+    size_t converted;
+    size_t done;
+    bool *failed;                     // Per input
+    double audio_seconds;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+} BatchPool;
+
+static int compareStrings(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+// Append a copy of path to a growing string array
+static bool appendInput(char ***inputs, size_t *count, size_t *capacity, const char *path) {
+    if (*count >= *capacity) {
+        size_t new_capacity = *capacity ? *capacity * 2 : 64;
+        char **grown = realloc(*inputs, new_capacity * sizeof(char*));
+        if (!grown) {
+            return false;
+        }
+        *inputs = grown;
+        *capacity = new_capacity;
+    }
+    
+    (*inputs)[*count] = strdup(path);
+    return (*inputs)[(*count)++] != NULL;
+}
+
+static void freeInputs(char **inputs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(inputs[i]);
+    }
+    free(inputs);
+}
+
+// Collect the CAS files to convert: every *.cas in a directory (sorted),
+// or the paths listed one per line in a text file (blank lines and
+// lines starting with '#' are skipped)
+static bool collectBatchInputs(const char *source, char ***inputs, size_t *count) {
+    size_t capacity = 0;
+    *inputs = NULL;
+    *count = 0;
+    bool ok = true;
+    
+    struct stat st;
+    if (stat(source, &st) != 0) {
+        fprintf(stderr, "Error: Cannot access '%s': %s\n", source, strerror(errno));
+        return false;
+    }
+    
+    if (S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(source);
+        if (!dir) {
+            fprintf(stderr, "Error: Cannot open directory '%s': %s\n", source, strerror(errno));
+            return false;
+        }
+        struct dirent *entry;
+        while (ok && (entry = readdir(dir)) != NULL) {
+            if (!hasCasExtension(entry->d_name)) {
+                continue;
+            }
+            char *path = buildFilePath(source, entry->d_name);
+            ok = path && appendInput(inputs, count, &capacity, path);
+            free(path);
+        }
+        closedir(dir);
+        if (ok) {
+            qsort(*inputs, *count, sizeof(char*), compareStrings);
+        }
+    } else {
+        FILE *list = fopen(source, "r");
+        if (!list) {
+            fprintf(stderr, "Error: Cannot open list file '%s'\n", source);
+            return false;
+        }
+        char line[4096];
+        while (ok && fgets(line, sizeof(line), list)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            const char *path = line + strspn(line, " \t");
+            if (*path == '\0' || *path == '#') {
+                continue;
+            }
+            ok = appendInput(inputs, count, &capacity, path);
+        }
+        fclose(list);
+    }
+    
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to allocate batch file list\n");
+        freeInputs(*inputs, *count);
+        *inputs = NULL;
+        *count = 0;
+    }
+    return ok;
+}
+
+// Output path for an input: same name with .wav, in out_dir or next to it
+static char* batchOutputPath(const char *input, const char *out_dir) {
+    char *name = generateOutputFilename(input, "wav");
+    if (!name) {
+        return NULL;
+    }
+    
+    char *input_dir = NULL;
+    const char *slash = strrchr(input, '/');
+    if (!out_dir && slash) {
+        input_dir = strndup(input, (size_t)(slash - input));
+    }
+    
+    char *path = buildFilePath(out_dir ? out_dir : input_dir, name);
+    free(input_dir);
+    free(name);
+    return path;
+}
+
+// Where an input's output lands, comparable across spellings of a path:
+// the input's device and inode, and the output's directory resolved by
+// realpath() plus its file name
+typedef struct {
+    char *path;                       // Canonical output path
+    size_t index;
+    dev_t device;
+    ino_t inode;
+    bool exists;                      // Input could be stat()ed
+} PlannedOutput;
+
+// realpath() of the output's directory joined with its name; an output
+// directory not created yet is kept as given (every output shares it)
+static char* canonicalOutputPath(const char *output) {
+    const char *slash = strrchr(output, '/');
+    char *dir = slash ? strndup(output, slash == output ? 1 : (size_t)(slash - output))
+                      : strdup(".");
+    char *real_dir = dir ? realpath(dir, NULL) : NULL;
+    free(dir);
+    if (!real_dir) {
+        return strdup(output);
+    }
+    char *path = buildFilePath(real_dir, slash ? slash + 1 : output);
+    free(real_dir);
+    return path;
+}
+
+static bool sameInput(const PlannedOutput *x, const PlannedOutput *y) {
+    return x->exists && y->exists && x->device == y->device && x->inode == y->inode;
+}
+
+static int compareInputs(const void *a, const void *b) {
+    const PlannedOutput *x = a, *y = b;
+    if (x->exists != y->exists) {
+        return x->exists ? -1 : 1;
+    }
+    if (x->device != y->device) {
+        return x->device < y->device ? -1 : 1;
+    }
+    if (x->inode != y->inode) {
+        return x->inode < y->inode ? -1 : 1;
+    }
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static int comparePlannedOutputs(const void *a, const void *b) {
+    const PlannedOutput *x = a, *y = b;
+    int order = strcmp(x->path, y->path);
+    return order ? order : (x->index > y->index) - (x->index < y->index);
+}
+
+// Plan the WAV path of every input before any is written. Two inputs
+// mapping to one WAV (same name from different directories with an output
+// directory) would overwrite each other in whatever order the workers
+// finish, and a file listed twice (a/g.cas, a/./g.cas, a hard link) would
+// be converted twice, so the batch is refused
+static bool planBatchOutputs(BatchPool *pool) {
+    pool->outputs = calloc(pool->count, sizeof(char*));
+    PlannedOutput *order = calloc(pool->count, sizeof(PlannedOutput));
+    bool ok = pool->outputs && order;
+    for (size_t i = 0; ok && i < pool->count; i++) {
+        pool->outputs[i] = batchOutputPath(pool->inputs[i], pool->out_dir);
+        ok = pool->outputs[i] != NULL;
+        if (ok) {
+            struct stat st;
+            order[i].index = i;
+            order[i].exists = stat(pool->inputs[i], &st) == 0;
+            order[i].device = order[i].exists ? st.st_dev : 0;
+            order[i].inode = order[i].exists ? st.st_ino : 0;
+            order[i].path = canonicalOutputPath(pool->outputs[i]);
+            ok = order[i].path != NULL;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to allocate batch output paths\n");
+        for (size_t i = 0; order && i < pool->count; i++) {
+            free(order[i].path);
+        }
+        free(order);
+        return false;
+    }
+    
+    // The same file under two names
+    qsort(order, pool->count, sizeof(PlannedOutput), compareInputs);
+    size_t duplicates = 0;
+    for (size_t i = 1; i < pool->count; i++) {
+        if (sameInput(&order[i - 1], &order[i])) {
+            fprintf(stderr, "Error: %s and %s are the same file\n",
+                    pool->inputs[order[i - 1].index], pool->inputs[order[i].index]);
+            duplicates++;
+        }
+    }
+    
+    // Different files written to one WAV (the same file is reported above)
+    qsort(order, pool->count, sizeof(PlannedOutput), comparePlannedOutputs);
+    size_t collisions = 0;
+    for (size_t i = 1; i < pool->count; i++) {
+        if (strcmp(order[i - 1].path, order[i].path) == 0 && !sameInput(&order[i - 1], &order[i])) {
+            fprintf(stderr, "Error: %s and %s would both be written to %s\n",
+                    pool->inputs[order[i - 1].index], pool->inputs[order[i].index],
+                    pool->outputs[order[i].index]);
+            collisions++;
+        }
+    }
+    for (size_t i = 0; i < pool->count; i++) {
+        free(order[i].path);
+    }
+    free(order);
+    if (duplicates > 0) {
+        fprintf(stderr, "Error: %zu input(s) listed more than once\n", duplicates);
+    }
+    if (collisions > 0) {
+        fprintf(stderr, "Error: %zu output name collision(s); rename the inputs or convert "
+                "them in separate batches\n", collisions);
+    }
+    return duplicates == 0 && collisions == 0;
+}
+
+static uint64_t fileSizeOf(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+// Worker thread: convert inputs in order until none are left
+static void* batchWorker(void *arg) {
+    BatchPool *pool = arg;
+    
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        size_t index = pool->next;
+        if (index < pool->count) {
+            pool->next++;
+        }
+        pthread_mutex_unlock(&pool->lock);
+        if (index >= pool->count) {
+            break;
+        }
+        
+        const char *input = pool->inputs[index];
+        const char *output = pool->outputs[index];
+        double duration = 0.0;
+        bool ok = convertCasToWavCached(input, output, pool->config, pool->cache, false, &duration);
+        
+        pthread_mutex_lock(&pool->lock);
+        pool->done++;
+        if (ok) {
+            pool->converted++;
+            pool->audio_seconds += duration;
+            pool->bytes_in += fileSizeOf(input);
+            pool->bytes_out += fileSizeOf(output);
+        } else {
+            pool->failed[index] = true;
+        }
+        if (pool->verbose || !ok) {
+            fprintf(pool->out, "  [%zu/%zu] %s %s -> %s\n", pool->done, pool->count,
+                    ok ? "✓" : "✗", input, output);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    
+    return NULL;
+}
+
+static double elapsedSeconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Convert every CAS file from source with threads workers sharing one
+// waveform table; prints aggregate throughput and the failures
+static int convertBatch(const char *source, const char *out_dir,
+                        const WaveformConfig *config, uint16_t threads, bool verbose) {
+    BatchPool pool = {
+        .out_dir = out_dir,
+        .config = config,
+        .verbose = verbose,
+        .out = stdout
+    };
+    if (!collectBatchInputs(source, &pool.inputs, &pool.count)) {
+        return 1;
+    }
+    if (pool.count == 0) {
+        fprintf(stderr, "Error: No CAS files found in '%s'\n", source);
+        free(pool.inputs);
+        return 1;
+    }
+    if (!planBatchOutputs(&pool) || (out_dir && !createDirectory(out_dir))) {
+        freeInputs(pool.outputs, pool.outputs ? pool.count : 0);
+        freeInputs(pool.inputs, pool.count);
+        return 1;
+    }
+    
+    // One table for every file: rendered once, then only read
+    WaveformCache *cache = createWaveformCache(config);
+    pool.failed = calloc(pool.count, sizeof(bool));
+    if (!cache || !pool.failed) {
+        fprintf(stderr, "Error: Failed to prepare batch conversion\n");
+        freeWaveformCache(cache);
+        free(pool.failed);
+        freeInputs(pool.outputs, pool.count);
+        freeInputs(pool.inputs, pool.count);
+        return 1;
+    }
+    pool.cache = cache;
+    pthread_mutex_init(&pool.lock, NULL);
+    
+    size_t thread_count = threads > pool.count ? pool.count : threads;
+    printf("Converting %zu CAS files on %zu thread%s...\n", pool.count, thread_count,
+           thread_count == 1 ? "" : "s");
+    fflush(stdout);
+    
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    pthread_t *workers = calloc(thread_count, sizeof(pthread_t));
+    size_t started = 0;
+    while (workers && started < thread_count &&
+           pthread_create(&workers[started], NULL, batchWorker, &pool) == 0) {
+        started++;
+    }
+    if (started < thread_count) {
+        fprintf(stderr, "Warning: Started %zu of %zu worker threads\n", started, thread_count);
+    }
+    if (started == 0) {
+        batchWorker(&pool);  // No threads: convert on this one
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    double elapsed = elapsedSeconds(&start);
+    
+    // Aggregate results
+    size_t failures = pool.count - pool.converted;
+    char in_size[32], out_size[32], audio[32];
+    formatBytes(pool.bytes_in, in_size, sizeof(in_size));
+    formatBytes(pool.bytes_out, out_size, sizeof(out_size));
+    formatDuration(pool.audio_seconds, audio, sizeof(audio));
+    
+    printf("\n=== Batch Summary ===\n");
+    printf("Converted:  %zu of %zu files", pool.converted, pool.count);
+    if (failures > 0) {
+        printf(" (%zu failed)", failures);
+    }
+    printf("\n");
+    printf("Input:      %s CAS\n", in_size);
+    printf("Output:     %s WAV, %s of audio\n", out_size, audio);
+    printf("Elapsed:    %.2f seconds\n", elapsed);
+    if (elapsed > 0.0) {
+        printf("Throughput: %.1f files/s, %.1f MB/s written, %.0fx real time\n",
+               pool.converted / elapsed, pool.bytes_out / elapsed / (1024.0 * 1024.0),
+               pool.audio_seconds / elapsed);
+    }
+    if (failures > 0) {
+        printf("Failed:\n");
+        for (size_t i = 0; i < pool.count; i++) {
+            if (pool.failed[i]) {
+                printf("  %s\n", pool.inputs[i]);
+            }
+        }
+    }
+    
+    pthread_mutex_destroy(&pool.lock);
+    free(workers);
+    free(pool.failed);
+    freeWaveformCache(cache);
+    freeInputs(pool.outputs, pool.count);
+    freeInputs(pool.inputs, pool.count);
+    return failures > 0 ? 1 : 0;
+}
+
+// Show whether the WAV decodes back to the container, or where it first
+// does not; returns true on a match
+static bool reportVerification(TapeVerifier *verifier, const cas_Container *container,
+                               uint32_t sample_rate, FILE *out) {
+    TapeVerifyResult result;
+    if (!finishTapeVerifier(verifier, &result)) {
+        fprintf(out, "✗ Verification could not run\n");
+        return false;
+    }
+    if (result.status == VERIFY_MATCH) {
+        fprintf(out, "✓ Verified: %zu blocks decode back to the original bytes\n",
+                result.blocks_expected);
+        return true;
+    }
+
+    char at[32];
+    formatDuration(result.sample / (double)sample_rate, at, sizeof(at));
+    fprintf(out, "✗ Verification failed: %s", getTapeVerifyStatusString(result.status));
+    if (result.status == VERIFY_EXTRA_BLOCK) {
+        fprintf(out, " after the last file\n");
+    } else {
+        const cas_File *file = &container->files[result.file_index];
+        fprintf(out, " in file %zu (%s", result.file_index + 1, getFileTypeString(file));
+        if (!file->is_custom) {
+            fprintf(out, " \"%.6s\"", (const char *)file->file_header.file_name);
+        }
+        if (result.header_block) {
+            fprintf(out, "), header block, byte %zu\n", result.byte_offset);
+        } else {
+            fprintf(out, "), data block %zu, byte %zu\n", result.block_index + 1, result.byte_offset);
+        }
+    }
+    char expected[16], found[16];
+    snprintf(expected, sizeof(expected), result.expected >= 0 ? "0x%02X" : "end of block",
+             result.expected);
+    snprintf(found, sizeof(found), result.found >= 0 ? "0x%02X" : "nothing", result.found);
+    fprintf(out, "  Expected: %s, decoded: %s\n", expected, found);
+    fprintf(out, "  At sample %llu (%s); %zu of %zu blocks decoded\n",
+            (unsigned long long)result.sample, at, result.blocks_decoded, result.blocks_expected);
+    return false;
+}
+
 int execute_convert(const char *input_file, const char *output_file,
                     uint16_t baud_rate, uint32_t sample_rate, 
                     WaveformType waveform_type, uint16_t channels,
@@ -74,11 +523,17 @@ int execute_convert(const char *input_file, const char *output_file,
                     uint8_t trapezoid_rise_percent,
                     float long_silence, float short_silence,
                     bool enable_lowpass, uint16_t lowpass_cutoff_hz,
-                    bool enable_markers, bool verbose) {
+                    bool enable_markers, size_t buffer_size, uint16_t threads,
+                    bool map_output, const char *batch_source, const char *out_dir,
+                    bool verify, bool verbose) {
     
-    // Generate output filename if not provided
+    // Generate output filename if not provided (batches name each output)
     char *generated_output = NULL;
-    if (!output_file) {
+    if (!output_file && !batch_source && strcmp(input_file, "-") == 0) {
+        fprintf(stderr, "Error: Reading CAS data from stdin needs an output file (-o)\n");
+        return 1;
+    }
+    if (!output_file && !batch_source) {
         generated_output = generateOutputFilename(input_file, "wav");
         if (!generated_output) {
             return 1;
@@ -86,6 +541,10 @@ int execute_convert(const char *input_file, const char *output_file,
         output_file = generated_output;
     }
     
+    // "-o -" streams the WAV to stdout; all messages go to stderr instead
+    bool streaming = output_file && (strcmp(output_file, "-") == 0);
+    FILE *out = streaming ? stderr : stdout;
+    
     // Validate all parameters
     if (!validateBaudRate(baud_rate)) {
         if (generated_output) free(generated_output);
@@ -109,36 +568,45 @@ int execute_convert(const char *input_file, const char *output_file,
     }
     
     if (verbose) {
-        printf("=== CAS to WAV Conversion ===\n");
-        printf("Input:  %s\n", input_file);
-        printf("Output: %s\n\n", output_file);
+        fprintf(out, "=== CAS to WAV Conversion ===\n");
+        if (batch_source) {
+            fprintf(out, "Batch:  %s\n", batch_source);
+            fprintf(out, "Output: %s\n\n", out_dir ? out_dir : "next to each input");
+        } else {
+            fprintf(out, "Input:  %s\n", input_file);
+            fprintf(out, "Output: %s\n\n", streaming ? "<stdout>" : output_file);
+        }
         
-        printf("Audio Settings:\n");
-        printf("  Baud rate:     %u baud (%s)\n", baud_rate, 
+        fprintf(out, "Audio Settings:\n");
+        fprintf(out, "  Baud rate:     %u baud (%s)\n", baud_rate, 
                baud_rate == 1200 ? "standard" : "turbo");
-        printf("  Sample rate:   %u Hz\n", sample_rate);
-        printf("  Bit depth:     %u-bit\n", bits_per_sample);
-        printf("  Channels:      %u (%s)\n", channels, 
+        fprintf(out, "  Sample rate:   %u Hz\n", sample_rate);
+        fprintf(out, "  Bit depth:     %u-bit\n", bits_per_sample);
+        fprintf(out, "  Channels:      %u (%s)\n", channels, 
                channels == 1 ? "mono" : "stereo");
-        printf("  Amplitude:     %u\n", amplitude);
-        printf("  Waveform:      ");
+        fprintf(out, "  Amplitude:     %u\n", amplitude);
+        fprintf(out, "  Waveform:      ");
         switch (waveform_type) {
-            case WAVE_SINE: printf("sine\n"); break;
-            case WAVE_SQUARE: printf("square\n"); break;
-            case WAVE_TRIANGLE: printf("triangle\n"); break;
+            case WAVE_SINE: fprintf(out, "sine\n"); break;
+            case WAVE_SQUARE: fprintf(out, "square\n"); break;
+            case WAVE_TRIANGLE: fprintf(out, "triangle\n"); break;
             case WAVE_TRAPEZOID: 
-                printf("trapezoid (rise: %u%%)\n", trapezoid_rise_percent); 
+                fprintf(out, "trapezoid (rise: %u%%)\n", trapezoid_rise_percent); 
                 break;
-            default: printf("unknown\n"); break;
+            default: fprintf(out, "unknown\n"); break;
         }
-        printf("  Low-pass:      %s", enable_lowpass ? "enabled" : "disabled");
+        fprintf(out, "  Low-pass:      %s", enable_lowpass ? "enabled" : "disabled");
         if (enable_lowpass) {
-            printf(" (cutoff: %u Hz)", lowpass_cutoff_hz);
+            fprintf(out, " (cutoff: %u Hz)", lowpass_cutoff_hz);
         }
-        printf("\n");
-        printf("  Leader timing: %.1fs / %.1fs (long/short)\n", long_silence, short_silence);
-        printf("  Cue markers:   %s\n", enable_markers ? "enabled" : "disabled");
-        printf("\n");
+        fprintf(out, "\n");
+        fprintf(out, "  Leader timing: %.1fs / %.1fs (long/short)\n", long_silence, short_silence);
+        fprintf(out, "  Cue markers:   %s\n", enable_markers ? "enabled" : "disabled");
+        fprintf(out, "  Write buffer:  %zu KiB\n", (buffer_size ? buffer_size : WAV_DEFAULT_BUFFER_SIZE) / 1024);
+        fprintf(out, "  Threads:       %u\n", threads);
+        fprintf(out, "  Write mode:    %s\n", map_output ? "preallocated, memory-mapped" : "buffered writes");
+        fprintf(out, "  Verify:        %s\n", verify ? "decode while rendering" : "disabled");
+        fprintf(out, "\n");
     }
     
     // Configure WAV format
@@ -167,79 +635,110 @@ int execute_convert(const char *input_file, const char *output_file,
     waveform.enable_lowpass = enable_lowpass;
     waveform.lowpass_cutoff_hz = lowpass_cutoff_hz;
     waveform.enable_markers = enable_markers;
+    waveform.output_buffer_size = buffer_size;
+    waveform.render_threads = threads;
+    waveform.map_output = map_output;
+    waveform.sample_tap = NULL;
     
-    // Read and verify CAS file first
-    size_t file_size;
-    uint8_t *file_data = readFileIntoMemory(input_file, &file_size);
-    if (!file_data) {
-        fprintf(stderr, "Error: Failed to read file '%s'\n", input_file);
+    // Batches spread files over the threads; each file renders serially
+    if (batch_source) {
+        waveform.render_threads = 1;
+        return convertBatch(batch_source, out_dir, &waveform, threads, verbose);
+    }
+    
+    // Read and verify CAS file first ("-" reads stdin)
+    cas_Input input;
+    if (!openCasInput(input_file, &input)) {
+        if (generated_output) free(generated_output);
+        return 1;
+    }
+    if (input.size == 0) {
+        fprintf(stderr, "Error: CAS file is empty\n");
+        closeCasInput(&input);
+        if (generated_output) free(generated_output);
         return 1;
     }
     
     if (verbose) {
-        printf("CAS file: %zu bytes\n", file_size);
+        fprintf(out, "CAS file: %zu bytes\n", input.size);
     }
     
-    // Parse CAS container to show what we're converting
+    // Parse the CAS container once: it is listed below and rendered as is
     cas_Container container;
-    if (!parseCasContainer(file_data, &container, file_size)) {
+    if (!parseCasContainerInPlace(input.data, &container, input.size)) {
         fprintf(stderr, "Error: Failed to parse CAS file\n");
-        free(file_data);
+        closeCasInput(&input);
+        if (generated_output) free(generated_output);
         return 1;
     }
     
     if (verbose) {
-        printf("Files in container: %zu\n", container.file_count);
+        fprintf(out, "Files in container: %zu\n", container.file_count);
         for (size_t i = 0; i < container.file_count; i++) {
             const cas_File *file = &container.files[i];
-            printf("  %zu. %s", i + 1, getFileTypeString(file));
+            fprintf(out, "  %zu. %s", i + 1, getFileTypeString(file));
             if (!file->is_custom) {
-                printf(" \"%.6s\"", (char*)file->file_header.file_name);
+                fprintf(out, " \"%.6s\"", (char*)file->file_header.file_name);
             }
             
             size_t total_data = 0;
             for (size_t j = 0; j < file->data_block_count; j++) {
                 total_data += file->data_blocks[j].data_size;
             }
-            printf(" (%zu bytes)\n", total_data);
+            fprintf(out, " (%zu bytes)\n", total_data);
         }
-        printf("\n");
+        fprintf(out, "\n");
     }
     
-    // Store container for later command generation
-    cas_Container saved_container = container;
+    // The verifier decodes the samples as they are written
+    TapeVerifier *verifier = NULL;
+    if (verify) {
+        verifier = createTapeVerifier(&container, &waveform);
+        if (!verifier) {
+            freeCasContainer(&container);
+            closeCasInput(&input);
+            if (generated_output) free(generated_output);
+            return 1;
+        }
+        waveform.sample_tap = getTapeVerifierSink(verifier);
+        if (verbose && (threads > 1 || map_output)) {
+            fprintf(out, "Verify: rendering serially with buffered writes\n\n");
+        }
+    }
     
-    // Perform conversion
+    // Perform conversion from the container parsed above
     double duration = 0.0;
-    if (!convertCasToWav(input_file, output_file, &waveform, verbose, &duration)) {
+    if (!convertContainerToWavFile(&container, output_file, &waveform, NULL, verbose, &duration)) {
         fprintf(stderr, "Error: Conversion failed\n");
-        free(container.files);
-        free(file_data);
+        freeTapeVerifier(verifier);
+        freeCasContainer(&container);
+        closeCasInput(&input);
+        if (generated_output) free(generated_output);
         return 1;
     }
     
     // Success message with duration
     int minutes = (int)(duration / 60.0);
     int seconds = (int)(duration) % 60;
-    printf("✓ Conversion complete!\n");
-    printf("Audio length: %d:%02d (%.1f seconds)\n", minutes, seconds, duration);
+    fprintf(out, "✓ Conversion complete!\n");
+    fprintf(out, "Audio length: %d:%02d (%.1f seconds)\n", minutes, seconds, duration);
     
     // Generate MSX command for loading (find first non-custom file)
-    printf("MSX Command: ");
+    fprintf(out, "MSX Command: ");
     
     bool found_command = false;
-    for (size_t i = 0; i < saved_container.file_count; i++) {
-        const cas_File *file = &saved_container.files[i];
+    for (size_t i = 0; i < container.file_count; i++) {
+        const cas_File *file = &container.files[i];
         
         if (!file->is_custom && !found_command) {
             if (isAsciiFile(file->file_header.file_type) || isBasicFile(file->file_header.file_type)) {
                 // Both ASCII and BASIC files use RUN"CAS:",R to load and auto-run
-                printf("RUN\"CAS:\",R\n");
+                fprintf(out, "RUN\"CAS:\",R\n");
             } else if (isBinaryFile(file->file_header.file_type)) {
                 if (file->data_block_header.exec_address != 0) {
-                    printf("BLOAD\"CAS:\",R\n");
+                    fprintf(out, "BLOAD\"CAS:\",R\n");
                 } else {
-                    printf("BLOAD\"CAS:\"\n");
+                    fprintf(out, "BLOAD\"CAS:\"\n");
                 }
             }
             found_command = true;
@@ -249,18 +748,20 @@ int execute_convert(const char *input_file, const char *output_file,
     
     if (!found_command) {
         if (verbose) {
-            printf("(Custom format - no standard MSX load command)\n");
+            fprintf(out, "(Custom format - no standard MSX load command)\n");
         } else {
-            printf("(Custom format)\n");
+            fprintf(out, "(Custom format)\n");
         }
     }
     
-    free(saved_container.files);
-    free(file_data);
+    bool verified = !verifier || reportVerification(verifier, &container, sample_rate, out);
+    freeTapeVerifier(verifier);
+    freeCasContainer(&container);
+    closeCasInput(&input);
     
     if (generated_output) {
         free(generated_output);
     }
     
-    return 0;
+    return verified ? 0 : 1;
 }
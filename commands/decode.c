@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../lib/caslib.h"
+#include "../lib/decodelib.h"
+#include "../lib/cmdlib.h"
+
+static double elapsedSeconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static bool writeImage(const char *output_file, const uint8_t *image, size_t size) {
+    bool to_stdout = strcmp(output_file, "-") == 0;
+    FILE *file = to_stdout ? stdout : fopen(output_file, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create output file %s\n", output_file);
+        return false;
+    }
+
+    bool ok = fwrite(image, 1, size, file) == size;
+    ok = (to_stdout ? fflush(file) : fclose(file)) == 0 && ok;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write %s\n", output_file);
+    }
+    return ok;
+}
+
+int execute_decode(const char *input_file, const char *output_file, uint16_t channel,
+                   uint16_t threads, bool verbose) {
+    // Generate output filename if not provided
+    char *generated_output = NULL;
+    if (!output_file && strcmp(input_file, "-") == 0) {
+        fprintf(stderr, "Error: Reading WAV data from stdin needs an output file (-o)\n");
+        return 1;
+    }
+    if (!output_file) {
+        generated_output = generateOutputFilename(input_file, "cas");
+        if (!generated_output) {
+            return 1;
+        }
+        output_file = generated_output;
+    }
+
+    // "-o -" writes the CAS image to stdout; all messages go to stderr instead
+    bool streaming = strcmp(output_file, "-") == 0;
+    FILE *out = streaming ? stderr : stdout;
+
+    if (verbose) {
+        fprintf(out, "=== WAV to CAS Decoding ===\n");
+        fprintf(out, "Input:   %s (channel %u)\n", input_file, channel + 1);
+        fprintf(out, "Output:  %s\n", streaming ? "<stdout>" : output_file);
+        fprintf(out, "Threads: %u\n\n", threads);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    TapeDecoderConfig config = {.threads = threads};
+    TapeDecoder *decoder = decodeWavFile(input_file, channel, &config);
+    if (!decoder) {
+        free(generated_output);
+        return 1;
+    }
+    double elapsed = elapsedSeconds(&start);
+
+    size_t block_count, image_size;
+    const TapeBlock *blocks = getTapeDecoderBlocks(decoder, &block_count);
+    const uint8_t *image = getTapeDecoderImage(decoder, &image_size);
+    double rate = getTapeDecoderSampleRate(decoder);
+    double duration = getTapeDecoderPosition(decoder) / rate;
+
+    if (block_count == 0) {
+        fprintf(stderr, "Error: No tape blocks found in %s\n", input_file);
+        freeTapeDecoder(decoder);
+        free(generated_output);
+        return 1;
+    }
+
+    size_t errors = 0;
+    for (size_t i = 0; i < block_count; i++) {
+        if (blocks[i].error) {
+            errors++;
+        }
+    }
+
+    if (verbose) {
+        fprintf(out, "  # |   Leader |     Data |      End |  Baud |    Bytes\n");
+        fprintf(out, "----+----------+----------+----------+-------+---------\n");
+        for (size_t i = 0; i < block_count; i++) {
+            const TapeBlock *block = &blocks[i];
+            fprintf(out, "%3zu | %7.2fs | %7.2fs | %7.2fs | %5u | %8zu%s\n", i + 1,
+                    block->leader_start / rate, block->data_start / rate, block->end / rate,
+                    block->baud_rate, block->size, block->error ? "  framing error" : "");
+        }
+        fprintf(out, "\n");
+    }
+
+    if (!writeImage(output_file, image, image_size)) {
+        freeTapeDecoder(decoder);
+        free(generated_output);
+        return 1;
+    }
+
+    // List the files the way the CAS parser sees them
+    cas_Container container;
+    if (verbose && buildTapeDecoderContainer(decoder, &container)) {
+        fprintf(out, "Files found: %zu\n", container.file_count);
+        for (size_t i = 0; i < container.file_count; i++) {
+            const cas_File *file = &container.files[i];
+            fprintf(out, "  %zu. %s", i + 1, getFileTypeString(file));
+            if (!file->is_custom) {
+                fprintf(out, " \"%.6s\"", (char*)file->file_header.file_name);
+            }
+            size_t total_size = 0;
+            for (size_t j = 0; j < file->data_block_count; j++) {
+                total_size += file->data_blocks[j].data_size;
+            }
+            fprintf(out, " (%zu bytes)\n", total_size);
+        }
+        fprintf(out, "\n");
+        freeCasContainer(&container);
+    }
+
+    char audio[32], size_str[32];
+    formatDuration(duration, audio, sizeof(audio));
+    formatBytes(image_size, size_str, sizeof(size_str));
+    if (errors > 0) {
+        fprintf(out, "⚠ Decoded with %zu damaged block(s) of %zu\n", errors, block_count);
+    } else {
+        fprintf(out, "✓ Decoding complete!\n");
+    }
+    fprintf(out, "Blocks: %zu, CAS size: %s\n", block_count, size_str);
+    fprintf(out, "Audio length: %s (%.1f seconds)", audio, duration);
+    if (elapsed > 0.0) {
+        fprintf(out, ", decoded at %.0fx real time", duration / elapsed);
+    }
+    fprintf(out, "\n");
+
+    freeTapeDecoder(decoder);
+    free(generated_output);
+    return errors > 0 ? 1 : 0;
+}
@@ -1,71 +1,189 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "../lib/caslib.h"
 #include "../lib/printlib.h"
 #include "../lib/cmdlib.h"
+#include "../lib/indexlib.h"
+
+// Where and how files are written
+typedef struct {
+    int dir_fd;               // Output directory (AT_FDCWD: current one)
+    const char *output_dir;   // Its name, for messages
+    int source_fd;            // The CAS file, to splice blocks from (or -1)
+    bool force;
+    bool verbose;
+    bool disk_format;
+} ExportTarget;
 
 // Helper function to export a single file
-static int export_single_file(const cas_File *file, int index, const char *output_dir, 
-                               bool force, bool verbose, bool disk_format) {
+static int export_single_file(const cas_File *file, int index, const ExportTarget *target) {
     char *filename = generateFilename(file, index);
     if (!filename) {
         fprintf(stderr, "Error: Failed to generate filename for file %d\n", index);
         return 1;
     }
     
-    char *filepath = buildFilePath(output_dir, filename);
+    char *filepath = buildFilePath(target->output_dir, filename);
     if (!filepath) {
         fprintf(stderr, "Error: Failed to build output path for '%s'\n", filename);
         free(filename);
         return 1;
     }
     
-    // Check if file exists and force flag
-    if (fileExists(filepath) && !force) {
-        fprintf(stderr, "Error: File '%s' already exists (use -f to overwrite)\n", filepath);
-        free(filepath);
-        free(filename);
-        return 1;
-    }
-    
-    int result = writeFileData(filepath, file, verbose, disk_format) ? 0 : 1;
+    // Existing files are only replaced with the force flag
+    int result = writeFileData(target->dir_fd, filename, filepath, file, target->source_fd,
+                               target->force, target->verbose, target->disk_format) ? 0 : 1;
     
     free(filepath);
     free(filename);
     return result;
 }
 
-int execute_export(const char *input_file, int filter_index, const char *output_dir, bool force, bool verbose, bool disk_format) {
+// Files of one container shared by the export workers
+typedef struct {
+    const cas_Container *container;
+    const ExportTarget *target;
+    pthread_mutex_t lock;
+    size_t next;              // Next file to hand out
+    bool failed;              // No new files after the first failure
+} ExportPool;
+
+static void* exportWorker(void *arg) {
+    ExportPool *pool = arg;
+    
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        size_t index = pool->next;
+        bool take = !pool->failed && index < pool->container->file_count;
+        if (take) {
+            pool->next++;
+        }
+        pthread_mutex_unlock(&pool->lock);
+        if (!take) {
+            break;
+        }
+        
+        if (export_single_file(&pool->container->files[index], (int)index + 1, pool->target) != 0) {
+            pthread_mutex_lock(&pool->lock);
+            pool->failed = true;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+    
+    return NULL;
+}
+
+// Export every file of container on up to threads workers
+static int export_all_files(const cas_Container *container, const ExportTarget *target, uint16_t threads) {
+    ExportPool pool = {
+        .container = container,
+        .target = target
+    };
+    pthread_mutex_init(&pool.lock, NULL);
+    
+    size_t thread_count = threads > container->file_count ? container->file_count : threads;
+    pthread_t *workers = thread_count > 1 ? calloc(thread_count, sizeof(pthread_t)) : NULL;
+    size_t started = 0;
+    while (workers && started < thread_count &&
+           pthread_create(&workers[started], NULL, exportWorker, &pool) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        exportWorker(&pool);  // One thread (or none started): export on this one
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    
+    free(workers);
+    pthread_mutex_destroy(&pool.lock);
+    return pool.failed ? 1 : 0;
+}
+
+// Release the directory and source descriptors
+static int finish_export(ExportTarget *target, int result) {
+    if (target->dir_fd != AT_FDCWD) {
+        close(target->dir_fd);
+    }
+    if (target->source_fd >= 0) {
+        close(target->source_fd);
+    }
+    return result;
+}
+
+int execute_export(const char *input_file, int filter_index, const char *output_dir, bool force,
+                   bool verbose, bool disk_format, uint16_t threads) {
     if (verbose) {
         printf("Reading file: %s\n", input_file);
     }
     
-    // Create output directory if specified
+    // Create output directory if specified; files are created relative to
+    // one descriptor for it, so the path is resolved once
     if (output_dir && !createDirectory(output_dir)) {
         return 1;
     }
+    ExportTarget target = {
+        .dir_fd = AT_FDCWD,
+        .output_dir = output_dir,
+        .source_fd = -1,
+        .force = force,
+        .verbose = verbose,
+        .disk_format = disk_format
+    };
+    if (output_dir) {
+        target.dir_fd = open(output_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (target.dir_fd < 0) {
+            fprintf(stderr, "Error: Cannot open directory '%s': %s\n", output_dir, strerror(errno));
+            return 1;
+        }
+    }
     
-    // Read the file into memory
-    size_t file_size;
-    uint8_t *file_data = readFileIntoMemory(input_file, &file_size);
-    if (!file_data) {
-        fprintf(stderr, "Error: Failed to read file '%s'\n", input_file);
-        return 1;
+    // Blocks are spliced from the CAS file itself; stdin is written from memory
+    if (strcmp(input_file, "-") != 0) {
+        target.source_fd = open(input_file, O_RDONLY | O_CLOEXEC);
+    }
+    
+    // With an up-to-date sidecar index, read only the requested file
+    if (filter_index > 0) {
+        cas_Container single;
+        bool indexed = false;
+        if (readIndexedFile(input_file, (size_t)filter_index - 1, &single, &indexed)) {
+            if (verbose) {
+                printf("Using index: %s%s\n\n", input_file, CAS_INDEX_SUFFIX);
+            }
+            int result = export_single_file(&single.files[0], filter_index, &target);
+            freeCasContainer(&single);
+            return finish_export(&target, result);
+        }
+        if (indexed) {
+            // Already reported: out of range or out of memory
+            return finish_export(&target, 1);
+        }
+    }
+    
+    // Load the file (mapped when it is a regular file)
+    cas_Input input;
+    if (!openCasInput(input_file, &input)) {
+        return finish_export(&target, 1);
     }
     
     if (verbose) {
-        printf("File size: %zu bytes\n", file_size);
+        printf("File size: %zu bytes\n", input.size);
         printf("Parsing CAS container...\n");
     }
     
     // Parse the CAS container
     cas_Container container;
-    if (!parseCasContainer(file_data, &container, file_size)) {
+    if (!parseCasContainerInPlace(input.data, &container, input.size)) {
         fprintf(stderr, "Error: Failed to parse CAS container\n");
-        free(file_data);
-        return 1;
+        closeCasInput(&input);
+        return finish_export(&target, 1);
     }
     
     if (verbose) {
@@ -80,20 +198,16 @@ int execute_export(const char *input_file, int filter_index, const char *output_
             fprintf(stderr, "Error: Index %d out of range (1-%zu)\n", filter_index, container.file_count);
             result = 1;
         } else {
-            result = export_single_file(&container.files[filter_index - 1], filter_index, 
-                                        output_dir, force, verbose, disk_format);
+            result = export_single_file(&container.files[filter_index - 1], filter_index, &target);
         }
     } else {
         // Export all files
-        for (size_t i = 0; i < container.file_count && result == 0; i++) {
-            result = export_single_file(&container.files[i], i + 1, 
-                                        output_dir, force, verbose, disk_format);
-        }
+        result = export_all_files(&container, &target, threads);
     }
     
     // Clean up
-    free(container.files);
-    free(file_data);
+    freeCasContainer(&container);
+    closeCasInput(&input);
     
-    return result;
+    return finish_export(&target, result);
 }
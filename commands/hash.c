@@ -0,0 +1,531 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../lib/caslib.h"
+#include "../lib/hashlib.h"
+#include "../lib/cmdlib.h"
+
+// =============================================================================
+// Content Hashes
+// =============================================================================
+
+// Hashes of every file (and, if asked, block) of one container. blocks is
+// indexed by the file's first block: first_block[i] + j
+typedef struct {
+    cas_ContentHash *files;
+    cas_ContentHash *blocks;
+    size_t *first_block;
+    uint64_t container;
+} ContainerHashes;
+
+static void freeContainerHashes(ContainerHashes *hashes) {
+    free(hashes->files);
+    free(hashes->blocks);
+    free(hashes->first_block);
+}
+
+static bool hashContainer(const cas_Container *container, bool with_blocks, ContainerHashes *hashes) {
+    size_t count = container->file_count ? container->file_count : 1;
+    size_t block_count = 0;
+    for (size_t i = 0; i < container->file_count; i++) {
+        block_count += container->files[i].data_block_count;
+    }
+
+    hashes->files = malloc(count * sizeof(cas_ContentHash));
+    hashes->first_block = malloc(count * sizeof(size_t));
+    hashes->blocks = with_blocks ? malloc((block_count ? block_count : 1) * sizeof(cas_ContentHash)) : NULL;
+    if (!hashes->files || !hashes->first_block || (with_blocks && !hashes->blocks)) {
+        freeContainerHashes(hashes);
+        return false;
+    }
+
+    size_t block = 0;
+    for (size_t i = 0; i < container->file_count; i++) {
+        hashes->first_block[i] = block;
+        hashes->files[i] = hashCasFile(&container->files[i], with_blocks ? &hashes->blocks[block] : NULL);
+        block += container->files[i].data_block_count;
+    }
+    hashes->container = hashCasContainer(container, hashes->files);
+    return true;
+}
+
+// =============================================================================
+// cast hash - One Record per Tape File
+// =============================================================================
+
+typedef struct {
+    pthread_mutex_t lock;             // Guards the output and the counts
+    FILE *out;
+    bool blocks;
+    bool verbose;
+    size_t files;
+} HashOutput;
+
+static void writeHashRecords(FILE *out, const char *path, const cas_Container *container,
+                             const ContainerHashes *hashes) {
+    size_t path_length = strlen(path);
+    for (size_t i = 0; i < container->file_count; i++) {
+        const cas_File *file = &container->files[i];
+        fputs("{\"path\":", out);
+        writeJsonString(out, path, path_length);
+        fprintf(out, ",\"index\":%zu,\"type\":\"%s\",\"name\":", i + 1, getFileTypeString(file));
+        if (file->is_custom) {
+            fputs("null", out);
+        } else {
+            char name[32];
+            formatTapeName(file, name, sizeof(name));
+            writeJsonString(out, name, strlen(name));
+        }
+        fprintf(out, ",\"size\":%zu,\"hash\":\"%016llx\"", hashes->files[i].size,
+                (unsigned long long)hashes->files[i].hash);
+        if (hashes->blocks) {
+            fputs(",\"blocks\":[", out);
+            for (size_t j = 0; j < file->data_block_count; j++) {
+                fprintf(out, "%s\"%016llx\"", j ? "," : "",
+                        (unsigned long long)hashes->blocks[hashes->first_block[i] + j].hash);
+            }
+            fputc(']', out);
+        }
+        fputs("}\n", out);
+    }
+}
+
+static bool hashRecords(void *context, const char *path, const cas_Container *container,
+                        size_t input_size) {
+    (void)input_size;
+    HashOutput *output = context;
+
+    ContainerHashes hashes;
+    char *records = NULL;
+    size_t records_size = 0;
+    bool ok = false;
+    if (hashContainer(container, output->blocks, &hashes)) {
+        FILE *buffer = open_memstream(&records, &records_size);
+        if (buffer) {
+            writeHashRecords(buffer, path, container, &hashes);
+            ok = (fclose(buffer) == 0);
+        }
+        freeContainerHashes(&hashes);
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to hash '%s'\n", path);
+    }
+
+    pthread_mutex_lock(&output->lock);
+    if (ok) {
+        fwrite(records, 1, records_size, output->out);
+        output->files += container->file_count;
+        if (output->verbose) {
+            fprintf(stderr, "  %s: %zu file(s)\n", path, container->file_count);
+        }
+    }
+    pthread_mutex_unlock(&output->lock);
+
+    free(records);
+    return ok;
+}
+
+int execute_hash(char **paths, size_t path_count, const char *output_file,
+                 uint16_t threads, bool blocks, bool verbose) {
+    HashOutput output = {
+        .blocks = blocks,
+        .verbose = verbose
+    };
+    output.out = output_file ? fopen(output_file, "w") : stdout;
+    if (!output.out) {
+        fprintf(stderr, "Error: Cannot create file '%s'\n", output_file);
+        return 1;
+    }
+
+    pthread_mutex_init(&output.lock, NULL);
+    CasWalkStats stats;
+    walkCasFiles(paths, path_count, threads, hashRecords, &output, &stats);
+    pthread_mutex_destroy(&output.lock);
+
+    bool written = (fflush(output.out) == 0);
+    if (output_file && fclose(output.out) != 0) {
+        written = false;
+    }
+    if (!written) {
+        fprintf(stderr, "Error: Failed to write hash records\n");
+    }
+    if (stats.out_of_memory) {
+        fprintf(stderr, "Error: Out of memory; some CAS files were not hashed\n");
+    }
+
+    printCasWalkSummary(&stats, "Hashed", output.files);
+    if (verbose) {
+        fprintf(stderr, "CRC32C: %s\n", hasHardwareCrc32c() ? "hardware" : "lookup tables");
+    }
+    return (stats.failed > 0 || stats.out_of_memory || !written) ? 1 : 0;
+}
+
+// =============================================================================
+// cast dedup - Duplicate Groups Across Containers
+// =============================================================================
+//
+// Every container, file and (with --blocks) block becomes one entry in a
+// flat array. A hash index per kind maps a content hash to the first entry
+// seen with it; later entries with the same hash are chained behind that
+// first one. Only hashes and positions are kept, so the index for a
+// million tape files takes tens of megabytes, whatever the archive size.
+// Groups are sorted by path before they are written, so the output does
+// not depend on the thread count.
+
+#define DEDUP_END UINT32_MAX
+
+typedef enum {
+    DEDUP_CONTAINER,
+    DEDUP_FILE,
+    DEDUP_BLOCK,
+    DEDUP_KINDS
+} DedupKind;
+
+static const char *const DEDUP_KIND_NAMES[DEDUP_KINDS] = {"container", "file", "block"};
+
+typedef struct {
+    uint64_t hash;
+    uint64_t size;            // Payload bytes (tape files for containers)
+    const char *type;         // getFileTypeString() of the file
+    uint32_t container;       // Index in paths
+    uint32_t file;            // 0-based file and block numbers
+    uint32_t block;
+    uint32_t next;            // Next copy of the same content, DEDUP_END ends
+    uint8_t file_name[6];
+    uint8_t kind;
+} DedupEntry;
+
+typedef struct {
+    pthread_mutex_t lock;             // Guards everything below
+    bool blocks;
+    bool verbose;
+    bool out_of_memory;
+
+    char **paths;                     // One per visited container
+    size_t path_count;
+    size_t path_capacity;
+
+    DedupEntry *entries;
+    size_t entry_count;
+    size_t entry_capacity;
+    cas_HashIndex index[DEDUP_KINDS];
+    size_t files;
+} DedupState;
+
+// Append an entry and link it behind the first one with its hash (lock held)
+static bool addDedupEntry(DedupState *state, const DedupEntry *entry) {
+    if (state->entry_count >= DEDUP_END - 1) {
+        return false;
+    }
+    if (state->entry_count >= state->entry_capacity) {
+        size_t new_capacity = state->entry_capacity ? state->entry_capacity * 2 : 4096;
+        DedupEntry *grown = realloc(state->entries, new_capacity * sizeof(DedupEntry));
+        if (!grown) {
+            return false;
+        }
+        state->entries = grown;
+        state->entry_capacity = new_capacity;
+    }
+
+    uint32_t slot = (uint32_t)state->entry_count;
+    uint32_t first = insertCasHashIndex(&state->index[entry->kind], entry->hash, slot);
+    if (first == CAS_HASH_INDEX_NONE) {
+        return false;
+    }
+    state->entries[slot] = *entry;
+    state->entries[slot].next = DEDUP_END;
+    if (first != slot) {
+        state->entries[slot].next = state->entries[first].next;
+        state->entries[first].next = slot;
+    }
+    state->entry_count++;
+    return true;
+}
+
+static bool addDedupContainer(DedupState *state, const char *path, const cas_Container *container,
+                              const ContainerHashes *hashes) {
+    if (state->path_count >= state->path_capacity) {
+        size_t new_capacity = state->path_capacity ? state->path_capacity * 2 : 256;
+        char **grown = realloc(state->paths, new_capacity * sizeof(char*));
+        if (!grown) {
+            return false;
+        }
+        state->paths = grown;
+        state->path_capacity = new_capacity;
+    }
+    char *copy = strdup(path);
+    if (!copy) {
+        return false;
+    }
+    uint32_t id = (uint32_t)state->path_count;
+    state->paths[state->path_count++] = copy;
+
+    DedupEntry entry = {
+        .hash = hashes->container,
+        .size = container->file_count,
+        .container = id,
+        .kind = DEDUP_CONTAINER
+    };
+    if (!addDedupEntry(state, &entry)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < container->file_count; i++) {
+        const cas_File *file = &container->files[i];
+        entry = (DedupEntry){
+            .hash = hashes->files[i].hash,
+            .size = hashes->files[i].size,
+            .type = getFileTypeString(file),
+            .container = id,
+            .file = (uint32_t)i,
+            .kind = DEDUP_FILE
+        };
+        memcpy(entry.file_name, file->file_header.file_name, sizeof(entry.file_name));
+        if (!addDedupEntry(state, &entry)) {
+            return false;
+        }
+
+        for (size_t j = 0; hashes->blocks && j < file->data_block_count; j++) {
+            const cas_ContentHash *block = &hashes->blocks[hashes->first_block[i] + j];
+            entry.hash = block->hash;
+            entry.size = block->size;
+            entry.block = (uint32_t)j;
+            entry.kind = DEDUP_BLOCK;
+            if (block->size > 0 && !addDedupEntry(state, &entry)) {
+                return false;
+            }
+        }
+    }
+    state->files += container->file_count;
+    return true;
+}
+
+// Hash outside the lock, index under it
+static bool indexContainer(void *context, const char *path, const cas_Container *container,
+                           size_t input_size) {
+    (void)input_size;
+    DedupState *state = context;
+
+    ContainerHashes hashes;
+    if (!hashContainer(container, state->blocks, &hashes)) {
+        fprintf(stderr, "Error: Failed to hash '%s'\n", path);
+        return false;
+    }
+
+    pthread_mutex_lock(&state->lock);
+    bool added = !state->out_of_memory && addDedupContainer(state, path, container, &hashes);
+    if (!added) {
+        state->out_of_memory = true;
+    } else if (state->verbose) {
+        fprintf(stderr, "  %s: %zu file(s)\n", path, container->file_count);
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    freeContainerHashes(&hashes);
+    return added;
+}
+
+// Sorting needs the paths; qsort has no context argument
+static const DedupState *sort_state;
+
+static int compareDedupEntries(const void *a, const void *b) {
+    const DedupEntry *x = &sort_state->entries[*(const uint32_t*)a];
+    const DedupEntry *y = &sort_state->entries[*(const uint32_t*)b];
+    int order = strcmp(sort_state->paths[x->container], sort_state->paths[y->container]);
+    if (order != 0) {
+        return order;
+    }
+    if (x->file != y->file) {
+        return x->file < y->file ? -1 : 1;
+    }
+    return (x->block > y->block) - (x->block < y->block);
+}
+
+// Copies of one content, sorted by path
+typedef struct {
+    uint32_t *members;
+    size_t count;
+} DedupGroup;
+
+// Groups compare by kind, then by their first copy
+static int compareDedupGroups(const void *a, const void *b) {
+    const DedupGroup *x = a;
+    const DedupGroup *y = b;
+    uint8_t kind_x = sort_state->entries[x->members[0]].kind;
+    uint8_t kind_y = sort_state->entries[y->members[0]].kind;
+    if (kind_x != kind_y) {
+        return kind_x < kind_y ? -1 : 1;
+    }
+    return compareDedupEntries(x->members, y->members);
+}
+
+static void writeDedupGroup(FILE *out, const DedupState *state, const uint32_t *members, size_t count) {
+    const DedupEntry *first = &state->entries[members[0]];
+    fprintf(out, "{\"kind\":\"%s\",\"hash\":\"%016llx\"", DEDUP_KIND_NAMES[first->kind],
+            (unsigned long long)first->hash);
+    if (first->kind == DEDUP_CONTAINER) {
+        fprintf(out, ",\"files\":%llu", (unsigned long long)first->size);
+    } else {
+        fprintf(out, ",\"type\":\"%s\",\"size\":%llu", first->type, (unsigned long long)first->size);
+    }
+    fprintf(out, ",\"count\":%zu,\"copies\":[", count);
+
+    for (size_t i = 0; i < count; i++) {
+        const DedupEntry *entry = &state->entries[members[i]];
+        const char *path = state->paths[entry->container];
+        fputs(i ? ",{\"path\":" : "{\"path\":", out);
+        writeJsonString(out, path, strlen(path));
+        if (entry->kind != DEDUP_CONTAINER) {
+            fprintf(out, ",\"index\":%u,\"name\":", entry->file + 1);
+            if (strcmp(entry->type, "CUSTOM") == 0) {
+                fputs("null", out);
+            } else {
+                cas_File file = {0};
+                memcpy(file.file_header.file_name, entry->file_name, sizeof(entry->file_name));
+                char name[32];
+                formatTapeName(&file, name, sizeof(name));
+                writeJsonString(out, name, strlen(name));
+            }
+        }
+        if (entry->kind == DEDUP_BLOCK) {
+            fprintf(out, ",\"block\":%u", entry->block + 1);
+        }
+        fputc('}', out);
+    }
+    fputs("]}\n", out);
+}
+
+// Per kind: groups with more than one copy, copies beyond the first and
+// the payload bytes those copies repeat
+typedef struct {
+    size_t groups;
+    size_t copies;
+    uint64_t bytes;
+} DedupTotals;
+
+// Collect, sort and write every group with more than one copy
+static bool writeDedupGroups(FILE *out, DedupState *state, DedupTotals totals[DEDUP_KINDS]) {
+    memset(totals, 0, DEDUP_KINDS * sizeof(DedupTotals));
+    size_t capacity = state->entry_count ? state->entry_count : 1;
+    uint32_t *members = malloc(capacity * sizeof(uint32_t));
+    DedupGroup *groups = malloc(capacity * sizeof(DedupGroup));
+    if (!members || !groups) {
+        free(members);
+        free(groups);
+        return false;
+    }
+
+    // A group starts at the entry its hash is indexed under; the members of
+    // each group lie together in members
+    sort_state = state;
+    size_t used = 0, group_count = 0;
+    for (size_t i = 0; i < state->entry_count; i++) {
+        const DedupEntry *entry = &state->entries[i];
+        if (entry->next == DEDUP_END ||
+            findCasHashIndex(&state->index[entry->kind], entry->hash) != (uint32_t)i) {
+            continue;
+        }
+        DedupGroup *group = &groups[group_count++];
+        group->members = &members[used];
+        for (uint32_t e = (uint32_t)i; e != DEDUP_END; e = state->entries[e].next) {
+            members[used++] = e;
+        }
+        group->count = (size_t)(&members[used] - group->members);
+        qsort(group->members, group->count, sizeof(uint32_t), compareDedupEntries);
+
+        DedupTotals *total = &totals[entry->kind];
+        total->groups++;
+        total->copies += group->count - 1;
+        if (entry->kind != DEDUP_CONTAINER) {
+            total->bytes += entry->size * (group->count - 1);
+        }
+    }
+
+    qsort(groups, group_count, sizeof(DedupGroup), compareDedupGroups);
+    for (size_t i = 0; i < group_count; i++) {
+        writeDedupGroup(out, state, groups[i].members, groups[i].count);
+    }
+
+    free(members);
+    free(groups);
+    return true;
+}
+
+int execute_dedup(char **paths, size_t path_count, const char *output_file,
+                  uint16_t threads, bool blocks, bool verbose) {
+    DedupState state = {
+        .blocks = blocks,
+        .verbose = verbose
+    };
+    for (int kind = 0; kind < DEDUP_KINDS; kind++) {
+        if (!initCasHashIndex(&state.index[kind], 1024)) {
+            fprintf(stderr, "Error: Failed to allocate the hash index\n");
+            for (int k = 0; k < kind; k++) {
+                freeCasHashIndex(&state.index[k]);
+            }
+            return 1;
+        }
+    }
+
+    FILE *out = output_file ? fopen(output_file, "w") : stdout;
+    bool written = out != NULL;
+    if (!out) {
+        fprintf(stderr, "Error: Cannot create file '%s'\n", output_file);
+    }
+
+    CasWalkStats stats = {0};
+    DedupTotals totals[DEDUP_KINDS] = {{0}};
+    if (out) {
+        pthread_mutex_init(&state.lock, NULL);
+        walkCasFiles(paths, path_count, threads, indexContainer, &state, &stats);
+        pthread_mutex_destroy(&state.lock);
+
+        if (!state.out_of_memory && !writeDedupGroups(out, &state, totals)) {
+            state.out_of_memory = true;
+        }
+        written = (fflush(out) == 0);
+        if (output_file && fclose(out) != 0) {
+            written = false;
+        }
+        if (!written) {
+            fprintf(stderr, "Error: Failed to write duplicate groups\n");
+        }
+        if (state.out_of_memory || stats.out_of_memory) {
+            fprintf(stderr, "Error: Out of memory; duplicates were not reported\n");
+        }
+
+        printCasWalkSummary(&stats, "Indexed", state.files);
+        char size_str[32];
+        formatBytes((size_t)totals[DEDUP_FILE].bytes, size_str, sizeof(size_str));
+        fprintf(stderr, "Duplicate files: %zu of %zu are copies (%s) in %zu group(s)\n",
+                totals[DEDUP_FILE].copies, state.files, size_str, totals[DEDUP_FILE].groups);
+        fprintf(stderr, "Duplicate CAS files: %zu of %zu are copies of another\n",
+                totals[DEDUP_CONTAINER].copies, stats.containers);
+        if (blocks) {
+            formatBytes((size_t)totals[DEDUP_BLOCK].bytes, size_str, sizeof(size_str));
+            fprintf(stderr, "Duplicate blocks: %zu copies (%s) in %zu group(s)\n",
+                    totals[DEDUP_BLOCK].copies, size_str, totals[DEDUP_BLOCK].groups);
+        }
+        if (verbose) {
+            size_t index_bytes = state.entry_capacity * sizeof(DedupEntry);
+            for (int kind = 0; kind < DEDUP_KINDS; kind++) {
+                index_bytes += state.index[kind].capacity * (sizeof(uint64_t) + sizeof(uint32_t));
+            }
+            formatBytes(index_bytes, size_str, sizeof(size_str));
+            fprintf(stderr, "Hash index: %zu entries in %s; CRC32C: %s\n", state.entry_count,
+                    size_str, hasHardwareCrc32c() ? "hardware" : "lookup tables");
+        }
+    }
+
+    for (size_t i = 0; i < state.path_count; i++) {
+        free(state.paths[i]);
+    }
+    free(state.paths);
+    free(state.entries);
+    for (int kind = 0; kind < DEDUP_KINDS; kind++) {
+        freeCasHashIndex(&state.index[kind]);
+    }
+    return (stats.failed > 0 || stats.out_of_memory || state.out_of_memory || !written) ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../lib/caslib.h"
+#include "../lib/indexlib.h"
+#include "../lib/cmdlib.h"
+
+int execute_index(const char *input_file, bool verbose) {
+    if (verbose) {
+        printf("Indexing file: %s\n", input_file);
+    }
+    
+    cas_Index index;
+    if (!buildCasIndex(input_file, &index)) {
+        return 1;
+    }
+    
+    if (verbose) {
+        printf("\n  # | Type   | Name   |   Offset |    Bytes | Blocks\n");
+        printf("----+--------+--------+----------+----------+-------\n");
+        for (size_t i = 0; i < index.entry_count; i++) {
+            const cas_IndexEntry *entry = &index.entries[i];
+            const char *name = entry->file.is_custom ? "" : (const char *)entry->file.file_header.file_name;
+            printf("%3zu | %-6s | %-6.6s | %8llu | %8llu | %6zu\n", i + 1,
+                   getFileTypeString(&entry->file), name,
+                   (unsigned long long)entry->header_offset,
+                   (unsigned long long)(entry->end_offset - entry->header_offset),
+                   entry->file.data_block_count);
+        }
+        printf("\n");
+    }
+    
+    bool saved = saveCasIndex(input_file, &index);
+    if (saved) {
+        char *path = casIndexPath(input_file);
+        printf("Indexed %zu file(s), %zu block(s): %s\n", index.entry_count, index.block_count,
+               path ? path : input_file);
+        free(path);
+    }
+    
+    freeCasIndex(&index);
+    return saved ? 0 : 1;
+}
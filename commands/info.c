@@ -6,30 +6,58 @@
 #include "../lib/caslib.h"
 #include "../lib/cmdlib.h"
 #include "../lib/wavlib.h"
+#include "../lib/presetlib.h"
 
-int execute_info(const char *input_file, bool verbose) {
+// Plan the tape layout for a configuration and get its exact duration
+// and WAV file size (8-bit mono, no markers)
+static bool estimateAudio(const cas_Container *container, const WaveformConfig *config,
+                          double *duration, size_t *wav_size) {
+    TapeLayout layout;
+    if (!planTapeLayout(container, config, &layout)) {
+        return false;
+    }
+    
+    WavFormat format = createDefaultWavFormat();
+    format.sample_rate = config->sample_rate;
+    
+    *duration = (double)layout.total_samples / config->sample_rate;
+    *wav_size = calculateLayoutWavSize(&layout, &format, NULL);
+    freeTapeLayout(&layout);
+    return true;
+}
+
+int execute_info(const char *input_file, const char *profile_name, bool verbose) {
+    // Resolve profile before doing any work
+    const AudioProfile *profile = NULL;
+    if (profile_name) {
+        profile = findProfile(profile_name);
+        if (!profile) {
+            fprintf(stderr, "Error: Unknown profile '%s'\n", profile_name);
+            fprintf(stderr, "Use 'cast profile' to list available profiles.\n");
+            return 1;
+        }
+    }
+    
     if (verbose) {
         printf("Reading file: %s\n", input_file);
     }
     
-    // Read the file into memory
-    size_t file_size;
-    uint8_t *file_data = readFileIntoMemory(input_file, &file_size);
-    if (!file_data) {
-        fprintf(stderr, "Error: Failed to read file '%s'\n", input_file);
+    // Load the file (mapped when it is a regular file)
+    cas_Input input;
+    if (!openCasInput(input_file, &input)) {
         return 1;
     }
     
     if (verbose) {
-        printf("File size: %zu bytes\n", file_size);
+        printf("File size: %zu bytes\n", input.size);
         printf("Parsing CAS container...\n\n");
     }
     
     // Parse the CAS container
     cas_Container container;
-    if (!parseCasContainer(file_data, &container, file_size)) {
+    if (!parseCasContainerInPlace(input.data, &container, input.size)) {
         fprintf(stderr, "Error: Failed to parse CAS container\n");
-        free(file_data);
+        closeCasInput(&input);
         return 1;
     }
     
@@ -67,9 +95,17 @@ int execute_info(const char *input_file, bool verbose) {
     printf("  Custom: %zu\n", custom_count);
     
     char size_str[64];
-    formatBytes(file_size, size_str, sizeof(size_str));
+    formatBytes(input.size, size_str, sizeof(size_str));
     printf("\nContainer size: %s\n", size_str);
     
+    if (verbose) {
+        cas_ContainerStats stats;
+        getCasContainerStats(&container, &stats);
+        formatBytes(stats.arena_used, size_str, sizeof(size_str));
+        printf("Parse memory:   %s for %zu files and %zu blocks (%zu of %zu bytes reserved)\n",
+               size_str, container.file_count, stats.block_count, stats.arena_used, stats.arena_capacity);
+    }
+    
     // =============================================================================
     // 2. AUDIO DURATION ESTIMATES
     // =============================================================================
@@ -77,9 +113,23 @@ int execute_info(const char *input_file, bool verbose) {
     printf("\nAudio Estimates\n");
     printf("===============\n");
     
-    // Calculate durations for both baud rates (using standard silence: 2.0s/1.0s)
-    double duration_1200 = calculateAudioDuration(&container, 1200, 2.0, 1.0);
-    double duration_2400 = calculateAudioDuration(&container, 2400, 2.0, 1.0);
+    // Plan exact layouts for both baud rates (43200 Hz, standard silence: 2.0s/1.0s)
+    WaveformConfig config = createDefaultWaveform();
+    double duration_1200 = 0.0;
+    double duration_2400 = 0.0;
+    size_t wav_size_1200 = 0;
+    size_t wav_size_2400 = 0;
+    
+    config.baud_rate = 1200;
+    bool planned = estimateAudio(&container, &config, &duration_1200, &wav_size_1200);
+    config.baud_rate = 2400;
+    planned = planned && estimateAudio(&container, &config, &duration_2400, &wav_size_2400);
+    if (!planned) {
+        fprintf(stderr, "Error: Failed to plan tape layout\n");
+        freeCasContainer(&container);
+        closeCasInput(&input);
+        return 1;
+    }
     
     char dur_1200_str[32];
     char dur_2400_str[32];
@@ -89,17 +139,39 @@ int execute_info(const char *input_file, bool verbose) {
     printf("At 1200 baud (standard):\n");
     printf("  Duration:  %s (%d seconds)\n", dur_1200_str, (int)ceil(duration_1200));
     
-    size_t wav_size_1200 = calculateWavFileSize(duration_1200, 43200);
     formatBytes(wav_size_1200, size_str, sizeof(size_str));
     printf("  WAV size:  %s (43200 Hz, 8-bit mono)\n", size_str);
     
     printf("\nAt 2400 baud (turbo):\n");
     printf("  Duration:  %s (%d seconds)\n", dur_2400_str, (int)ceil(duration_2400));
     
-    size_t wav_size_2400 = calculateWavFileSize(duration_2400, 43200);
     formatBytes(wav_size_2400, size_str, sizeof(size_str));
     printf("  WAV size:  %s (43200 Hz, 8-bit mono)\n", size_str);
     
+    // Exact figures for the requested profile
+    if (profile) {
+        WaveformConfig profile_config = createDefaultWaveform();
+        applyProfile(&profile_config, profile);
+        profile_config.sample_rate = profile->sample_rate;
+        
+        double duration_profile;
+        size_t wav_size_profile;
+        if (!estimateAudio(&container, &profile_config, &duration_profile, &wav_size_profile)) {
+            fprintf(stderr, "Error: Failed to plan tape layout for profile '%s'\n", profile->name);
+            freeCasContainer(&container);
+            closeCasInput(&input);
+            return 1;
+        }
+        
+        char dur_profile_str[32];
+        formatDuration(duration_profile, dur_profile_str, sizeof(dur_profile_str));
+        printf("\nWith profile '%s' (%u baud):\n", profile->name, profile->baud_rate);
+        printf("  Duration:  %s (%.3f seconds)\n", dur_profile_str, duration_profile);
+        
+        formatBytes(wav_size_profile, size_str, sizeof(size_str));
+        printf("  WAV size:  %s (%u Hz, 8-bit mono)\n", size_str, profile->sample_rate);
+    }
+    
     // =============================================================================
     // 3. SIZE ANALYSIS
     // =============================================================================
@@ -130,8 +202,8 @@ int execute_info(const char *input_file, bool verbose) {
         }
     }
     
-    size_t cas_overhead = file_size - total_payload;
-    double cas_overhead_percent = (double)cas_overhead / (double)file_size * 100.0;
+    size_t cas_overhead = input.size - total_payload;
+    double cas_overhead_percent = (double)cas_overhead / (double)input.size * 100.0;
     
     formatBytes(total_payload, size_str, sizeof(size_str));
     printf("CAS File:\n");
@@ -142,7 +214,7 @@ int execute_info(const char *input_file, bool verbose) {
     
     // Calculate audio expansion at 1200 baud (standard)
     // WAV file size includes silence + sync + framing + encoded headers
-    size_t wav_size = calculateWavFileSize(duration_1200, 43200);
+    size_t wav_size = wav_size_1200;
     double expansion_ratio = (double)wav_size / (double)total_payload;
     
     formatBytes(wav_size, size_str, sizeof(size_str));
@@ -180,8 +252,8 @@ int execute_info(const char *input_file, bool verbose) {
     }
     
     // Cleanup
-    free(container.files);
-    free(file_data);
+    freeCasContainer(&container);
+    closeCasInput(&input);
     
     return 0;
 }
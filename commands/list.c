@@ -5,6 +5,7 @@
 #include "../lib/caslib.h"
 #include "../lib/printlib.h"
 #include "../lib/cmdlib.h"
+#include "../lib/indexlib.h"
 #include "../lib/playlib.h"
 
 int execute_list(const char *input_file, bool extended, int filter_index, bool show_markers, bool verbose) {
@@ -47,24 +48,40 @@ int execute_list(const char *input_file, bool extended, int filter_index, bool s
         printf("Reading file: %s\n", input_file);
     }
     
-    // Read the file into memory
-    size_t file_size;
-    uint8_t *file_data = readFileIntoMemory(input_file, &file_size);
-    if (!file_data) {
-        fprintf(stderr, "Error: Failed to read file '%s'\n", input_file);
+    // With an up-to-date sidecar index, read only the requested file
+    if (filter_index > 0) {
+        cas_Container single;
+        bool indexed = false;
+        if (readIndexedFile(input_file, (size_t)filter_index - 1, &single, &indexed)) {
+            if (verbose) {
+                printf("Using index: %s%s\n\n", input_file, CAS_INDEX_SUFFIX);
+            }
+            printFile(&single.files[0], filter_index);
+            freeCasContainer(&single);
+            return 0;
+        }
+        if (indexed) {
+            // Already reported: out of range or out of memory
+            return 1;
+        }
+    }
+    
+    // Load the file (mapped when it is a regular file)
+    cas_Input input;
+    if (!openCasInput(input_file, &input)) {
         return 1;
     }
     
     if (verbose) {
-        printf("File size: %zu bytes\n", file_size);
+        printf("File size: %zu bytes\n", input.size);
         printf("Parsing CAS container...\n");
     }
     
     // Parse the CAS container
     cas_Container container;
-    if (!parseCasContainer(file_data, &container, file_size)) {
+    if (!parseCasContainerInPlace(input.data, &container, input.size)) {
         fprintf(stderr, "Error: Failed to parse CAS container\n");
-        free(file_data);
+        closeCasInput(&input);
         return 1;
     }
     
@@ -76,14 +93,14 @@ int execute_list(const char *input_file, bool extended, int filter_index, bool s
     if (filter_index) {
         if (filter_index < 1 || (size_t)filter_index > container.file_count) {
             fprintf(stderr, "Error: Index %d out of range (1-%zu)\n", filter_index, container.file_count);
-            free(container.files);
-            free(file_data);
+            freeCasContainer(&container);
+            closeCasInput(&input);
             return 1;
         }
         
         printFile(&container.files[filter_index - 1], filter_index);
-        free(container.files);
-        free(file_data);
+        freeCasContainer(&container);
+        closeCasInput(&input);
         return 0;
     }
     
@@ -97,8 +114,8 @@ int execute_list(const char *input_file, bool extended, int filter_index, bool s
     }
     
     // Cleanup
-    free(container.files);
-    free(file_data);
+    freeCasContainer(&container);
+    closeCasInput(&input);
     
     return 0;
 }
\ No newline at end of file
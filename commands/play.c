@@ -1,9 +1,11 @@
 /*
- * play.c - Play WAV file with real-time marker display
+ * play.c - Play WAV or CAS file with real-time marker display
  */
 
 #include "../lib/uilib.h"
 #include "../lib/playlib.h"
+#include "../lib/presetlib.h"
+#include "../lib/cmdlib.h"
 #include "commands.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -512,11 +514,30 @@ static void renderDisplay(AudioPlayer *player, DisplayState *state, const Marker
 // Main Play Function
 // =============================================================================
 
-int execute_play(const char *filename, bool verbose) {
+int execute_play(const char *filename, const char *profile_name, bool verbose) {
     (void)verbose;
 
-    // Create audio player
-    AudioPlayer *player = createAudioPlayer(filename);
+    // Create audio player: CAS files are synthesized in the audio callback
+    AudioPlayer *player = NULL;
+    if (hasCasExtension(filename)) {
+        WaveformConfig config = createDefaultWaveform();
+        if (profile_name) {
+            const AudioProfile *profile = findProfile(profile_name);
+            if (!profile) {
+                fprintf(stderr, "Error: Unknown profile '%s'\n", profile_name);
+                fprintf(stderr, "Use 'cast profile' to list available profiles.\n");
+                return 1;
+            }
+            applyProfile(&config, profile);
+            config.sample_rate = profile->sample_rate;
+        }
+        player = createCasPlayer(filename, &config);
+    } else {
+        if (profile_name) {
+            fprintf(stderr, "Warning: --profile only applies to CAS files\n");
+        }
+        player = createAudioPlayer(filename);
+    }
     if (!player) {
         fprintf(stderr, "Error: Failed to create audio player\n");
         return 1;
@@ -534,8 +555,9 @@ int execute_play(const char *filename, bool verbose) {
     tb_set_output_mode(TB_OUTPUT_NORMAL);
     tb_hide_cursor();
 
-    // Read markers (optional - works without them)
-    MarkerListInfo *markers = readWavMarkers(filename);
+    // Markers (optional - works without them); read from the WAV file or
+    // generated from the tape layout for CAS files
+    const MarkerListInfo *markers = player->markers;
 
     // Initialize display state
     DisplayState state = {0};
@@ -605,11 +627,6 @@ int execute_play(const char *filename, bool verbose) {
     pauseAudio(player);
     tb_shutdown();
 
-    if (markers) {
-        free(markers->markers);
-        free(markers);
-    }
-
     destroyAudioPlayer(player);
 
     return 0;
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include "../lib/caslib.h"
+#include "../lib/recordlib.h"
+#include "../lib/cmdlib.h"
+
+#define POLL_MS 5  // Wait for captured frames at most this long per poll
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void handleInterrupt(int signal_number) {
+    (void)signal_number;
+    interrupted = 1;
+}
+
+// The CAS file grows block by block as the tape plays
+typedef struct {
+    FILE *file;
+    const char *output_file;
+    FILE *out;               // Progress messages
+    uint32_t sample_rate;
+    size_t written;          // Bytes in the CAS file
+    size_t block_count;
+    size_t errors;
+    bool write_failed;
+} RecordState;
+
+// File type of a header block (type marker and name), or NULL
+static const char* headerType(const uint8_t *data, size_t size) {
+    if (size != sizeof(cas_FileHeader)) {
+        return NULL;
+    }
+    if (memcmp(data, FILETYPE_BINARY, sizeof(FILETYPE_BINARY)) == 0) return "binary";
+    if (memcmp(data, FILETYPE_BASIC, sizeof(FILETYPE_BASIC)) == 0) return "BASIC";
+    if (memcmp(data, FILETYPE_ASCII, sizeof(FILETYPE_ASCII)) == 0) return "ASCII";
+    return NULL;
+}
+
+// Append the block as in a CAS image (8-byte aligned header, then the
+// bytes) and show it
+static bool writeBlock(void *context, const TapeBlock *block, const uint8_t *data) {
+    RecordState *state = context;
+    static const uint8_t padding[8] = {0};
+    size_t pad = (8 - state->written % 8) % 8;
+
+    bool ok = fwrite(padding, 1, pad, state->file) == pad &&
+              fwrite(CAS_HEADER, 1, sizeof(CAS_HEADER), state->file) == sizeof(CAS_HEADER) &&
+              fwrite(data, 1, block->size, state->file) == block->size &&
+              fflush(state->file) == 0;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write %s\n", state->output_file);
+        state->write_failed = true;
+        return false;
+    }
+    state->written += pad + sizeof(CAS_HEADER) + block->size;
+    state->block_count++;
+    state->errors += block->error;
+
+    char at[32];
+    formatDuration(block->leader_start / (double)state->sample_rate, at, sizeof(at));
+    fprintf(state->out, "  Block %zu at %s: %u baud, %zu bytes", state->block_count, at,
+            block->baud_rate, block->size);
+    const char *type = headerType(data, block->size);
+    if (type) {
+        fprintf(state->out, ", %s file \"%.6s\"", type, (const char *)data + sizeof(FILETYPE_BINARY));
+    }
+    fprintf(state->out, "%s\n", block->error ? "  framing error" : "");
+    fflush(state->out);
+    return true;
+}
+
+int execute_record(const char *output_file, const char *input_file, int device_index,
+                   uint16_t channel, uint32_t sample_rate, double duration, bool fast,
+                   bool list_devices, bool verbose) {
+    if (list_devices) {
+        return listCaptureDevices(stdout) ? 0 : 1;
+    }
+
+    // "-o -" writes the CAS file to stdout; all messages go to stderr instead
+    bool streaming = strcmp(output_file, "-") == 0;
+    FILE *out = streaming ? stderr : stdout;
+
+    RecordState state = {.output_file = output_file, .out = out};
+    TapeRecorderConfig config = {
+        .sample_rate = sample_rate,
+        .channel = channel,
+        .device_index = device_index,
+        .input_file = input_file,
+        .realtime = !fast,
+        .decoder = {.block_end = writeBlock, .context = &state}
+    };
+    TapeRecorder *recorder = createTapeRecorder(&config);
+    if (!recorder) {
+        return 1;
+    }
+    state.sample_rate = getTapeRecorderSampleRate(recorder);
+
+    state.file = streaming ? stdout : fopen(output_file, "wb");
+    if (!state.file) {
+        fprintf(stderr, "Error: Cannot create output file %s\n", output_file);
+        freeTapeRecorder(recorder);
+        return 1;
+    }
+
+    fprintf(out, "=== Recording Tape ===\n");
+    fprintf(out, "Input:   %s (%u Hz, channel %u)\n", getTapeRecorderSource(recorder),
+            state.sample_rate, channel + 1);
+    fprintf(out, "Output:  %s\n", streaming ? "<stdout>" : output_file);
+    if (duration > 0) {
+        fprintf(out, "Stops after %.1f seconds", duration);
+        fprintf(out, "%s\n\n", input_file ? " or at the end of the file" : " or on Ctrl+C");
+    } else {
+        fprintf(out, "%s\n\n", input_file ? "Stops at the end of the file or on Ctrl+C"
+                                          : "Start the tape on the MSX; Ctrl+C stops recording");
+    }
+    fflush(out);
+
+    interrupted = 0;
+    void (*previous_handler)(int) = signal(SIGINT, handleInterrupt);
+    bool ok = startTapeRecorder(recorder);
+    uint64_t stop_at = duration > 0 ? (uint64_t)(duration * state.sample_rate) : UINT64_MAX;
+    TapeDecoder *decoder = getTapeRecorderDecoder(recorder);
+    while (ok && !interrupted && getTapeDecoderPosition(decoder) < stop_at) {
+        if (!pollTapeRecorder(recorder, POLL_MS)) {
+            break;  // End of the input file, or the CAS file could not be written
+        }
+    }
+    ok = stopTapeRecorder(recorder) && ok && !state.write_failed;
+    signal(SIGINT, previous_handler);
+
+    if (!streaming && fclose(state.file) != 0 && !state.write_failed) {
+        fprintf(stderr, "Error: Failed to write %s\n", output_file);
+        ok = false;
+    }
+
+    TapeRecorderStats stats;
+    getTapeRecorderStats(recorder, &stats);
+    char audio[32], size_str[32];
+    formatDuration(getTapeDecoderPosition(decoder) / (double)state.sample_rate, audio, sizeof(audio));
+    formatBytes(state.written, size_str, sizeof(size_str));
+
+    fprintf(out, "\n");
+    if (!ok) {
+        fprintf(out, "✗ Recording failed\n");
+    } else if (state.block_count == 0) {
+        fprintf(out, "⚠ No tape blocks found\n");
+    } else if (state.errors > 0) {
+        fprintf(out, "⚠ Recorded with %zu damaged block(s) of %zu\n", state.errors, state.block_count);
+    } else {
+        fprintf(out, "✓ Recording complete!\n");
+    }
+    fprintf(out, "Blocks: %zu, CAS size: %s\n", state.block_count, size_str);
+    fprintf(out, "Audio recorded: %s\n", audio);
+    if (stats.frames_dropped > 0) {
+        fprintf(out, "⚠ %llu frames lost: the decoder fell %d ms behind the input\n",
+                (unsigned long long)stats.frames_dropped, RECORD_BUFFER_MS);
+    }
+    if (verbose) {
+        fprintf(out, "Latency: %d ms device periods, at most %.0f ms of audio waiting to decode\n",
+                RECORD_PERIOD_MS, stats.max_backlog_ms);
+    }
+
+    freeTapeRecorder(recorder);
+    return ok && state.block_count > 0 && state.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../lib/caslib.h"
+#include "../lib/wavlib.h"
+#include "../lib/cmdlib.h"
+
+// =============================================================================
+// Corpus Scan
+// =============================================================================
+//
+// walkCasFiles() visits the CAS files in parallel. Each container's records
+// are formatted on its worker and written in one piece, so lines from
+// different containers never interleave. Records come out in completion
+// order.
+
+typedef struct {
+    pthread_mutex_t lock;             // Guards the output and the counts
+    FILE *out;
+    bool csv;
+    bool verbose;
+    WaveformConfig config;            // Timing for the duration estimates
+    size_t files;
+} ScanOutput;
+
+// =============================================================================
+// Records - NDJSON and CSV
+// =============================================================================
+
+#define SCAN_CSV_HEADER "path,index,files,type,name,load,end,exec,size,blocks,duration\n"
+
+// CSV field, quoted when it holds a separator, quote or line break
+static void writeCsvField(FILE *out, const char *text, size_t length) {
+    bool quote = false;
+    for (size_t i = 0; i < length && !quote; i++) {
+        quote = (text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r');
+    }
+    if (!quote) {
+        fwrite(text, 1, length, out);
+        return;
+    }
+    fputc('"', out);
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '"') {
+            fputc('"', out);
+        }
+        fputc(text[i], out);
+    }
+    fputc('"', out);
+}
+
+// Write one record per tape file of a container
+static void writeScanRecords(FILE *out, const ScanOutput *scan, const char *path,
+                             const cas_Container *container, const double *durations) {
+    size_t path_length = strlen(path);
+    for (size_t i = 0; i < container->file_count; i++) {
+        const cas_File *file = &container->files[i];
+        bool binary = !file->is_custom && isBinaryFile(file->file_header.file_type);
+        char name[32] = "";
+        if (!file->is_custom) {
+            formatTapeName(file, name, sizeof(name));
+        }
+        char load[8] = "", end[8] = "", exec[8] = "";
+        if (binary) {
+            snprintf(load, sizeof(load), "0x%04X", file->data_block_header.load_address);
+            snprintf(end, sizeof(end), "0x%04X", file->data_block_header.end_address);
+            snprintf(exec, sizeof(exec), "0x%04X", file->data_block_header.exec_address);
+        }
+
+        if (scan->csv) {
+            writeCsvField(out, path, path_length);
+            fprintf(out, ",%zu,%zu,%s,", i + 1, container->file_count, getFileTypeString(file));
+            writeCsvField(out, name, strlen(name));
+            fprintf(out, ",%s,%s,%s,%zu,%zu,%.3f\n", load, end, exec, file->data_size,
+                    file->data_block_count, durations[i]);
+            continue;
+        }
+
+        fputs("{\"path\":", out);
+        writeJsonString(out, path, path_length);
+        fprintf(out, ",\"index\":%zu,\"files\":%zu,\"type\":\"%s\",\"name\":", i + 1,
+                container->file_count, getFileTypeString(file));
+        if (file->is_custom) {
+            fputs("null", out);
+        } else {
+            writeJsonString(out, name, strlen(name));
+        }
+        if (binary) {
+            fprintf(out, ",\"load\":\"%s\",\"end\":\"%s\",\"exec\":\"%s\"", load, end, exec);
+        } else {
+            fputs(",\"load\":null,\"end\":null,\"exec\":null", out);
+        }
+        fprintf(out, ",\"size\":%zu,\"blocks\":%zu,\"duration\":%.3f}\n",
+                file->data_size, file->data_block_count, durations[i]);
+    }
+}
+
+// Seconds of audio per tape file, from the exact tape layout
+static double* fileDurations(const cas_Container *container, const WaveformConfig *config) {
+    double *durations = calloc(container->file_count ? container->file_count : 1, sizeof(double));
+    TapeLayout layout;
+    if (!durations || !planTapeLayout(container, config, &layout)) {
+        free(durations);
+        return NULL;
+    }
+    for (size_t i = 0; i < layout.count; i++) {
+        const TapeSegment *segment = &layout.segments[i];
+        durations[segment->file_index] += (double)segment->sample_count / config->sample_rate;
+    }
+    freeTapeLayout(&layout);
+    return durations;
+}
+
+// Write the records of one parsed CAS file in a single piece
+static bool scanContainer(void *context, const char *path, const cas_Container *container,
+                          size_t input_size) {
+    (void)input_size;
+    ScanOutput *scan = context;
+    if (container->file_count == 0) {
+        fprintf(stderr, "Error: '%s' holds no tape files\n", path);
+        return false;
+    }
+
+    double *durations = fileDurations(container, &scan->config);
+    char *records = NULL;
+    size_t records_size = 0;
+    FILE *buffer = durations ? open_memstream(&records, &records_size) : NULL;
+    bool ok = false;
+    if (buffer) {
+        writeScanRecords(buffer, scan, path, container, durations);
+        ok = (fclose(buffer) == 0);
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to scan '%s'\n", path);
+    }
+
+    pthread_mutex_lock(&scan->lock);
+    if (ok) {
+        fwrite(records, 1, records_size, scan->out);
+        scan->files += container->file_count;
+        if (scan->verbose) {
+            fprintf(stderr, "  %s: %zu file(s)\n", path, container->file_count);
+        }
+    }
+    pthread_mutex_unlock(&scan->lock);
+
+    free(records);
+    free(durations);
+    return ok;
+}
+
+int execute_scan(char **paths, size_t path_count, bool csv, const char *output_file,
+                 uint16_t threads, uint16_t baud_rate, bool verbose) {
+    ScanOutput scan = {
+        .csv = csv,
+        .verbose = verbose,
+        .config = createDefaultWaveform()
+    };
+    scan.config.baud_rate = baud_rate;
+
+    scan.out = output_file ? fopen(output_file, "w") : stdout;
+    if (!scan.out) {
+        fprintf(stderr, "Error: Cannot create file '%s'\n", output_file);
+        return 1;
+    }
+    if (csv) {
+        fputs(SCAN_CSV_HEADER, scan.out);
+    }
+
+    pthread_mutex_init(&scan.lock, NULL);
+    CasWalkStats stats;
+    walkCasFiles(paths, path_count, threads, scanContainer, &scan, &stats);
+    pthread_mutex_destroy(&scan.lock);
+
+    bool written = (fflush(scan.out) == 0);
+    if (output_file && fclose(scan.out) != 0) {
+        written = false;
+    }
+    if (!written) {
+        fprintf(stderr, "Error: Failed to write scan records\n");
+    }
+    if (stats.out_of_memory) {
+        fprintf(stderr, "Error: Out of memory; the scan is incomplete\n");
+    }
+
+    // Throughput goes to stderr so the records can be piped as they are
+    printCasWalkSummary(&stats, "Scanned", scan.files);
+    return (stats.failed > 0 || stats.out_of_memory || !written) ? 1 : 0;
+}
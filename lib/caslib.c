@@ -2,62 +2,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 const uint8_t CAS_HEADER[8] = {0x1F, 0xA6, 0xDE, 0xBA, 0xCC, 0x13, 0x7D, 0x74};
 const uint8_t FILETYPE_ASCII[10]  = {0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA};
 const uint8_t FILETYPE_BINARY[10] = {0xD0, 0xD0, 0xD0, 0xD0, 0xD0, 0xD0, 0xD0, 0xD0, 0xD0, 0xD0};
 const uint8_t FILETYPE_BASIC[10]  = {0xD3, 0xD3, 0xD3, 0xD3, 0xD3, 0xD3, 0xD3, 0xD3, 0xD3, 0xD3};
 
-static bool hasBytesAvailable(size_t pos, size_t needed, size_t total_length) {
-    return pos + needed <= total_length;
-}
-
 static uint16_t readLittleEndian16(const uint8_t *data) {
     return data[0] | (data[1] << 8);
 }
 
-static bool isCasHeader(uint8_t *data, size_t *pos, size_t length) {
-    if (!hasBytesAvailable(*pos, sizeof(CAS_HEADER), length)) {
-        return false;
-    }
-    return memcmp(data + *pos, CAS_HEADER, sizeof(CAS_HEADER)) == 0;
-}
-
-static bool readCasHeader(uint8_t *data, size_t *pos, cas_Header *header, size_t length) {
-    if (!hasBytesAvailable(*pos, sizeof(CAS_HEADER), length)) {
-        return false;
-    }
-    memcpy(header->bytes, data + *pos, sizeof(CAS_HEADER));
-    *pos += sizeof(CAS_HEADER);
-    return true;
-}
-
-static bool tryReadCasHeader(uint8_t *data, size_t *pos, cas_Header *header, size_t length) {
-    if (!isCasHeader(data, pos, length)) {
-        return false;
-    }
-    return readCasHeader(data, pos, header, length);
-}
-
-static bool readFileHeader(uint8_t *data, size_t *pos, cas_FileHeader *file_header, size_t length) {
-    if (!hasBytesAvailable(*pos, sizeof(cas_FileHeader), length)) {
-        return false;
-    }
-    memcpy(file_header->file_type, data + *pos, sizeof(file_header->file_type));
-    *pos += sizeof(file_header->file_type);
-    memcpy(file_header->file_name, data + *pos, sizeof(file_header->file_name));
-    *pos += sizeof(file_header->file_name);
-    return true;
-}
-
-static bool peekFileType(uint8_t *data, size_t pos, uint8_t *file_type, size_t length) {
-    if (!hasBytesAvailable(pos, 10, length)) {
-        return false;
-    }
-    memcpy(file_type, data + pos, 10);
-    return true;
-}
-
 static bool compareFileType(const uint8_t *file_type, const uint8_t *type_pattern) {
     return memcmp(file_type, type_pattern, 10) == 0;
 }
@@ -118,296 +77,685 @@ char* generateFilename(const cas_File *file, int index) {
     return filename;
 }
 
-static bool readDataBlockHeader(uint8_t *data, size_t *pos, cas_DataBlockHeader *data_block_header, size_t length) {
-    if (!hasBytesAvailable(*pos, sizeof(cas_DataBlockHeader), length)) {
-        return false;
-    }
-    data_block_header->load_address = readLittleEndian16(&data[*pos]);
-    *pos += 2;
-    data_block_header->end_address  = readLittleEndian16(&data[*pos]);
-    *pos += 2;
-    data_block_header->exec_address = readLittleEndian16(&data[*pos]);
-    *pos += 2;
-    return true;
+// Load 8 bytes as one word (unaligned-safe; compiles to a single load)
+static inline uint64_t loadWord64(const uint8_t *p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
 }
 
-static size_t findNextCasHeader(uint8_t *data, size_t start_pos, size_t length) {
+static size_t findNextCasHeader(const uint8_t *data, size_t start_pos, size_t length) {
     // Search for next CAS header starting from start_pos
     // Note: Headers are NOT always 8-byte aligned (e.g., Las Aventuras de Rudolphine Rur has one at 0x9042)
-    for (size_t i = start_pos; i + 8 <= length; i++) {
-        if (memcmp(data + i, CAS_HEADER, 8) == 0) {
-            return i;
+    // so every offset is a candidate: memchr() (vectorized in the C library)
+    // skips to each 0x1F and one 64-bit compare checks the whole header
+    if (length < sizeof(CAS_HEADER) || start_pos > length - sizeof(CAS_HEADER)) {
+        return length;
+    }
+    
+    const uint64_t header = loadWord64(CAS_HEADER);
+    const uint8_t *p = data + start_pos;
+    const uint8_t *last = data + length - sizeof(CAS_HEADER);  // Last possible start
+    
+    // Aligned fast path: headers usually sit at 8-byte boundaries right
+    // where the previous block's padding ends, so check there before searching
+    if ((start_pos & 7) == 0 && loadWord64(p) == header) {
+        return start_pos;
+    }
+    
+    while (p <= last) {
+        p = memchr(p, CAS_HEADER[0], (size_t)(last - p) + 1);
+        if (!p) {
+            break;
+        }
+        if (loadWord64(p) == header) {
+            return (size_t)(p - data);
         }
+        p++;
     }
     return length;
 }
 
-static bool expandArray(void **array, size_t *capacity, size_t item_size) {
-    *capacity *= 2;
-    void *new_array = realloc(*array, (*capacity) * item_size);
-    if (!new_array) {
-        fprintf(stderr, "Failed to reallocate memory for array\n");
-        free(*array);
-        *array = NULL;
-        return false;
-    }
-    *array = new_array;
-    return true;
-}
-
-static void* allocateArray(size_t capacity, size_t item_size) {
-    void *array = malloc(capacity * item_size);
-    if (!array) {
-        fprintf(stderr, "Failed to allocate memory for array\n");
-    }
-    return array;
+// =============================================================================
+// Streaming Parser
+// =============================================================================
+
+// Longest field the parser needs in one piece (a typed file header); a field
+// split across feeds is carried in the parser until it is complete
+#define STREAM_FIELD_MAX  16
+#define STREAM_CARRY_SIZE (4 * STREAM_FIELD_MAX)
+
+typedef enum {
+    STREAM_FILE_HEADER,      // Expecting a file's CAS header (or the end)
+    STREAM_FILE_TYPE,        // Expecting the file type and name
+    STREAM_BLOCK_HEADER,     // Binary/BASIC: expecting the data block's CAS header
+    STREAM_ADDRESS_HEADER,   // Binary: expecting the load/end/exec addresses
+    STREAM_ASCII_HEADER,     // ASCII: expecting the next block's CAS header
+    STREAM_BLOCK_DATA,       // Inside a block, up to the next CAS header
+    STREAM_DONE,             // Trailing bytes are not CAS data and are ignored
+    STREAM_FAILED
+} StreamState;
+
+struct cas_StreamParser {
+    cas_StreamCallbacks callbacks;
+    void *context;
+    StreamState state;
+    size_t offset;           // Stream position of the next unconsumed byte
+    size_t file_offset;      // Stream position of the current file's CAS header
+    cas_File file;           // File being parsed (no data_blocks)
+    bool is_ascii;           // File type, checked once per file
+    bool is_binary;
+    cas_Header block_header; // CAS header of the current block
+    size_t block_size;       // Bytes delivered for the current block
+    bool block_has_eof;      // ASCII: the current block holds an EOF marker
+    uint8_t carry[STREAM_CARRY_SIZE];
+    size_t carry_length;
+};
+
+static void initStreamParser(cas_StreamParser *parser, const cas_StreamCallbacks *callbacks, void *context) {
+    memset(parser, 0, sizeof(*parser));
+    if (callbacks) {
+        parser->callbacks = *callbacks;
+    }
+    parser->context = context;
+    parser->state = STREAM_FILE_HEADER;
 }
 
-static bool allocateDataBlock(cas_File *file, const char *error_msg) {
-    file->data_blocks = malloc(sizeof(cas_DataBlock));
-    if (!file->data_blocks) {
-        fprintf(stderr, "Failed to allocate memory for %s data block\n", error_msg);
-        return false;
-    }
-    file->data_block_count = 1;
-    return true;
+static void advanceStream(cas_StreamParser *parser, size_t *pos, size_t count) {
+    *pos += count;
+    parser->offset += count;
 }
 
-static bool readDataBlockCasHeader(uint8_t *data, cas_File *file, size_t *pos, size_t length, const char *error_msg) {
-    if (!isCasHeader(data, pos, length)) {
-        free(file->data_blocks);
-        fprintf(stderr, "Failed to find second CAS header for %s data block\n", error_msg);
-        return false;
+// A file is malformed: report it (same messages as the container parser) and
+// stop. The file never gets file_end, so consumers can drop it
+static void failStreamFile(cas_StreamParser *parser, const char *reason, bool typed) {
+    if (reason) {
+        fprintf(stderr, "%s\n", reason);
     }
-
-    if (!readCasHeader(data, pos, &file->data_blocks[0].header, length)) {
-        free(file->data_blocks);
-        fprintf(stderr, "Failed to read CAS header for %s data block\n", error_msg);
-        return false;
+    if (typed) {
+        fprintf(stderr, "Failed to parse %s file\n",
+                parser->is_binary ? "binary" : parser->is_ascii ? "ASCII" : "basic");
     }
-    return true;
+    fprintf(stderr, "Failed to parse file at position %zu\n", parser->offset);
+    parser->state = STREAM_FAILED;
 }
 
-static bool allocateAndCopyData(cas_DataBlock *block, uint8_t *source, size_t data_size, size_t data_offset, const char *error_msg) {
-    block->data = malloc(data_size);
-    block->data_size = data_size;
-    block->data_offset = data_offset;
-    if (!block->data) {
-        fprintf(stderr, "Failed to allocate memory for %s data\n", error_msg);
-        return false;
+// A callback refused an event; it reports its own error
+static bool checkCallback(cas_StreamParser *parser, bool accepted) {
+    if (!accepted) {
+        parser->state = STREAM_FAILED;
     }
-    memcpy(block->data, source, data_size);
-    return true;
+    return accepted;
 }
 
+static bool startStreamBlock(cas_StreamParser *parser) {
+    parser->block_size = 0;
+    parser->block_has_eof = false;
+    parser->state = STREAM_BLOCK_DATA;
+    return checkCallback(parser, !parser->callbacks.block_start ||
+        parser->callbacks.block_start(parser->context, &parser->file,
+                                      &parser->block_header, parser->offset));
+}
 
-
-static bool parseAsciiFile(uint8_t *data, cas_File *file, size_t *pos, size_t length) {
-    size_t block_count = 0;
-    size_t capacity = 5;
-    size_t total_data_size = 0;
-    bool eof_found = false;
-
-    file->data_blocks = allocateArray(capacity, sizeof(cas_DataBlock));
-    if (!file->data_blocks) {
-        fprintf(stderr, "Failed to allocate memory for ASCII data blocks\n");
+// The current block ended at a CAS header or at the end of the stream
+static bool endStreamBlock(cas_StreamParser *parser, bool at_stream_end) {
+    if (parser->callbacks.block_end &&
+        !checkCallback(parser, parser->callbacks.block_end(parser->context, parser->block_size))) {
         return false;
     }
+    
+    // ASCII files run block after block until one holds the EOF marker;
+    // BINARY sizes include the 6-byte address header
+    parser->file.data_size += parser->block_size + (parser->is_binary ? 6 : 0);
+    if (parser->is_ascii && !parser->block_has_eof) {
+        if (at_stream_end) {
+            failStreamFile(parser, NULL, true);
+            return false;
+        }
+        parser->state = STREAM_ASCII_HEADER;
+        return true;
+    }
+    
+    parser->state = STREAM_FILE_HEADER;
+    return checkCallback(parser, !parser->callbacks.file_end ||
+        parser->callbacks.file_end(parser->context, &parser->file));
+}
 
-    // Read blocks separated by CAS headers until EOF marker (0x1A)
-    while (!eof_found && *pos < length) {
-        if (!tryReadCasHeader(data, pos, &file->data_blocks[block_count].header, length)) {
+// Consume as much of data as the current state allows. Unless final, what
+// is left over is shorter than STREAM_FIELD_MAX; with final the stream ends
+// after data. Returns the number of bytes consumed
+static size_t stepStream(cas_StreamParser *parser, const uint8_t *data, size_t length, bool final) {
+    size_t pos = 0;
+    
+    for (;;) {
+        const uint8_t *p = data + pos;
+        size_t avail = length - pos;
+        
+        switch (parser->state) {
+        case STREAM_DONE:
+            advanceStream(parser, &pos, avail);
+            return length;
+        case STREAM_FAILED:
+            return length;
+            
+        case STREAM_FILE_HEADER:
+            if (avail < sizeof(CAS_HEADER)) {
+                if (!final) {
+                    return pos;
+                }
+                parser->state = STREAM_DONE;
+                break;
+            }
+            if (loadWord64(p) != loadWord64(CAS_HEADER)) {
+                parser->state = STREAM_DONE;
+                break;
+            }
+            memset(&parser->file, 0, sizeof(parser->file));
+            parser->is_ascii = false;
+            parser->is_binary = false;
+            memcpy(parser->file.header.bytes, p, sizeof(CAS_HEADER));
+            parser->file_offset = parser->offset;
+            advanceStream(parser, &pos, sizeof(CAS_HEADER));
+            parser->state = STREAM_FILE_TYPE;
+            break;
+            
+        case STREAM_FILE_TYPE: {
+            cas_FileHeader *file_header = &parser->file.file_header;
+            if (avail < sizeof(file_header->file_type)) {
+                if (final) {
+                    failStreamFile(parser, "Truncated data: not enough bytes for file type", false);
+                }
+                return final ? length : pos;
+            }
+            
+            bool is_ascii = isAsciiFile(p);
+            bool is_binary = isBinaryFile(p);
+            if (!is_ascii && !is_binary && !isBasicFile(p)) {
+                // Custom block: the file's own header starts its only block
+                parser->file.is_custom = true;
+                parser->block_header = parser->file.header;
+                if (!checkCallback(parser, !parser->callbacks.file_start ||
+                        parser->callbacks.file_start(parser->context, &parser->file,
+                                                     parser->file_offset)) ||
+                    !startStreamBlock(parser)) {
+                    return length;
+                }
+                break;
+            }
+            
+            if (avail < sizeof(cas_FileHeader)) {
+                if (final) {
+                    failStreamFile(parser, "Failed to read file header", false);
+                }
+                return final ? length : pos;
+            }
+            memcpy(file_header->file_type, p, sizeof(file_header->file_type));
+            memcpy(file_header->file_name, p + sizeof(file_header->file_type),
+                   sizeof(file_header->file_name));
+            advanceStream(parser, &pos, sizeof(cas_FileHeader));
+            parser->is_ascii = is_ascii;
+            parser->is_binary = is_binary;
+            parser->state = is_ascii ? STREAM_ASCII_HEADER : STREAM_BLOCK_HEADER;
+            if (!checkCallback(parser, !parser->callbacks.file_start ||
+                    parser->callbacks.file_start(parser->context, &parser->file,
+                                                 parser->file_offset))) {
+                return length;
+            }
             break;
         }
-
-        if (block_count >= capacity) {
-            if (!expandArray((void**)&file->data_blocks, &capacity, sizeof(cas_DataBlock))) {
-                fprintf(stderr, "Failed to expand memory for ASCII data blocks\n");
-                return false;
+            
+        case STREAM_BLOCK_HEADER:
+        case STREAM_ASCII_HEADER: {
+            bool ascii = (parser->state == STREAM_ASCII_HEADER);
+            if (avail < sizeof(CAS_HEADER) && !final) {
+                return pos;
             }
+            if (avail < sizeof(CAS_HEADER) || loadWord64(p) != loadWord64(CAS_HEADER)) {
+                if (!ascii) {
+                    fprintf(stderr, "Failed to find second CAS header for %s data block\n",
+                            parser->is_binary ? "binary" : "basic");
+                }
+                failStreamFile(parser, NULL, true);
+                return length;
+            }
+            memcpy(parser->block_header.bytes, p, sizeof(CAS_HEADER));
+            advanceStream(parser, &pos, sizeof(CAS_HEADER));
+            if (parser->is_binary) {
+                parser->state = STREAM_ADDRESS_HEADER;
+            } else if (!startStreamBlock(parser)) {
+                return length;
+            }
+            break;
         }
-
-        size_t block_start = *pos;
-        
-        while (*pos < length && !isCasHeader(data, pos, length)) {
-            if (data[*pos] == 0x1A) {
-                eof_found = true;
-                (*pos)++;
-                // Skip remaining bytes until next header
-                while (*pos < length && !isCasHeader(data, pos, length)) {
-                    (*pos)++;
+            
+        case STREAM_ADDRESS_HEADER: {
+            cas_DataBlockHeader *addresses = &parser->file.data_block_header;
+            if (avail < 6) {
+                if (final) {
+                    failStreamFile(parser, "Failed to read data block header for binary data block", true);
                 }
-                break;
+                return final ? length : pos;
+            }
+            addresses->load_address = readLittleEndian16(p);
+            addresses->end_address  = readLittleEndian16(p + 2);
+            addresses->exec_address = readLittleEndian16(p + 4);
+            advanceStream(parser, &pos, 6);
+            if (!startStreamBlock(parser)) {
+                return length;
             }
-            (*pos)++;
+            break;
+        }
+            
+        case STREAM_BLOCK_DATA: {
+            // A block runs to the next CAS header. Without one in view, the
+            // last 7 bytes could start a header, so they wait for more data
+            size_t header_pos = findNextCasHeader(p, 0, avail);
+            bool at_header = header_pos < avail;
+            size_t span = header_pos;
+            if (!at_header && !final) {
+                span = (avail > sizeof(CAS_HEADER) - 1) ? avail - (sizeof(CAS_HEADER) - 1) : 0;
+            }
+            
+            if (span > 0) {
+                if (parser->is_ascii && !parser->block_has_eof && memchr(p, EOF_MARKER, span)) {
+                    parser->block_has_eof = true;
+                }
+                if (parser->callbacks.block_data &&
+                    !checkCallback(parser, parser->callbacks.block_data(parser->context, p, span,
+                                                                        parser->offset))) {
+                    return length;
+                }
+                parser->block_size += span;
+                advanceStream(parser, &pos, span);
+            }
+            
+            if (!at_header && !final) {
+                return pos;
+            }
+            if (!endStreamBlock(parser, !at_header)) {
+                return length;
+            }
+            break;
         }
-        
-        size_t block_size = *pos - block_start;
-        if (!allocateAndCopyData(&file->data_blocks[block_count], data + block_start, block_size, block_start, "ASCII data block")) {
-            free(file->data_blocks);
-            return false;
         }
-        total_data_size += block_size;
-        block_count++;
     }
-
-    file->data_size = total_data_size;
-    file->data_block_count = block_count;
-    return eof_found;
 }
 
-static bool parseBasicFile(uint8_t *data, cas_File *file, size_t *pos, size_t length) {
-    if (!allocateDataBlock(file, "basic")) {
-        return false;
+cas_StreamParser* createCasStreamParser(const cas_StreamCallbacks *callbacks, void *context) {
+    cas_StreamParser *parser = malloc(sizeof(cas_StreamParser));
+    if (!parser) {
+        fprintf(stderr, "Failed to allocate CAS stream parser\n");
+        return NULL;
     }
+    initStreamParser(parser, callbacks, context);
+    return parser;
+}
 
-    if (!readDataBlockCasHeader(data, file, pos, length, "basic")) {
-        return false;
+bool feedCasStreamParser(cas_StreamParser *parser, const uint8_t *data, size_t size) {
+    while (size > 0 && parser->state != STREAM_FAILED) {
+        if (parser->carry_length == 0) {
+            // Parse straight from the caller's buffer; only a split field's
+            // first bytes are copied
+            size_t used = stepStream(parser, data, size, false);
+            data += used;
+            size -= used;
+            memcpy(parser->carry, data, size);
+            parser->carry_length = size;
+            break;
+        }
+        
+        // Complete the carried field with the next bytes, then hand back
+        // whatever was taken from data and not consumed
+        size_t take = STREAM_CARRY_SIZE - parser->carry_length;
+        if (take > size) {
+            take = size;
+        }
+        memcpy(parser->carry + parser->carry_length, data, take);
+        parser->carry_length += take;
+        data += take;
+        size -= take;
+        
+        size_t left = parser->carry_length - stepStream(parser, parser->carry, parser->carry_length, false);
+        if (left <= take) {
+            data -= left;
+            size += left;
+            parser->carry_length = 0;
+        } else {
+            memmove(parser->carry, parser->carry + parser->carry_length - left, left);
+            parser->carry_length = left;
+        }
     }
+    return parser->state != STREAM_FAILED;
+}
 
-    // BASIC files have raw tokenized data (no 6-byte header like BINARY)
-    size_t data_start = *pos;
-    size_t next_header_pos = findNextCasHeader(data, *pos, length);
-    size_t data_size = next_header_pos - data_start;
-    if (!allocateAndCopyData(&file->data_blocks[0], data + *pos, data_size, *pos, "basic data block")) {
-        free(file->data_blocks);
-        return false;
-    }
-    *pos += data_size;
+bool finishCasStreamParser(cas_StreamParser *parser) {
+    stepStream(parser, parser->carry, parser->carry_length, true);
+    parser->carry_length = 0;
+    return parser->state != STREAM_FAILED;
+}
 
-    file->data_size = data_size;
-    return true;
+size_t getCasStreamOffset(const cas_StreamParser *parser) {
+    return parser->offset;
 }
 
-static bool parseBinaryFile(uint8_t *data, cas_File *file, size_t *pos, size_t length) {
-    if (!allocateDataBlock(file, "binary")) {
-        return false;
-    }
+void freeCasStreamParser(cas_StreamParser *parser) {
+    free(parser);
+}
 
-    if (!readDataBlockCasHeader(data, file, pos, length, "binary")) {
-        return false;
+// =============================================================================
+// Parse Arena
+// =============================================================================
+
+bool initCasArena(cas_Arena *arena, size_t capacity) {
+    arena->base = malloc(capacity ? capacity : 1);
+    arena->capacity = arena->base ? capacity : 0;
+    arena->used = 0;
+    return arena->base != NULL;
+}
+
+void* allocCasArena(cas_Arena *arena, size_t size, size_t align) {
+    size_t start = (arena->used + align - 1) & ~(align - 1);
+    if (start < arena->used || start > arena->capacity || size > arena->capacity - start) {
+        return NULL;
     }
+    arena->used = start + size;
+    return arena->base + start;
+}
 
-    // Read 6-byte data block header (load/end/exec addresses)
-    if (!readDataBlockHeader(data, pos, &file->data_block_header, length)) {
-        free(file->data_blocks);
-        fprintf(stderr, "Failed to read data block header for binary data block\n");
-        return false;
+void freeCasArena(cas_Arena *arena) {
+    if (arena) {
+        free(arena->base);
+        arena->base = NULL;
+        arena->capacity = 0;
+        arena->used = 0;
     }
+}
 
-    // Find data size by scanning for next CAS header (end_address field is unreliable)
-    size_t data_start = *pos;
-    size_t next_header_pos = findNextCasHeader(data, *pos, length);
-    size_t data_size = next_header_pos - data_start;
+// =============================================================================
+// Container Parsing
+// =============================================================================
+
+// Builds a container from stream parser events. The files array and the
+// block array are reserved up front from an upper bound; each file's blocks
+// are a contiguous run of the block array, and copied block bytes are
+// bumped from the arena behind them as they arrive
+typedef struct {
+    cas_Container *container;
+    size_t file_capacity;
+    cas_DataBlock *blocks;
+    size_t block_count;
+    size_t block_capacity;
+    bool copy_data;          // Copy block bytes into the arena
+    uint8_t *source;         // Buffer being parsed (blocks point into it when not copying)
+} ContainerBuilder;
+
+// Every file and every data block starts at a CAS header, so the number of
+// headers bounds both (the pattern cannot overlap itself)
+static size_t countCasHeaders(const uint8_t *data, size_t length) {
+    size_t count = 0;
+    for (size_t i = findNextCasHeader(data, 0, length); i < length;
+         i = findNextCasHeader(data, i + sizeof(CAS_HEADER), length)) {
+        count++;
+    }
+    return count;
+}
 
-    if (*pos + data_size > length) {
-        free(file->data_blocks);
-        fprintf(stderr, "Not enough data for binary data block\n");
+// Start a file's run of blocks at the next free slot
+static bool buildFileStart(void *context, const cas_File *file, size_t offset) {
+    (void)offset;
+    ContainerBuilder *builder = context;
+    cas_Container *container = builder->container;
+    if (container->file_count >= builder->file_capacity) {
+        fprintf(stderr, "Too many files in CAS container\n");
         return false;
     }
+    
+    cas_File *entry = &container->files[container->file_count];
+    *entry = *file;
+    entry->data_blocks = builder->blocks + builder->block_count;
+    entry->data_block_count = 0;
+    return true;
+}
 
-    if (!allocateAndCopyData(&file->data_blocks[0], data + *pos, data_size, *pos, "binary data block")) {
-        free(file->data_blocks);
+// Take the next block slot; its bytes are a view into the source buffer,
+// or start at the arena's next free byte
+static bool buildBlockStart(void *context, const cas_File *file, const cas_Header *header, size_t offset) {
+    ContainerBuilder *builder = context;
+    if (builder->block_count >= builder->block_capacity) {
+        fprintf(stderr, "Too many data blocks in CAS container\n");
         return false;
     }
-    *pos += data_size;
-
-    file->data_size = 6 + data_size;  // 6-byte header + data
+    
+    cas_File *entry = &builder->container->files[builder->container->file_count];
+    entry->data_block_header = file->data_block_header;
+    cas_DataBlock *block = &entry->data_blocks[entry->data_block_count++];
+    builder->block_count++;
+    
+    block->header = *header;
+    block->data_size = 0;
+    block->data_offset = offset;
+    block->data = builder->copy_data ? allocCasArena(&builder->container->arena, 0, 1)
+                                     : builder->source + offset;
     return true;
 }
 
-static bool parseCustomFile(uint8_t *data, cas_File *file, size_t *pos, size_t length) {
-    file->is_custom = true;
-    size_t start_pos = *pos;
+static bool buildBlockData(void *context, const uint8_t *data, size_t size, size_t offset) {
+    (void)offset;
+    ContainerBuilder *builder = context;
+    if (builder->copy_data) {
+        // Nothing else is allocated mid-block, so this extends the block
+        uint8_t *copy = allocCasArena(&builder->container->arena, size, 1);
+        if (!copy) {
+            fprintf(stderr, "CAS container data exceeds its reserved storage\n");
+            return false;
+        }
+        memcpy(copy, data, size);
+    }
+    builder->blocks[builder->block_count - 1].data_size += size;
+    return true;
+}
 
-    size_t next_header_pos = findNextCasHeader(data, *pos, length);
-    file->data_size = next_header_pos - start_pos;
+// Only complete files are counted; a file that fails to parse is dropped
+static bool buildFileEnd(void *context, const cas_File *file) {
+    ContainerBuilder *builder = context;
+    cas_Container *container = builder->container;
+    container->files[container->file_count].data_size = file->data_size;
+    container->file_count++;
+    return true;
+}
 
-    if (!allocateDataBlock(file, "custom")) {
-        return false;
+// The file and block arrays were reserved for one entry per header; close
+// the gaps so files, blocks and copied bytes sit back to back and the arena
+// only counts what the container holds. bytes_start is where copied bytes
+// begin in the arena
+static void compactContainer(ContainerBuilder *builder, size_t bytes_start) {
+    cas_Container *container = builder->container;
+    cas_Arena *arena = &container->arena;
+    
+    size_t files_end = container->file_count * sizeof(cas_File);
+    size_t blocks_start = (files_end + _Alignof(cas_DataBlock) - 1) & ~(_Alignof(cas_DataBlock) - 1);
+    cas_DataBlock *blocks = (cas_DataBlock*)(arena->base + blocks_start);
+    if (blocks != builder->blocks) {
+        memmove(blocks, builder->blocks, builder->block_count * sizeof(cas_DataBlock));
+        for (size_t i = 0; i < container->file_count; i++) {
+            cas_File *file = &container->files[i];
+            file->data_blocks = blocks + (file->data_blocks - builder->blocks);
+        }
+    }
+    
+    size_t new_bytes_start = blocks_start + builder->block_count * sizeof(cas_DataBlock);
+    size_t bytes_size = arena->used - bytes_start;
+    if (builder->copy_data && new_bytes_start != bytes_start) {
+        memmove(arena->base + new_bytes_start, arena->base + bytes_start, bytes_size);
+        for (size_t i = 0; i < builder->block_count; i++) {
+            blocks[i].data -= bytes_start - new_bytes_start;
+        }
     }
+    arena->used = new_bytes_start + bytes_size;
+}
+
+// Parse into the container's arena: files, blocks and, when copy_data is
+// set, the block bytes (never more than the input). A malformed file ends
+// the parse but keeps the files before it
+static bool parseContainer(uint8_t *data, cas_Container *container, size_t length, bool copy_data) {
+    container->files = NULL;
+    container->file_count = 0;
 
-    if (!allocateAndCopyData(&file->data_blocks[0], data + *pos, file->data_size, *pos, "custom")) {
-        free(file->data_blocks);
+    size_t bound = countCasHeaders(data, length);
+    size_t capacity = bound ? bound : 1;
+    size_t files_size = capacity * sizeof(cas_File);
+    size_t blocks_size = capacity * sizeof(cas_DataBlock);
+    if (!initCasArena(&container->arena, files_size + _Alignof(cas_DataBlock) + blocks_size +
+                                         (copy_data ? length : 0))) {
+        fprintf(stderr, "Failed to allocate memory for CAS container files\n");
         return false;
     }
-    file->data_block_count = 1;
-
-    *pos = next_header_pos;
+    container->files = allocCasArena(&container->arena, files_size, _Alignof(cas_File));
+
+    ContainerBuilder builder = {
+        .container = container,
+        .file_capacity = capacity,
+        .blocks = allocCasArena(&container->arena, blocks_size, _Alignof(cas_DataBlock)),
+        .block_capacity = capacity,
+        .copy_data = copy_data,
+        .source = data
+    };
+    static const cas_StreamCallbacks build_callbacks = {
+        .file_start = buildFileStart,
+        .block_start = buildBlockStart,
+        .block_data = buildBlockData,
+        .file_end = buildFileEnd
+    };
+
+    // The whole buffer is one chunk, so the parser needs no allocation
+    cas_StreamParser parser;
+    initStreamParser(&parser, &build_callbacks, &builder);
+    size_t bytes_start = container->arena.used;
+    feedCasStreamParser(&parser, data, length);
+    finishCasStreamParser(&parser);
+    compactContainer(&builder, bytes_start);
     return true;
 }
 
-static bool parseFile(uint8_t *data, cas_File *file, size_t *pos, size_t length) {
-    file->is_custom = false;
+bool parseCasContainer(uint8_t *data, cas_Container *container, size_t length) {
+    return parseContainer(data, container, length, true);
+}
+
+bool parseCasContainerInPlace(uint8_t *data, cas_Container *container, size_t length) {
+    return parseContainer(data, container, length, false);
+}
 
-    if (!tryReadCasHeader(data, pos, &file->header, length)) {
-        fprintf(stderr, "Failed to read CAS header\n");
-        return false;
+void freeCasContainer(cas_Container *container) {
+    if (container) {
+        freeCasArena(&container->arena);
+        container->files = NULL;
+        container->file_count = 0;
     }
+}
 
-    uint8_t file_type[10];
-    if (!peekFileType(data, *pos, file_type, length)) {
-        fprintf(stderr, "Truncated data: not enough bytes for file type\n");
-        return false;
+void getCasContainerStats(const cas_Container *container, cas_ContainerStats *stats) {
+    stats->arena_capacity = container->arena.capacity;
+    stats->arena_used = container->arena.used;
+    stats->block_count = 0;
+    for (size_t i = 0; i < container->file_count; i++) {
+        stats->block_count += container->files[i].data_block_count;
     }
+}
 
-    bool is_ascii  = isAsciiFile(file_type);
-    bool is_binary = isBinaryFile(file_type);
-    bool is_basic  = isBasicFile(file_type);
+// =============================================================================
+// Input Files - Mapped or Read
+// =============================================================================
 
-    if (is_ascii || is_binary || is_basic) {
-        if (!readFileHeader(data, pos, &file->file_header, length)) {
-            fprintf(stderr, "Failed to read file header\n");
-            return false;
-        }
+#define INPUT_READ_CHUNK (64 * 1024)  // First buffer size for unmappable input
 
-        if (is_binary) {
-            if (!parseBinaryFile(data, file, pos, length)) {
-                fprintf(stderr, "Failed to parse binary file\n");
-                return false;
-            }
-            return true;
-        } else if (is_basic) {
-            if (!parseBasicFile(data, file, pos, length)) {
-                fprintf(stderr, "Failed to parse basic file\n");
+// Read input that cannot be mapped (pipe, terminal, stdin) until EOF
+static bool readCasStream(int fd, const char *filename, cas_Input *input) {
+    uint8_t *data = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+    
+    for (;;) {
+        if (size == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : INPUT_READ_CHUNK;
+            uint8_t *grown = realloc(data, new_capacity);
+            if (!grown) {
+                fprintf(stderr, "Error: Failed to allocate memory for '%s'\n", filename);
+                free(data);
                 return false;
             }
-            return true;
-        } else if (is_ascii) {
-            if (!parseAsciiFile(data, file, pos, length)) {
-                fprintf(stderr, "Failed to parse ASCII file\n");
-                return false;
+            data = grown;
+            capacity = new_capacity;
+        }
+        
+        ssize_t result = read(fd, data + size, capacity - size);
+        if (result == 0) {
+            break;
+        }
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
             }
-            return true;
+            fprintf(stderr, "Error: Cannot read '%s': %s\n", filename, strerror(errno));
+            free(data);
+            return false;
         }
+        size += (size_t)result;
     }
-
-    return parseCustomFile(data, file, pos, length);
+    
+    input->data = data;
+    input->size = size;
+    input->mapped = false;
+    return true;
 }
 
-bool parseCasContainer(uint8_t *data, cas_Container *container, size_t length) {
-    size_t pos = 0;
-    size_t capacity = 5;
-    container->file_count = 0;
-
-    container->files = allocateArray(capacity, sizeof(cas_File));
-    if (!container->files) {
-        fprintf(stderr, "Failed to allocate memory for CAS container files\n");
+bool openCasInput(const char *filename, cas_Input *input) {
+    input->data = NULL;
+    input->size = 0;
+    input->mapped = false;
+    
+    bool from_stdin = (strcmp(filename, "-") == 0);
+    int fd = from_stdin ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open '%s': %s\n", filename, strerror(errno));
         return false;
     }
-
-    while (pos < length && isCasHeader(data, &pos, length)) {
-        if (container->file_count >= capacity) {
-            if (!expandArray((void**)&container->files, &capacity, sizeof(cas_File))) {
-                return false;
-            }
+    
+    // Regular files are mapped: the parser reads the page cache directly
+    // instead of a second copy. Private and writable, so the parser's
+    // non-const pointers can never reach the file
+    bool ok = false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+            input->data = mapping;
+            input->size = (size_t)st.st_size;
+            input->mapped = true;
+            ok = true;
         }
+    }
+    if (!input->mapped) {
+        ok = readCasStream(fd, filename, input);
+    }
+    
+    if (!from_stdin) {
+        close(fd);
+    }
+    return ok;
+}
 
-        if (!parseFile(data, &container->files[container->file_count], &pos, length)) {
-            fprintf(stderr, "Failed to parse file at position %zu\n", pos);
-            break;
-        }
-        container->file_count++;
+void closeCasInput(cas_Input *input) {
+    if (!input) {
+        return;
     }
-    return true;
+    if (input->mapped) {
+        munmap(input->data, input->size);
+    } else {
+        free(input->data);
+    }
+    input->data = NULL;
+    input->size = 0;
+    input->mapped = false;
 }
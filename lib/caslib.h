@@ -49,17 +49,111 @@ typedef struct {
     size_t data_size;  // actual data size (for all file types)
 } cas_File;
 
+// Bump allocator: one block of memory handed out front to back and
+// released all at once
+typedef struct {
+    uint8_t *base;
+    size_t capacity;
+    size_t used;
+} cas_Arena;
+
 typedef struct {
     cas_File* files;
     size_t file_count;
+    cas_Arena arena;         // Owns files, data blocks and copied block bytes
 } cas_Container;
 
+// Memory a container holds
+typedef struct {
+    size_t arena_capacity;   // Bytes reserved for the parse
+    size_t arena_used;       // Bytes handed out to files, blocks and data
+    size_t block_count;      // Data blocks over all files
+} cas_ContainerStats;
+
+// A CAS image loaded for parsing: regular files are memory-mapped
+// (copy-on-write, read sequentially), pipes and stdin are read into a buffer
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    bool mapped;             // data is a mapping (otherwise heap memory)
+} cas_Input;
+
 // Function declarations
 bool isAsciiFile(const uint8_t *file_type);
 bool isBinaryFile(const uint8_t *file_type);
 bool isBasicFile(const uint8_t *file_type);
 const char* getFileTypeString(const cas_File *file);
 char* generateFilename(const cas_File *file, int index);
+
+// Parse a CAS image into container
+// Files, data blocks and copies of the block bytes are stored in one
+// allocation; release it with freeCasContainer()
 bool parseCasContainer(uint8_t *data, cas_Container *container, size_t length);
 
+// Zero-copy parse: each cas_DataBlock.data points into data (at its
+// data_offset), so data must stay alive and unchanged while the container
+// is in use. Files and blocks take a single allocation
+bool parseCasContainerInPlace(uint8_t *data, cas_Container *container, size_t length);
+
+// Free everything a parse allocated (the source buffer is not touched)
+void freeCasContainer(cas_Container *container);
+
+// Report the container's arena usage
+void getCasContainerStats(const cas_Container *container, cas_ContainerStats *stats);
+
+// Reserve capacity bytes for arena. Returns false on allocation failure
+bool initCasArena(cas_Arena *arena, size_t capacity);
+
+// Take size bytes aligned to align (a power of two) from arena; NULL when
+// it is full. Consecutive byte (align 1) allocations are contiguous
+void* allocCasArena(cas_Arena *arena, size_t size, size_t align);
+
+void freeCasArena(cas_Arena *arena);
+
+// Streaming parser: the caller feeds chunks of any size and gets events in
+// stream order. The parser itself holds only a few bytes of a field split
+// across chunks, so memory does not grow with the input. Offsets are
+// positions in the whole stream. Any callback may be NULL; returning false
+// stops the parse
+typedef struct {
+    // A file starts at offset: its CAS header, is_custom and (unless
+    // custom) its file header are set
+    bool (*file_start)(void *context, const cas_File *file, size_t offset);
+    // A data block's bytes start at offset; for BINARY files the file's
+    // data_block_header (load/end/exec addresses) is set by now
+    bool (*block_start)(void *context, const cas_File *file, const cas_Header *header, size_t offset);
+    // The next bytes of the current block; data is only valid during the call
+    bool (*block_data)(void *context, const uint8_t *data, size_t size, size_t offset);
+    // The current block ended after size bytes
+    bool (*block_end)(void *context, size_t size);
+    // The file is complete and data_size is set. A file that fails to
+    // parse never gets here, so consumers can drop it
+    bool (*file_end)(void *context, const cas_File *file);
+} cas_StreamCallbacks;
+
+typedef struct cas_StreamParser cas_StreamParser;
+
+// Create a parser; callbacks is copied. Returns NULL on error
+cas_StreamParser* createCasStreamParser(const cas_StreamCallbacks *callbacks, void *context);
+
+// Parse the next size bytes of the stream. Returns false once a file is
+// malformed or a callback stopped the parse; bytes after the last CAS file
+// (data that does not start with a CAS header) are ignored
+bool feedCasStreamParser(cas_StreamParser *parser, const uint8_t *data, size_t size);
+
+// End of stream: completes the last block and file
+bool finishCasStreamParser(cas_StreamParser *parser);
+
+// Bytes of the stream consumed so far (after a failure: where it stopped)
+size_t getCasStreamOffset(const cas_StreamParser *parser);
+
+void freeCasStreamParser(cas_StreamParser *parser);
+
+// Load a CAS image from filename ("-" reads stdin)
+// Returns false (after printing an error) if the file cannot be read
+bool openCasInput(const char *filename, cas_Input *input);
+
+// Release a loaded image; containers parsed in place from it become invalid
+void closeCasInput(cas_Input *input);
+
 #endif // CASLIB_H
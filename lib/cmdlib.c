@@ -1,62 +1,19 @@
+#define _GNU_SOURCE  // copy_file_range()
 #include "cmdlib.h"
 #include "caslib.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <errno.h>
-
-uint8_t* readFileIntoMemory(const char *filename, size_t *out_size) {
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
-        perror("Error opening file");
-        return NULL;
-    }
-
-    // Get file size
-    if (fseek(fp, 0, SEEK_END) != 0) {
-        perror("Error seeking to end of file");
-        fclose(fp);
-        return NULL;
-    }
-
-    long file_size_long = ftell(fp);
-    if (file_size_long < 0) {
-        perror("Error getting file size");
-        fclose(fp);
-        return NULL;
-    }
-
-    if (fseek(fp, 0, SEEK_SET) != 0) {
-        perror("Error seeking to start of file");
-        fclose(fp);
-        return NULL;
-    }
-
-    size_t file_size = (size_t)file_size_long;
-
-    // Allocate buffer
-    uint8_t *data = malloc(file_size);
-    if (!data) {
-        perror("Memory allocation failed");
-        fclose(fp);
-        return NULL;
-    }
-
-    // Read entire file
-    size_t bytes_read = fread(data, 1, file_size, fp);
-    fclose(fp);
-
-    if (bytes_read != file_size) {
-        fprintf(stderr, "Error: Could not read entire file (expected %zu bytes, got %zu)\n", 
-                file_size, bytes_read);
-        free(data);
-        return NULL;
-    }
-
-    *out_size = file_size;
-    return data;
-}
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
 
 bool fileExists(const char *filename) {
     struct stat st;
@@ -105,91 +62,159 @@ static inline void write_le16(uint8_t *dest, uint16_t value) {
     dest[1] = (value >> 8) & 0xFF;
 }
 
-// Helper function to write the data block header (6 bytes: load, end, exec addresses)
-static bool write_data_block_header(FILE *fp, const char *filename, const cas_DataBlockHeader *header) {
-    uint8_t buffer[6];
-    write_le16(&buffer[0], header->load_address);
-    write_le16(&buffer[2], header->end_address);
-    write_le16(&buffer[4], header->exec_address);
-    
-    if (fwrite(buffer, 1, 6, fp) != 6) {
-        fprintf(stderr, "Error: Failed to write header to '%s'\n", filename);
+// Ranges this large are spliced; below it the system call costs more than
+// the copy it saves, so smaller pieces are gathered into one writev()
+#define SPLICE_MIN_SIZE (64 * 1024)
+#define PENDING_MAX 64
+
+// Pieces of the output still to be written, in order
+typedef struct {
+    struct iovec iov[PENDING_MAX];
+    int count;
+} PendingWrites;
+
+// Write every pending piece, resuming after partial writes and signals
+static bool flushPending(int fd, PendingWrites *pending) {
+    struct iovec *iov = pending->iov;
+    int count = pending->count;
+    pending->count = 0;
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
+    }
+    return true;
+}
+
+// Queue size bytes of data (which must stay valid until the next flush)
+static bool queueWrite(int fd, PendingWrites *pending, const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    if (pending->count == PENDING_MAX && !flushPending(fd, pending)) {
         return false;
     }
+    pending->iov[pending->count].iov_base = (void*)data;
+    pending->iov[pending->count].iov_len = size;
+    pending->count++;
     return true;
 }
 
-bool writeFileData(const char *filename, const cas_File *file, bool verbose, bool disk_format) {
-    FILE *fp = fopen(filename, "wb");
-    if (!fp) {
-        fprintf(stderr, "Error: Cannot create file '%s': %s\n", filename, strerror(errno));
+// Append size bytes at offset of source_fd to fd. copy_file_range() shares
+// or copies the range inside the kernel; when the file systems do not
+// support it sendfile() still avoids user space, and whatever is left is
+// written from data (the same bytes, already in memory)
+static bool spliceRange(int fd, int source_fd, uint64_t offset, const uint8_t *data, size_t size) {
+    off_t position = (off_t)offset;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t copied = copy_file_range(source_fd, &position, fd, NULL, size - done, 0);
+        if (copied <= 0) {
+            break;
+        }
+        done += (size_t)copied;
+    }
+    while (done < size) {
+        ssize_t sent = sendfile(fd, source_fd, &position, size - done);
+        if (sent <= 0) {
+            break;
+        }
+        done += (size_t)sent;
+    }
+    PendingWrites rest = {.count = 0};
+    return queueWrite(fd, &rest, data + done, size - done) && flushPending(fd, &rest);
+}
+
+bool writeFileData(int dir_fd, const char *name, const char *path, const cas_File *file,
+                   int source_fd, bool overwrite, bool verbose, bool disk_format) {
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : O_EXCL);
+    int fd = openat(dir_fd, name, flags, 0644);
+    if (fd < 0) {
+        if (errno == EEXIST) {
+            fprintf(stderr, "Error: File '%s' already exists (use -f to overwrite)\n", path);
+        } else {
+            fprintf(stderr, "Error: Cannot create file '%s': %s\n", path, strerror(errno));
+        }
         return false;
     }
     
+    // Large blocks are spliced from the source; the disk prefix, the BINARY
+    // address header and small blocks go out together in one writev()
+    PendingWrites pending = {.count = 0};
+    uint8_t header[7];
+    size_t header_size = 0;
+    const char *prefix_note = "";
+    
     // For disk format: add MSX disk file identifier bytes
     // BASIC: 0xFF prefix, BINARY: 0xFE prefix
     if (disk_format) {
         if (isBasicFile(file->file_header.file_type)) {
-            uint8_t prefix = 0xFF;
-            if (fwrite(&prefix, 1, 1, fp) != 1) {
-                fprintf(stderr, "Error: Failed to write BASIC prefix to '%s'\n", filename);
-                fclose(fp);
-                return false;
-            }
-            if (verbose) {
-                printf("Added 0xFF prefix (BASIC file identifier)\n");
-            }
+            header[header_size++] = BASIC_FILE_ID_BYTE;
+            prefix_note = "Added 0xFF prefix (BASIC file identifier)\n";
         } else if (isBinaryFile(file->file_header.file_type)) {
-            uint8_t prefix = BINARY_FILE_ID_BYTE;
-            if (fwrite(&prefix, 1, 1, fp) != 1) {
-                fprintf(stderr, "Error: Failed to write binary prefix to '%s'\n", filename);
-                fclose(fp);
-                return false;
-            }
-            if (verbose) {
-                printf("Added 0xFE prefix (BSAVE file identifier)\n");
-            }
+            header[header_size++] = BINARY_FILE_ID_BYTE;
+            prefix_note = "Added 0xFE prefix (BSAVE file identifier)\n";
         }
     }
     
     // Write header for BINARY files only (BINARY has 6-byte address header, BASIC does not)
     if (isBinaryFile(file->file_header.file_type)) {
-        if (!write_data_block_header(fp, filename, &file->data_block_header)) {
-            fclose(fp);
-            fprintf(stderr, "Error: Failed to write data block header to '%s'\n", filename);
-            return false;
-        }
+        write_le16(&header[header_size], file->data_block_header.load_address);
+        write_le16(&header[header_size + 2], file->data_block_header.end_address);
+        write_le16(&header[header_size + 4], file->data_block_header.exec_address);
+        header_size += 6;
     }
     
+    bool ok = queueWrite(fd, &pending, header, header_size);
+    
     // Write all data blocks
-    for (size_t i = 0; i < file->data_block_count; i++) {
+    for (size_t i = 0; ok && i < file->data_block_count; i++) {
         const cas_DataBlock *block = &file->data_blocks[i];
         if (block->data && block->data_size > 0) {
             size_t write_size = block->data_size;
             
             // For ASCII files, stop at EOF marker (0x1A) - exclude the marker itself
             if (isAsciiFile(file->file_header.file_type)) {
-                for (size_t j = 0; j < block->data_size; j++) {
-                    if (block->data[j] == 0x1A) {
-                        write_size = j;  // Stop before 0x1A
-                        break;
-                    }
+                const uint8_t *eof = memchr(block->data, EOF_MARKER, block->data_size);
+                if (eof) {
+                    write_size = (size_t)(eof - block->data);
                 }
             }
             
-            size_t written = fwrite(block->data, 1, write_size, fp);
-            if (written != write_size) {
-                fprintf(stderr, "Error: Failed to write data to '%s'\n", filename);
-                fclose(fp);
-                return false;
+            if (source_fd >= 0 && write_size >= SPLICE_MIN_SIZE) {
+                ok = flushPending(fd, &pending) &&
+                     spliceRange(fd, source_fd, block->data_offset, block->data, write_size);
+            } else {
+                ok = queueWrite(fd, &pending, block->data, write_size);
             }
         }
     }
+    ok = ok && flushPending(fd, &pending);
     
-    fclose(fp);
+    if (close(fd) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write data to '%s'\n", path);
+        return false;
+    }
     
     if (verbose) {
-        printf("Exported: %s (%zu bytes)\n", filename, file->data_size);
+        // One call, so lines of files exported in parallel stay together
+        printf("%sExported: %s (%zu bytes)\n", prefix_note, path, file->data_size);
     }
     
     return true;
@@ -236,3 +261,271 @@ char* generateOutputFilename(const char *input_file, const char *new_ext) {
     
     return output;
 }
+
+bool hasCasExtension(const char *filename) {
+    const char *dot = strrchr(filename, '.');
+    return dot && strcasecmp(dot, ".cas") == 0;
+}
+
+// =============================================================================
+// Records
+// =============================================================================
+
+void writeJsonString(FILE *out, const char *text, size_t length) {
+    fputc('"', out);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\') {
+            fprintf(out, "\\%c", c);
+        } else if (c < 0x20 || c == 0x7F) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+void formatTapeName(const cas_File *file, char *name, size_t size) {
+    size_t length = 6;
+    while (length > 0 && file->file_header.file_name[length - 1] == ' ') {
+        length--;
+    }
+    size_t used = 0;
+    name[0] = '\0';
+    for (size_t i = 0; i < length && used + 5 <= size; i++) {
+        uint8_t c = file->file_header.file_name[i];
+        if (c >= 0x20 && c < 0x7F) {
+            name[used++] = (char)c;
+            name[used] = '\0';
+        } else {
+            used += (size_t)snprintf(name + used, size - used, "\\x%02X", c);
+        }
+    }
+}
+
+// =============================================================================
+// Parallel CAS Walk
+// =============================================================================
+//
+// Workers share one stack of paths still to visit. A directory is listed
+// and its subdirectories and *.cas files are pushed back for any worker;
+// a CAS file is parsed in place and handed to the visit callback.
+
+// A directory to list or a CAS file to visit
+typedef struct {
+    char *path;
+    bool is_dir;
+} WalkItem;
+
+typedef struct {
+    WalkItem *items;                  // Stack of paths still to visit
+    size_t count;
+    size_t capacity;
+    size_t active;                    // Workers busy with an item
+    pthread_mutex_t lock;             // Guards everything here
+    pthread_cond_t ready;             // Items were pushed, or the walk is over
+
+    CasWalkVisit visit;
+    void *context;
+    CasWalkStats *stats;
+} CasWalk;
+
+// Push a copy of path (lock held)
+static bool pushWalkItem(CasWalk *walk, const char *path, bool is_dir) {
+    if (walk->count >= walk->capacity) {
+        size_t new_capacity = walk->capacity ? walk->capacity * 2 : 256;
+        WalkItem *grown = realloc(walk->items, new_capacity * sizeof(WalkItem));
+        if (!grown) {
+            return false;
+        }
+        walk->items = grown;
+        walk->capacity = new_capacity;
+    }
+
+    char *copy = strdup(path);
+    if (!copy) {
+        return false;
+    }
+    walk->items[walk->count].path = copy;
+    walk->items[walk->count].is_dir = is_dir;
+    walk->count++;
+    return true;
+}
+
+// Push the subdirectories and CAS files of a directory. Symbolic links are
+// followed to files only, so a link cannot send the walk around a loop
+static void listWalkDirectory(CasWalk *walk, const char *path) {
+    DIR *dir = opendir(path);
+    if (!dir) {
+        fprintf(stderr, "Error: Cannot open directory '%s': %s\n", path, strerror(errno));
+        pthread_mutex_lock(&walk->lock);
+        walk->stats->failed++;
+        pthread_mutex_unlock(&walk->lock);
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+
+        bool is_dir = (entry->d_type == DT_DIR);
+        bool is_file = (entry->d_type == DT_REG);
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+            struct stat st;
+            int flags = (entry->d_type == DT_LNK) ? 0 : AT_SYMLINK_NOFOLLOW;
+            if (fstatat(dirfd(dir), name, &st, flags) == 0) {
+                is_dir = (entry->d_type == DT_UNKNOWN) && S_ISDIR(st.st_mode);
+                is_file = S_ISREG(st.st_mode);
+            }
+        }
+        if (!is_dir && !(is_file && hasCasExtension(name))) {
+            continue;
+        }
+
+        char *child = buildFilePath(path, name);
+        pthread_mutex_lock(&walk->lock);
+        if (!child || !pushWalkItem(walk, child, is_dir)) {
+            walk->stats->out_of_memory = true;
+        }
+        pthread_cond_broadcast(&walk->ready);
+        pthread_mutex_unlock(&walk->lock);
+        free(child);
+    }
+    closedir(dir);
+}
+
+// Parse one CAS file in place and visit it
+static void visitWalkFile(CasWalk *walk, const char *path) {
+    cas_Input input;
+    cas_Container container;
+    bool opened = openCasInput(path, &input);
+    bool parsed = opened && parseCasContainerInPlace(input.data, &container, input.size);
+    bool ok = parsed && walk->visit(walk->context, path, &container, input.size);
+
+    pthread_mutex_lock(&walk->lock);
+    if (ok) {
+        walk->stats->containers++;
+        walk->stats->bytes += input.size;
+    } else {
+        walk->stats->failed++;
+    }
+    pthread_mutex_unlock(&walk->lock);
+
+    if (parsed) {
+        freeCasContainer(&container);
+    }
+    if (opened) {
+        closeCasInput(&input);
+    }
+}
+
+// Worker thread: take items until the stack is empty and nobody can add more
+static void* walkWorker(void *arg) {
+    CasWalk *walk = arg;
+
+    pthread_mutex_lock(&walk->lock);
+    for (;;) {
+        while (walk->count == 0 && walk->active > 0) {
+            pthread_cond_wait(&walk->ready, &walk->lock);
+        }
+        if (walk->count == 0) {
+            break;
+        }
+        WalkItem item = walk->items[--walk->count];
+        walk->active++;
+        pthread_mutex_unlock(&walk->lock);
+
+        if (item.is_dir) {
+            listWalkDirectory(walk, item.path);
+        } else {
+            visitWalkFile(walk, item.path);
+        }
+        free(item.path);
+
+        pthread_mutex_lock(&walk->lock);
+        walk->active--;
+        if (walk->count == 0 && walk->active == 0) {
+            pthread_cond_broadcast(&walk->ready);
+        }
+    }
+    pthread_mutex_unlock(&walk->lock);
+    return NULL;
+}
+
+void walkCasFiles(char **paths, size_t path_count, uint16_t threads,
+                  CasWalkVisit visit, void *context, CasWalkStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    CasWalk walk = {
+        .visit = visit,
+        .context = context,
+        .stats = stats
+    };
+
+    // Arguments: directories are walked, files are visited whatever their name
+    for (size_t i = 0; i < path_count; i++) {
+        struct stat st;
+        if (stat(paths[i], &st) != 0) {
+            fprintf(stderr, "Error: Cannot access '%s': %s\n", paths[i], strerror(errno));
+            stats->failed++;
+            continue;
+        }
+        size_t length = strlen(paths[i]);
+        while (length > 1 && paths[i][length - 1] == '/') {
+            paths[i][--length] = '\0';
+        }
+        if (!pushWalkItem(&walk, paths[i], S_ISDIR(st.st_mode))) {
+            stats->out_of_memory = true;
+        }
+    }
+
+    pthread_mutex_init(&walk.lock, NULL);
+    pthread_cond_init(&walk.ready, NULL);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t *workers = calloc(threads, sizeof(pthread_t));
+    size_t started = 0;
+    while (workers && started < threads &&
+           pthread_create(&workers[started], NULL, walkWorker, &walk) == 0) {
+        started++;
+    }
+    if (started < threads) {
+        fprintf(stderr, "Warning: Started %zu of %u worker threads\n", started, threads);
+    }
+    if (started == 0) {
+        walkWorker(&walk);  // No threads: walk on this one
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    stats->elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    stats->threads = started ? started : 1;
+
+    pthread_cond_destroy(&walk.ready);
+    pthread_mutex_destroy(&walk.lock);
+    free(workers);
+    free(walk.items);
+}
+
+void printCasWalkSummary(const CasWalkStats *stats, const char *verb, size_t tape_files) {
+    char size_str[32];
+    formatBytes(stats->bytes, size_str, sizeof(size_str));
+    fprintf(stderr, "%s %zu CAS file(s) holding %zu tape file(s), %s in %.2f seconds",
+            verb, stats->containers, tape_files, size_str, stats->elapsed);
+    if (stats->failed > 0) {
+        fprintf(stderr, " (%zu failed)", stats->failed);
+    }
+    fprintf(stderr, "\n");
+    if (stats->elapsed > 0.0) {
+        fprintf(stderr, "Throughput: %.1f CAS files/s, %.1f MB/s on %zu thread%s\n",
+                stats->containers / stats->elapsed, stats->bytes / stats->elapsed / (1024.0 * 1024.0),
+                stats->threads, stats->threads == 1 ? "" : "s");
+    }
+}
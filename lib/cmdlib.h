@@ -4,13 +4,9 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include "caslib.h"
 
-// Read an entire file into memory
-// Returns pointer to allocated buffer, or NULL on error
-// Caller must free the returned buffer
-uint8_t* readFileIntoMemory(const char *filename, size_t *out_size);
-
 // Check if a file exists
 bool fileExists(const char *filename);
 
@@ -21,9 +17,15 @@ bool createDirectory(const char *path);
 // Returns allocated string that must be freed by caller
 char* buildFilePath(const char *dir, const char *filename);
 
-// Write CAS file data to disk
+// Write CAS file data to disk as name in directory dir_fd (AT_FDCWD for the
+// current directory); path names it in messages. Large blocks are copied
+// from source_fd, the CAS file their data_offset refers to, without passing
+// through user space where the file systems allow it; everything else (or
+// everything, with source_fd -1) is written from memory in one writev().
+// Existing files are replaced only with overwrite
 // disk_format: if true, add MSX-DOS prefix (0xFE/0xFF) for BINARY/BASIC files
-bool writeFileData(const char *filename, const cas_File *file, bool verbose, bool disk_format);
+bool writeFileData(int dir_fd, const char *name, const char *path, const cas_File *file,
+                   int source_fd, bool overwrite, bool verbose, bool disk_format);
 
 // Format bytes into human-readable string (e.g., "1.5 KB", "2.3 MB")
 void formatBytes(size_t bytes, char *buffer, size_t buffer_size);
@@ -35,4 +37,38 @@ void formatDuration(double seconds, char *buffer, size_t buffer_size);
 // Returns allocated string that must be freed by caller
 char* generateOutputFilename(const char *input_file, const char *new_ext);
 
+// Check for a .cas extension (any case)
+bool hasCasExtension(const char *filename);
+
+// Write text as a JSON string: quotes, backslashes and control bytes escaped
+void writeJsonString(FILE *out, const char *text, size_t length);
+
+// Tape file name without trailing spaces; MSX characters outside printable
+// ASCII become \xNN so every record is plain text
+void formatTapeName(const cas_File *file, char *name, size_t size);
+
+// Parallel walk over CAS files: directories in paths are searched
+// recursively for *.cas files (symbolic links are followed to files only),
+// files named directly are visited whatever their name. Trailing slashes
+// are stripped from paths in place. Each CAS file is parsed in place and
+// passed to visit, on several threads at once; input_size is the CAS
+// file's size. visit returning false counts the file as failed
+typedef bool (*CasWalkVisit)(void *context, const char *path,
+                             const cas_Container *container, size_t input_size);
+
+typedef struct {
+    size_t containers;       // CAS files visited
+    size_t failed;           // Paths that could not be read, parsed or visited
+    uint64_t bytes;          // Size of the visited CAS files
+    size_t threads;          // Workers that ran
+    bool out_of_memory;      // Some paths were dropped; the walk is incomplete
+    double elapsed;          // Seconds
+} CasWalkStats;
+
+void walkCasFiles(char **paths, size_t path_count, uint16_t threads,
+                  CasWalkVisit visit, void *context, CasWalkStats *stats);
+
+// "<verb> N CAS file(s) holding M tape file(s)..." and the throughput, on stderr
+void printCasWalkSummary(const CasWalkStats *stats, const char *verb, size_t tape_files);
+
 #endif // CMDLIB_H
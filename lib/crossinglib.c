@@ -0,0 +1,490 @@
+#include "crossinglib.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CROSSING_X86 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+// Inlined into each kernel, so the AVX2 one runs it as VEX code too
+// (calling SSE code with wide registers in use stalls the CPU)
+#define KERNEL_INLINE __attribute__((always_inline)) inline
+#endif
+
+// =============================================================================
+// Level Tracking
+// =============================================================================
+
+#define LEVEL_DECAY         0.85    // Envelope decay per window (about 0.3 s to -20 dB at 44.1 kHz)
+#define MIN_HYSTERESIS      328     // About 1% of full scale: quieter input is silence
+#define HYSTERESIS_DIVISOR  5       // Hysteresis band: 1/5 of the envelope
+
+static inline int32_t loadSample(const void *samples, PcmFormat format, size_t i) {
+    if (format == PCM_U8) {
+        return (((const uint8_t *)samples)[i] - 128) * 256;
+    }
+    return ((const int16_t *)samples)[i];
+}
+
+static void measureRangeScalar(const void *samples, PcmFormat format, size_t from, size_t count,
+                               int32_t *low, int32_t *high) {
+    for (size_t i = from; i < count; i++) {
+        int32_t x = loadSample(samples, format, i);
+        *low = x < *low ? x : *low;
+        *high = x > *high ? x : *high;
+    }
+}
+
+#ifdef CROSSING_X86
+// Returns how many samples it covered; the caller finishes the rest
+static size_t measureRangeSSE2(const void *samples, PcmFormat format, size_t count,
+                               int32_t *low, int32_t *high) {
+    if (count < 16) {
+        return 0;
+    }
+    size_t i;
+    if (format == PCM_U8) {
+        const uint8_t *p = samples;
+        __m128i lows = _mm_loadu_si128((const __m128i *)p);
+        __m128i highs = lows;
+        for (i = 16; i + 16 <= count; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+            lows = _mm_min_epu8(lows, v);
+            highs = _mm_max_epu8(highs, v);
+        }
+        uint8_t lanes[2][16];
+        _mm_storeu_si128((__m128i *)lanes[0], lows);
+        _mm_storeu_si128((__m128i *)lanes[1], highs);
+        for (int n = 0; n < 16; n++) {
+            int32_t min = (lanes[0][n] - 128) * 256;
+            int32_t max = (lanes[1][n] - 128) * 256;
+            *low = min < *low ? min : *low;
+            *high = max > *high ? max : *high;
+        }
+    } else {
+        const int16_t *p = samples;
+        __m128i lows = _mm_loadu_si128((const __m128i *)p);
+        __m128i highs = lows;
+        for (i = 8; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+            lows = _mm_min_epi16(lows, v);
+            highs = _mm_max_epi16(highs, v);
+        }
+        int16_t lanes[2][8];
+        _mm_storeu_si128((__m128i *)lanes[0], lows);
+        _mm_storeu_si128((__m128i *)lanes[1], highs);
+        for (int n = 0; n < 8; n++) {
+            *low = lanes[0][n] < *low ? lanes[0][n] : *low;
+            *high = lanes[1][n] > *high ? lanes[1][n] : *high;
+        }
+    }
+    return i;
+}
+
+AVX2_TARGET
+static size_t measureRangeAVX2(const void *samples, PcmFormat format, size_t count,
+                               int32_t *low, int32_t *high) {
+    if (count < 32) {
+        return 0;
+    }
+    size_t i;
+    if (format == PCM_U8) {
+        const uint8_t *p = samples;
+        __m256i lows = _mm256_loadu_si256((const __m256i *)p);
+        __m256i highs = lows;
+        for (i = 32; i + 32 <= count; i += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+            lows = _mm256_min_epu8(lows, v);
+            highs = _mm256_max_epu8(highs, v);
+        }
+        uint8_t lanes[2][32];
+        _mm256_storeu_si256((__m256i *)lanes[0], lows);
+        _mm256_storeu_si256((__m256i *)lanes[1], highs);
+        for (int n = 0; n < 32; n++) {
+            int32_t min = (lanes[0][n] - 128) * 256;
+            int32_t max = (lanes[1][n] - 128) * 256;
+            *low = min < *low ? min : *low;
+            *high = max > *high ? max : *high;
+        }
+    } else {
+        const int16_t *p = samples;
+        __m256i lows = _mm256_loadu_si256((const __m256i *)p);
+        __m256i highs = lows;
+        for (i = 16; i + 16 <= count; i += 16) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+            lows = _mm256_min_epi16(lows, v);
+            highs = _mm256_max_epi16(highs, v);
+        }
+        int16_t lanes[2][16];
+        _mm256_storeu_si256((__m256i *)lanes[0], lows);
+        _mm256_storeu_si256((__m256i *)lanes[1], highs);
+        for (int n = 0; n < 16; n++) {
+            *low = lanes[0][n] < *low ? lanes[0][n] : *low;
+            *high = lanes[1][n] > *high ? lanes[1][n] : *high;
+        }
+    }
+    return i;
+}
+#endif
+
+void measurePcmRange(CrossingKernel kernel, const void *samples, PcmFormat format,
+                     size_t count, int32_t *low, int32_t *high) {
+    *low = *high = loadSample(samples, format, 0);
+    size_t done = 0;
+#ifdef CROSSING_X86
+    if (kernel == CROSSING_AVX2) {
+        done = measureRangeAVX2(samples, format, count, low, high);
+    } else if (kernel == CROSSING_SSE2) {
+        done = measureRangeSSE2(samples, format, count, low, high);
+    }
+#else
+    (void)kernel;
+#endif
+    measureRangeScalar(samples, format, done, count, low, high);
+}
+
+void updateCrossingLevel(CrossingDetector *detector, const void *samples, PcmFormat format,
+                         size_t count) {
+    if (count == 0) {
+        return;
+    }
+    int32_t low, high;
+    measurePcmRange(detector->kernel, samples, format, count, &low, &high);
+
+    double swing = (high - low) / 2.0;
+    detector->envelope *= LEVEL_DECAY;
+    if (swing > detector->envelope) {
+        detector->envelope = swing;
+    }
+    if (swing * 4 > detector->envelope) {
+        detector->center = (high + low) / 2;
+    }
+    int32_t band = (int32_t)(detector->envelope / HYSTERESIS_DIVISOR);
+    detector->hysteresis = band > MIN_HYSTERESIS ? band : MIN_HYSTERESIS;
+}
+
+// =============================================================================
+// Crossing Detection
+// =============================================================================
+
+// One call's pass over the samples, shared by the kernels
+typedef struct {
+    const void *samples;
+    PcmFormat format;
+    int32_t center;
+    int32_t band;
+    double base;             // Position of the sample before the first
+    bool high;
+    double zero;
+    double last_crossing;
+    double *halves;
+    size_t count;            // Half-periods written
+} Scan;
+
+static inline void reportCrossing(Scan *scan) {
+    scan->halves[scan->count++] = scan->zero - scan->last_crossing;
+    scan->last_crossing = scan->zero;
+}
+
+// Samples from to to-1 one at a time; previous is the sample before from
+// minus the center. Returns the last sample minus the center
+static int32_t scanScalar(Scan *scan, size_t from, size_t to, int32_t previous) {
+    for (size_t i = from; i < to; i++) {
+        int32_t x = loadSample(scan->samples, scan->format, i) - scan->center;
+        if (scan->high) {
+            if (previous >= 0 && x < 0) {
+                scan->zero = scan->base + i + (double)previous / (previous - x);
+            }
+            if (x < -scan->band) {
+                scan->high = false;
+                reportCrossing(scan);
+            }
+        } else {
+            if (previous <= 0 && x > 0) {
+                scan->zero = scan->base + i + (double)-previous / (x - previous);
+            }
+            if (x > scan->band) {
+                scan->high = true;
+                reportCrossing(scan);
+            }
+        }
+        previous = x;
+    }
+    return previous;
+}
+
+#ifdef CROSSING_X86
+// Center crossing between samples k - 1 and k (k >= 1), interpolated the
+// way scanScalar does it
+static KERNEL_INLINE void setZero(Scan *scan, size_t k) {
+    int32_t previous = loadSample(scan->samples, scan->format, k - 1) - scan->center;
+    int32_t x = loadSample(scan->samples, scan->format, k) - scan->center;
+    if (scan->high) {
+        scan->zero = scan->base + k + (double)previous / (previous - x);
+    } else {
+        scan->zero = scan->base + k + (double)-previous / (x - previous);
+    }
+}
+
+static inline unsigned highestBit(uint32_t mask) {
+    return 31 - (unsigned)__builtin_clz(mask);
+}
+
+// Bit n of each mask stands for sample i + n: below/above the band, center
+// crossed downward/upward. Replays scanScalar's decisions from the masks,
+// one trigger flip at a time
+static KERNEL_INLINE void scanMasks(Scan *scan, size_t i, uint32_t below, uint32_t above,
+                      uint32_t down, uint32_t up) {
+    for (;;) {
+        uint32_t trigger = scan->high ? below : above;
+        uint32_t zeros = scan->high ? down : up;
+        if (trigger == 0) {
+            if (zeros) {
+                setZero(scan, i + highestBit(zeros));
+            }
+            return;
+        }
+
+        unsigned flip = (unsigned)__builtin_ctz(trigger);
+        uint32_t through = (flip == 31) ? UINT32_MAX : (2u << flip) - 1;
+        zeros &= through;
+        if (zeros) {
+            setZero(scan, i + highestBit(zeros));
+        }
+        scan->high = !scan->high;
+        reportCrossing(scan);
+
+        below &= ~through;
+        above &= ~through;
+        down &= ~through;
+        up &= ~through;
+    }
+}
+
+// Band edges as 16-bit thresholds: an edge beyond the 16-bit range can
+// never be passed, so clamping it changes no comparison
+static inline int16_t lowEdge(const Scan *scan) {
+    int32_t edge = scan->center - scan->band;
+    return (int16_t)(edge < INT16_MIN ? INT16_MIN : edge);
+}
+
+static inline int16_t highEdge(const Scan *scan) {
+    int32_t edge = scan->center + scan->band;
+    return (int16_t)(edge > INT16_MAX ? INT16_MAX : edge);
+}
+
+static inline void loadSSE2(const Scan *scan, size_t i, __m128i *first, __m128i *second) {
+    if (scan->format == PCM_U8) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)((const uint8_t *)scan->samples + i));
+        __m128i zero = _mm_setzero_si128();
+        __m128i offset = _mm_set1_epi16(128);
+        *first = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(bytes, zero), offset), 8);
+        *second = _mm_slli_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(bytes, zero), offset), 8);
+    } else {
+        const int16_t *p = (const int16_t *)scan->samples + i;
+        *first = _mm_loadu_si128((const __m128i *)p);
+        *second = _mm_loadu_si128((const __m128i *)(p + 8));
+    }
+}
+
+static inline uint32_t maskSSE2(__m128i first, __m128i second) {
+    return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(first, second));
+}
+
+// 16 samples a step from i (>= 1); returns where it stopped
+static size_t scanSSE2(Scan *scan, size_t i, size_t count) {
+    const __m128i center = _mm_set1_epi16((int16_t)scan->center);
+    const __m128i low = _mm_set1_epi16(lowEdge(scan));
+    const __m128i high = _mm_set1_epi16(highEdge(scan));
+
+    // Sign of the sample before each step, for the crossing masks
+    int32_t before = loadSample(scan->samples, scan->format, i - 1);
+    uint32_t negative_carry = before < scan->center;
+    uint32_t positive_carry = before > scan->center;
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i s0, s1;
+        loadSSE2(scan, i, &s0, &s1);
+        uint32_t negative = maskSSE2(_mm_cmplt_epi16(s0, center), _mm_cmplt_epi16(s1, center));
+        uint32_t positive = maskSSE2(_mm_cmpgt_epi16(s0, center), _mm_cmpgt_epi16(s1, center));
+        uint32_t down = negative & ~((negative << 1) | negative_carry);
+        uint32_t up = positive & ~((positive << 1) | positive_carry);
+        negative_carry = negative >> 15;
+        positive_carry = positive >> 15;
+
+        if (scan->high) {
+            uint32_t below = maskSSE2(_mm_cmplt_epi16(s0, low), _mm_cmplt_epi16(s1, low));
+            if (below == 0) {
+                if (down) {
+                    setZero(scan, i + highestBit(down));
+                }
+                continue;
+            }
+        } else {
+            uint32_t above = maskSSE2(_mm_cmpgt_epi16(s0, high), _mm_cmpgt_epi16(s1, high));
+            if (above == 0) {
+                if (up) {
+                    setZero(scan, i + highestBit(up));
+                }
+                continue;
+            }
+        }
+        uint32_t below = maskSSE2(_mm_cmplt_epi16(s0, low), _mm_cmplt_epi16(s1, low));
+        uint32_t above = maskSSE2(_mm_cmpgt_epi16(s0, high), _mm_cmpgt_epi16(s1, high));
+        scanMasks(scan, i, below, above, down, up);
+    }
+    return i;
+}
+
+AVX2_TARGET
+static inline void loadAVX2(const Scan *scan, size_t i, __m256i *first, __m256i *second) {
+    if (scan->format == PCM_U8) {
+        const uint8_t *p = (const uint8_t *)scan->samples + i;
+        __m256i offset = _mm256_set1_epi16(128);
+        __m256i low = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p));
+        __m256i high = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(p + 16)));
+        *first = _mm256_slli_epi16(_mm256_sub_epi16(low, offset), 8);
+        *second = _mm256_slli_epi16(_mm256_sub_epi16(high, offset), 8);
+    } else {
+        const int16_t *p = (const int16_t *)scan->samples + i;
+        *first = _mm256_loadu_si256((const __m256i *)p);
+        *second = _mm256_loadu_si256((const __m256i *)(p + 16));
+    }
+}
+
+// Packing works within 128-bit lanes; the permute puts the 32 results back
+// in sample order
+AVX2_TARGET
+static inline uint32_t maskAVX2(__m256i first, __m256i second) {
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(first, second), 0xD8);
+    return (uint32_t)_mm256_movemask_epi8(packed);
+}
+
+// 32 samples a step from i (>= 1); returns where it stopped
+AVX2_TARGET
+static size_t scanAVX2(Scan *scan, size_t i, size_t count) {
+    const __m256i center = _mm256_set1_epi16((int16_t)scan->center);
+    const __m256i low = _mm256_set1_epi16(lowEdge(scan));
+    const __m256i high = _mm256_set1_epi16(highEdge(scan));
+
+    int32_t before = loadSample(scan->samples, scan->format, i - 1);
+    uint32_t negative_carry = before < scan->center;
+    uint32_t positive_carry = before > scan->center;
+
+    for (; i + 32 <= count; i += 32) {
+        __m256i s0, s1;
+        loadAVX2(scan, i, &s0, &s1);
+        uint32_t negative = maskAVX2(_mm256_cmpgt_epi16(center, s0), _mm256_cmpgt_epi16(center, s1));
+        uint32_t positive = maskAVX2(_mm256_cmpgt_epi16(s0, center), _mm256_cmpgt_epi16(s1, center));
+        uint32_t down = negative & ~((negative << 1) | negative_carry);
+        uint32_t up = positive & ~((positive << 1) | positive_carry);
+        negative_carry = negative >> 31;
+        positive_carry = positive >> 31;
+
+        if (scan->high) {
+            uint32_t below = maskAVX2(_mm256_cmpgt_epi16(low, s0), _mm256_cmpgt_epi16(low, s1));
+            if (below == 0) {
+                if (down) {
+                    setZero(scan, i + highestBit(down));
+                }
+                continue;
+            }
+        } else {
+            uint32_t above = maskAVX2(_mm256_cmpgt_epi16(s0, high), _mm256_cmpgt_epi16(s1, high));
+            if (above == 0) {
+                if (up) {
+                    setZero(scan, i + highestBit(up));
+                }
+                continue;
+            }
+        }
+        uint32_t below = maskAVX2(_mm256_cmpgt_epi16(low, s0), _mm256_cmpgt_epi16(low, s1));
+        uint32_t above = maskAVX2(_mm256_cmpgt_epi16(s0, high), _mm256_cmpgt_epi16(s1, high));
+        scanMasks(scan, i, below, above, down, up);
+    }
+    return i;
+}
+#endif
+
+size_t findHalfPeriods(CrossingDetector *detector, const void *samples, PcmFormat format,
+                       size_t count, double *halves) {
+    Scan scan = {
+        .samples = samples,
+        .format = format,
+        .center = detector->center,
+        .band = detector->hysteresis,
+        .base = (double)detector->position - 1,
+        .high = detector->high,
+        .zero = detector->zero,
+        .last_crossing = detector->last_crossing,
+        .halves = halves
+    };
+    int32_t previous = detector->previous;
+    size_t i = 0;
+
+#ifdef CROSSING_X86
+    // The vector kernels compare samples with the center as 16-bit values
+    if (detector->kernel != CROSSING_SCALAR && count > 1 && scan.band >= 0 &&
+        scan.center >= INT16_MIN && scan.center <= INT16_MAX) {
+        // The first sample goes alone: the vector steps look one sample back
+        scanScalar(&scan, 0, 1, previous);
+        i = 1;
+        if (detector->kernel == CROSSING_AVX2) {
+            i = scanAVX2(&scan, i, count);
+        }
+        i = scanSSE2(&scan, i, count);
+        previous = loadSample(samples, format, i - 1) - scan.center;
+    }
+#endif
+    previous = scanScalar(&scan, i, count, previous);
+
+    detector->previous = previous;
+    detector->high = scan.high;
+    detector->zero = scan.zero;
+    detector->last_crossing = scan.last_crossing;
+    detector->position += count;
+    return scan.count;
+}
+
+// =============================================================================
+// Kernel Selection
+// =============================================================================
+
+bool hasCrossingKernel(CrossingKernel kernel) {
+    switch (kernel) {
+        case CROSSING_SCALAR:
+            return true;
+#ifdef CROSSING_X86
+        case CROSSING_SSE2:
+            return true;  // Part of x86-64
+        case CROSSING_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+CrossingKernel getBestCrossingKernel(void) {
+    if (hasCrossingKernel(CROSSING_AVX2)) {
+        return CROSSING_AVX2;
+    }
+    if (hasCrossingKernel(CROSSING_SSE2)) {
+        return CROSSING_SSE2;
+    }
+    return CROSSING_SCALAR;
+}
+
+const char* getCrossingKernelName(CrossingKernel kernel) {
+    switch (kernel) {
+        case CROSSING_SCALAR: return "scalar";
+        case CROSSING_SSE2: return "SSE2";
+        case CROSSING_AVX2: return "AVX2";
+        default: return "unknown";
+    }
+}
+
+void initCrossingDetector(CrossingDetector *detector) {
+    *detector = (CrossingDetector){
+        .hysteresis = MIN_HYSTERESIS,
+        .kernel = getBestCrossingKernel()
+    };
+}
@@ -0,0 +1,84 @@
+#ifndef CROSSINGLIB_H
+#define CROSSINGLIB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// =============================================================================
+// Zero-Crossing Kernel
+// =============================================================================
+//
+// The hot loop of tape decoding: find where the signal crosses its center
+// and measure the time between crossings (half-periods), in fractions of a
+// sample. A Schmitt trigger reports a crossing only once the signal has
+// gone on past a hysteresis band around the center, so noise near the
+// center adds none; the crossing itself is interpolated where the signal
+// passed the center.
+//
+// The vector kernels (SSE2, AVX2) compare 16 or 32 samples at a time with
+// the center and the band edges and turn the results into bit masks. Only
+// the few samples where the trigger flips are then looked at one by one,
+// so a half-period costs a handful of instructions however many samples it
+// spans. Every kernel gives bit-identical results.
+//
+// =============================================================================
+
+#define CROSSING_WINDOW     1024    // Samples per updateCrossingLevel() window
+
+typedef enum {
+    PCM_U8,                  // 8-bit unsigned, 128 = center (8-bit WAV)
+    PCM_S16                  // 16-bit signed, native byte order
+} PcmFormat;
+
+typedef enum {
+    CROSSING_SCALAR,
+    CROSSING_SSE2,
+    CROSSING_AVX2
+} CrossingKernel;
+
+// Detector state, carried from one block of samples to the next. Levels
+// are on the 16-bit scale: an 8-bit sample x counts as (x - 128) * 256
+typedef struct {
+    int32_t center;          // Signal center (-32768 to 32767)
+    int32_t hysteresis;      // Band the signal must leave on either side
+    double envelope;         // Peak swing, decaying (updateCrossingLevel)
+    CrossingKernel kernel;   // Set by initCrossingDetector; may be lowered
+    bool high;               // Schmitt trigger output
+    int32_t previous;        // Last sample minus center
+    double zero;             // Last center crossing in the direction awaited
+    double last_crossing;    // Position of the last crossing reported
+    uint64_t position;       // Samples processed
+} CrossingDetector;
+
+// Start at position 0 with the fastest kernel this CPU runs
+void initCrossingDetector(CrossingDetector *detector);
+
+// Find the half-periods in count samples with the detector's center and
+// hysteresis. halves must hold count values (a crossing needs at least one
+// sample); returns how many were written. The first is measured from the
+// last crossing of the previous call (from 0 at the start)
+size_t findHalfPeriods(CrossingDetector *detector, const void *samples, PcmFormat format,
+                       size_t count, double *halves);
+
+// Follow the signal level over one window (up to CROSSING_WINDOW samples,
+// before findHalfPeriods on them): the center moves to the midpoint of the
+// window's extremes, whatever the duty cycle, and the hysteresis band to a
+// fifth of the decaying peak swing. Input quieter than about 1% of full
+// scale finds no crossings
+void updateCrossingLevel(CrossingDetector *detector, const void *samples, PcmFormat format,
+                         size_t count);
+
+// Lowest and highest sample of count (at least 1), on the 16-bit scale
+void measurePcmRange(CrossingKernel kernel, const void *samples, PcmFormat format,
+                     size_t count, int32_t *low, int32_t *high);
+
+bool hasCrossingKernel(CrossingKernel kernel);
+CrossingKernel getBestCrossingKernel(void);
+const char* getCrossingKernelName(CrossingKernel kernel);
+
+static inline size_t getPcmSampleSize(PcmFormat format) {
+    return format == PCM_U8 ? 1 : 2;
+}
+
+#endif // CROSSINGLIB_H
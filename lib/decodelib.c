@@ -0,0 +1,1039 @@
+#include "decodelib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// =============================================================================
+// Decoder Tuning
+// =============================================================================
+
+#define LEADER_LOCK_HALVES  200     // Matching half-cycles that make a leader (50 1-bits)
+#define LEADER_TOLERANCE    0.2     // Cycle length variation allowed in a leader
+#define MIN_CYCLE_HZ        1500    // Plausible 1-bit cycle frequencies: 2400 Hz at
+#define MAX_CYCLE_HZ        9000    // 1200 baud to 7200 Hz at 3600 baud, plus drift
+#define STOP_MAX_HALVES     64      // SHORT half-cycles after a byte before it is a new leader
+#define GAP_SHORT_HALVES    20      // Silence: no crossing for 10 LONG half-cycles
+#define MIN_SAMPLE_RATE     8000
+
+// =============================================================================
+// Tape Decoder
+// =============================================================================
+
+typedef enum {
+    DECODE_HUNT,             // Looking for a leader
+    DECODE_LEADER,           // In a leader, waiting for the first START bit
+    DECODE_START,            // Saw a LONG half-cycle: second half of a START bit?
+    DECODE_DATA,             // Reading data bits
+    DECODE_STOP              // After a byte: stop bits, then a START bit
+} DecodeState;
+
+struct TapeDecoder {
+    TapeDecoderConfig config;
+
+    // Zero crossings
+    CrossingDetector detector;
+    double halves[CROSSING_WINDOW];
+
+    // Half-cycles to bits
+    DecodeState state;
+    double w;                // SHORT half-cycle length in samples
+    double previous_half;    // For cycle lengths in the leader and stop bits
+    size_t run;              // Leader: matching half-cycles so far
+    double run_mean;         // Leader: mean cycle length of the run
+    double run_start;        // Leader: first crossing of the run
+    double start_half;       // First half of the START bit
+    double start_position;
+    double half;             // Data and stop bits: first half of the current cycle (0 = none)
+    bool short_pending;      // Data: first SHORT cycle of a 1-bit seen
+    uint8_t byte;
+    int bit_count;
+    size_t stop_halves;
+
+    // Output
+    TapeBlock block;         // Block being decoded
+    bool in_block;           // block has a CAS header in the image
+    uint8_t *image;
+    size_t image_size;
+    size_t image_capacity;
+    TapeBlock *blocks;
+    size_t block_count;
+    size_t block_capacity;
+    bool stopped;            // Callback stopped or out of memory
+};
+
+static bool reserveImage(TapeDecoder *decoder, size_t extra) {
+    if (decoder->image_size + extra <= decoder->image_capacity) {
+        return true;
+    }
+    size_t capacity = decoder->image_capacity ? decoder->image_capacity * 2 : 64 * 1024;
+    while (capacity < decoder->image_size + extra) {
+        capacity *= 2;
+    }
+    uint8_t *grown = realloc(decoder->image, capacity);
+    if (!grown) {
+        fprintf(stderr, "Error: Out of memory for the decoded CAS image\n");
+        decoder->stopped = true;
+        return false;
+    }
+    decoder->image = grown;
+    decoder->image_capacity = capacity;
+    return true;
+}
+
+// A new leader was recognized at sample position
+static void startBlock(TapeDecoder *decoder, double position) {
+    memset(&decoder->block, 0, sizeof(decoder->block));
+    decoder->block.leader_start = (uint64_t)position;
+    decoder->block.baud_rate = (uint32_t)(decoder->config.sample_rate / (4.0 * decoder->w) + 0.5);
+    decoder->in_block = false;
+}
+
+static void appendByte(TapeDecoder *decoder, uint8_t byte, double position) {
+    if (!decoder->in_block) {
+        // Pad to 8 bytes and open the block with a CAS header
+        size_t padding = (8 - decoder->image_size % 8) % 8;
+        if (!reserveImage(decoder, padding + sizeof(CAS_HEADER))) {
+            return;
+        }
+        memset(decoder->image + decoder->image_size, 0x00, padding);
+        decoder->image_size += padding;
+        decoder->block.image_offset = decoder->image_size;
+        decoder->block.data_start = (uint64_t)decoder->start_position;
+        memcpy(decoder->image + decoder->image_size, CAS_HEADER, sizeof(CAS_HEADER));
+        decoder->image_size += sizeof(CAS_HEADER);
+        decoder->in_block = true;
+    }
+    if (!reserveImage(decoder, 1)) {
+        return;
+    }
+    decoder->image[decoder->image_size++] = byte;
+    decoder->block.size++;
+    decoder->block.end = (uint64_t)position;
+}
+
+// Add decoder->block, whose bytes are in the image, to the list and report it
+static void pushBlock(TapeDecoder *decoder) {
+    if (decoder->block_count == decoder->block_capacity) {
+        size_t capacity = decoder->block_capacity ? decoder->block_capacity * 2 : 64;
+        TapeBlock *grown = realloc(decoder->blocks, capacity * sizeof(TapeBlock));
+        if (!grown) {
+            fprintf(stderr, "Error: Out of memory for decoded blocks\n");
+            decoder->stopped = true;
+            return;
+        }
+        decoder->blocks = grown;
+        decoder->block_capacity = capacity;
+    }
+    decoder->blocks[decoder->block_count++] = decoder->block;
+
+    if (decoder->config.block_end &&
+        !decoder->config.block_end(decoder->config.context, &decoder->block,
+                                   decoder->image + decoder->block.image_offset + sizeof(CAS_HEADER))) {
+        decoder->stopped = true;
+    }
+}
+
+// Close the block being decoded (if it has bytes) and report it
+static void endBlock(TapeDecoder *decoder, bool error) {
+    if (!decoder->in_block) {
+        return;
+    }
+    decoder->in_block = false;
+    decoder->block.error = error;
+    pushBlock(decoder);
+}
+
+static void resetHunt(TapeDecoder *decoder) {
+    decoder->state = DECODE_HUNT;
+    decoder->run = 0;
+    decoder->previous_half = 0;
+}
+
+// A framing error or silence inside a byte: keep what was decoded
+static void loseSync(TapeDecoder *decoder) {
+    endBlock(decoder, true);
+    resetHunt(decoder);
+}
+
+static void beginByte(TapeDecoder *decoder) {
+    decoder->state = DECODE_DATA;
+    decoder->half = 0;
+    decoder->short_pending = false;
+    decoder->byte = 0;
+    decoder->bit_count = 0;
+}
+
+// Follow tape speed: nudge w toward the SHORT half-cycle a cycle implies
+static inline void trackSpeed(TapeDecoder *decoder, double short_half, double rate) {
+    decoder->w += (short_half - decoder->w) * rate;
+}
+
+// Leader search: consecutive pairs of half-cycles (so uneven halves from
+// DC offset or odd sample counts still match) of about the same length
+static void huntLeader(TapeDecoder *decoder, double half, double crossing) {
+    double previous = decoder->previous_half;
+    decoder->previous_half = half;
+    if (previous == 0) {
+        return;
+    }
+
+    double cycle = previous + half;
+    double rate = decoder->config.sample_rate;
+    if (cycle < rate / MAX_CYCLE_HZ || cycle > rate / MIN_CYCLE_HZ) {
+        decoder->run = 0;
+        return;
+    }
+    if (decoder->run > 0 && cycle > decoder->run_mean * (1.0 - LEADER_TOLERANCE) &&
+        cycle < decoder->run_mean * (1.0 + LEADER_TOLERANCE)) {
+        decoder->run++;
+        decoder->run_mean += (cycle - decoder->run_mean) / (decoder->run < 32 ? decoder->run : 32);
+    } else {
+        decoder->run = 1;
+        decoder->run_mean = cycle;
+        decoder->run_start = crossing - cycle;
+    }
+
+    if (decoder->run >= LEADER_LOCK_HALVES) {
+        decoder->w = decoder->run_mean / 2;
+        decoder->state = DECODE_LEADER;
+        startBlock(decoder, decoder->run_start);
+    }
+}
+
+// One half-cycle (the distance between two crossings) ending at crossing
+static void decodeHalfCycle(TapeDecoder *decoder, double half, double crossing) {
+    double w = decoder->w;
+
+    // Silence between crossings ends whatever was being decoded
+    if (decoder->state != DECODE_HUNT && half > GAP_SHORT_HALVES * w) {
+        if (decoder->state == DECODE_STOP || decoder->state == DECODE_LEADER) {
+            endBlock(decoder, false);
+            resetHunt(decoder);
+        } else {
+            loseSync(decoder);
+        }
+        return;
+    }
+
+    switch (decoder->state) {
+        case DECODE_HUNT:
+            huntLeader(decoder, half, crossing);
+            break;
+
+        case DECODE_LEADER:
+            if (half > 1.5 * w) {
+                decoder->start_half = half;
+                decoder->start_position = crossing - half;
+                decoder->state = DECODE_START;
+                break;
+            }
+            if (half < 0.3 * w) {
+                resetHunt(decoder);  // Too short for this tape: noise, not signal
+                break;
+            }
+            if (decoder->previous_half > 0) {
+                trackSpeed(decoder, (decoder->previous_half + half) / 2, 1.0 / 64);
+            }
+            decoder->previous_half = half;
+            break;
+
+        case DECODE_START: {
+            // The first START bit fixes which crossings pair into cycles
+            double cycle = decoder->start_half + half;
+            if (cycle > 3 * w && cycle < 6 * w) {
+                trackSpeed(decoder, cycle / 4, 1.0 / 32);
+                beginByte(decoder);
+            } else {
+                decoder->state = DECODE_LEADER;  // A stray long half-cycle in the leader
+                decoder->previous_half = half;
+            }
+            break;
+        }
+
+        case DECODE_STOP: {
+            // Stop bits are read as cycles paired like the data bits: a
+            // half-cycle next to a 0-bit may be anywhere between SHORT and
+            // LONG (triangle and trapezoid waves cross the center a quarter
+            // cycle in), but a pair never is
+            if (decoder->half == 0) {
+                decoder->half = half;
+                break;
+            }
+            double cycle = decoder->half + half;
+            decoder->half = 0;
+            if (cycle > 3 * w) {
+                if (cycle > 6 * w) {
+                    loseSync(decoder);
+                    break;
+                }
+                trackSpeed(decoder, cycle / 4, 1.0 / 32);
+                decoder->start_position = crossing - cycle;
+                beginByte(decoder);
+            } else if (cycle < w) {
+                loseSync(decoder);
+            } else {
+                trackSpeed(decoder, cycle / 2, 1.0 / 32);
+                decoder->stop_halves += 2;
+                if (decoder->stop_halves > STOP_MAX_HALVES) {
+                    // Still SHORT: the leader of the next block followed directly
+                    endBlock(decoder, false);
+                    decoder->state = DECODE_LEADER;
+                    decoder->previous_half = 0;
+                    startBlock(decoder, crossing);
+                }
+            }
+            break;
+        }
+
+        case DECODE_DATA: {
+            if (decoder->half == 0) {
+                decoder->half = half;
+                break;
+            }
+            double cycle = decoder->half + half;
+            decoder->half = 0;
+
+            int bit;
+            if (cycle > 3 * w) {
+                if (cycle > 6 * w || decoder->short_pending) {
+                    loseSync(decoder);
+                    break;
+                }
+                trackSpeed(decoder, cycle / 4, 1.0 / 32);
+                bit = 0;
+            } else {
+                if (cycle < w) {
+                    loseSync(decoder);
+                    break;
+                }
+                trackSpeed(decoder, cycle / 2, 1.0 / 32);
+                if (!decoder->short_pending) {
+                    decoder->short_pending = true;
+                    break;
+                }
+                decoder->short_pending = false;
+                bit = 1;
+            }
+
+            decoder->byte |= (uint8_t)(bit << decoder->bit_count);
+            if (++decoder->bit_count == 8) {
+                appendByte(decoder, decoder->byte, crossing);
+                decoder->state = DECODE_STOP;
+                decoder->stop_halves = 0;
+            }
+            break;
+        }
+    }
+}
+
+TapeDecoder* createTapeDecoder(const TapeDecoderConfig *config) {
+    if (!config || config->sample_rate < MIN_SAMPLE_RATE) {
+        fprintf(stderr, "Error: Unsupported sample rate for decoding\n");
+        return NULL;
+    }
+    TapeDecoder *decoder = calloc(1, sizeof(TapeDecoder));
+    if (!decoder) {
+        fprintf(stderr, "Error: Failed to allocate tape decoder\n");
+        return NULL;
+    }
+    decoder->config = *config;
+    initCrossingDetector(&decoder->detector);
+    resetHunt(decoder);
+    return decoder;
+}
+
+bool feedTapeDecoderPcm(TapeDecoder *decoder, const void *samples, PcmFormat format, size_t count) {
+    CrossingDetector *detector = &decoder->detector;
+    const uint8_t *p = samples;
+    size_t sample_size = getPcmSampleSize(format);
+
+    while (count > 0 && !decoder->stopped) {
+        size_t window = count < CROSSING_WINDOW ? count : CROSSING_WINDOW;
+        updateCrossingLevel(detector, p, format, window);
+        double crossing = detector->last_crossing;
+        size_t found = findHalfPeriods(detector, p, format, window, decoder->halves);
+        for (size_t i = 0; i < found && !decoder->stopped; i++) {
+            crossing += decoder->halves[i];
+            decodeHalfCycle(decoder, decoder->halves[i], crossing);
+        }
+        p += window * sample_size;
+        count -= window;
+
+        // Silence after the last crossing ends a block without waiting
+        // for the next signal
+        double silence = detector->position - detector->last_crossing;
+        if (decoder->state != DECODE_HUNT && silence > GAP_SHORT_HALVES * decoder->w) {
+            decodeHalfCycle(decoder, silence, detector->position);
+        }
+    }
+    return !decoder->stopped;
+}
+
+bool feedTapeDecoder(TapeDecoder *decoder, const int16_t *samples, size_t count) {
+    return feedTapeDecoderPcm(decoder, samples, PCM_S16, count);
+}
+
+bool finishTapeDecoder(TapeDecoder *decoder) {
+    if (decoder->state == DECODE_STOP || decoder->state == DECODE_LEADER) {
+        endBlock(decoder, false);
+    } else if (decoder->state != DECODE_HUNT) {
+        endBlock(decoder, true);
+    }
+    resetHunt(decoder);
+    return !decoder->stopped;
+}
+
+const uint8_t* getTapeDecoderImage(const TapeDecoder *decoder, size_t *size) {
+    *size = decoder->image_size;
+    return decoder->image;
+}
+
+const TapeBlock* getTapeDecoderBlocks(const TapeDecoder *decoder, size_t *count) {
+    *count = decoder->block_count;
+    return decoder->blocks;
+}
+
+uint64_t getTapeDecoderPosition(const TapeDecoder *decoder) {
+    return decoder->detector.position;
+}
+
+uint32_t getTapeDecoderSampleRate(const TapeDecoder *decoder) {
+    return decoder->config.sample_rate;
+}
+
+bool buildTapeDecoderContainer(const TapeDecoder *decoder, cas_Container *container) {
+    return parseCasContainer(decoder->image, container, decoder->image_size);
+}
+
+void freeTapeDecoder(TapeDecoder *decoder) {
+    if (decoder) {
+        free(decoder->image);
+        free(decoder->blocks);
+        free(decoder);
+    }
+}
+
+// =============================================================================
+// WAV Reader
+// =============================================================================
+
+#define WAV_FORMAT_PCM         0x0001
+#define WAV_FORMAT_FLOAT       0x0003
+#define WAV_FORMAT_EXTENSIBLE  0xFFFE
+#define READER_FRAMES          4096
+
+static uint16_t getLE16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t getLE32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Skip size bytes of a chunk (pipes cannot seek)
+static bool skipBytes(FILE *file, uint64_t size) {
+    if (fseek(file, (long)size, SEEK_CUR) == 0) {
+        return true;
+    }
+    uint8_t scratch[4096];
+    while (size > 0) {
+        size_t take = size < sizeof(scratch) ? (size_t)size : sizeof(scratch);
+        if (fread(scratch, 1, take, file) != take) {
+            return false;
+        }
+        size -= take;
+    }
+    return true;
+}
+
+// Read the fmt chunk. Returns false (after printing an error) for formats
+// the reader does not convert
+static bool readFormatChunk(WavReader *reader, const char *filename, uint32_t size) {
+    uint8_t fmt[40] = {0};
+    size_t take = size < sizeof(fmt) ? size : sizeof(fmt);
+    if (size < 16 || fread(fmt, 1, take, reader->file) != take ||
+        !skipBytes(reader->file, size - take + (size & 1))) {
+        fprintf(stderr, "Error: Damaged fmt chunk in %s\n", filename);
+        return false;
+    }
+
+    uint16_t tag = getLE16(fmt);
+    reader->channels = getLE16(fmt + 2);
+    reader->sample_rate = getLE32(fmt + 4);
+    reader->bits_per_sample = getLE16(fmt + 14);
+    if (tag == WAV_FORMAT_EXTENSIBLE && size >= 40) {
+        tag = getLE16(fmt + 24);  // First bytes of the SubFormat GUID
+    }
+    reader->is_float = (tag == WAV_FORMAT_FLOAT);
+
+    bool supported = (tag == WAV_FORMAT_PCM &&
+                      (reader->bits_per_sample == 8 || reader->bits_per_sample == 16 ||
+                       reader->bits_per_sample == 24 || reader->bits_per_sample == 32)) ||
+                     (tag == WAV_FORMAT_FLOAT && reader->bits_per_sample == 32);
+    if (!supported) {
+        fprintf(stderr, "Error: %s: unsupported WAV format (tag 0x%04X, %u bits)\n",
+                filename, tag, reader->bits_per_sample);
+        return false;
+    }
+    if (reader->channels == 0 || reader->sample_rate == 0) {
+        fprintf(stderr, "Error: %s: no channels or sample rate\n", filename);
+        return false;
+    }
+    if (reader->channel >= reader->channels) {
+        fprintf(stderr, "Error: %s has %u channel(s), cannot read channel %u\n",
+                filename, reader->channels, reader->channel + 1);
+        return false;
+    }
+    return true;
+}
+
+bool openWavReader(const char *filename, uint16_t channel, WavReader *reader) {
+    memset(reader, 0, sizeof(*reader));
+    reader->channel = channel;
+    if (strcmp(filename, "-") == 0) {
+        reader->file = stdin;
+    } else {
+        reader->file = fopen(filename, "rb");
+        reader->close_file = true;
+    }
+    if (!reader->file) {
+        fprintf(stderr, "Error: Cannot open %s\n", filename);
+        return false;
+    }
+
+    uint8_t riff[12];
+    if (fread(riff, 1, sizeof(riff), reader->file) != sizeof(riff) ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "Error: %s is not a WAV file\n", filename);
+        closeWavReader(reader);
+        return false;
+    }
+
+    // Chunks up to the samples: fmt, then data (others are skipped)
+    bool have_format = false;
+    for (;;) {
+        uint8_t chunk[8];
+        if (fread(chunk, 1, sizeof(chunk), reader->file) != sizeof(chunk)) {
+            fprintf(stderr, "Error: No data chunk in %s\n", filename);
+            closeWavReader(reader);
+            return false;
+        }
+        uint32_t size = getLE32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (!readFormatChunk(reader, filename, size)) {
+                closeWavReader(reader);
+                return false;
+            }
+            have_format = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_format) {
+                fprintf(stderr, "Error: Data before fmt chunk in %s\n", filename);
+                closeWavReader(reader);
+                return false;
+            }
+            size_t frame_size = (size_t)reader->channels * (reader->bits_per_sample / 8);
+            // Streams written before their length was known leave 0 or ~0
+            reader->frames = (size == 0 || size == UINT32_MAX) ? UINT64_MAX : size / frame_size;
+            long offset = ftell(reader->file);
+            reader->data_offset = offset > 0 ? (uint64_t)offset : 0;
+            break;
+        } else if (!skipBytes(reader->file, (uint64_t)size + (size & 1))) {
+            fprintf(stderr, "Error: Truncated WAV file %s\n", filename);
+            closeWavReader(reader);
+            return false;
+        }
+    }
+
+    reader->buffer_frames = READER_FRAMES;
+    reader->buffer = malloc(READER_FRAMES * (size_t)reader->channels * (reader->bits_per_sample / 8));
+    if (!reader->buffer) {
+        fprintf(stderr, "Error: Failed to allocate WAV read buffer\n");
+        closeWavReader(reader);
+        return false;
+    }
+    return true;
+}
+
+// Read up to count frames (at most a buffer) into reader->buffer
+static size_t readFrames(WavReader *reader, size_t count) {
+    size_t frame_size = (size_t)reader->channels * (reader->bits_per_sample / 8);
+    uint64_t remaining = reader->frames - reader->frames_read;
+    size_t want = count < reader->buffer_frames ? count : reader->buffer_frames;
+    want = want < remaining ? want : (size_t)remaining;
+    if (want == 0) {
+        return 0;
+    }
+    size_t got = fread(reader->buffer, frame_size, want, reader->file);
+    if (got == 0) {
+        reader->frames = reader->frames_read;  // End of file before the declared end
+    }
+    reader->frames_read += got;
+    return got;
+}
+
+// Convert count frames of the selected channel to 16-bit
+static void convertFrames(const WavReader *reader, const uint8_t *frames, size_t count, int16_t *out) {
+    size_t bytes = reader->bits_per_sample / 8;
+    size_t frame_size = reader->channels * bytes;
+    const uint8_t *p = frames + reader->channel * bytes;
+    switch (reader->bits_per_sample) {
+        case 8:
+            for (size_t i = 0; i < count; i++, p += frame_size) {
+                out[i] = (int16_t)((p[0] - 128) * 256);
+            }
+            break;
+        case 16:
+            for (size_t i = 0; i < count; i++, p += frame_size) {
+                out[i] = (int16_t)getLE16(p);
+            }
+            break;
+        case 24:
+            for (size_t i = 0; i < count; i++, p += frame_size) {
+                out[i] = (int16_t)getLE16(p + 1);
+            }
+            break;
+        case 32:
+            for (size_t i = 0; i < count; i++, p += frame_size) {
+                if (reader->is_float) {
+                    float value;
+                    memcpy(&value, p, sizeof(value));
+                    value = value > 1.0f ? 1.0f : value < -1.0f ? -1.0f : value;
+                    out[i] = (int16_t)(value * 32767.0f);
+                } else {
+                    out[i] = (int16_t)getLE16(p + 2);
+                }
+            }
+            break;
+    }
+}
+
+// Copy count frames of the selected channel as stored (8 and 16-bit files)
+static void extractFrames(const WavReader *reader, const uint8_t *frames, size_t count, void *samples) {
+    size_t bytes = reader->bits_per_sample / 8;
+    size_t frame_size = reader->channels * bytes;
+    const uint8_t *p = frames + reader->channel * bytes;
+    uint8_t *out = samples;
+    if (reader->channels == 1) {
+        memcpy(out, p, count * bytes);
+    } else if (bytes == 1) {
+        for (size_t i = 0; i < count; i++, p += frame_size) {
+            out[i] = p[0];
+        }
+    } else {
+        for (size_t i = 0; i < count; i++, p += frame_size) {
+            memcpy(out + i * 2, p, 2);
+        }
+    }
+}
+
+size_t readWavReader(WavReader *reader, int16_t *samples, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        size_t got = readFrames(reader, count - done);
+        if (got == 0) {
+            break;
+        }
+        convertFrames(reader, reader->buffer, got, samples + done);
+        done += got;
+    }
+    return done;
+}
+
+bool getWavReaderPcmFormat(const WavReader *reader, PcmFormat *format) {
+    if (reader->bits_per_sample == 8) {
+        *format = PCM_U8;
+        return true;
+    }
+    if (reader->bits_per_sample == 16) {
+        *format = PCM_S16;
+        return true;
+    }
+    return false;
+}
+
+size_t readWavReaderPcm(WavReader *reader, void *samples, size_t count) {
+    PcmFormat format;
+    if (!getWavReaderPcmFormat(reader, &format)) {
+        return 0;
+    }
+    size_t bytes = getPcmSampleSize(format);
+    size_t done = 0;
+    while (done < count) {
+        size_t got = readFrames(reader, count - done);
+        if (got == 0) {
+            break;
+        }
+        extractFrames(reader, reader->buffer, got, (uint8_t *)samples + done * bytes);
+        done += got;
+    }
+    return done;
+}
+
+void closeWavReader(WavReader *reader) {
+    if (reader->file && reader->close_file) {
+        fclose(reader->file);
+    }
+    free(reader->buffer);
+    memset(reader, 0, sizeof(*reader));
+}
+
+#define DECODE_READ_FRAMES (64 * 1024)
+
+// =============================================================================
+// Parallel Decoding
+// =============================================================================
+//
+// A long recording is many blocks with silence between them, and the
+// decoder starts over after every silence. So the file is mapped, a quick
+// pre-pass measures the level of every 10 ms, and the recording is cut in
+// the middle of each silence. Worker threads decode the pieces with
+// decoders of their own; the blocks are then joined in tape order into
+// one decoder, as if it had read the whole file. Cuts fall on level
+// windows of the serial decoder, so both see the same samples per window
+//
+// =============================================================================
+
+#define ENERGY_BLOCK_MS     10      // Pre-pass: level measured per 10 ms
+#define GAP_MIN_MS          100     // Silence that splits the recording
+#define LOUD_PERCENTILE     99      // The loud level: range of the 99th percentile block
+#define SILENCE_DIVISOR     8       // Silent: range under 1/8 of the loud level,
+#define MIN_SILENCE_RANGE   656     // and always under twice the minimum hysteresis
+#define PREPASS_JOBS        64      // Pre-pass work split per thread
+
+typedef struct {
+    const WavReader *reader;
+    const uint8_t *data;     // Mapped frames
+    uint64_t frames;
+    PcmFormat format;
+    bool native;             // Samples used as stored
+    TapeDecoderConfig config;
+
+    // Pre-pass: sample range of each energy block
+    size_t block_frames;
+    size_t block_count;
+    uint16_t *ranges;
+
+    // Pieces: piece i runs from cuts[i] to cuts[i + 1]
+    uint64_t *cuts;
+    size_t piece_count;
+    TapeDecoder **decoders;
+
+    // Work sharing
+    pthread_mutex_t lock;
+    bool prepass;            // Phase: pre-pass jobs, then pieces
+    size_t job_count;
+    size_t next_job;
+    bool failed;
+} ParallelDecode;
+
+// count frames (at most DECODE_READ_FRAMES) from first, in job->format:
+// mono files straight from the mapping, others through buffer
+static const void* loadFrames(const ParallelDecode *job, uint64_t first, size_t count, void *buffer) {
+    const WavReader *reader = job->reader;
+    const uint8_t *frames = job->data + first * reader->channels * (reader->bits_per_sample / 8);
+    if (job->native && reader->channels == 1) {
+        return frames;
+    }
+    if (job->native) {
+        extractFrames(reader, frames, count, buffer);
+    } else {
+        convertFrames(reader, frames, count, buffer);
+    }
+    return buffer;
+}
+
+static void measureBlocks(ParallelDecode *job, size_t first, size_t last, void *buffer) {
+    CrossingKernel kernel = getBestCrossingKernel();
+    for (size_t block = first; block < last; block++) {
+        uint64_t start = (uint64_t)block * job->block_frames;
+        size_t count = job->frames - start < job->block_frames ? (size_t)(job->frames - start)
+                                                                 : job->block_frames;
+        int32_t low, high;
+        measurePcmRange(kernel, loadFrames(job, start, count, buffer), job->format, count, &low, &high);
+        job->ranges[block] = (uint16_t)(high - low);
+    }
+}
+
+static TapeDecoder* decodePiece(ParallelDecode *job, size_t piece, void *buffer) {
+    TapeDecoder *decoder = createTapeDecoder(&job->config);
+    if (!decoder) {
+        return NULL;
+    }
+    for (uint64_t frame = job->cuts[piece]; frame < job->cuts[piece + 1]; ) {
+        uint64_t left = job->cuts[piece + 1] - frame;
+        size_t count = left < DECODE_READ_FRAMES ? (size_t)left : DECODE_READ_FRAMES;
+        if (!feedTapeDecoderPcm(decoder, loadFrames(job, frame, count, buffer), job->format, count)) {
+            break;  // Out of memory (there is no callback to stop it)
+        }
+        frame += count;
+    }
+    if (!finishTapeDecoder(decoder)) {
+        freeTapeDecoder(decoder);
+        return NULL;
+    }
+    return decoder;
+}
+
+static void* parallelWorker(void *arg) {
+    ParallelDecode *job = arg;
+    void *buffer = malloc(DECODE_READ_FRAMES * sizeof(int16_t));
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        size_t index = job->next_job++;
+        bool stop = !buffer || job->failed || index >= job->job_count;
+        if (!buffer) {
+            job->failed = true;
+        }
+        pthread_mutex_unlock(&job->lock);
+        if (stop) {
+            break;
+        }
+
+        if (job->prepass) {
+            size_t per_job = (job->block_count + job->job_count - 1) / job->job_count;
+            size_t first = index * per_job;
+            size_t last = first + per_job < job->block_count ? first + per_job : job->block_count;
+            measureBlocks(job, first, last, buffer);
+        } else {
+            job->decoders[index] = decodePiece(job, index, buffer);
+            if (!job->decoders[index]) {
+                pthread_mutex_lock(&job->lock);
+                job->failed = true;
+                pthread_mutex_unlock(&job->lock);
+            }
+        }
+    }
+    free(buffer);
+    return NULL;
+}
+
+// Run job_count jobs of the current phase on up to threads workers
+static bool runParallelJobs(ParallelDecode *job, size_t job_count, uint16_t threads) {
+    job->job_count = job_count;
+    job->next_job = 0;
+    size_t thread_count = threads < job_count ? threads : job_count;
+    pthread_t *workers = calloc(thread_count, sizeof(pthread_t));
+    size_t started = 0;
+    while (workers && started < thread_count &&
+           pthread_create(&workers[started], NULL, parallelWorker, job) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        parallelWorker(job);  // No threads: work on this one
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    return !job->failed;
+}
+
+// Cut in the middle of every silence of GAP_MIN_MS or more, on a window
+// boundary. Returns false when out of memory
+static bool findCuts(ParallelDecode *job) {
+    // The loud level from a histogram of the block ranges
+    size_t *histogram = calloc(65536, sizeof(size_t));
+    job->cuts = malloc((job->block_count / 2 + 2) * sizeof(uint64_t));
+    if (!histogram || !job->cuts) {
+        free(histogram);
+        return false;
+    }
+    for (size_t i = 0; i < job->block_count; i++) {
+        histogram[job->ranges[i]]++;
+    }
+    size_t below = 0, target = job->block_count * LOUD_PERCENTILE / 100;
+    uint32_t loud = 0;
+    while (loud < 65535 && below + histogram[loud] <= target) {
+        below += histogram[loud++];
+    }
+    free(histogram);
+    uint32_t threshold = loud / SILENCE_DIVISOR;
+    threshold = threshold > MIN_SILENCE_RANGE ? threshold : MIN_SILENCE_RANGE;
+
+    size_t gap_blocks = GAP_MIN_MS / ENERGY_BLOCK_MS;
+    job->piece_count = 0;
+    job->cuts[0] = 0;
+    size_t run = 0;
+    for (size_t i = 0; i <= job->block_count; i++) {
+        if (i < job->block_count && job->ranges[i] < threshold) {
+            run++;
+            continue;
+        }
+        // A silence ended (or the file did); not at the very start or end
+        if (run >= gap_blocks && run < i && i < job->block_count) {
+            uint64_t middle = (uint64_t)(i - run / 2) * job->block_frames;
+            middle -= middle % CROSSING_WINDOW;
+            if (middle > job->cuts[job->piece_count]) {
+                job->cuts[++job->piece_count] = middle;
+            }
+        }
+        run = 0;
+    }
+    job->cuts[++job->piece_count] = job->frames;
+    return true;
+}
+
+// Append a block decoded by another decoder, as if decoded here
+static void adoptBlock(TapeDecoder *decoder, const TapeBlock *block, const uint8_t *data,
+                       uint64_t offset) {
+    size_t padding = (8 - decoder->image_size % 8) % 8;
+    if (!reserveImage(decoder, padding + sizeof(CAS_HEADER) + block->size)) {
+        return;
+    }
+    memset(decoder->image + decoder->image_size, 0x00, padding);
+    decoder->image_size += padding;
+
+    decoder->block = *block;
+    decoder->block.image_offset = decoder->image_size;
+    decoder->block.leader_start += offset;
+    decoder->block.data_start += offset;
+    decoder->block.end += offset;
+    memcpy(decoder->image + decoder->image_size, CAS_HEADER, sizeof(CAS_HEADER));
+    memcpy(decoder->image + decoder->image_size + sizeof(CAS_HEADER), data, block->size);
+    decoder->image_size += sizeof(CAS_HEADER) + block->size;
+    pushBlock(decoder);
+}
+
+// Decode a mapped regular file on threads workers. Returns NULL with
+// *fallback set when the file cannot be mapped (decode it serially)
+static TapeDecoder* decodeMappedWav(const char *filename, WavReader *reader,
+                                    const TapeDecoderConfig *config, bool *fallback) {
+    *fallback = true;
+    struct stat st;
+    int fd = fileno(reader->file);
+    if (reader->file == stdin || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        (uint64_t)st.st_size <= reader->data_offset) {
+        return NULL;
+    }
+    size_t frame_size = (size_t)reader->channels * (reader->bits_per_sample / 8);
+    uint64_t frames = ((uint64_t)st.st_size - reader->data_offset) / frame_size;
+    frames = frames < reader->frames ? frames : reader->frames;
+    void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    *fallback = false;
+
+    ParallelDecode job = {
+        .reader = reader,
+        .data = (const uint8_t *)mapping + reader->data_offset,
+        .frames = frames,
+        .config = *config,
+        .block_frames = reader->sample_rate * ENERGY_BLOCK_MS / 1000
+    };
+    job.native = getWavReaderPcmFormat(reader, &job.format);
+    if (!job.native) {
+        job.format = PCM_S16;
+    }
+    job.config.block_end = NULL;  // Blocks are reported as they are joined
+    job.block_count = (size_t)((frames + job.block_frames - 1) / job.block_frames);
+    job.ranges = malloc((job.block_count + 1) * sizeof(uint16_t));
+    pthread_mutex_init(&job.lock, NULL);
+    madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    TapeDecoder *decoder = createTapeDecoder(config);
+    bool ok = decoder && job.ranges;
+    if (ok) {
+        job.prepass = true;
+        ok = runParallelJobs(&job, (size_t)config->threads * PREPASS_JOBS, config->threads);
+    }
+    ok = ok && findCuts(&job);
+    if (ok) {
+        job.decoders = calloc(job.piece_count, sizeof(TapeDecoder *));
+        job.prepass = false;
+        ok = job.decoders && runParallelJobs(&job, job.piece_count, config->threads);
+    }
+    if (!ok && decoder) {
+        fprintf(stderr, "Error: Parallel decoding of %s failed\n", filename);
+    }
+
+    // Join the pieces in tape order
+    for (size_t piece = 0; ok && piece < job.piece_count && !decoder->stopped; piece++) {
+        size_t count;
+        const TapeBlock *blocks = getTapeDecoderBlocks(job.decoders[piece], &count);
+        const uint8_t *image = job.decoders[piece]->image;
+        for (size_t i = 0; i < count && !decoder->stopped; i++) {
+            adoptBlock(decoder, &blocks[i], image + blocks[i].image_offset + sizeof(CAS_HEADER),
+                       job.cuts[piece]);
+        }
+    }
+    if (ok) {
+        decoder->detector.position = frames;
+    }
+
+    for (size_t piece = 0; job.decoders && piece < job.piece_count; piece++) {
+        freeTapeDecoder(job.decoders[piece]);
+    }
+    free(job.decoders);
+    free(job.cuts);
+    free(job.ranges);
+    pthread_mutex_destroy(&job.lock);
+    munmap(mapping, (size_t)st.st_size);
+    if (!ok) {
+        freeTapeDecoder(decoder);
+        return NULL;
+    }
+    return decoder;
+}
+
+TapeDecoder* decodeWavFile(const char *filename, uint16_t channel, const TapeDecoderConfig *config) {
+    WavReader reader;
+    if (!openWavReader(filename, channel, &reader)) {
+        return NULL;
+    }
+
+    TapeDecoderConfig settings = *config;
+    settings.sample_rate = reader.sample_rate;
+    // Rates the decoder rejects go the serial way to be reported (below
+    // 100 Hz the energy pre-pass would have no samples per block)
+    if (settings.threads > 1 && settings.sample_rate >= MIN_SAMPLE_RATE) {
+        bool fallback;
+        TapeDecoder *decoder = decodeMappedWav(filename, &reader, &settings, &fallback);
+        if (!fallback) {
+            closeWavReader(&reader);
+            return decoder;
+        }
+    }
+    TapeDecoder *decoder = createTapeDecoder(&settings);
+    // 8 and 16-bit files go to the decoder as stored
+    PcmFormat format;
+    bool native = getWavReaderPcmFormat(&reader, &format);
+    if (!native) {
+        format = PCM_S16;
+    }
+    void *samples = malloc(DECODE_READ_FRAMES * getPcmSampleSize(format));
+    if (!decoder || !samples) {
+        if (decoder && !samples) {
+            fprintf(stderr, "Error: Failed to allocate sample buffer\n");
+        }
+        free(samples);
+        freeTapeDecoder(decoder);
+        closeWavReader(&reader);
+        return NULL;
+    }
+
+    bool ok = true;
+    size_t count;
+    while (ok && (count = native ? readWavReaderPcm(&reader, samples, DECODE_READ_FRAMES)
+                                 : readWavReader(&reader, samples, DECODE_READ_FRAMES)) > 0) {
+        ok = feedTapeDecoderPcm(decoder, samples, format, count);
+    }
+    if (ok && ferror(reader.file)) {
+        fprintf(stderr, "Error: Failed to read %s\n", filename);
+        ok = false;
+    }
+    ok = ok && finishTapeDecoder(decoder);
+
+    free(samples);
+    closeWavReader(&reader);
+    if (!ok) {
+        freeTapeDecoder(decoder);
+        return NULL;
+    }
+    return decoder;
+}
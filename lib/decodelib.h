@@ -0,0 +1,145 @@
+#ifndef DECODELIB_H
+#define DECODELIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "caslib.h"
+#include "crossinglib.h"
+
+// =============================================================================
+// WAV to CAS Decoding
+// =============================================================================
+//
+// DECODING STRATEGY (WAV → CAS), the reverse of wavlib's encoder:
+//
+// 1. Find zero crossings (crossinglib): the signal is compared against a
+//    center and a hysteresis band tracked per window of samples, so DC
+//    offset, level changes and noise below the band produce no crossings.
+//    Crossings are interpolated between samples; the distance between two
+//    is a half-cycle
+//
+// 2. Lock onto a leader: a run of half-cycles whose consecutive pairs (full
+//    cycles) all have about the same length. The run sets the SHORT
+//    half-cycle length w (a 1-bit half-cycle); a LONG one is 2w. The baud
+//    rate follows from w, so 1200, 2400 and faster tapes need no setting
+//
+// 3. Deframe bytes: a LONG half-cycle after the leader or the stop bits
+//    opens a START bit; then 8 data bits, LSB first, are read as full
+//    cycles (one LONG cycle = 0, two SHORT cycles = 1). Stop bits are the
+//    SHORT half-cycles skipped before the next START bit. w follows every
+//    cycle, so tape speed drift is tracked
+//
+// 4. A block ends at silence (no crossing for 10 LONG half-cycles), at a
+//    new leader or at a framing error. Each block becomes a CAS header
+//    plus its bytes, the header 8-byte aligned as in a real CAS file
+//    (docs/CASFILE.md section 4.2)
+//
+// =============================================================================
+
+// One decoded block. Sample positions count from the first sample fed
+typedef struct {
+    size_t image_offset;     // Offset of the block's CAS header in the image
+    size_t size;             // Data bytes decoded
+    uint64_t leader_start;   // Sample where the leader was recognized
+    uint64_t data_start;     // Sample of the first START bit
+    uint64_t end;            // Sample after the last byte
+    uint32_t baud_rate;      // Measured from the leader (e.g. 1200, 2400)
+    bool error;              // Cut short by a framing error
+} TapeBlock;
+
+typedef struct {
+    uint32_t sample_rate;
+    // Called as each block ends, data holding its size bytes (only valid
+    // during the call). May be NULL; returning false stops decoding
+    bool (*block_end)(void *context, const TapeBlock *block, const uint8_t *data);
+    void *context;
+    // decodeWavFile(): worker threads decoding a WAV file split at its
+    // silences (0 or 1: one pass as the file is read). Blocks are still
+    // reported in tape order, once all are decoded
+    uint16_t threads;
+} TapeDecoderConfig;
+
+typedef struct TapeDecoder TapeDecoder;
+
+// Create a decoder for mono 16-bit samples at config->sample_rate.
+// Returns NULL on error
+TapeDecoder* createTapeDecoder(const TapeDecoderConfig *config);
+
+// Decode the next count samples. Memory does not grow with the audio, only
+// with the bytes decoded. Returns false when a callback stopped decoding
+// or memory ran out
+bool feedTapeDecoder(TapeDecoder *decoder, const int16_t *samples, size_t count);
+
+// Same for samples in another PCM format (8-bit unsigned as stored in WAV
+// files, without converting them first)
+bool feedTapeDecoderPcm(TapeDecoder *decoder, const void *samples, PcmFormat format, size_t count);
+
+// End of audio: completes the block being decoded
+bool finishTapeDecoder(TapeDecoder *decoder);
+
+// The CAS image decoded so far (valid until the next feed or free)
+const uint8_t* getTapeDecoderImage(const TapeDecoder *decoder, size_t *size);
+
+// The blocks decoded so far, in tape order
+const TapeBlock* getTapeDecoderBlocks(const TapeDecoder *decoder, size_t *count);
+
+// Samples fed so far
+uint64_t getTapeDecoderPosition(const TapeDecoder *decoder);
+
+// Sample rate the decoder runs at (the WAV's, after decodeWavFile)
+uint32_t getTapeDecoderSampleRate(const TapeDecoder *decoder);
+
+// Parse the decoded image into container (see parseCasContainer)
+bool buildTapeDecoderContainer(const TapeDecoder *decoder, cas_Container *container);
+
+void freeTapeDecoder(TapeDecoder *decoder);
+
+// =============================================================================
+// WAV Reader
+// =============================================================================
+
+// Streaming reader for PCM WAV files: 8, 16, 24 or 32-bit integer and
+// 32-bit float samples, any channel count, plain or WAVE_FORMAT_EXTENSIBLE.
+// One channel is read, converted to 16-bit signed
+typedef struct {
+    FILE *file;
+    uint32_t sample_rate;
+    uint16_t channels;
+    uint16_t bits_per_sample;
+    bool is_float;
+    uint16_t channel;        // Channel being read
+    uint64_t frames;         // Frames in the data chunk (UINT64_MAX: until end of file)
+    uint64_t frames_read;
+    uint64_t data_offset;    // File offset of the first frame
+    uint8_t *buffer;         // Raw frames read at a time
+    size_t buffer_frames;
+    bool close_file;         // File was opened by the reader
+} WavReader;
+
+// Open filename ("-" reads stdin) and read its header; channel selects the
+// channel to decode (0 = left). Returns false (after printing an error) if
+// the file is not a WAV this reader supports
+bool openWavReader(const char *filename, uint16_t channel, WavReader *reader);
+
+// Read up to count frames of the selected channel into samples. Returns
+// the number of frames read: 0 at the end of the data
+size_t readWavReader(WavReader *reader, int16_t *samples, size_t count);
+
+// 8 and 16-bit WAVs can also be read without converting the samples:
+// true, with the format readWavReaderPcm() delivers, for those
+bool getWavReaderPcmFormat(const WavReader *reader, PcmFormat *format);
+
+// Read up to count frames of the selected channel as stored (mono files
+// straight into samples). Returns the number of frames read
+size_t readWavReaderPcm(WavReader *reader, void *samples, size_t count);
+
+void closeWavReader(WavReader *reader);
+
+// Decode a whole WAV file. Returns the finished decoder (free it with
+// freeTapeDecoder), or NULL after printing an error. config->sample_rate
+// is taken from the file
+TapeDecoder* decodeWavFile(const char *filename, uint16_t channel, const TapeDecoderConfig *config);
+
+#endif // DECODELIB_H
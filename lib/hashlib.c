@@ -0,0 +1,408 @@
+#include "hashlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define CRC32C_X86 1
+#define CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC32C_ARM 1
+#define CRC32C_TARGET
+#endif
+
+// =============================================================================
+// CRC32C - Hardware and Table Implementations
+// =============================================================================
+
+#define CRC32C_POLY 0x82F63B78u   // Castagnoli polynomial, bit-reversed
+
+// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zeros
+static uint32_t crc_tables[8][256];
+static pthread_once_t crc_tables_once = PTHREAD_ONCE_INIT;
+
+static void buildCrcTables(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+        }
+        crc_tables[0][i] = crc;
+    }
+    for (int k = 1; k < 8; k++) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t prev = crc_tables[k - 1][i];
+            crc_tables[k][i] = (prev >> 8) ^ crc_tables[0][prev & 0xFF];
+        }
+    }
+}
+
+// 8 bytes as a little-endian word, the order the CRC32 instruction takes them
+static inline uint64_t loadLittleEndian64(const uint8_t *p) {
+    uint64_t word = 0;
+    for (int i = 7; i >= 0; i--) {
+        word = (word << 8) | p[i];
+    }
+    return word;
+}
+
+// One word through the tables: what the CRC32 instruction does in hardware
+static inline uint32_t crcTableWord(uint32_t crc, uint64_t word) {
+    uint32_t low = crc ^ (uint32_t)word;
+    uint32_t high = (uint32_t)(word >> 32);
+    return crc_tables[7][low & 0xFF] ^ crc_tables[6][(low >> 8) & 0xFF] ^
+           crc_tables[5][(low >> 16) & 0xFF] ^ crc_tables[4][low >> 24] ^
+           crc_tables[3][high & 0xFF] ^ crc_tables[2][(high >> 8) & 0xFF] ^
+           crc_tables[1][(high >> 16) & 0xFF] ^ crc_tables[0][high >> 24];
+}
+
+static uint32_t crcTableUpdate(uint32_t crc, const uint8_t *p, size_t size) {
+    pthread_once(&crc_tables_once, buildCrcTables);
+    for (; size >= 8; p += 8, size -= 8) {
+        crc = crcTableWord(crc, loadLittleEndian64(p));
+    }
+    for (; size > 0; p++, size--) {
+        crc = (crc >> 8) ^ crc_tables[0][(crc ^ *p) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+CRC32C_TARGET
+static inline uint32_t crcHardwareWord(uint32_t crc, uint64_t word) {
+#ifdef CRC32C_X86
+    return (uint32_t)_mm_crc32_u64(crc, word);
+#else
+    return __crc32cd(crc, word);
+#endif
+}
+
+CRC32C_TARGET
+static uint32_t crcHardwareUpdate(uint32_t crc, const uint8_t *p, size_t size) {
+    for (; size >= 8; p += 8, size -= 8) {
+        crc = crcHardwareWord(crc, loadLittleEndian64(p));
+    }
+    for (; size > 0; p++, size--) {
+#ifdef CRC32C_X86
+        crc = _mm_crc32_u8(crc, *p);
+#else
+        crc = __crc32cb(crc, *p);
+#endif
+    }
+    return crc;
+}
+#endif
+
+bool hasHardwareCrc32c(void) {
+#if defined(CRC32C_X86)
+    return __builtin_cpu_supports("sse4.2");
+#elif defined(CRC32C_ARM)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t crc32cPortable(uint32_t crc, const void *data, size_t size) {
+    return ~crcTableUpdate(~crc, data, size);
+}
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t size) {
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+    if (hasHardwareCrc32c()) {
+        return ~crcHardwareUpdate(~crc, data, size);
+    }
+#endif
+    return crc32cPortable(crc, data, size);
+}
+
+// =============================================================================
+// 64-bit Content Hash
+// =============================================================================
+
+// The lanes are independent dependency chains, so the CPU overlaps their
+// CRC32 instructions and two lanes cost little more than one
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+CRC32C_TARGET
+static void hashWordsHardware(uint32_t lanes[2], const uint8_t *p, size_t words) {
+    uint32_t a = lanes[0];
+    uint32_t b = lanes[1];
+    for (size_t i = 0; i < words; i++, p += 8) {
+        uint64_t word = loadLittleEndian64(p);
+        a = crcHardwareWord(a, word);
+        b = crcHardwareWord(b, word ^ (word >> 32));
+    }
+    lanes[0] = a;
+    lanes[1] = b;
+}
+#endif
+
+static void hashWordsTable(uint32_t lanes[2], const uint8_t *p, size_t words) {
+    pthread_once(&crc_tables_once, buildCrcTables);
+    uint32_t a = lanes[0];
+    uint32_t b = lanes[1];
+    for (size_t i = 0; i < words; i++, p += 8) {
+        uint64_t word = loadLittleEndian64(p);
+        a = crcTableWord(a, word);
+        b = crcTableWord(b, word ^ (word >> 32));
+    }
+    lanes[0] = a;
+    lanes[1] = b;
+}
+
+static void hashWords(cas_Hash *hash, const uint8_t *p, size_t words) {
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+    if (hash->hardware) {
+        hashWordsHardware(hash->lanes, p, words);
+        return;
+    }
+#endif
+    hashWordsTable(hash->lanes, p, words);
+}
+
+void initCasHash(cas_Hash *hash, uint32_t seed) {
+    memset(hash, 0, sizeof(*hash));
+    hash->lanes[0] = ~seed;
+    hash->lanes[1] = ~seed;
+    hash->hardware = hasHardwareCrc32c();
+}
+
+void updateCasHash(cas_Hash *hash, const void *data, size_t size) {
+    const uint8_t *p = data;
+    if (size == 0) {
+        return;
+    }
+    hash->length += size;
+
+    if (hash->tail_length > 0) {
+        size_t take = sizeof(hash->tail) - hash->tail_length;
+        if (take > size) {
+            take = size;
+        }
+        memcpy(hash->tail + hash->tail_length, p, take);
+        hash->tail_length += take;
+        p += take;
+        size -= take;
+        if (hash->tail_length < sizeof(hash->tail)) {
+            return;
+        }
+        hashWords(hash, hash->tail, 1);
+        hash->tail_length = 0;
+    }
+
+    hashWords(hash, p, size / 8);
+    hash->tail_length = size % 8;
+    memcpy(hash->tail, p + size - hash->tail_length, hash->tail_length);
+}
+
+uint64_t finishCasHash(const cas_Hash *hash) {
+    // The last word is zero-filled; mixing in the length keeps "AB" and
+    // "AB\0" apart
+    cas_Hash last = *hash;
+    if (last.tail_length > 0) {
+        memset(last.tail + last.tail_length, 0, sizeof(last.tail) - last.tail_length);
+        hashWords(&last, last.tail, 1);
+    }
+    uint64_t h = ((uint64_t)~last.lanes[0] << 32) | (uint32_t)~last.lanes[1];
+    h ^= last.length * 0x9E3779B97F4A7C15ull;
+
+    // Final mix (one-to-one): spreads every input bit over the low bits a
+    // hash table indexes with
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// =============================================================================
+// CAS Payload Hashes
+// =============================================================================
+
+// Seeds keep equal bytes in different roles apart
+#define SEED_CUSTOM     0x43555354u  // "CUST"
+#define SEED_BINARY     0x42494E41u  // "BINA"
+#define SEED_BASIC      0x42415349u  // "BASI"
+#define SEED_ASCII      0x41534349u  // "ASCI"
+#define SEED_BLOCK      0x424C4F4Bu  // "BLOK"
+#define SEED_CONTAINER  0x54415045u  // "TAPE"
+
+static uint32_t fileSeed(const cas_File *file) {
+    if (file->is_custom) {
+        return SEED_CUSTOM;
+    }
+    if (isBinaryFile(file->file_header.file_type)) {
+        return SEED_BINARY;
+    }
+    return isAsciiFile(file->file_header.file_type) ? SEED_ASCII : SEED_BASIC;
+}
+
+size_t getCasBlockPayloadSize(const cas_File *file, size_t block_index) {
+    const cas_DataBlock *block = &file->data_blocks[block_index];
+    size_t size = block->data ? block->data_size : 0;
+    if (size == 0) {
+        return 0;
+    }
+
+    if (!file->is_custom && isAsciiFile(file->file_header.file_type)) {
+        const uint8_t *eof = memchr(block->data, EOF_MARKER, size);
+        return eof ? (size_t)(eof - block->data) : size;
+    }
+
+    const cas_DataBlockHeader *addresses = &file->data_block_header;
+    if (!file->is_custom && isBinaryFile(file->file_header.file_type) &&
+        addresses->end_address >= addresses->load_address) {
+        size_t remaining = (size_t)(addresses->end_address - addresses->load_address) + 1;
+        for (size_t i = 0; i < block_index && remaining > 0; i++) {
+            size_t used = file->data_blocks[i].data_size;
+            remaining -= (used < remaining) ? used : remaining;
+        }
+        return (size < remaining) ? size : remaining;
+    }
+
+    // BASIC, custom, and BINARY files whose addresses give no length
+    while (size > 0 && block->data[size - 1] == 0x00) {
+        size--;
+    }
+    return size;
+}
+
+cas_ContentHash hashCasFile(const cas_File *file, cas_ContentHash *blocks) {
+    cas_Hash hash;
+    initCasHash(&hash, fileSeed(file));
+    cas_ContentHash result = {0};
+
+    if (!file->is_custom && isBinaryFile(file->file_header.file_type)) {
+        const cas_DataBlockHeader *addresses = &file->data_block_header;
+        uint8_t header[6] = {
+            addresses->load_address & 0xFF, addresses->load_address >> 8,
+            addresses->end_address & 0xFF, addresses->end_address >> 8,
+            addresses->exec_address & 0xFF, addresses->exec_address >> 8
+        };
+        updateCasHash(&hash, header, sizeof(header));
+        result.size += sizeof(header);
+    }
+
+    for (size_t i = 0; i < file->data_block_count; i++) {
+        const cas_DataBlock *block = &file->data_blocks[i];
+        size_t size = getCasBlockPayloadSize(file, i);
+        updateCasHash(&hash, block->data, size);
+        result.size += size;
+        if (blocks) {
+            cas_Hash block_hash;
+            initCasHash(&block_hash, SEED_BLOCK);
+            updateCasHash(&block_hash, block->data, size);
+            blocks[i].hash = finishCasHash(&block_hash);
+            blocks[i].size = size;
+        }
+    }
+
+    result.hash = finishCasHash(&hash);
+    return result;
+}
+
+uint64_t hashCasContainer(const cas_Container *container, const cas_ContentHash *files) {
+    cas_Hash hash;
+    initCasHash(&hash, SEED_CONTAINER);
+    for (size_t i = 0; i < container->file_count; i++) {
+        const cas_File *file = &container->files[i];
+        uint8_t record[8 + sizeof(cas_FileHeader)];
+        for (int b = 0; b < 8; b++) {
+            record[b] = (uint8_t)(files[i].hash >> (8 * b));
+        }
+        size_t length = 8;
+        if (!file->is_custom) {
+            memcpy(record + 8, &file->file_header, sizeof(cas_FileHeader));
+            length += sizeof(cas_FileHeader);
+        }
+        updateCasHash(&hash, record, length);
+    }
+    return finishCasHash(&hash);
+}
+
+// =============================================================================
+// Hash Index
+// =============================================================================
+
+static bool allocHashSlots(cas_HashIndex *index, size_t capacity) {
+    index->keys = malloc(capacity * sizeof(uint64_t));
+    index->values = malloc(capacity * sizeof(uint32_t));
+    if (!index->keys || !index->values) {
+        free(index->keys);
+        free(index->values);
+        index->keys = NULL;
+        index->values = NULL;
+        return false;
+    }
+    memset(index->values, 0xFF, capacity * sizeof(uint32_t));  // CAS_HASH_INDEX_NONE
+    index->capacity = capacity;
+    return true;
+}
+
+// Slot holding key, or the free slot where it belongs. Content hashes are
+// already mixed, so their low bits pick the slot directly
+static size_t probeHashIndex(const cas_HashIndex *index, uint64_t key) {
+    size_t mask = index->capacity - 1;
+    size_t slot = (size_t)key & mask;
+    while (index->values[slot] != CAS_HASH_INDEX_NONE && index->keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+bool initCasHashIndex(cas_HashIndex *index, size_t expected) {
+    memset(index, 0, sizeof(*index));
+    size_t capacity = 64;
+    while (capacity < expected * 2) {
+        capacity *= 2;
+    }
+    return allocHashSlots(index, capacity);
+}
+
+static bool growHashIndex(cas_HashIndex *index) {
+    cas_HashIndex grown = {0};
+    if (!allocHashSlots(&grown, index->capacity * 2)) {
+        return false;
+    }
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->values[i] != CAS_HASH_INDEX_NONE) {
+            size_t slot = probeHashIndex(&grown, index->keys[i]);
+            grown.keys[slot] = index->keys[i];
+            grown.values[slot] = index->values[i];
+        }
+    }
+    grown.count = index->count;
+    freeCasHashIndex(index);
+    *index = grown;
+    return true;
+}
+
+uint32_t insertCasHashIndex(cas_HashIndex *index, uint64_t key, uint32_t value) {
+    if ((index->count + 1) * 2 > index->capacity && !growHashIndex(index)) {
+        return CAS_HASH_INDEX_NONE;
+    }
+    size_t slot = probeHashIndex(index, key);
+    if (index->values[slot] == CAS_HASH_INDEX_NONE) {
+        index->keys[slot] = key;
+        index->values[slot] = value;
+        index->count++;
+    }
+    return index->values[slot];
+}
+
+uint32_t findCasHashIndex(const cas_HashIndex *index, uint64_t key) {
+    if (index->capacity == 0) {
+        return CAS_HASH_INDEX_NONE;
+    }
+    return index->values[probeHashIndex(index, key)];
+}
+
+void freeCasHashIndex(cas_HashIndex *index) {
+    free(index->keys);
+    free(index->values);
+    memset(index, 0, sizeof(*index));
+}
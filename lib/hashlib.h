@@ -0,0 +1,110 @@
+#ifndef HASHLIB_H
+#define HASHLIB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "caslib.h"
+
+// =============================================================================
+// CRC32C (Castagnoli)
+// =============================================================================
+
+// CRC32C of size bytes, continuing from crc (0 to start). Runs on the CPU's
+// CRC32 instruction (x86-64 SSE4.2, ARMv8 CRC) when there is one
+uint32_t crc32c(uint32_t crc, const void *data, size_t size);
+
+// Same result from lookup tables only
+uint32_t crc32cPortable(uint32_t crc, const void *data, size_t size);
+
+// True when crc32c() and the content hash use the CPU's CRC32 instruction
+bool hasHardwareCrc32c(void);
+
+// =============================================================================
+// 64-bit Content Hash
+// =============================================================================
+
+// Two CRC32C lanes over the same 8-byte words: one takes each word as is,
+// the other the word folded with its upper half (w ^ w >> 32). Together
+// they map every word one-to-one, so two payloads of the same length that
+// differ within a single word never share a hash; unrelated payloads do so
+// with a chance of about 2^-64. Not a cryptographic hash: collisions can be
+// made on purpose. The result does not depend on how the bytes are split
+// across update calls
+typedef struct {
+    uint32_t lanes[2];
+    uint8_t tail[8];         // Bytes of an incomplete word
+    size_t tail_length;
+    uint64_t length;         // Bytes hashed so far
+    bool hardware;           // Set by initCasHash; clear it to force the
+                             // table code (same results)
+} cas_Hash;
+
+// Start a hash; payloads hashed with different seeds never compare equal
+void initCasHash(cas_Hash *hash, uint32_t seed);
+
+void updateCasHash(cas_Hash *hash, const void *data, size_t size);
+
+uint64_t finishCasHash(const cas_Hash *hash);
+
+// =============================================================================
+// CAS Payload Hashes
+// =============================================================================
+
+// The hashes skip what does not belong to the content: CAS headers, the
+// file header (type and name) and the zero padding that aligns the next
+// CAS header. By file type, a block's payload is:
+// - BINARY: the program bytes, end - load + 1 of them
+// - ASCII:  the text before the EOF marker
+// - BASIC and custom blocks: the bytes without trailing zeros (a tokenized
+//   program ends in zeros anyway; custom blocks carry no length)
+typedef struct {
+    uint64_t hash;
+    size_t size;             // Payload bytes hashed
+} cas_ContentHash;
+
+// Payload bytes of one data block of file
+size_t getCasBlockPayloadSize(const cas_File *file, size_t block_index);
+
+// Hash a file's content: its type, the address header of BINARY files
+// (a program loaded elsewhere is a different program) and its blocks'
+// payloads; the name is left out. When blocks is not NULL it receives
+// data_block_count block hashes, computed in the same pass. Blocks hash
+// only their payload, whatever file they belong to
+cas_ContentHash hashCasFile(const cas_File *file, cas_ContentHash *blocks);
+
+// Hash a whole tape from its file hashes (file_count of them, in order)
+// and file headers: equal for containers holding the same files under the
+// same names in the same order
+uint64_t hashCasContainer(const cas_Container *container, const cas_ContentHash *files);
+
+// =============================================================================
+// Hash Index
+// =============================================================================
+
+// Open-addressing table from 64-bit content hashes to caller values:
+// 12 bytes per slot, kept at most half full
+#define CAS_HASH_INDEX_NONE UINT32_MAX
+
+typedef struct {
+    uint64_t *keys;
+    uint32_t *values;        // CAS_HASH_INDEX_NONE marks a free slot
+    size_t capacity;         // Power of two
+    size_t count;
+} cas_HashIndex;
+
+// Reserve room for about expected keys. Returns false on allocation failure
+bool initCasHashIndex(cas_HashIndex *index, size_t expected);
+
+// Store value under key unless the key is already present. Returns the
+// value stored under key (value itself when it is new), or
+// CAS_HASH_INDEX_NONE when the table cannot grow. value must not be
+// CAS_HASH_INDEX_NONE
+uint32_t insertCasHashIndex(cas_HashIndex *index, uint64_t key, uint32_t value);
+
+// Look up key. Returns CAS_HASH_INDEX_NONE when it is not present
+uint32_t findCasHashIndex(const cas_HashIndex *index, uint64_t key);
+
+void freeCasHashIndex(cas_HashIndex *index);
+
+#endif // HASHLIB_H
@@ -0,0 +1,509 @@
+#include "indexlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// =============================================================================
+// Index File Layout (all values little-endian)
+// =============================================================================
+//
+//   Header (48 bytes):  magic "CASINDEX", version, file count, block count,
+//                       reserved, CAS file size, mtime seconds, nanoseconds
+//   Files (56 each):    header offset, end offset, data size, first block,
+//                       block count, custom flag, file type + name (16),
+//                       load/end/exec addresses, one pad byte
+//   Blocks (16 each):   data offset, data size
+//
+// CAS headers are not stored: every header the parser accepts is CAS_HEADER
+
+#define INDEX_MAGIC        "CASINDEX"
+#define INDEX_VERSION      1
+#define INDEX_HEADER_SIZE  48
+#define INDEX_FILE_SIZE    56
+#define INDEX_BLOCK_SIZE   16
+
+static void putLE16(uint8_t *p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+}
+
+static void putLE32(uint8_t *p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static void putLE64(uint8_t *p, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint16_t getLE16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t getLE32(const uint8_t *p) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static uint64_t getLE64(const uint8_t *p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+char* casIndexPath(const char *cas_filename) {
+    size_t length = strlen(cas_filename) + strlen(CAS_INDEX_SUFFIX) + 1;
+    char *path = malloc(length);
+    if (path) {
+        snprintf(path, length, "%s%s", cas_filename, CAS_INDEX_SUFFIX);
+    }
+    return path;
+}
+
+void freeCasIndex(cas_Index *index) {
+    if (index) {
+        free(index->entries);
+        free(index->blocks);
+        memset(index, 0, sizeof(*index));
+    }
+}
+
+// =============================================================================
+// Building
+// =============================================================================
+
+// Collects entries from stream parser events. Blocks of a file that fails
+// to parse are appended but not committed
+typedef struct {
+    cas_Index *index;
+    size_t entry_capacity;
+    size_t block_capacity;
+    size_t committed_blocks;
+    uint64_t header_offset;
+    uint64_t end_offset;
+    bool out_of_memory;
+} IndexBuilder;
+
+static bool indexFileStart(void *context, const cas_File *file, size_t offset) {
+    (void)file;
+    IndexBuilder *builder = context;
+    builder->header_offset = offset;
+    builder->end_offset = offset;
+    return true;
+}
+
+static bool indexBlockStart(void *context, const cas_File *file, const cas_Header *header, size_t offset) {
+    (void)file;
+    (void)header;
+    IndexBuilder *builder = context;
+    cas_Index *index = builder->index;
+
+    if (index->block_count == builder->block_capacity) {
+        size_t capacity = builder->block_capacity ? builder->block_capacity * 2 : 64;
+        cas_IndexBlock *blocks = realloc(index->blocks, capacity * sizeof(cas_IndexBlock));
+        if (!blocks) {
+            fprintf(stderr, "Error: Failed to allocate index blocks\n");
+            builder->out_of_memory = true;
+            return false;
+        }
+        index->blocks = blocks;
+        builder->block_capacity = capacity;
+    }
+
+    cas_IndexBlock *block = &index->blocks[index->block_count++];
+    block->data_offset = offset;
+    block->data_size = 0;
+    return true;
+}
+
+static bool indexBlockEnd(void *context, size_t size) {
+    IndexBuilder *builder = context;
+    cas_IndexBlock *block = &builder->index->blocks[builder->index->block_count - 1];
+    block->data_size = size;
+    builder->end_offset = block->data_offset + size;
+    return true;
+}
+
+static bool indexFileEnd(void *context, const cas_File *file) {
+    IndexBuilder *builder = context;
+    cas_Index *index = builder->index;
+
+    if (index->entry_count == builder->entry_capacity) {
+        size_t capacity = builder->entry_capacity ? builder->entry_capacity * 2 : 16;
+        cas_IndexEntry *entries = realloc(index->entries, capacity * sizeof(cas_IndexEntry));
+        if (!entries) {
+            fprintf(stderr, "Error: Failed to allocate index entries\n");
+            builder->out_of_memory = true;
+            return false;
+        }
+        index->entries = entries;
+        builder->entry_capacity = capacity;
+    }
+
+    cas_IndexEntry *entry = &index->entries[index->entry_count++];
+    entry->header_offset = builder->header_offset;
+    entry->end_offset = builder->end_offset;
+    entry->file = *file;
+    entry->file.data_blocks = NULL;
+    entry->file.data_block_count = index->block_count - builder->committed_blocks;
+    entry->first_block = builder->committed_blocks;
+    builder->committed_blocks = index->block_count;
+    return true;
+}
+
+bool buildCasIndex(const char *cas_filename, cas_Index *index) {
+    memset(index, 0, sizeof(*index));
+
+    struct stat st;
+    if (stat(cas_filename, &st) != 0) {
+        fprintf(stderr, "Error: Cannot open '%s': %s\n", cas_filename, strerror(errno));
+        return false;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        fprintf(stderr, "Error: Only regular files can be indexed ('%s')\n", cas_filename);
+        return false;
+    }
+
+    cas_Input input;
+    if (!openCasInput(cas_filename, &input)) {
+        return false;
+    }
+
+    static const cas_StreamCallbacks index_callbacks = {
+        .file_start = indexFileStart,
+        .block_start = indexBlockStart,
+        .block_end = indexBlockEnd,
+        .file_end = indexFileEnd
+    };
+    IndexBuilder builder = { .index = index };
+    cas_StreamParser *parser = createCasStreamParser(&index_callbacks, &builder);
+    if (!parser) {
+        closeCasInput(&input);
+        return false;
+    }
+
+    // Like the container parse, a malformed file ends the index but keeps
+    // the files before it; only allocation failures are errors
+    feedCasStreamParser(parser, input.data, input.size);
+    finishCasStreamParser(parser);
+    freeCasStreamParser(parser);
+    closeCasInput(&input);
+    if (builder.out_of_memory) {
+        freeCasIndex(index);
+        return false;
+    }
+
+    index->block_count = builder.committed_blocks;
+    index->source_size = (uint64_t)st.st_size;
+    index->source_mtime_sec = (int64_t)st.st_mtim.tv_sec;
+    index->source_mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    return true;
+}
+
+// =============================================================================
+// Saving and Loading
+// =============================================================================
+
+bool saveCasIndex(const char *cas_filename, const cas_Index *index) {
+    char *path = casIndexPath(cas_filename);
+    if (!path) {
+        fprintf(stderr, "Error: Failed to allocate index path\n");
+        return false;
+    }
+
+    size_t size = INDEX_HEADER_SIZE + index->entry_count * INDEX_FILE_SIZE +
+                  index->block_count * INDEX_BLOCK_SIZE;
+    uint8_t *buffer = calloc(1, size);
+    if (!buffer) {
+        fprintf(stderr, "Error: Failed to allocate %zu byte index\n", size);
+        free(path);
+        return false;
+    }
+
+    memcpy(buffer, INDEX_MAGIC, 8);
+    putLE32(buffer + 8, INDEX_VERSION);
+    putLE32(buffer + 12, (uint32_t)index->entry_count);
+    putLE32(buffer + 16, (uint32_t)index->block_count);
+    putLE64(buffer + 24, index->source_size);
+    putLE64(buffer + 32, (uint64_t)index->source_mtime_sec);
+    putLE64(buffer + 40, (uint64_t)index->source_mtime_nsec);
+
+    uint8_t *p = buffer + INDEX_HEADER_SIZE;
+    for (size_t i = 0; i < index->entry_count; i++, p += INDEX_FILE_SIZE) {
+        const cas_IndexEntry *entry = &index->entries[i];
+        putLE64(p, entry->header_offset);
+        putLE64(p + 8, entry->end_offset);
+        putLE64(p + 16, entry->file.data_size);
+        putLE32(p + 24, (uint32_t)entry->first_block);
+        putLE32(p + 28, (uint32_t)entry->file.data_block_count);
+        p[32] = entry->file.is_custom ? 1 : 0;
+        memcpy(p + 33, entry->file.file_header.file_type, 10);
+        memcpy(p + 43, entry->file.file_header.file_name, 6);
+        putLE16(p + 49, entry->file.data_block_header.load_address);
+        putLE16(p + 51, entry->file.data_block_header.end_address);
+        putLE16(p + 53, entry->file.data_block_header.exec_address);
+    }
+    for (size_t i = 0; i < index->block_count; i++, p += INDEX_BLOCK_SIZE) {
+        putLE64(p, index->blocks[i].data_offset);
+        putLE64(p + 8, index->blocks[i].data_size);
+    }
+
+    FILE *f = fopen(path, "wb");
+    bool ok = f && fwrite(buffer, 1, size, f) == size;
+    if (f && fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Cannot write index '%s': %s\n", path, strerror(errno));
+        remove(path);
+    }
+
+    free(buffer);
+    free(path);
+    return ok;
+}
+
+// Read exactly size bytes at offset
+static bool readAt(int fd, void *buffer, size_t size, uint64_t offset) {
+    uint8_t *dest = buffer;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t result = pread(fd, dest + done, size - done, (off_t)(offset + done));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        done += (size_t)result;
+    }
+    return true;
+}
+
+// An open index whose header matches the CAS file it sits next to
+typedef struct {
+    int fd;
+    size_t entry_count;
+    size_t block_count;
+    struct stat source;
+} IndexFile;
+
+// Open "<cas_filename>.idx" and check its header. Fails quietly when the
+// index is missing, damaged, from another version, or stale (the CAS
+// file's size or mtime changed since it was written)
+static bool openIndexFile(const char *cas_filename, IndexFile *file) {
+    if (stat(cas_filename, &file->source) != 0 || !S_ISREG(file->source.st_mode)) {
+        return false;
+    }
+
+    char *path = casIndexPath(cas_filename);
+    file->fd = path ? open(path, O_RDONLY) : -1;
+    free(path);
+    if (file->fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    uint8_t header[INDEX_HEADER_SIZE];
+    if (fstat(file->fd, &st) == 0 && readAt(file->fd, header, sizeof(header), 0)) {
+        file->entry_count = getLE32(header + 12);
+        file->block_count = getLE32(header + 16);
+        uint64_t expected = INDEX_HEADER_SIZE + (uint64_t)file->entry_count * INDEX_FILE_SIZE +
+                            (uint64_t)file->block_count * INDEX_BLOCK_SIZE;
+        if (memcmp(header, INDEX_MAGIC, 8) == 0 &&
+            getLE32(header + 8) == INDEX_VERSION &&
+            (uint64_t)st.st_size == expected &&
+            getLE64(header + 24) == (uint64_t)file->source.st_size &&
+            (int64_t)getLE64(header + 32) == (int64_t)file->source.st_mtim.tv_sec &&
+            (int64_t)getLE64(header + 40) == (int64_t)file->source.st_mtim.tv_nsec) {
+            return true;
+        }
+    }
+    close(file->fd);
+    return false;
+}
+
+static void decodeEntry(const uint8_t *p, cas_IndexEntry *entry) {
+    memset(entry, 0, sizeof(*entry));
+    entry->header_offset = getLE64(p);
+    entry->end_offset = getLE64(p + 8);
+    entry->file.data_size = getLE64(p + 16);
+    entry->first_block = getLE32(p + 24);
+    entry->file.data_block_count = getLE32(p + 28);
+    entry->file.is_custom = (p[32] != 0);
+    memcpy(entry->file.header.bytes, CAS_HEADER, sizeof(CAS_HEADER));
+    memcpy(entry->file.file_header.file_type, p + 33, 10);
+    memcpy(entry->file.file_header.file_name, p + 43, 6);
+    entry->file.data_block_header.load_address = getLE16(p + 49);
+    entry->file.data_block_header.end_address = getLE16(p + 51);
+    entry->file.data_block_header.exec_address = getLE16(p + 53);
+}
+
+static void decodeBlock(const uint8_t *p, cas_IndexBlock *block) {
+    block->data_offset = getLE64(p);
+    block->data_size = getLE64(p + 8);
+}
+
+// A damaged index is never trusted: the file's range must lie inside the
+// CAS file, its blocks inside the block table and inside its range
+static bool checkEntryRange(const cas_IndexEntry *entry, size_t block_count, uint64_t source_size) {
+    return entry->header_offset <= entry->end_offset && entry->end_offset <= source_size &&
+           entry->first_block <= block_count &&
+           entry->file.data_block_count <= block_count - entry->first_block;
+}
+
+static bool checkEntryBlocks(const cas_IndexEntry *entry, const cas_IndexBlock *blocks) {
+    for (size_t i = 0; i < entry->file.data_block_count; i++) {
+        if (blocks[i].data_offset < entry->header_offset ||
+            blocks[i].data_offset > entry->end_offset ||
+            blocks[i].data_size > entry->end_offset - blocks[i].data_offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool loadCasIndex(const char *cas_filename, cas_Index *index) {
+    memset(index, 0, sizeof(*index));
+
+    IndexFile file;
+    if (!openIndexFile(cas_filename, &file)) {
+        return false;
+    }
+
+    size_t table_size = file.entry_count * INDEX_FILE_SIZE + file.block_count * INDEX_BLOCK_SIZE;
+    uint8_t *table = malloc(table_size ? table_size : 1);
+    index->entries = calloc(file.entry_count ? file.entry_count : 1, sizeof(cas_IndexEntry));
+    index->blocks = calloc(file.block_count ? file.block_count : 1, sizeof(cas_IndexBlock));
+    bool ok = table && index->entries && index->blocks &&
+              readAt(file.fd, table, table_size, INDEX_HEADER_SIZE);
+    close(file.fd);
+
+    if (ok) {
+        index->entry_count = file.entry_count;
+        index->block_count = file.block_count;
+        index->source_size = (uint64_t)file.source.st_size;
+        index->source_mtime_sec = (int64_t)file.source.st_mtim.tv_sec;
+        index->source_mtime_nsec = (int64_t)file.source.st_mtim.tv_nsec;
+
+        const uint8_t *blocks = table + file.entry_count * INDEX_FILE_SIZE;
+        for (size_t i = 0; i < file.block_count; i++) {
+            decodeBlock(blocks + i * INDEX_BLOCK_SIZE, &index->blocks[i]);
+        }
+        for (size_t i = 0; ok && i < file.entry_count; i++) {
+            cas_IndexEntry *entry = &index->entries[i];
+            decodeEntry(table + i * INDEX_FILE_SIZE, entry);
+            ok = checkEntryRange(entry, index->block_count, index->source_size) &&
+                 checkEntryBlocks(entry, index->blocks + entry->first_block);
+        }
+    }
+
+    free(table);
+    if (!ok) {
+        freeCasIndex(index);
+    }
+    return ok;
+}
+
+// =============================================================================
+// Random Access
+// =============================================================================
+
+bool readIndexedFile(const char *cas_filename, size_t file_index,
+                     cas_Container *container, bool *indexed) {
+    container->files = NULL;
+    container->file_count = 0;
+    container->arena = (cas_Arena){0};
+
+    IndexFile file;
+    *indexed = openIndexFile(cas_filename, &file);
+    if (!*indexed) {
+        return false;
+    }
+    if (file_index >= file.entry_count) {
+        fprintf(stderr, "Error: Index %zu out of range (1-%zu)\n", file_index + 1, file.entry_count);
+        close(file.fd);
+        return false;
+    }
+
+    // Only this file's record and blocks are read from the index
+    uint8_t record[INDEX_FILE_SIZE];
+    cas_IndexEntry entry;
+    bool ok = readAt(file.fd, record, sizeof(record), INDEX_HEADER_SIZE + file_index * INDEX_FILE_SIZE);
+    if (ok) {
+        decodeEntry(record, &entry);
+        ok = checkEntryRange(&entry, file.block_count, (uint64_t)file.source.st_size);
+    }
+
+    size_t block_count = ok ? entry.file.data_block_count : 0;
+    uint8_t *table = ok ? malloc(block_count * INDEX_BLOCK_SIZE + 1) : NULL;
+    cas_IndexBlock *blocks = ok ? malloc((block_count + 1) * sizeof(cas_IndexBlock)) : NULL;
+    ok = ok && table && blocks &&
+         readAt(file.fd, table, block_count * INDEX_BLOCK_SIZE,
+                INDEX_HEADER_SIZE + file.entry_count * INDEX_FILE_SIZE +
+                entry.first_block * INDEX_BLOCK_SIZE);
+    close(file.fd);
+    for (size_t i = 0; ok && i < block_count; i++) {
+        decodeBlock(table + i * INDEX_BLOCK_SIZE, &blocks[i]);
+    }
+    free(table);
+    if (!ok || !checkEntryBlocks(&entry, blocks)) {
+        *indexed = false;  // Damaged: the caller parses the whole file instead
+        free(blocks);
+        return false;
+    }
+
+    // One arena, as for a parsed container: the file, its blocks and the
+    // file's bytes from its CAS header to the end of its last block
+    size_t span = (size_t)(entry.end_offset - entry.header_offset);
+    size_t blocks_size = block_count * sizeof(cas_DataBlock);
+    if (!initCasArena(&container->arena, sizeof(cas_File) + _Alignof(cas_DataBlock) + blocks_size + span)) {
+        fprintf(stderr, "Error: Failed to allocate memory for file %zu\n", file_index + 1);
+        free(blocks);
+        return false;
+    }
+    cas_File *cas_file = allocCasArena(&container->arena, sizeof(cas_File), _Alignof(cas_File));
+    cas_DataBlock *data_blocks = allocCasArena(&container->arena, blocks_size, _Alignof(cas_DataBlock));
+    uint8_t *bytes = allocCasArena(&container->arena, span, 1);
+
+    int fd = open(cas_filename, O_RDONLY);
+    ok = fd >= 0 && readAt(fd, bytes, span, entry.header_offset);
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    // The file must still start with a CAS header where the index says;
+    // if not, the index is no use and the caller parses the whole file
+    if (!ok || span < sizeof(CAS_HEADER) || memcmp(bytes, CAS_HEADER, sizeof(CAS_HEADER)) != 0) {
+        *indexed = false;
+        free(blocks);
+        freeCasArena(&container->arena);
+        return false;
+    }
+
+    *cas_file = entry.file;
+    cas_file->data_blocks = data_blocks;
+    for (size_t i = 0; i < block_count; i++) {
+        memcpy(data_blocks[i].header.bytes, CAS_HEADER, sizeof(CAS_HEADER));
+        data_blocks[i].data_offset = (size_t)blocks[i].data_offset;
+        data_blocks[i].data_size = (size_t)blocks[i].data_size;
+        data_blocks[i].data = bytes + (blocks[i].data_offset - entry.header_offset);
+    }
+    free(blocks);
+
+    container->files = cas_file;
+    container->file_count = 1;
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef INDEXLIB_H
+#define INDEXLIB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "caslib.h"
+
+// =============================================================================
+// CAS Sidecar Index
+// =============================================================================
+
+// The index of "game.cas" is stored next to it as "game.cas.idx". It records
+// where every file and block sits, so a single file can be read without
+// parsing the rest of the container. It is tied to the CAS file's size and
+// modification time and ignored once either changes
+#define CAS_INDEX_SUFFIX ".idx"
+
+// One block's bytes in the CAS file
+typedef struct {
+    uint64_t data_offset;
+    uint64_t data_size;
+} cas_IndexBlock;
+
+// One file: its headers and sizes, and the byte range it occupies
+typedef struct {
+    uint64_t header_offset;  // The file's CAS header
+    uint64_t end_offset;     // End of its last block
+    cas_File file;           // Headers and data_size (data_blocks is unused)
+    size_t first_block;      // First of its data_block_count entries in blocks
+} cas_IndexEntry;
+
+typedef struct {
+    uint64_t source_size;    // CAS file size and mtime the index describes
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    cas_IndexEntry *entries;
+    size_t entry_count;
+    cas_IndexBlock *blocks;
+    size_t block_count;
+} cas_Index;
+
+// Build the index of cas_filename (a regular file) with the streaming parser
+bool buildCasIndex(const char *cas_filename, cas_Index *index);
+
+// Write index to "<cas_filename>.idx"
+bool saveCasIndex(const char *cas_filename, const cas_Index *index);
+
+// Load "<cas_filename>.idx" if it exists and still matches the CAS file.
+// Returns false without printing anything when there is no usable index
+bool loadCasIndex(const char *cas_filename, cas_Index *index);
+
+// Read only file number file_index (0-based) into a one-file container,
+// using the index for its offsets: one index record, the file's block
+// records and the file's own bytes are read, whatever the container size.
+// Blocks keep their offsets in the whole CAS file. Release with
+// freeCasContainer(). indexed is false (and nothing is printed) when there
+// is no usable index (missing, stale, or damaged anywhere, including a
+// file that no longer starts where its record says), so the caller can
+// fall back to a full parse. With indexed true, a false return is an
+// error already reported: file_index is out of range or memory ran out
+bool readIndexedFile(const char *cas_filename, size_t file_index,
+                     cas_Container *container, bool *indexed);
+
+void freeCasIndex(cas_Index *index);
+
+// Returns allocated "<cas_filename>.idx" (caller must free)
+char* casIndexPath(const char *cas_filename);
+
+#endif // INDEXLIB_H
@@ -266,6 +266,43 @@ void freeMarkerListInfo(MarkerListInfo *markers) {
 // Audio Playback Implementation
 // =============================================================================
 
+/*
+ * CAS playback: render the next frames with the tape synthesizer
+ * 8-bit samples are converted to float like miniaudio's u8 decoder does
+ */
+static void synthesizeFrames(AudioPlayer *player, float *output, ma_uint32 frame_count) {
+    uint8_t samples[4096];
+    size_t frames_done = 0;
+    
+    ma_mutex_lock((ma_mutex *)player->synth_lock);
+    while (frames_done < frame_count) {
+        size_t want = frame_count - frames_done;
+        if (want > sizeof(samples)) want = sizeof(samples);
+        
+        size_t rendered = renderTapeSynth(player->tape_synth, samples, want);
+        for (size_t i = 0; i < rendered; i++) {
+            float x = samples[i] * 0.00784313725490196078f - 1.0f;
+            output[frames_done + i] = x * player->volume;
+        }
+        frames_done += rendered;
+        
+        if (rendered < want) {
+            break;  // End of tape
+        }
+    }
+    size_t position = getTapeSynthPosition(player->tape_synth);
+    ma_mutex_unlock((ma_mutex *)player->synth_lock);
+    
+    // Pad with silence and stop at the end of the tape
+    if (frames_done < frame_count) {
+        memset(output + frames_done, 0, (frame_count - frames_done) * sizeof(float));
+        player->state = PLAYER_STOPPED;
+    }
+    
+    // Position comes straight from the synthesizer
+    player->current_position = (double)position / player->sample_rate;
+}
+
 /*
  * Audio callback for miniaudio
  * This is called by miniaudio when it needs more audio data
@@ -280,6 +317,11 @@ static void audio_data_callback(ma_device *device, void *output, const void *inp
         return;
     }
     
+    if (player->tape_synth) {
+        synthesizeFrames(player, (float *)output, frame_count);
+        return;
+    }
+    
     ma_decoder *decoder = (ma_decoder *)player->ma_decoder;
     
     // Read frames from decoder
@@ -315,6 +357,34 @@ static void audio_data_callback(ma_device *device, void *output, const void *inp
     }
 }
 
+/*
+ * Open a playback device (f32) for the player's rate and channel count
+ * Returns NULL on error
+ */
+static ma_device* createPlaybackDevice(AudioPlayer *player) {
+    ma_device *device = malloc(sizeof(ma_device));
+    if (!device) {
+        fprintf(stderr, "Failed to allocate device\n");
+        return NULL;
+    }
+    
+    ma_device_config device_config = ma_device_config_init(ma_device_type_playback);
+    device_config.playback.format = ma_format_f32;
+    device_config.playback.channels = player->channels;
+    device_config.sampleRate = player->sample_rate;
+    device_config.dataCallback = audio_data_callback;
+    device_config.pUserData = player;
+    
+    ma_result result = ma_device_init(NULL, &device_config, device);
+    if (result != MA_SUCCESS) {
+        fprintf(stderr, "Failed to initialize playback device: %d\n", result);
+        free(device);
+        return NULL;
+    }
+    
+    return device;
+}
+
 AudioPlayer* createAudioPlayer(const char *filename) {
     AudioPlayer *player = calloc(1, sizeof(AudioPlayer));
     if (!player) {
@@ -374,9 +444,8 @@ AudioPlayer* createAudioPlayer(const char *filename) {
     player->total_duration = (double)length_in_frames / player->sample_rate;
     
     // Create playback device
-    ma_device *device = malloc(sizeof(ma_device));
+    ma_device *device = createPlaybackDevice(player);
     if (!device) {
-        fprintf(stderr, "Failed to allocate device\n");
         ma_decoder_uninit(decoder);
         free(decoder);
         free((void *)player->filepath);
@@ -385,26 +454,97 @@ AudioPlayer* createAudioPlayer(const char *filename) {
         return NULL;
     }
     
-    ma_device_config device_config = ma_device_config_init(ma_device_type_playback);
-    device_config.playback.format = ma_format_f32;
-    device_config.playback.channels = player->channels;
-    device_config.sampleRate = player->sample_rate;
-    device_config.dataCallback = audio_data_callback;
-    device_config.pUserData = player;
+    player->ma_device = device;
     
-    result = ma_device_init(NULL, &device_config, device);
-    if (result != MA_SUCCESS) {
-        fprintf(stderr, "Failed to initialize playback device: %d\n", result);
-        free(device);
-        ma_decoder_uninit(decoder);
-        free(decoder);
-        free((void *)player->filepath);
-        freeMarkerListInfo(player->markers);
-        free(player);
+    return player;
+}
+
+/*
+ * Convert generated markers to the playback marker list
+ */
+static MarkerListInfo* createMarkerListInfo(const MarkerList *list, uint32_t sample_rate,
+                                            double total_duration) {
+    MarkerListInfo *info = malloc(sizeof(MarkerListInfo));
+    if (!info) return NULL;
+    
+    info->count = list->count;
+    info->sample_rate = sample_rate;
+    info->total_duration = total_duration;
+    info->markers = malloc((list->count ? list->count : 1) * sizeof(MarkerInfo));
+    if (!info->markers) {
+        free(info);
         return NULL;
     }
     
-    player->ma_device = device;
+    for (size_t i = 0; i < list->count; i++) {
+        MarkerInfo *marker = &info->markers[i];
+        marker->sample_position = (uint32_t)list->markers[i].sample_position;
+        marker->time_seconds = marker->sample_position / (double)sample_rate;
+        marker->category = list->markers[i].category;
+        memcpy(marker->description, list->markers[i].description, sizeof(marker->description));
+    }
+    
+    return info;
+}
+
+AudioPlayer* createCasPlayer(const char *filename, const WaveformConfig *config) {
+    if (!filename || !config) {
+        fprintf(stderr, "Error: Invalid parameters to createCasPlayer\n");
+        return NULL;
+    }
+    
+    AudioPlayer *player = calloc(1, sizeof(AudioPlayer));
+    if (!player) {
+        fprintf(stderr, "Failed to allocate AudioPlayer\n");
+        return NULL;
+    }
+    
+    player->filepath = strdup(filename);
+    player->state = PLAYER_STOPPED;
+    player->volume = 0.8f;  // Default 80% volume
+    player->sample_rate = config->sample_rate;
+    player->channels = 1;
+    
+    // Load and parse the CAS file
+    if (!openCasInput(filename, &player->input)) {
+        destroyAudioPlayer(player);
+        return NULL;
+    }
+    if (!parseCasContainerInPlace(player->input.data, &player->container, player->input.size)) {
+        fprintf(stderr, "Error: Failed to read CAS file '%s'\n", filename);
+        destroyAudioPlayer(player);
+        return NULL;
+    }
+    
+    // Synthesizer and virtual markers from the tape layout
+    MarkerList *markers = createMarkerList();
+    player->tape_synth = markers ? createTapeSynth(&player->container, config, markers) : NULL;
+    if (!player->tape_synth) {
+        fprintf(stderr, "Error: Failed to prepare tape synthesis\n");
+        freeMarkerList(markers);
+        destroyAudioPlayer(player);
+        return NULL;
+    }
+    
+    player->total_frames = getTapeSynthLength(player->tape_synth);
+    player->total_duration = (double)player->total_frames / player->sample_rate;
+    player->markers = createMarkerListInfo(markers, player->sample_rate, player->total_duration);
+    freeMarkerList(markers);
+    
+    ma_mutex *lock = malloc(sizeof(ma_mutex));
+    if (!lock || ma_mutex_init(lock) != MA_SUCCESS) {
+        fprintf(stderr, "Failed to create synthesizer lock\n");
+        free(lock);
+        destroyAudioPlayer(player);
+        return NULL;
+    }
+    player->synth_lock = lock;
+    
+    player->ma_device = createPlaybackDevice(player);
+    if (!player->ma_device) {
+        destroyAudioPlayer(player);
+        return NULL;
+    }
     
     return player;
 }
@@ -439,6 +579,20 @@ void resumeAudio(AudioPlayer *player) {
 bool seekAudio(AudioPlayer *player, double seconds) {
     if (!player) return false;
     
+    // CAS playback: the target is a sample position on the tape layout
+    if (player->tape_synth) {
+        if (seconds < 0.0) seconds = 0.0;
+        size_t target = (size_t)(seconds * player->sample_rate);
+        
+        ma_mutex_lock((ma_mutex *)player->synth_lock);
+        seekTapeSynth(player->tape_synth, target);
+        size_t position = getTapeSynthPosition(player->tape_synth);
+        ma_mutex_unlock((ma_mutex *)player->synth_lock);
+        
+        player->current_position = (double)position / player->sample_rate;
+        return true;
+    }
+    
     ma_decoder *decoder = (ma_decoder *)player->ma_decoder;
     ma_uint64 target_frame = (ma_uint64)(seconds * player->sample_rate);
     
@@ -505,6 +659,15 @@ void destroyAudioPlayer(AudioPlayer *player) {
         free(decoder);
     }
     
+    // Free CAS playback state
+    if (player->synth_lock) {
+        ma_mutex_uninit((ma_mutex *)player->synth_lock);
+        free(player->synth_lock);
+    }
+    freeTapeSynth(player->tape_synth);
+    freeCasContainer(&player->container);
+    closeCasInput(&player->input);
+    
     // Free resources
     freeMarkerListInfo(player->markers);
     free((void *)player->filepath);
@@ -5,6 +5,7 @@
  * - Reading WAV cue point markers
  * - Audio playback with precise position tracking
  * - Playback controls (play, pause, seek, volume)
+ * - CAS playback synthesized on the fly (no WAV file)
  */
 
 #ifndef PLAYLIB_H
@@ -54,8 +55,14 @@ typedef struct {
     PlayerState state;
     double current_position;  // Current position in seconds
     float volume;             // 0.0 to 1.0
-    void *ma_decoder;         // miniaudio decoder
+    void *ma_decoder;         // miniaudio decoder (WAV playback)
     void *ma_device;          // miniaudio device
+    
+    // CAS playback: samples are synthesized in the audio callback
+    TapeSynth *tape_synth;    // NULL for WAV playback
+    void *synth_lock;         // miniaudio mutex guarding tape_synth
+    cas_Input input;          // CAS file contents (the container points into it)
+    cas_Container container;  // Parsed container the synthesizer renders
 } AudioPlayer;
 
 // =============================================================================
@@ -90,6 +97,15 @@ void freeMarkerListInfo(MarkerListInfo *markers);
  */
 AudioPlayer* createAudioPlayer(const char *filename);
 
+/*
+ * Create audio player for a CAS file
+ * Audio is synthesized in the playback callback with the given waveform
+ * settings; markers come from the tape layout and seeking is computed
+ * from it, so nothing is written to disk
+ * Returns NULL on error
+ */
+AudioPlayer* createCasPlayer(const char *filename, const WaveformConfig *config);
+
 /*
  * Start playback
  */
@@ -0,0 +1,434 @@
+/*
+ * recordlib.c - Tape recording from an audio input device
+ */
+
+#include "miniaudio.h"  // Implementation compiled in playlib.c
+#include "recordlib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define DEFAULT_RECORD_RATE 44100
+#define POLL_SLEEP_MS       2       // Ring buffer checked this often while empty
+#define DRAIN_FRAMES        4096    // Frames of one channel picked per feed
+
+struct TapeRecorder {
+    TapeRecorderConfig config;
+    TapeDecoder *decoder;
+    uint32_t sample_rate;
+    uint16_t channels;       // Channels per frame in the ring buffer
+    uint16_t channel;        // Channel decoded
+    char source[256];
+
+    // Frames from the audio thread (or file thread) to the decoder
+    ma_pcm_rb ring;
+    bool ring_ready;
+    int16_t *buffer;         // One channel picked out of multi-channel frames
+
+    // Capture device
+    ma_context *context;
+    ma_device *device;
+
+    // WAV file standing in for the device
+    WavReader reader;
+    bool reader_open;
+    pthread_t thread;
+    bool thread_started;
+
+    // Shared with the producer thread (gcc atomics)
+    int stop_requested;
+    int input_ended;
+    uint64_t frames_captured;
+    uint64_t frames_dropped;
+
+    double max_backlog_ms;
+    bool started;
+    bool stopped;
+};
+
+// =============================================================================
+// Producer Side
+// =============================================================================
+
+// Copy count frames into the ring buffer. A device callback cannot wait:
+// frames that do not fit are dropped. With wait, the producer sleeps until
+// the decoder has made room
+static void pushFrames(TapeRecorder *recorder, const int16_t *frames, uint32_t count, bool wait) {
+    size_t frame_size = (size_t)recorder->channels * sizeof(int16_t);
+    uint32_t done = 0;
+    while (done < count) {
+        uint32_t frames_free = count - done;
+        void *region;
+        if (ma_pcm_rb_acquire_write(&recorder->ring, &frames_free, &region) != MA_SUCCESS) {
+            break;
+        }
+        if (frames_free > 0) {
+            memcpy(region, (const uint8_t *)frames + done * frame_size, frames_free * frame_size);
+        }
+        ma_pcm_rb_commit_write(&recorder->ring, frames_free);
+        done += frames_free;
+
+        if (frames_free == 0) {
+            if (!wait || __atomic_load_n(&recorder->stop_requested, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            struct timespec pause = {0, 1000000};
+            nanosleep(&pause, NULL);
+        }
+    }
+    __atomic_fetch_add(&recorder->frames_captured, done, __ATOMIC_RELEASE);
+    if (done < count) {
+        __atomic_fetch_add(&recorder->frames_dropped, count - done, __ATOMIC_RELEASE);
+    }
+}
+
+static void captureCallback(ma_device *device, void *output, const void *input, ma_uint32 frame_count) {
+    (void)output;  // Capture only
+    pushFrames((TapeRecorder *)device->pUserData, input, frame_count, false);
+}
+
+// Read the WAV file one device period at a time, like a capture device
+static void* fileInputThread(void *arg) {
+    TapeRecorder *recorder = arg;
+    uint32_t period = recorder->sample_rate * RECORD_PERIOD_MS / 1000;
+    int16_t *samples = malloc(period * sizeof(int16_t));
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t frames_sent = 0;
+    size_t count;
+    while (samples && !__atomic_load_n(&recorder->stop_requested, __ATOMIC_ACQUIRE) &&
+           (count = readWavReader(&recorder->reader, samples, period)) > 0) {
+        frames_sent += count;
+        if (recorder->config.realtime) {
+            // A period is delivered once it has been "played"
+            uint64_t ns = frames_sent * 1000000000ull / recorder->sample_rate + (uint64_t)start.tv_nsec;
+            struct timespec due = {start.tv_sec + (time_t)(ns / 1000000000ull),
+                                   (long)(ns % 1000000000ull)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+        }
+        pushFrames(recorder, samples, (uint32_t)count, !recorder->config.realtime);
+    }
+    free(samples);
+    __atomic_store_n(&recorder->input_ended, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// =============================================================================
+// Opening the Input
+// =============================================================================
+
+static ma_context* openContext(bool null_device) {
+    ma_context *context = malloc(sizeof(ma_context));
+    if (!context) {
+        fprintf(stderr, "Error: Failed to allocate audio context\n");
+        return NULL;
+    }
+    ma_backend null_backend[] = {ma_backend_null};
+    ma_result result = null_device ? ma_context_init(null_backend, 1, NULL, context)
+                                   : ma_context_init(NULL, 0, NULL, context);
+    if (result != MA_SUCCESS) {
+        fprintf(stderr, "Error: Failed to initialize audio: %s\n", ma_result_description(result));
+        free(context);
+        return NULL;
+    }
+    // miniaudio falls back to its null backend, which records silence
+    if (!null_device && context->backend == ma_backend_null) {
+        fprintf(stderr, "Error: No audio input available (no sound system found)\n");
+        ma_context_uninit(context);
+        free(context);
+        return NULL;
+    }
+    return context;
+}
+
+bool listCaptureDevices(FILE *out) {
+    ma_context *context = openContext(false);
+    if (!context) {
+        return false;
+    }
+    ma_device_info *capture_infos;
+    ma_uint32 capture_count;
+    ma_result result = ma_context_get_devices(context, NULL, NULL, &capture_infos, &capture_count);
+    if (result != MA_SUCCESS) {
+        fprintf(stderr, "Error: Failed to list audio devices: %s\n", ma_result_description(result));
+    } else {
+        fprintf(out, "Capture devices (%s):\n", ma_get_backend_name(context->backend));
+        for (ma_uint32 i = 0; i < capture_count; i++) {
+            fprintf(out, "  %u. %s%s\n", i + 1, capture_infos[i].name,
+                    capture_infos[i].isDefault ? " (default)" : "");
+        }
+        if (capture_count == 0) {
+            fprintf(out, "  none\n");
+        }
+    }
+    ma_context_uninit(context);
+    free(context);
+    return result == MA_SUCCESS;
+}
+
+static bool openCaptureDevice(TapeRecorder *recorder) {
+    const TapeRecorderConfig *config = &recorder->config;
+    recorder->context = openContext(config->null_device);
+    if (!recorder->context) {
+        return false;
+    }
+
+    ma_device_config device_config = ma_device_config_init(ma_device_type_capture);
+    device_config.capture.format = ma_format_s16;
+    device_config.capture.channels = config->channel + 1;
+    device_config.sampleRate = recorder->sample_rate;
+    device_config.periodSizeInMilliseconds = RECORD_PERIOD_MS;
+    device_config.dataCallback = captureCallback;
+    device_config.pUserData = recorder;
+
+    if (config->device_index >= 0) {
+        ma_device_info *capture_infos;
+        ma_uint32 capture_count;
+        if (ma_context_get_devices(recorder->context, NULL, NULL, &capture_infos,
+                                   &capture_count) != MA_SUCCESS ||
+            (ma_uint32)config->device_index >= capture_count) {
+            fprintf(stderr, "Error: No capture device %d (see 'cast record --list')\n",
+                    config->device_index + 1);
+            return false;
+        }
+        device_config.capture.pDeviceID = &capture_infos[config->device_index].id;
+    }
+
+    recorder->device = malloc(sizeof(ma_device));
+    if (!recorder->device) {
+        fprintf(stderr, "Error: Failed to allocate capture device\n");
+        return false;
+    }
+    ma_result result = ma_device_init(recorder->context, &device_config, recorder->device);
+    if (result != MA_SUCCESS) {
+        fprintf(stderr, "Error: Failed to open capture device: %s\n", ma_result_description(result));
+        free(recorder->device);
+        recorder->device = NULL;
+        return false;
+    }
+    // miniaudio converts to the format and rate asked for
+    snprintf(recorder->source, sizeof(recorder->source), "%s",
+             config->null_device ? "null device" : recorder->device->capture.name);
+    return true;
+}
+
+TapeRecorder* createTapeRecorder(const TapeRecorderConfig *config) {
+    TapeRecorder *recorder = calloc(1, sizeof(TapeRecorder));
+    if (!recorder) {
+        fprintf(stderr, "Error: Failed to allocate tape recorder\n");
+        return NULL;
+    }
+    recorder->config = *config;
+    recorder->sample_rate = config->sample_rate ? config->sample_rate : DEFAULT_RECORD_RATE;
+
+    // The WAV reader picks the channel; a device delivers channel + 1 of them
+    if (config->input_file) {
+        if (!openWavReader(config->input_file, config->channel, &recorder->reader)) {
+            free(recorder);
+            return NULL;
+        }
+        recorder->reader_open = true;
+        recorder->sample_rate = recorder->reader.sample_rate;
+        recorder->channels = 1;
+        recorder->channel = 0;
+        snprintf(recorder->source, sizeof(recorder->source), "%s", config->input_file);
+    } else {
+        recorder->channels = config->channel + 1;
+        recorder->channel = config->channel;
+    }
+
+    uint32_t ring_frames = (uint32_t)((uint64_t)recorder->sample_rate * RECORD_BUFFER_MS / 1000);
+    if (ma_pcm_rb_init(ma_format_s16, recorder->channels, ring_frames, NULL, NULL,
+                       &recorder->ring) != MA_SUCCESS) {
+        fprintf(stderr, "Error: Failed to allocate recording buffer\n");
+        freeTapeRecorder(recorder);
+        return NULL;
+    }
+    recorder->ring_ready = true;
+    recorder->buffer = malloc(DRAIN_FRAMES * sizeof(int16_t));
+    if (!recorder->buffer) {
+        fprintf(stderr, "Error: Failed to allocate recording buffer\n");
+        freeTapeRecorder(recorder);
+        return NULL;
+    }
+
+    if (!config->input_file && !openCaptureDevice(recorder)) {
+        freeTapeRecorder(recorder);
+        return NULL;
+    }
+
+    TapeDecoderConfig decoder_config = config->decoder;
+    decoder_config.sample_rate = recorder->sample_rate;
+    recorder->decoder = createTapeDecoder(&decoder_config);
+    if (!recorder->decoder) {
+        freeTapeRecorder(recorder);
+        return NULL;
+    }
+    return recorder;
+}
+
+bool startTapeRecorder(TapeRecorder *recorder) {
+    if (recorder->started) {
+        return true;
+    }
+    if (recorder->device) {
+        ma_result result = ma_device_start(recorder->device);
+        if (result != MA_SUCCESS) {
+            fprintf(stderr, "Error: Failed to start capture: %s\n", ma_result_description(result));
+            return false;
+        }
+    } else {
+        if (pthread_create(&recorder->thread, NULL, fileInputThread, recorder) != 0) {
+            fprintf(stderr, "Error: Failed to start input thread\n");
+            return false;
+        }
+        recorder->thread_started = true;
+    }
+    recorder->started = true;
+    return true;
+}
+
+// =============================================================================
+// Consumer Side
+// =============================================================================
+
+// Feed everything in the ring buffer to the decoder. Returns false when
+// the decoder stopped; *drained counts the frames taken
+static bool drainRing(TapeRecorder *recorder, uint32_t *drained) {
+    uint32_t available = ma_pcm_rb_available_read(&recorder->ring);
+    double backlog_ms = available * 1000.0 / recorder->sample_rate;
+    if (backlog_ms > recorder->max_backlog_ms) {
+        recorder->max_backlog_ms = backlog_ms;
+    }
+
+    *drained = 0;
+    bool ok = true;
+    while (ok && *drained < available) {
+        uint32_t count = available - *drained;
+        void *region;
+        if (ma_pcm_rb_acquire_read(&recorder->ring, &count, &region) != MA_SUCCESS || count == 0) {
+            break;
+        }
+        const int16_t *frames = region;
+        if (recorder->channels == 1) {
+            ok = feedTapeDecoder(recorder->decoder, frames, count);
+        } else {
+            for (uint32_t done = 0; ok && done < count; ) {
+                uint32_t take = count - done < DRAIN_FRAMES ? count - done : DRAIN_FRAMES;
+                for (uint32_t i = 0; i < take; i++) {
+                    recorder->buffer[i] = frames[(size_t)(done + i) * recorder->channels +
+                                                 recorder->channel];
+                }
+                ok = feedTapeDecoder(recorder->decoder, recorder->buffer, take);
+                done += take;
+            }
+        }
+        ma_pcm_rb_commit_read(&recorder->ring, count);
+        *drained += count;
+    }
+    return ok;
+}
+
+static double elapsedMilliseconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) * 1e3 + (double)(now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+bool pollTapeRecorder(TapeRecorder *recorder, uint32_t timeout_ms) {
+    if (!recorder->started || recorder->stopped) {
+        return false;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;) {
+        // Read the flag first: frames pushed before the end are then seen
+        bool ended = __atomic_load_n(&recorder->input_ended, __ATOMIC_ACQUIRE) != 0;
+        uint32_t drained;
+        if (!drainRing(recorder, &drained)) {
+            return false;
+        }
+        if (drained > 0) {
+            return true;
+        }
+        if (ended) {
+            return false;
+        }
+        if (elapsedMilliseconds(&start) >= timeout_ms) {
+            return true;
+        }
+        struct timespec pause = {0, POLL_SLEEP_MS * 1000000L};
+        nanosleep(&pause, NULL);
+    }
+}
+
+// Stop the producer; the ring buffer keeps what it delivered
+static void stopInput(TapeRecorder *recorder) {
+    if (recorder->device && ma_device_is_started(recorder->device)) {
+        ma_device_stop(recorder->device);
+    }
+    if (recorder->thread_started) {
+        __atomic_store_n(&recorder->stop_requested, 1, __ATOMIC_RELEASE);
+        pthread_join(recorder->thread, NULL);
+        recorder->thread_started = false;
+    }
+}
+
+bool stopTapeRecorder(TapeRecorder *recorder) {
+    if (recorder->stopped) {
+        return true;
+    }
+    stopInput(recorder);
+    recorder->stopped = true;
+
+    uint32_t drained;
+    bool ok = true;
+    do {
+        ok = drainRing(recorder, &drained);
+    } while (ok && drained > 0);
+    return finishTapeDecoder(recorder->decoder) && ok;
+}
+
+TapeDecoder* getTapeRecorderDecoder(const TapeRecorder *recorder) {
+    return recorder->decoder;
+}
+
+void getTapeRecorderStats(const TapeRecorder *recorder, TapeRecorderStats *stats) {
+    stats->frames_captured = __atomic_load_n(&recorder->frames_captured, __ATOMIC_ACQUIRE);
+    stats->frames_dropped = __atomic_load_n(&recorder->frames_dropped, __ATOMIC_ACQUIRE);
+    stats->max_backlog_ms = recorder->max_backlog_ms;
+}
+
+const char* getTapeRecorderSource(const TapeRecorder *recorder) {
+    return recorder->source;
+}
+
+uint32_t getTapeRecorderSampleRate(const TapeRecorder *recorder) {
+    return recorder->sample_rate;
+}
+
+void freeTapeRecorder(TapeRecorder *recorder) {
+    if (!recorder) {
+        return;
+    }
+    stopInput(recorder);
+    if (recorder->device) {
+        ma_device_uninit(recorder->device);
+        free(recorder->device);
+    }
+    if (recorder->context) {
+        ma_context_uninit(recorder->context);
+        free(recorder->context);
+    }
+    if (recorder->ring_ready) {
+        ma_pcm_rb_uninit(&recorder->ring);
+    }
+    if (recorder->reader_open) {
+        closeWavReader(&recorder->reader);
+    }
+    freeTapeDecoder(recorder->decoder);
+    free(recorder->buffer);
+    free(recorder);
+}
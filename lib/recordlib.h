@@ -0,0 +1,85 @@
+#ifndef RECORDLIB_H
+#define RECORDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "decodelib.h"
+
+// =============================================================================
+// Tape Recording (Audio Input to CAS)
+// =============================================================================
+//
+// Decodes a tape as it plays into an audio input, e.g. an MSX saving with
+// CSAVE or BSAVE into the line input of the sound card:
+//
+//   capture device ──► ring buffer ──► pollTapeRecorder() ──► TapeDecoder
+//   (audio thread)     (lock-free)     (caller's thread)      (block_end)
+//
+// miniaudio's capture callback only copies frames into a single-producer,
+// single-consumer ring buffer (ma_pcm_rb), so it never waits on the
+// decoder. The caller drains the ring with pollTapeRecorder() and the
+// decoder reports each block through its block_end callback, on the
+// caller's thread. With 10 ms device periods and a poll every few
+// milliseconds, samples reach the decoder within a few tens of ms.
+//
+// A WAV file can stand in for the device: a thread reads it into the same
+// ring buffer, paced in real time like a device or as fast as the decoder
+// drains it.
+//
+// =============================================================================
+
+#define RECORD_PERIOD_MS    10      // Device period: frames per capture callback
+#define RECORD_BUFFER_MS    2000    // Ring buffer; a longer stall drops frames
+
+typedef struct {
+    uint32_t sample_rate;    // Capture rate (0: 44100)
+    uint16_t channel;        // Channel to decode (0 = left); channel + 1 are captured
+    int device_index;        // Capture device from listCaptureDevices() (-1: default)
+    bool null_device;        // miniaudio's null backend: silence in real time
+    const char *input_file;  // WAV file read instead of a device (NULL: device)
+    bool realtime;           // input_file: deliver frames at the file's own rate
+    TapeDecoderConfig decoder;  // block_end and context (sample_rate is set here)
+} TapeRecorderConfig;
+
+typedef struct {
+    uint64_t frames_captured;   // Frames delivered by the device or file
+    uint64_t frames_dropped;    // Frames lost because the ring buffer was full
+    double max_backlog_ms;      // Most audio waiting in the ring when drained
+} TapeRecorderStats;
+
+typedef struct TapeRecorder TapeRecorder;
+
+// Print the capture devices, numbered for TapeRecorderConfig.device_index.
+// Returns false if no audio backend could be opened
+bool listCaptureDevices(FILE *out);
+
+// Open the device (or WAV file) and create the decoder; nothing is
+// captured until startTapeRecorder(). Returns NULL after printing an error
+TapeRecorder* createTapeRecorder(const TapeRecorderConfig *config);
+
+bool startTapeRecorder(TapeRecorder *recorder);
+
+// Decode the frames captured so far, waiting up to timeout_ms for the
+// first of them. Returns false once the input has ended (WAV file) or the
+// decoder stopped; true otherwise, also when nothing arrived in time
+bool pollTapeRecorder(TapeRecorder *recorder, uint32_t timeout_ms);
+
+// Stop capturing, decode what is left in the ring buffer and finish the
+// block being decoded. Returns false if the decoder failed
+bool stopTapeRecorder(TapeRecorder *recorder);
+
+// The decoder, with the image and blocks decoded so far
+TapeDecoder* getTapeRecorderDecoder(const TapeRecorder *recorder);
+
+void getTapeRecorderStats(const TapeRecorder *recorder, TapeRecorderStats *stats);
+
+// Name of the device being recorded ("null device" or the WAV file name)
+const char* getTapeRecorderSource(const TapeRecorder *recorder);
+
+uint32_t getTapeRecorderSampleRate(const TapeRecorder *recorder);
+
+void freeTapeRecorder(TapeRecorder *recorder);
+
+#endif // RECORDLIB_H
@@ -0,0 +1,374 @@
+/*
+ * verifylib.c - Round-trip verification of rendered tapes
+ */
+
+#include "verifylib.h"
+#include "decodelib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define QUEUE_DEPTH 4  // Sample buffers waiting to be decoded (the writer then waits)
+
+// A block the tape holds, with where the writer rendered its bytes
+typedef struct {
+    size_t file_index;
+    bool header_block;
+    size_t block_index;
+    size_t offset;           // Bytes in TapeVerifier.expected
+    size_t size;
+    size_t start_sample;     // First sample of the block's first byte
+} ExpectedBlock;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} QueuedSamples;
+
+struct TapeVerifier {
+    const cas_Container *container;
+    WavSink sink;
+    TapeDecoder *decoder;
+
+    uint8_t *expected;       // Bytes of every block, back to back
+    ExpectedBlock *blocks;
+    size_t block_count;
+    size_t byte_length[256]; // Samples per framed byte value, as the writer renders it
+
+    // Filled on the decoding thread
+    size_t blocks_decoded;
+    TapeVerifyResult result;
+
+    // Sample buffers from the writer to the decoding thread
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    QueuedSamples queue[QUEUE_DEPTH];
+    size_t queue_head;
+    size_t queue_count;
+    bool closing;            // No more samples will come
+    bool failed;             // Out of memory or the decoder stopped
+    pthread_t thread;
+    bool thread_started;
+};
+
+// =============================================================================
+// Expected Blocks
+// =============================================================================
+
+// Bytes of the block a HEADER or DATA segment renders, as the writer
+// renders them (the address header the parser split off goes first)
+static size_t blockBytes(const cas_File *file, const TapeSegment *segment, uint8_t *dest) {
+    if (segment->kind == SEGMENT_HEADER) {
+        if (dest) {
+            memcpy(dest, file->file_header.file_type, sizeof(file->file_header.file_type));
+            memcpy(dest + sizeof(file->file_header.file_type), file->file_header.file_name,
+                   sizeof(file->file_header.file_name));
+        }
+        return sizeof(cas_FileHeader);
+    }
+
+    const cas_DataBlock *block = &file->data_blocks[segment->block_index];
+    size_t size = 0;
+    if (segment->block_index == 0 && isBinaryFile(file->file_header.file_type)) {
+        const cas_DataBlockHeader *addresses = &file->data_block_header;
+        uint16_t values[3] = {addresses->load_address, addresses->end_address,
+                              addresses->exec_address};
+        for (size_t i = 0; i < 3; i++) {
+            if (dest) {
+                dest[size] = values[i] & 0xFF;
+                dest[size + 1] = values[i] >> 8;
+            }
+            size += 2;
+        }
+    }
+    if (dest) {
+        memcpy(dest + size, block->data, block->data_size);
+    }
+    return size + block->data_size;
+}
+
+static bool planExpectedBlocks(TapeVerifier *verifier, const WaveformConfig *config) {
+    // A 0-bit is not always exactly two 1-bit cycles, so framed bytes differ
+    // in length by value: take the lengths from the writer's byte table
+    WaveformCache *cache = createWaveformCache(config);
+    if (!cache) {
+        return false;
+    }
+    memcpy(verifier->byte_length, cache->byte_length, sizeof(verifier->byte_length));
+    freeWaveformCache(cache);
+
+    TapeLayout layout;
+    if (!planTapeLayout(verifier->container, config, &layout)) {
+        return false;
+    }
+
+    // Count first, then copy the bytes
+    size_t total = 0;
+    for (size_t i = 0; i < layout.count; i++) {
+        const TapeSegment *segment = &layout.segments[i];
+        if (segment->kind == SEGMENT_HEADER || segment->kind == SEGMENT_DATA) {
+            total += blockBytes(&verifier->container->files[segment->file_index], segment, NULL);
+            verifier->block_count++;
+        }
+    }
+    verifier->expected = malloc(total ? total : 1);
+    verifier->blocks = calloc(verifier->block_count ? verifier->block_count : 1,
+                              sizeof(ExpectedBlock));
+    if (!verifier->expected || !verifier->blocks) {
+        freeTapeLayout(&layout);
+        return false;
+    }
+
+    size_t offset = 0, index = 0;
+    for (size_t i = 0; i < layout.count; i++) {
+        const TapeSegment *segment = &layout.segments[i];
+        if (segment->kind != SEGMENT_HEADER && segment->kind != SEGMENT_DATA) {
+            continue;
+        }
+        ExpectedBlock *block = &verifier->blocks[index++];
+        block->file_index = segment->file_index;
+        block->header_block = segment->kind == SEGMENT_HEADER;
+        block->block_index = segment->block_index;
+        block->offset = offset;
+        block->size = blockBytes(&verifier->container->files[segment->file_index], segment,
+                                 verifier->expected + offset);
+        block->start_sample = segment->start_sample;
+        offset += block->size;
+    }
+    freeTapeLayout(&layout);
+    return true;
+}
+
+// =============================================================================
+// Comparing
+// =============================================================================
+
+// Keep the first difference only: later ones usually follow from it
+static void recordDifference(TapeVerifier *verifier, TapeVerifyStatus status,
+                             const ExpectedBlock *block, size_t byte_offset, int expected,
+                             int found, uint64_t sample) {
+    TapeVerifyResult *result = &verifier->result;
+    if (result->status != VERIFY_MATCH) {
+        return;
+    }
+    result->status = status;
+    result->file_index = block ? block->file_index : verifier->container->file_count;
+    result->header_block = block && block->header_block;
+    result->block_index = block ? block->block_index : 0;
+    result->byte_offset = byte_offset;
+    result->expected = expected;
+    result->found = found;
+    result->sample = sample;
+}
+
+// First sample of a block's byte: the lengths of the bytes before it added
+// to where the block starts
+static uint64_t byteSample(const TapeVerifier *verifier, const ExpectedBlock *block,
+                           size_t byte_offset) {
+    const uint8_t *bytes = verifier->expected + block->offset;
+    uint64_t sample = block->start_sample;
+    for (size_t i = 0; i < byte_offset && i < block->size; i++) {
+        sample += verifier->byte_length[bytes[i]];
+    }
+    return sample;
+}
+
+static bool compareBlock(void *context, const TapeBlock *decoded, const uint8_t *data) {
+    TapeVerifier *verifier = context;
+    size_t index = verifier->blocks_decoded++;
+    if (index >= verifier->block_count) {
+        recordDifference(verifier, VERIFY_EXTRA_BLOCK, NULL, 0, -1, decoded->size ? data[0] : -1,
+                         decoded->data_start);
+        return true;
+    }
+
+    const ExpectedBlock *block = &verifier->blocks[index];
+    const uint8_t *expected = verifier->expected + block->offset;
+    size_t common = decoded->size < block->size ? decoded->size : block->size;
+    size_t i = 0;
+    while (i < common && data[i] == expected[i]) {
+        i++;
+    }
+    if (i < common) {
+        recordDifference(verifier, VERIFY_BYTE_DIFFERS, block, i, expected[i], data[i],
+                         byteSample(verifier, block, i));
+    } else if (decoded->size < block->size) {
+        recordDifference(verifier, VERIFY_BLOCK_SHORT, block, i, expected[i], -1,
+                         byteSample(verifier, block, i));
+    } else if (decoded->size > block->size) {
+        recordDifference(verifier, VERIFY_BLOCK_LONG, block, i, -1, data[i],
+                         byteSample(verifier, block, i));
+    }
+    return true;
+}
+
+// =============================================================================
+// Decoding Thread
+// =============================================================================
+
+static void* decodeSamples(void *arg) {
+    TapeVerifier *verifier = arg;
+    pthread_mutex_lock(&verifier->lock);
+    for (;;) {
+        while (verifier->queue_count == 0 && !verifier->closing) {
+            pthread_cond_wait(&verifier->changed, &verifier->lock);
+        }
+        if (verifier->queue_count == 0) {
+            break;  // Closing and drained
+        }
+        QueuedSamples samples = verifier->queue[verifier->queue_head];
+        pthread_mutex_unlock(&verifier->lock);
+
+        bool ok = feedTapeDecoderPcm(verifier->decoder, samples.data, PCM_U8, samples.size);
+        free(samples.data);
+
+        // Free the slot only now: the writer waits while decoding lags
+        pthread_mutex_lock(&verifier->lock);
+        verifier->queue_head = (verifier->queue_head + 1) % QUEUE_DEPTH;
+        verifier->queue_count--;
+        verifier->failed = verifier->failed || !ok;
+        pthread_cond_broadcast(&verifier->changed);
+    }
+    pthread_mutex_unlock(&verifier->lock);
+    return NULL;
+}
+
+// WavSink write: queue a copy of the samples, waiting for a free slot
+static bool queueSamples(void *context, const uint8_t *data, size_t size) {
+    TapeVerifier *verifier = context;
+    uint8_t *copy = malloc(size ? size : 1);
+    if (!copy) {
+        fprintf(stderr, "Error: Failed to allocate verification buffer\n");
+        return false;
+    }
+    memcpy(copy, data, size);
+
+    pthread_mutex_lock(&verifier->lock);
+    while (verifier->queue_count == QUEUE_DEPTH && !verifier->failed) {
+        pthread_cond_wait(&verifier->changed, &verifier->lock);
+    }
+    bool ok = !verifier->failed;
+    if (ok) {
+        size_t slot = (verifier->queue_head + verifier->queue_count) % QUEUE_DEPTH;
+        verifier->queue[slot] = (QueuedSamples){copy, size};
+        verifier->queue_count++;
+        pthread_cond_broadcast(&verifier->changed);
+    }
+    pthread_mutex_unlock(&verifier->lock);
+    if (!ok) {
+        fprintf(stderr, "Error: Verification decoder failed\n");
+        free(copy);
+    }
+    return ok;
+}
+
+// =============================================================================
+// Public Interface
+// =============================================================================
+
+TapeVerifier* createTapeVerifier(const cas_Container *container, const WaveformConfig *config) {
+    if (!container || !config) {
+        fprintf(stderr, "Error: Invalid parameters to createTapeVerifier\n");
+        return NULL;
+    }
+    TapeVerifier *verifier = calloc(1, sizeof(TapeVerifier));
+    if (!verifier) {
+        fprintf(stderr, "Error: Failed to allocate verifier\n");
+        return NULL;
+    }
+    verifier->container = container;
+    verifier->sink = (WavSink){.write = queueSamples, .context = verifier, .samples_only = true};
+    pthread_mutex_init(&verifier->lock, NULL);
+    pthread_cond_init(&verifier->changed, NULL);
+
+    if (!planExpectedBlocks(verifier, config)) {
+        fprintf(stderr, "Error: Failed to plan the tape to verify\n");
+        freeTapeVerifier(verifier);
+        return NULL;
+    }
+
+    TapeDecoderConfig decoder_config = {
+        .sample_rate = config->sample_rate,
+        .block_end = compareBlock,
+        .context = verifier
+    };
+    verifier->decoder = createTapeDecoder(&decoder_config);
+    if (!verifier->decoder) {
+        freeTapeVerifier(verifier);
+        return NULL;
+    }
+
+    if (pthread_create(&verifier->thread, NULL, decodeSamples, verifier) != 0) {
+        fprintf(stderr, "Error: Failed to start verification thread\n");
+        freeTapeVerifier(verifier);
+        return NULL;
+    }
+    verifier->thread_started = true;
+    return verifier;
+}
+
+const WavSink* getTapeVerifierSink(TapeVerifier *verifier) {
+    return &verifier->sink;
+}
+
+// Let the thread decode what is queued and end
+static void stopDecoding(TapeVerifier *verifier) {
+    if (!verifier->thread_started) {
+        return;
+    }
+    pthread_mutex_lock(&verifier->lock);
+    verifier->closing = true;
+    pthread_cond_broadcast(&verifier->changed);
+    pthread_mutex_unlock(&verifier->lock);
+    pthread_join(verifier->thread, NULL);
+    verifier->thread_started = false;
+}
+
+bool finishTapeVerifier(TapeVerifier *verifier, TapeVerifyResult *result) {
+    stopDecoding(verifier);
+    if (verifier->failed || !finishTapeDecoder(verifier->decoder)) {
+        fprintf(stderr, "Error: Verification decoder failed\n");
+        return false;
+    }
+
+    // Blocks the audio never got to
+    if (verifier->blocks_decoded < verifier->block_count) {
+        const ExpectedBlock *block = &verifier->blocks[verifier->blocks_decoded];
+        recordDifference(verifier, VERIFY_BLOCK_MISSING, block, 0,
+                         block->size > 0 ? verifier->expected[block->offset] : -1, -1,
+                         block->start_sample);
+    }
+    *result = verifier->result;
+    result->blocks_expected = verifier->block_count;
+    result->blocks_decoded = verifier->blocks_decoded;
+    return true;
+}
+
+void freeTapeVerifier(TapeVerifier *verifier) {
+    if (!verifier) {
+        return;
+    }
+    stopDecoding(verifier);
+    for (size_t i = 0; i < verifier->queue_count; i++) {
+        free(verifier->queue[(verifier->queue_head + i) % QUEUE_DEPTH].data);
+    }
+    freeTapeDecoder(verifier->decoder);
+    free(verifier->expected);
+    free(verifier->blocks);
+    pthread_cond_destroy(&verifier->changed);
+    pthread_mutex_destroy(&verifier->lock);
+    free(verifier);
+}
+
+const char* getTapeVerifyStatusString(TapeVerifyStatus status) {
+    switch (status) {
+        case VERIFY_MATCH: return "match";
+        case VERIFY_BYTE_DIFFERS: return "byte differs";
+        case VERIFY_BLOCK_SHORT: return "block cut short";
+        case VERIFY_BLOCK_LONG: return "block too long";
+        case VERIFY_BLOCK_MISSING: return "block missing";
+        case VERIFY_EXTRA_BLOCK: return "extra block";
+        default: return "unknown";
+    }
+}
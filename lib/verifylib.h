@@ -0,0 +1,72 @@
+#ifndef VERIFYLIB_H
+#define VERIFYLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "caslib.h"
+#include "wavlib.h"
+
+// =============================================================================
+// Round-Trip Verification (CAS → WAV → CAS)
+// =============================================================================
+//
+// Proves a conversion decodes back to the bytes it was made from. The
+// verifier is a WavSink for WaveformConfig.sample_tap: every buffer of
+// samples the writer flushes is copied to a queue and decoded by the
+// verifier's own thread while the next buffer renders, so checking costs
+// little more than the decoding that overlaps with it.
+//
+// Each decoded block is compared with the block the tape should hold at
+// that place: a file header (type marker and name), or a data block (the
+// 6-byte address header of a binary file's first block, then its bytes).
+// The first difference is kept, with the sample where that byte was
+// rendered: where the tape layout puts the block, plus the framed lengths
+// of the bytes before it.
+//
+// =============================================================================
+
+typedef enum {
+    VERIFY_MATCH,            // Every block decoded back to its bytes
+    VERIFY_BYTE_DIFFERS,     // A byte decoded to another value
+    VERIFY_BLOCK_SHORT,      // A block ended before its last byte
+    VERIFY_BLOCK_LONG,       // A block decoded with bytes after its end
+    VERIFY_BLOCK_MISSING,    // A block was not found in the audio
+    VERIFY_EXTRA_BLOCK       // The audio holds a block the tape does not
+} TapeVerifyStatus;
+
+typedef struct {
+    TapeVerifyStatus status;
+    size_t blocks_expected;
+    size_t blocks_decoded;
+
+    // First difference (status other than VERIFY_MATCH)
+    size_t file_index;       // File in the container (file_count: after the last)
+    bool header_block;       // The file header block, else data block block_index
+    size_t block_index;
+    size_t byte_offset;      // Offset in the block
+    int expected;            // Byte on the tape (-1: after the block's end)
+    int found;               // Byte decoded (-1: none)
+    uint64_t sample;         // Sample where the byte was rendered
+} TapeVerifyResult;
+
+typedef struct TapeVerifier TapeVerifier;
+
+// Verifier for the audio of container rendered with config (the container
+// must outlive it). Starts the decoding thread. Returns NULL on error
+TapeVerifier* createTapeVerifier(const cas_Container *container, const WaveformConfig *config);
+
+// Sink taking the rendered samples in order, 8-bit unsigned mono as
+// convertContainerToWavFile() writes them; set it as config->sample_tap
+const WavSink* getTapeVerifierSink(TapeVerifier *verifier);
+
+// Wait for every sample written to be decoded and compare the end of the
+// tape. Returns false (after printing an error) if verification could not
+// run; result holds the outcome otherwise
+bool finishTapeVerifier(TapeVerifier *verifier, TapeVerifyResult *result);
+
+void freeTapeVerifier(TapeVerifier *verifier);
+
+const char* getTapeVerifyStatusString(TapeVerifyStatus status);
+
+#endif // VERIFYLIB_H
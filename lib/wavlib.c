@@ -112,7 +112,11 @@ WaveformConfig createDefaultWaveform(void) {
         .short_silence = SILENCE_SHORT_HEADER, // 1s before data blocks
         .enable_lowpass = false,     // Disabled by default for backward compatibility
         .lowpass_cutoff_hz = 6000,   // Sensible default: above 4800 Hz max signal
-        .enable_markers = false      // Disabled by default
+        .enable_markers = false,     // Disabled by default
+        .output_buffer_size = 0,     // WAV_DEFAULT_BUFFER_SIZE
+        .render_threads = 1,         // Single-threaded
+        .map_output = false,         // Buffered stdio writes
+        .sample_tap = NULL           // No second consumer of the samples
     };
     return config;
 }
@@ -219,7 +223,8 @@ void freeMarkerList(MarkerList *list) {
 // Helper: Add marker if markers are enabled
 static inline void addMarkerIfEnabled(WavWriter *writer, MarkerCategory category, 
                                       const char *description) {
-    if (writer && writer->markers) {
+    // Stream and mapped-file markers were fixed when the header was written
+    if (writer && writer->markers && !writer->streaming && !writer->mapping) {
         addMarker(writer->markers, writer->sample_count, category, description);
     }
 }
@@ -241,6 +246,41 @@ bool enableMarkers(WavWriter *writer) {
 // WAV File Management
 // =============================================================================
 
+// Write the RIFF, fmt and data chunk headers (44 bytes)
+// Sizes are placeholders for files patched on close, final values for streams
+static bool writeWavHeader(FILE *file, const WavFormat *format,
+                           uint32_t data_size, uint32_t riff_chunk_size) {
+    WavRiffHeader riff = {
+        .riff = {'R', 'I', 'F', 'F'},
+        .file_size = riff_chunk_size,
+        .wave = {'W', 'A', 'V', 'E'}
+    };
+    
+    WavFmtChunk fmt = {
+        .fmt = {'f', 'm', 't', ' '},
+        .chunk_size = 16,
+        .audio_format = 1,  // PCM
+        .num_channels = format->channels,
+        .sample_rate = format->sample_rate,
+        .byte_rate = format->sample_rate * format->channels * format->bits_per_sample / 8,
+        .block_align = format->channels * format->bits_per_sample / 8,
+        .bits_per_sample = format->bits_per_sample
+    };
+    
+    WavDataChunk data = {
+        .data = {'d', 'a', 't', 'a'},
+        .data_size = data_size
+    };
+    
+    if (fwrite(&riff, sizeof(riff), 1, file) != 1 ||
+        fwrite(&fmt, sizeof(fmt), 1, file) != 1 ||
+        fwrite(&data, sizeof(data), 1, file) != 1) {
+        fprintf(stderr, "Error: Failed to write WAV headers\n");
+        return false;
+    }
+    return true;
+}
+
 WavWriter* createWavFile(const char *filename, const WavFormat *format) {
     if (!filename || !format) {
         fprintf(stderr, "Error: Invalid parameters to createWavFile\n");
@@ -272,35 +312,23 @@ WavWriter* createWavFile(const char *filename, const WavFormat *format) {
     writer->sample_count = 0;
     writer->lowpass_state = 128.0;  // Initialize to 8-bit center value
     writer->markers = NULL;          // No markers by default (enabled later if needed)
+    writer->cache = NULL;            // No waveform cache by default
+    writer->owned_cache = NULL;
+    writer->buffer = NULL;
+    writer->buffer_size = 0;
+    writer->buffer_used = 0;
+    writer->streaming = false;
+    writer->stream_samples = 0;
+    writer->close_stream = false;
+    writer->mapping = NULL;
+    writer->mapping_size = 0;
+    writer->sink = (WavSink){0};
+    writer->to_sink = false;
+    writer->tap = (WavSink){0};
+    writer->to_tap = false;
     
     // Write WAV headers (with placeholder sizes - will update on close)
-    WavRiffHeader riff = {
-        .riff = {'R', 'I', 'F', 'F'},
-        .file_size = 0,  // Will update on close
-        .wave = {'W', 'A', 'V', 'E'}
-    };
-    
-    WavFmtChunk fmt = {
-        .fmt = {'f', 'm', 't', ' '},
-        .chunk_size = 16,
-        .audio_format = 1,  // PCM
-        .num_channels = format->channels,
-        .sample_rate = format->sample_rate,
-        .byte_rate = format->sample_rate * format->channels * format->bits_per_sample / 8,
-        .block_align = format->channels * format->bits_per_sample / 8,
-        .bits_per_sample = format->bits_per_sample
-    };
-    
-    WavDataChunk data = {
-        .data = {'d', 'a', 't', 'a'},
-        .data_size = 0  // Will update on close
-    };
-    
-    // Write headers
-    if (fwrite(&riff, sizeof(riff), 1, writer->file) != 1 ||
-        fwrite(&fmt, sizeof(fmt), 1, writer->file) != 1 ||
-        fwrite(&data, sizeof(data), 1, writer->file) != 1) {
-        fprintf(stderr, "Error: Failed to write WAV headers\n");
+    if (!writeWavHeader(writer->file, format, 0, 0)) {
         fclose(writer->file);
         free(writer);
         return NULL;
@@ -309,6 +337,13 @@ WavWriter* createWavFile(const char *filename, const WavFormat *format) {
     // Save position of data chunk size field for later update
     writer->data_chunk_pos = sizeof(WavRiffHeader) + sizeof(WavFmtChunk) + 4;
     
+    // Allocate output buffer
+    if (!setWavBufferSize(writer, WAV_DEFAULT_BUFFER_SIZE)) {
+        fclose(writer->file);
+        free(writer);
+        return NULL;
+    }
+    
     return writer;
 }
 
@@ -316,6 +351,26 @@ WavWriter* createWavFile(const char *filename, const WavFormat *format) {
 // Cue Chunk Writing
 // =============================================================================
 
+// Size of one labl sub-chunk: header (12) + text with null, padded to even
+static size_t labelChunkSize(const char *text) {
+    size_t text_len = strlen(text) + 1;  // "desc\0"
+    return 12 + ((text_len + 1) & ~1);
+}
+
+// Total size of the cue and LIST/adtl chunks written for a marker list
+static size_t markerChunksSize(const MarkerList *markers) {
+    if (!markers || markers->count == 0) {
+        return 0;
+    }
+    
+    size_t size = 12 + markers->count * 24;  // cue header + cue points
+    size += 12;                              // LIST header + "adtl"
+    for (size_t i = 0; i < markers->count; i++) {
+        size += labelChunkSize(markers->markers[i].description);
+    }
+    return size;
+}
+
 // Write cue chunk with marker positions
 static bool writeCueChunk(FILE *file, const MarkerList *markers) {
     if (!file || !markers || markers->count == 0) {
@@ -357,14 +412,11 @@ static bool writeAdtlChunk(FILE *file, const MarkerList *markers) {
     }
     
     // Calculate total size of all labels
+    // Each label chunk: "labl" (4) + size (4) + cue_id (4) + text (padded to even)
     uint32_t labels_size = 0;
     for (size_t i = 0; i < markers->count; i++) {
         // Use description directly without category prefix
-        size_t text_len = strlen(markers->markers[i].description) + 1; // "desc\0"
-        
-        // Each label chunk: "labl" (4) + size (4) + cue_id (4) + text (padded to even)
-        size_t label_chunk_size = 12 + ((text_len + 1) & ~1);  // Pad to even
-        labels_size += label_chunk_size;
+        labels_size += labelChunkSize(markers->markers[i].description);
     }
     
     // Write LIST chunk header
@@ -404,15 +456,415 @@ static bool writeAdtlChunk(FILE *file, const MarkerList *markers) {
     return true;
 }
 
+// =============================================================================
+// WAV Streaming - Pre-sized Headers
+// =============================================================================
+
+WavWriter* createWavStream(FILE *stream, const WavFormat *format,
+                           size_t total_samples, MarkerList *markers) {
+    if (!stream || !format) {
+        fprintf(stderr, "Error: Invalid parameters to createWavStream\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    if (!validateWavFormat(format)) {
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    // Sizes are final: nothing can be patched once bytes are in the pipe
+    size_t data_size = total_samples * (format->bits_per_sample / 8);
+    size_t riff_chunk_size = 36 + data_size + markerChunksSize(markers);
+    if (riff_chunk_size > UINT32_MAX) {
+        fprintf(stderr, "Error: Audio too long for a WAV stream\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    WavWriter *writer = calloc(1, sizeof(WavWriter));
+    if (!writer) {
+        fprintf(stderr, "Error: Failed to allocate WavWriter\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    writer->file = stream;
+    writer->format = *format;
+    writer->lowpass_state = 128.0;
+    writer->markers = markers;
+    writer->streaming = true;
+    writer->stream_samples = total_samples;
+    writer->data_chunk_pos = sizeof(WavRiffHeader) + sizeof(WavFmtChunk) + 4;
+    
+    if (!writeWavHeader(stream, format, (uint32_t)data_size, (uint32_t)riff_chunk_size) ||
+        !setWavBufferSize(writer, WAV_DEFAULT_BUFFER_SIZE)) {
+        freeMarkerList(markers);
+        free(writer);
+        return NULL;
+    }
+    
+    return writer;
+}
+
+// =============================================================================
+// Memory-Mapped Output - Preallocated Files
+// =============================================================================
+//
+// The tape layout gives the exact file size before the first sample, so
+// the file can be preallocated in one piece (no fragmentation from
+// appending) and mapped: the encoder renders samples straight into the
+// page cache, and the header and marker chunks are written in place
+// through memory streams over the mapping instead of patched by seeking.
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+
+// Size of the RIFF, fmt and data chunk headers before the first sample
+#define WAV_HEADER_SIZE (sizeof(WavRiffHeader) + sizeof(WavFmtChunk) + sizeof(WavDataChunk))
+
+// Unmap, close and free a mapped writer (any step may be missing)
+static void releaseMappedWavFile(WavWriter *writer) {
+    if (writer->mapping) {
+        munmap(writer->mapping, writer->mapping_size);
+    }
+    if (writer->file) {
+        fclose(writer->file);
+    }
+    freeMarkerList(writer->markers);
+    freeWaveformCache(writer->owned_cache);
+    free(writer);
+}
+
+// Reserve size bytes for the whole file on disk
+// Filesystems that cannot preallocate get a sparse file of the same size
+static int preallocateFile(int fd, size_t size) {
+    int err = posix_fallocate(fd, 0, (off_t)size);
+    if (err == EINVAL || err == EOPNOTSUPP) {
+        err = (ftruncate(fd, (off_t)size) == 0) ? 0 : errno;
+    }
+    return err;
+}
+
+// Write the final header into dest (WAV_HEADER_SIZE bytes)
+static bool renderWavHeader(uint8_t *dest, const WavFormat *format,
+                            uint32_t data_size, uint32_t riff_chunk_size) {
+    FILE *header = fmemopen(dest, WAV_HEADER_SIZE, "r+");
+    if (!header) {
+        fprintf(stderr, "Error: Failed to write WAV headers\n");
+        return false;
+    }
+    bool ok = writeWavHeader(header, format, data_size, riff_chunk_size);
+    return (fclose(header) == 0) && ok;
+}
+
+// Write the cue and adtl chunks into dest (markerChunksSize() bytes)
+static bool renderMarkerChunks(uint8_t *dest, size_t size, const MarkerList *markers) {
+    FILE *chunks = fmemopen(dest, size, "r+");
+    bool ok = chunks && writeCueChunk(chunks, markers) && writeAdtlChunk(chunks, markers);
+    if (chunks && fclose(chunks) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write marker chunks\n");
+    }
+    return ok;
+}
+
+WavWriter* createMappedWavFile(const char *filename, const WavFormat *format,
+                               size_t total_samples, MarkerList *markers) {
+    if (!filename || !format) {
+        fprintf(stderr, "Error: Invalid parameters to createMappedWavFile\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    if (!validateWavFormat(format)) {
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    size_t data_size = total_samples * (format->bits_per_sample / 8);
+    size_t riff_chunk_size = 36 + data_size + markerChunksSize(markers);
+    if (riff_chunk_size > UINT32_MAX - 8) {
+        fprintf(stderr, "Error: Audio too long for a WAV file\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    size_t file_size = riff_chunk_size + 8;
+    
+    WavWriter *writer = calloc(1, sizeof(WavWriter));
+    if (!writer) {
+        fprintf(stderr, "Error: Failed to allocate WavWriter\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    writer->format = *format;
+    writer->lowpass_state = 128.0;
+    writer->markers = markers;
+    writer->stream_samples = total_samples;
+    writer->data_chunk_pos = sizeof(WavRiffHeader) + sizeof(WavFmtChunk) + 4;
+    
+    // A shared writable mapping needs the file open for reading too
+    writer->file = fopen(filename, "w+b");
+    if (!writer->file) {
+        fprintf(stderr, "Error: Cannot create file '%s'\n", filename);
+        releaseMappedWavFile(writer);
+        return NULL;
+    }
+    
+    int fd = fileno(writer->file);
+    int err = preallocateFile(fd, file_size);
+    if (err != 0) {
+        fprintf(stderr, "Error: Cannot allocate %zu bytes for '%s': %s\n",
+                file_size, filename, strerror(err));
+        releaseMappedWavFile(writer);
+        return NULL;
+    }
+    
+    void *mapping = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map '%s': %s\n", filename, strerror(errno));
+        releaseMappedWavFile(writer);
+        return NULL;
+    }
+    writer->mapping = mapping;
+    writer->mapping_size = file_size;
+    
+    // The data chunk is the output buffer: samples land in their final place
+    writer->buffer = writer->mapping + WAV_HEADER_SIZE;
+    writer->buffer_size = data_size;
+    
+    if (!renderWavHeader(writer->mapping, format, (uint32_t)data_size, (uint32_t)riff_chunk_size)) {
+        releaseMappedWavFile(writer);
+        return NULL;
+    }
+    
+    return writer;
+}
+
+// A mapped file holds exactly the samples declared when it was created
+static bool reportMappedOverflow(const WavWriter *writer) {
+    fprintf(stderr, "Error: More samples than the %zu declared for the mapped WAV file\n",
+            writer->stream_samples);
+    return false;
+}
+
+// Finish a file created with createMappedWavFile(): the header is already
+// final, the marker chunks fill the space reserved after the samples
+static bool closeMappedWavFile(WavWriter *writer) {
+    bool ok = true;
+    if (writer->sample_count != writer->stream_samples) {
+        fprintf(stderr, "Error: Wrote %zu samples but the WAV header declares %zu\n",
+                writer->sample_count, writer->stream_samples);
+        ok = false;
+    }
+    
+    size_t chunks_offset = WAV_HEADER_SIZE + writer->buffer_size;
+    size_t chunks_size = writer->mapping_size - chunks_offset;
+    if (ok && chunks_size > 0) {
+        ok = renderMarkerChunks(writer->mapping + chunks_offset, chunks_size, writer->markers);
+    }
+    
+    if (munmap(writer->mapping, writer->mapping_size) != 0) {
+        ok = false;
+    }
+    writer->mapping = NULL;
+    if (fclose(writer->file) != 0) {
+        ok = false;
+    }
+    writer->file = NULL;
+    
+    releaseMappedWavFile(writer);
+    return ok;
+}
+
+// =============================================================================
+// WAV Sinks - Output Without Files
+// =============================================================================
+//
+// A sink writer is a stream writer whose bytes go to a callback: the
+// header is rendered with its final sizes before the first sample, every
+// buffer flush is one sink write and the marker chunks follow on close.
+
+WavWriter* createWavSinkWriter(const WavSink *sink, const WavFormat *format,
+                               size_t total_samples, MarkerList *markers) {
+    if (!sink || !sink->write || !format) {
+        fprintf(stderr, "Error: Invalid parameters to createWavSinkWriter\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    if (!validateWavFormat(format)) {
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    size_t data_size = total_samples * (format->bits_per_sample / 8);
+    size_t riff_chunk_size = 36 + data_size + markerChunksSize(markers);
+    if (riff_chunk_size > UINT32_MAX) {
+        fprintf(stderr, "Error: Audio too long for a WAV stream\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    WavWriter *writer = calloc(1, sizeof(WavWriter));
+    if (!writer) {
+        fprintf(stderr, "Error: Failed to allocate WavWriter\n");
+        freeMarkerList(markers);
+        return NULL;
+    }
+    
+    writer->format = *format;
+    writer->lowpass_state = 128.0;
+    writer->markers = markers;
+    writer->streaming = true;
+    writer->stream_samples = total_samples;
+    writer->data_chunk_pos = sizeof(WavRiffHeader) + sizeof(WavFmtChunk) + 4;
+    writer->sink = *sink;
+    writer->to_sink = true;
+    
+    uint8_t header[WAV_HEADER_SIZE];
+    bool ok = sink->samples_only ||
+              (renderWavHeader(header, format, (uint32_t)data_size, (uint32_t)riff_chunk_size) &&
+               sink->write(sink->context, header, sizeof(header)));
+    if (!ok || !setWavBufferSize(writer, WAV_DEFAULT_BUFFER_SIZE)) {
+        freeMarkerList(markers);
+        free(writer->buffer);
+        free(writer);
+        return NULL;
+    }
+    
+    return writer;
+}
+
+// Append to a WavBuffer, doubling its capacity as it fills
+static bool writeToBuffer(void *context, const uint8_t *data, size_t size) {
+    WavBuffer *buffer = context;
+    if (size > buffer->capacity - buffer->size) {
+        size_t capacity = buffer->capacity ? buffer->capacity : WAV_DEFAULT_BUFFER_SIZE;
+        while (capacity - buffer->size < size) {
+            capacity *= 2;
+        }
+        uint8_t *grown = realloc(buffer->data, capacity);
+        if (!grown) {
+            fprintf(stderr, "Error: Failed to allocate %zu bytes for WAV output\n", capacity);
+            return false;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return true;
+}
+
+WavSink createWavBufferSink(WavBuffer *buffer) {
+    WavSink sink = {
+        .write = writeToBuffer,
+        .context = buffer,
+        .samples_only = false
+    };
+    return sink;
+}
+
+void freeWavBuffer(WavBuffer *buffer) {
+    if (buffer) {
+        free(buffer->data);
+        buffer->data = NULL;
+        buffer->size = 0;
+        buffer->capacity = 0;
+    }
+}
+
+// Write everything, across short writes and signals
+static bool writeToFd(void *context, const uint8_t *data, size_t size) {
+    int fd = (int)(intptr_t)context;
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: Failed to write WAV output: %s\n", strerror(errno));
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+WavSink createWavFdSink(int fd) {
+    WavSink sink = {
+        .write = writeToFd,
+        .context = (void *)(intptr_t)fd,
+        .samples_only = false
+    };
+    return sink;
+}
+
 // =============================================================================
 // WAV File Closing
 // =============================================================================
 
+// Finish a stream opened with createWavStream() (stream is left open) or
+// a sink writer
+static bool closeWavStream(WavWriter *writer) {
+    bool ok = true;
+    if (writer->sample_count != writer->stream_samples) {
+        fprintf(stderr, "Error: Streamed %zu samples but the WAV header declares %zu\n",
+                writer->sample_count, writer->stream_samples);
+        ok = false;
+    }
+    
+    size_t chunks_size = markerChunksSize(writer->markers);
+    if (ok && chunks_size > 0 && writer->to_sink && !writer->sink.samples_only) {
+        uint8_t *chunks = malloc(chunks_size);
+        ok = chunks && renderMarkerChunks(chunks, chunks_size, writer->markers) &&
+             writer->sink.write(writer->sink.context, chunks, chunks_size);
+        free(chunks);
+    } else if (ok && chunks_size > 0 && !writer->to_sink) {
+        ok = writeCueChunk(writer->file, writer->markers) &&
+             writeAdtlChunk(writer->file, writer->markers);
+        if (!ok) {
+            fprintf(stderr, "Error: Failed to write marker chunks\n");
+        }
+    }
+    if (writer->file && fflush(writer->file) != 0) {
+        ok = false;
+    }
+    if (writer->close_stream && fclose(writer->file) != 0) {
+        ok = false;
+    }
+    
+    freeMarkerList(writer->markers);
+    freeWaveformCache(writer->owned_cache);
+    free(writer->buffer);
+    free(writer);
+    return ok;
+}
+
 bool closeWavFile(WavWriter *writer) {
-    if (!writer || !writer->file) {
+    if (!writer || (!writer->file && !writer->to_sink)) {
         return false;
     }
     
+    // Mapped files were sized up front and written in place
+    if (writer->mapping) {
+        return closeMappedWavFile(writer);
+    }
+    
+    // Write out any samples still in the buffer
+    bool flushed = flushWavFile(writer);
+    
+    // Streams were sized up front: append marker chunks, never seek
+    if (writer->streaming) {
+        return closeWavStream(writer) && flushed;
+    }
+    
     // Calculate data chunk size
     size_t bytes_per_sample = writer->format.bits_per_sample / 8;
     uint32_t data_size = writer->sample_count * bytes_per_sample;
@@ -463,58 +915,182 @@ bool closeWavFile(WavWriter *writer) {
         freeMarkerList(writer->markers);
     }
     
+    // Clean up waveform cache and output buffer
+    freeWaveformCache(writer->owned_cache);
+    free(writer->buffer);
+    
     // Close and free
     fclose(writer->file);
     free(writer);
     
-    return true;
+    return flushed;
 }
 
-bool writeSamples(WavWriter *writer, const uint8_t *samples, size_t count) {
-    if (!writer || !writer->file || !samples) {
+bool flushWavFile(WavWriter *writer) {
+    if (!writer || (!writer->file && !writer->to_sink)) {
         return false;
     }
     
-    if (count == 0) {
+    // Samples written to a mapping are already in the file
+    if (writer->mapping || writer->buffer_used == 0) {
         return true;
     }
     
-    // Write samples
-    if (fwrite(samples, 1, count, writer->file) != count) {
+    size_t pending = writer->buffer_used;
+    writer->buffer_used = 0;
+    if (writer->to_tap && !writer->tap.write(writer->tap.context, writer->buffer, pending)) {
+        return false;
+    }
+    if (writer->to_sink) {
+        return writer->sink.write(writer->sink.context, writer->buffer, pending);
+    }
+    if (fwrite(writer->buffer, 1, pending, writer->file) != pending) {
         fprintf(stderr, "Error: Failed to write samples to WAV file\n");
         return false;
     }
     
-    writer->sample_count += count;
+    // Hand each buffer to the reader on the other end of a pipe right away
+    if (writer->streaming && fflush(writer->file) != 0) {
+        fprintf(stderr, "Error: Failed to write samples to WAV stream\n");
+        return false;
+    }
     return true;
 }
 
-// =============================================================================
-// MSX Tape Structure
-// =============================================================================
+bool tapWavSamples(WavWriter *writer, const WavSink *tap) {
+    if (!writer || !tap || !tap->write) {
+        return false;
+    }
+    if (writer->mapping) {
+        fprintf(stderr, "Error: Samples of a mapped WAV file cannot be tapped\n");
+        return false;
+    }
+    writer->tap = *tap;
+    writer->to_tap = true;
+    return true;
+}
 
-bool writeSilence(WavWriter *writer, float seconds) {
-    if (!writer || seconds < 0) {
+bool setWavBufferSize(WavWriter *writer, size_t size) {
+    if (!writer) {
         return false;
     }
+    if (writer->mapping) {
+        return true;  // Samples go straight into the mapped file
+    }
     
-    // Add marker before silence starts
-    char desc[256];
-    snprintf(desc, sizeof(desc), "Silence (%.1fs)", seconds);
-    addMarkerIfEnabled(writer, MARKER_DETAIL, desc);
+    if (size < WAV_MIN_BUFFER_SIZE) {
+        size = WAV_MIN_BUFFER_SIZE;
+    }
+    if (size == writer->buffer_size) {
+        return true;
+    }
     
-    size_t num_samples = (size_t)(writer->format.sample_rate * seconds);
-    uint8_t silence_value = (writer->format.bits_per_sample == 8) ? 128 : 0;
+    // Pending samples must reach the file before the buffer is replaced
+    if (!flushWavFile(writer)) {
+        return false;
+    }
     
-    // Write silence in chunks
-    uint8_t buffer[4096];
-    memset(buffer, silence_value, sizeof(buffer));
+    void *buffer = NULL;
+    if (posix_memalign(&buffer, WAV_BUFFER_ALIGNMENT, size) != 0) {
+        fprintf(stderr, "Error: Failed to allocate %zu byte output buffer\n", size);
+        return false;
+    }
     
-    while (num_samples > 0) {
-        size_t chunk = (num_samples > sizeof(buffer)) ? sizeof(buffer) : num_samples;
-        if (!writeSamples(writer, buffer, chunk)) {
-            return false;
+    free(writer->buffer);
+    writer->buffer = buffer;
+    writer->buffer_size = size;
+    return true;
+}
+
+// Get space for count samples at the end of the output buffer
+// Flushes when full and grows the buffer if count exceeds its capacity
+// The samples count once commitSamples() is called
+static uint8_t* reserveSamples(WavWriter *writer, size_t count) {
+    if (writer->buffer_used + count > writer->buffer_size) {
+        if (writer->mapping) {
+            reportMappedOverflow(writer);
+            return NULL;
+        }
+        if (!flushWavFile(writer)) {
+            return NULL;
+        }
+        if (count > writer->buffer_size && !setWavBufferSize(writer, count)) {
+            return NULL;
+        }
+    }
+    return writer->buffer + writer->buffer_used;
+}
+
+// Account for count samples written into reserved buffer space
+static inline void commitSamples(WavWriter *writer, size_t count) {
+    writer->buffer_used += count;
+    writer->sample_count += count;
+}
+
+bool writeSamples(WavWriter *writer, const uint8_t *samples, size_t count) {
+    if (!writer || (!writer->file && !writer->to_sink) || !samples) {
+        return false;
+    }
+    
+    // Copy samples into the output buffer, flushing whenever it fills
+    while (count > 0) {
+        size_t space = writer->buffer_size - writer->buffer_used;
+        if (space == 0) {
+            if (writer->mapping) {
+                return reportMappedOverflow(writer);
+            }
+            if (!flushWavFile(writer)) {
+                return false;
+            }
+            space = writer->buffer_size;
+        }
+        
+        size_t chunk = (count < space) ? count : space;
+        memcpy(writer->buffer + writer->buffer_used, samples, chunk);
+        commitSamples(writer, chunk);
+        samples += chunk;
+        count -= chunk;
+    }
+    
+    return true;
+}
+
+// =============================================================================
+// MSX Tape Structure
+// =============================================================================
+
+// Number of samples written for a silence of the given duration
+static size_t silenceSampleCount(uint32_t sample_rate, float seconds) {
+    return (size_t)(sample_rate * seconds);
+}
+
+// Marker description for a silence segment
+static void formatSilenceMarker(char *desc, size_t size, float seconds) {
+    snprintf(desc, size, "Silence (%.1fs)", seconds);
+}
+
+bool writeSilence(WavWriter *writer, float seconds) {
+    if (!writer || seconds < 0) {
+        return false;
+    }
+    
+    // Add marker before silence starts
+    char desc[256];
+    formatSilenceMarker(desc, sizeof(desc), seconds);
+    addMarkerIfEnabled(writer, MARKER_DETAIL, desc);
+    
+    size_t num_samples = silenceSampleCount(writer->format.sample_rate, seconds);
+    uint8_t silence_value = (writer->format.bits_per_sample == 8) ? 128 : 0;
+    
+    // Fill the output buffer directly, one buffer-sized chunk at a time
+    while (num_samples > 0) {
+        size_t chunk = (num_samples > writer->buffer_size) ? writer->buffer_size : num_samples;
+        uint8_t *dest = reserveSamples(writer, chunk);
+        if (!dest) {
+            return false;
         }
+        memset(dest, silence_value, chunk);
+        commitSamples(writer, chunk);
         num_samples -= chunk;
     }
     
@@ -572,28 +1148,8 @@ void applyLowPassFilter(uint8_t *samples, size_t count,
 // Waveform Generation - Pulse Primitives
 // =============================================================================
 
-// Generate one complete wave cycle (pulse) at specified frequency
-bool writePulse(WavWriter *writer, uint16_t frequency, const WaveformConfig *config) {
-    if (!writer || !config || frequency == 0) {
-        return false;
-    }
-    
-    // Calculate samples per complete cycle
-    size_t samples_per_cycle = config->sample_rate / frequency;
-    
-    if (samples_per_cycle == 0) {
-        fprintf(stderr, "Error: Frequency %u Hz too high for sample rate %u Hz\n", 
-                frequency, config->sample_rate);
-        return false;
-    }
-    
-    // Allocate buffer for one complete cycle
-    uint8_t *buffer = malloc(samples_per_cycle);
-    if (!buffer) {
-        fprintf(stderr, "Error: Failed to allocate pulse buffer\n");
-        return false;
-    }
-    
+// Render one complete wave cycle into buffer (samples_per_cycle samples)
+static bool renderPulse(uint8_t *buffer, size_t samples_per_cycle, const WaveformConfig *config) {
     // Generate waveform based on type
     switch (config->type) {
         case WAVE_SINE:
@@ -678,7 +1234,6 @@ bool writePulse(WavWriter *writer, uint16_t frequency, const WaveformConfig *con
             // Custom waveform: repeat user-provided samples to fill one cycle
             if (!config->custom_samples || config->custom_length == 0) {
                 fprintf(stderr, "Error: Custom waveform requires samples\n");
-                free(buffer);
                 return false;
             }
             for (size_t i = 0; i < samples_per_cycle; i++) {
@@ -690,10 +1245,96 @@ bool writePulse(WavWriter *writer, uint16_t frequency, const WaveformConfig *con
             
         default:
             fprintf(stderr, "Error: Unknown waveform type\n");
-            free(buffer);
             return false;
     }
     
+    return true;
+}
+
+// Calculate samples per complete cycle (0 if frequency is too high)
+static size_t samplesPerCycle(uint16_t frequency, const WaveformConfig *config) {
+    size_t samples_per_cycle = config->sample_rate / frequency;
+    if (samples_per_cycle == 0) {
+        fprintf(stderr, "Error: Frequency %u Hz too high for sample rate %u Hz\n", 
+                frequency, config->sample_rate);
+    }
+    return samples_per_cycle;
+}
+
+// Check whether cached cycles were rendered with the same waveform settings
+static bool cacheMatchesConfig(const WaveformCache *cache, const WaveformConfig *config) {
+    const WaveformConfig *cached = &cache->config;
+    return cached->type == config->type &&
+           cached->amplitude == config->amplitude &&
+           cached->baud_rate == config->baud_rate &&
+           cached->sample_rate == config->sample_rate &&
+           cached->trapezoid_rise_percent == config->trapezoid_rise_percent &&
+           cached->custom_samples == config->custom_samples &&
+           cached->custom_length == config->custom_length;
+}
+
+// Look up a cached cycle for frequency (NULL if not cached)
+static const uint8_t* findCachedPulse(const WavWriter *writer, uint16_t frequency,
+                                      const WaveformConfig *config, size_t *length) {
+    const WaveformCache *cache = writer->cache;
+    if (!cache || !cacheMatchesConfig(cache, config)) {
+        return NULL;
+    }
+    if (frequency == cache->config.baud_rate) {
+        *length = cache->bit0_length;
+        return cache->bit0_cycle;
+    }
+    if (frequency == cache->config.baud_rate * 2) {
+        *length = cache->bit1_length;
+        return cache->bit1_cycle;
+    }
+    return NULL;
+}
+
+// Write one rendered cycle (filtered in the output buffer if enabled)
+static bool writeCycle(WavWriter *writer, const uint8_t *cycle, size_t length,
+                       const WaveformConfig *config) {
+    uint8_t *dest = reserveSamples(writer, length);
+    if (!dest) {
+        return false;
+    }
+    
+    memcpy(dest, cycle, length);
+    if (config->enable_lowpass) {
+        applyLowPassFilter(dest, length, 
+                          writer->format.sample_rate, 
+                          config->lowpass_cutoff_hz,
+                          &writer->lowpass_state);
+    }
+    commitSamples(writer, length);
+    return true;
+}
+
+// Generate one complete wave cycle (pulse) at specified frequency
+bool writePulse(WavWriter *writer, uint16_t frequency, const WaveformConfig *config) {
+    if (!writer || !config || frequency == 0) {
+        return false;
+    }
+    
+    // Fast path: copy a pre-rendered cycle
+    size_t cached_length;
+    const uint8_t *cached = findCachedPulse(writer, frequency, config, &cached_length);
+    if (cached) {
+        return writeCycle(writer, cached, cached_length, config);
+    }
+    
+    // Calculate samples per complete cycle
+    size_t samples_per_cycle = samplesPerCycle(frequency, config);
+    if (samples_per_cycle == 0) {
+        return false;
+    }
+    
+    // Render straight into the output buffer (filtered in place below)
+    uint8_t *buffer = reserveSamples(writer, samples_per_cycle);
+    if (!buffer || !renderPulse(buffer, samples_per_cycle, config)) {
+        return false;
+    }
+    
     // Apply low-pass filter if enabled
     if (config->enable_lowpass) {
         applyLowPassFilter(buffer, samples_per_cycle, 
@@ -702,11 +1343,143 @@ bool writePulse(WavWriter *writer, uint16_t frequency, const WaveformConfig *con
                           &writer->lowpass_state);
     }
     
-    // Write the generated waveform
-    bool result = writeSamples(writer, buffer, samples_per_cycle);
-    free(buffer);
+    // Account for the generated waveform
+    commitSamples(writer, samples_per_cycle);
+    return true;
+}
+
+// =============================================================================
+// Waveform Cache
+// =============================================================================
+
+// Allocate and render one cycle at frequency
+static uint8_t* renderCachedPulse(uint16_t frequency, const WaveformConfig *config, size_t *length) {
+    size_t samples_per_cycle = samplesPerCycle(frequency, config);
+    if (samples_per_cycle == 0) {
+        return NULL;
+    }
     
-    return result;
+    uint8_t *cycle = malloc(samples_per_cycle);
+    if (!cycle) {
+        fprintf(stderr, "Error: Failed to allocate waveform cache\n");
+        return NULL;
+    }
+    if (!renderPulse(cycle, samples_per_cycle, config)) {
+        free(cycle);
+        return NULL;
+    }
+    
+    *length = samples_per_cycle;
+    return cycle;
+}
+
+// Append one bit (as pre-rendered cycles) to a byte table entry
+static uint8_t* appendCachedBit(uint8_t *dest, const WaveformCache *cache, int bit) {
+    if (bit) {
+        memcpy(dest, cache->bit1_cycle, cache->bit1_length);
+        dest += cache->bit1_length;
+        memcpy(dest, cache->bit1_cycle, cache->bit1_length);
+        return dest + cache->bit1_length;
+    }
+    memcpy(dest, cache->bit0_cycle, cache->bit0_length);
+    return dest + cache->bit0_length;
+}
+
+// Samples in one framed byte: START (0) + 8 data bits + 2 STOP (1)
+// Lengths differ per value when a 0-bit and a 1-bit have different
+// sample counts (sample rate not divisible by 2×baud_rate)
+static size_t framedByteSampleCount(uint8_t value, size_t bit0_samples, size_t bit1_samples) {
+    int ones = __builtin_popcount(value);
+    return (size_t)(1 + 8 - ones) * bit0_samples + (size_t)(ones + 2) * bit1_samples;
+}
+
+// Render all 256 framed byte waveforms into one contiguous table
+static bool buildByteTable(WaveformCache *cache) {
+    size_t bit1_samples = 2 * cache->bit1_length;
+    size_t total = 0;
+    
+    for (int value = 0; value < 256; value++) {
+        cache->byte_offset[value] = total;
+        cache->byte_length[value] = framedByteSampleCount(value, cache->bit0_length, bit1_samples);
+        total += cache->byte_length[value];
+    }
+    
+    cache->byte_samples = malloc(total);
+    if (!cache->byte_samples) {
+        fprintf(stderr, "Error: Failed to allocate byte table\n");
+        return false;
+    }
+    
+    for (int value = 0; value < 256; value++) {
+        uint8_t *dest = cache->byte_samples + cache->byte_offset[value];
+        dest = appendCachedBit(dest, cache, 0);            // START bit
+        for (int i = 0; i < 8; i++) {
+            dest = appendCachedBit(dest, cache, (value >> i) & 1);  // LSB first
+        }
+        dest = appendCachedBit(dest, cache, 1);            // STOP bits
+        appendCachedBit(dest, cache, 1);
+    }
+    
+    return true;
+}
+
+WaveformCache* createWaveformCache(const WaveformConfig *config) {
+    if (!config || config->baud_rate == 0) {
+        fprintf(stderr, "Error: Invalid parameters to createWaveformCache\n");
+        return NULL;
+    }
+    
+    WaveformCache *cache = calloc(1, sizeof(WaveformCache));
+    if (!cache) {
+        fprintf(stderr, "Error: Failed to allocate WaveformCache\n");
+        return NULL;
+    }
+    cache->config = *config;
+    
+    cache->bit0_cycle = renderCachedPulse(config->baud_rate, config, &cache->bit0_length);
+    cache->bit1_cycle = renderCachedPulse(config->baud_rate * 2, config, &cache->bit1_length);
+    if (!cache->bit0_cycle || !cache->bit1_cycle || !buildByteTable(cache)) {
+        freeWaveformCache(cache);
+        return NULL;
+    }
+    
+    return cache;
+}
+
+void freeWaveformCache(WaveformCache *cache) {
+    if (cache) {
+        free(cache->bit0_cycle);
+        free(cache->bit1_cycle);
+        free(cache->byte_samples);
+        free(cache);
+    }
+}
+
+bool enableWaveformCache(WavWriter *writer, const WaveformConfig *config) {
+    if (!writer || !config) {
+        return false;
+    }
+    
+    WaveformCache *cache = createWaveformCache(config);
+    if (!cache) {
+        return false;
+    }
+    
+    freeWaveformCache(writer->owned_cache);
+    writer->owned_cache = cache;
+    writer->cache = cache;
+    return true;
+}
+
+bool shareWaveformCache(WavWriter *writer, const WaveformCache *cache) {
+    if (!writer || !cache) {
+        return false;
+    }
+    
+    freeWaveformCache(writer->owned_cache);
+    writer->owned_cache = NULL;
+    writer->cache = cache;
+    return true;
 }
 
 // =============================================================================
@@ -747,6 +1520,13 @@ bool writeByte(WavWriter *writer, uint8_t byte, const WaveformConfig *config) {
         return false;
     }
     
+    // Fast path: the whole framed byte is one copy from the byte table
+    if (writer->cache && cacheMatchesConfig(writer->cache, config)) {
+        const WaveformCache *cache = writer->cache;
+        return writeCycle(writer, cache->byte_samples + cache->byte_offset[byte],
+                          cache->byte_length[byte], config);
+    }
+    
     // START bit (always 0)
     if (!writeBit0(writer, config)) {
         return false;
@@ -777,10 +1557,90 @@ bool writeByte(WavWriter *writer, uint8_t byte, const WaveformConfig *config) {
     return true;
 }
 
+bool writeBytes(WavWriter *writer, const uint8_t *data, size_t count, const WaveformConfig *config) {
+    if (!writer || !config || (!data && count > 0)) {
+        return false;
+    }
+    
+    // Table-driven encoder: check the cache once for the whole run
+    if (writer->cache && cacheMatchesConfig(writer->cache, config)) {
+        const WaveformCache *cache = writer->cache;
+        for (size_t i = 0; i < count; i++) {
+            if (!writeCycle(writer, cache->byte_samples + cache->byte_offset[data[i]],
+                            cache->byte_length[data[i]], config)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        if (!writeByte(writer, data[i], config)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // =============================================================================
 // MSX Tape Protocol - Sync/Header Sequences
 // =============================================================================
 
+// Fill length samples (a whole number of cycles) with a repeated cycle
+// One copy of the cycle is placed and then doubled in place
+// (1, 2, 4, 8... cycles) until the destination is full
+static void fillRepeatedCycle(uint8_t *dest, const uint8_t *cycle, size_t cycle_length,
+                              size_t length) {
+    memcpy(dest, cycle, cycle_length);
+    size_t filled = cycle_length;
+    while (filled < length) {
+        size_t copy = (filled < length - filled) ? filled : length - filled;
+        memcpy(dest + filled, dest, copy);
+        filled += copy;
+    }
+}
+
+// Leader generator: write cycle repeats times into the output buffer,
+// one buffer-sized chunk at a time
+static bool writeRepeatedCycle(WavWriter *writer, const uint8_t *cycle, size_t cycle_length,
+                               size_t repeats, const WaveformConfig *config) {
+    // Chunks hold whole cycles so every chunk starts in phase
+    size_t cycles_per_chunk = writer->buffer_size / cycle_length;
+    if (cycles_per_chunk == 0) {
+        cycles_per_chunk = 1;
+    }
+    
+    while (repeats > 0) {
+        size_t cycles = (repeats < cycles_per_chunk) ? repeats : cycles_per_chunk;
+        size_t length = cycles * cycle_length;
+        uint8_t *dest = reserveSamples(writer, length);
+        if (!dest) {
+            return false;
+        }
+        
+        fillRepeatedCycle(dest, cycle, cycle_length, length);
+        
+        // The filter is stateful, so it runs over the replicated samples
+        if (config->enable_lowpass) {
+            applyLowPassFilter(dest, length, 
+                              writer->format.sample_rate, 
+                              config->lowpass_cutoff_hz,
+                              &writer->lowpass_state);
+        }
+        
+        commitSamples(writer, length);
+        repeats -= cycles;
+    }
+    
+    return true;
+}
+
+// Marker description for a sync segment
+static void formatSyncMarker(char *desc, size_t size, size_t count) {
+    const char *sync_type = (count >= 4000) ? "long" : "short";
+    snprintf(desc, size, "Sync %s (%zu bits)", sync_type, count);
+}
+
 // Write sync pulses (consecutive 1-bits)
 // MSX uses: 8000 pulses for file headers, 2000 for data blocks
 bool writeSync(WavWriter *writer, size_t count, const WaveformConfig *config) {
@@ -790,18 +1650,25 @@ bool writeSync(WavWriter *writer, size_t count, const WaveformConfig *config) {
     
     // Add marker for sync start
     char desc[256];
-    const char *sync_type = (count >= 4000) ? "long" : "short";
-    snprintf(desc, sizeof(desc), "Sync %s (%zu bits)", sync_type, count);
+    formatSyncMarker(desc, sizeof(desc), count);
     addMarkerIfEnabled(writer, MARKER_DETAIL, desc);
     
-    // Write the specified number of consecutive 1-bits
-    for (size_t i = 0; i < count; i++) {
-        if (!writeBit1(writer, config)) {
-            return false;
-        }
+    // Each 1-bit is two identical cycles at 2×baud_rate, so the whole
+    // leader is one cycle replicated 2 × count times
+    if (writer->cache && cacheMatchesConfig(writer->cache, config)) {
+        return writeRepeatedCycle(writer, writer->cache->bit1_cycle,
+                                  writer->cache->bit1_length, count * 2, config);
     }
     
-    return true;
+    size_t cycle_length;
+    uint8_t *cycle = renderCachedPulse(config->baud_rate * 2, config, &cycle_length);
+    if (!cycle) {
+        return false;
+    }
+    bool result = writeRepeatedCycle(writer, cycle, cycle_length, count * 2, config);
+    free(cycle);
+    
+    return result;
 }
 
 // =============================================================================
@@ -814,148 +1681,77 @@ bool writeSync(WavWriter *writer, size_t count, const WaveformConfig *config) {
 // Helper: Write file header block (type marker + filename)
 static bool writeFileHeaderBlock(WavWriter *writer, const cas_File *file, 
                                  const WaveformConfig *config) {
-    // Write type marker (10 bytes)
-    for (int i = 0; i < 10; i++) {
-        if (!writeByte(writer, file->file_header.file_type[i], config)) {
-            return false;
-        }
-    }
-    
-    // Write filename (6 bytes)
-    for (int i = 0; i < 6; i++) {
-        if (!writeByte(writer, file->file_header.file_name[i], config)) {
-            return false;
-        }
-    }
-    
-    return true;
+    // Write type marker (10 bytes) followed by filename (6 bytes)
+    return writeBytes(writer, file->file_header.file_type, 10, config) &&
+           writeBytes(writer, file->file_header.file_name, 6, config);
 }
 
-// Helper: Write data block header (for BINARY/BASIC files)
+// Helper: Write data block header (for BINARY files)
 static bool writeDataBlockHeader(WavWriter *writer, const cas_File *file,
                                  const WaveformConfig *config) {
-    // Write load address (2 bytes, little-endian)
+    // Load, end and exec addresses (2 bytes each, little-endian)
     uint16_t load_addr = file->data_block_header.load_address;
-    if (!writeByte(writer, load_addr & 0xFF, config)) return false;
-    if (!writeByte(writer, (load_addr >> 8) & 0xFF, config)) return false;
-    
-    // Write end address (2 bytes, little-endian)
     uint16_t end_addr = file->data_block_header.end_address;
-    if (!writeByte(writer, end_addr & 0xFF, config)) return false;
-    if (!writeByte(writer, (end_addr >> 8) & 0xFF, config)) return false;
-    
-    // Write exec address (2 bytes, little-endian)
     uint16_t exec_addr = file->data_block_header.exec_address;
-    if (!writeByte(writer, exec_addr & 0xFF, config)) return false;
-    if (!writeByte(writer, (exec_addr >> 8) & 0xFF, config)) return false;
+    uint8_t header[6] = {
+        load_addr & 0xFF, (load_addr >> 8) & 0xFF,
+        end_addr & 0xFF, (end_addr >> 8) & 0xFF,
+        exec_addr & 0xFF, (exec_addr >> 8) & 0xFF
+    };
     
-    return true;
+    return writeBytes(writer, header, sizeof(header), config);
 }
 
-// Convert a complete CAS file to WAV audio format
-bool convertCasToWav(const char *cas_filename, const char *wav_filename,
-                     const WaveformConfig *config, bool verbose, double *duration_seconds) {
-    if (!cas_filename || !wav_filename || !config) {
-        fprintf(stderr, "Error: Invalid parameters to convertCasToWav\n");
-        return false;
-    }
-    
-    // Read CAS file into memory
-    FILE *cas_file = fopen(cas_filename, "rb");
-    if (!cas_file) {
-        fprintf(stderr, "Error: Cannot open CAS file '%s'\n", cas_filename);
-        return false;
-    }
-    
-    // Get file size
-    fseek(cas_file, 0, SEEK_END);
-    size_t cas_size = ftell(cas_file);
-    fseek(cas_file, 0, SEEK_SET);
-    
-    if (cas_size == 0) {
-        fprintf(stderr, "Error: CAS file is empty\n");
-        fclose(cas_file);
-        return false;
-    }
-    
-    // Allocate buffer and read file
-    uint8_t *cas_data = malloc(cas_size);
-    if (!cas_data) {
-        fprintf(stderr, "Error: Failed to allocate memory for CAS file\n");
-        fclose(cas_file);
-        return false;
-    }
-    
-    if (fread(cas_data, 1, cas_size, cas_file) != cas_size) {
-        fprintf(stderr, "Error: Failed to read CAS file\n");
-        free(cas_data);
-        fclose(cas_file);
-        return false;
-    }
-    fclose(cas_file);
-    
-    // Parse CAS container
-    cas_Container container;
-    if (!parseCasContainer(cas_data, &container, cas_size)) {
-        fprintf(stderr, "Error: Failed to parse CAS file\n");
-        free(cas_data);
-        return false;
+// Helper: Marker description for the start of a file
+static void formatFileMarker(char *desc, size_t size, const cas_File *file,
+                             size_t file_idx, size_t file_count) {
+    if (!file->is_custom) {
+        snprintf(desc, size, "File %zu/%zu: %s \"%.6s\"",
+                file_idx + 1, file_count, getFileTypeString(file),
+                (char*)file->file_header.file_name);
+    } else {
+        snprintf(desc, size, "File %zu/%zu: Custom block",
+                file_idx + 1, file_count);
     }
-    
-    if (verbose) {
-        printf("Converting '%s' to '%s'...\n", cas_filename, wav_filename);
-        printf("  Files in container: %zu\n", container.file_count);
-    }
-    
-    // Create WAV file with sample rate from config
-    WavFormat format = createDefaultWavFormat();
-    format.sample_rate = config->sample_rate;  // Use sample rate from config
-    WavWriter *writer = createWavFile(wav_filename, &format);
-    if (!writer) {
-        fprintf(stderr, "Error: Failed to create WAV file\n");
-        free(cas_data);
-        return false;
-    }
-    
-    // Enable markers if requested
-    if (config->enable_markers) {
-        if (!enableMarkers(writer)) {
-            fprintf(stderr, "Error: Failed to enable markers\n");
-            closeWavFile(writer);
-            free(cas_data);
-            return false;
-        }
-    }
-    
+}
+
+// Helper: Marker description for the start of a data block
+static void formatBlockMarker(char *desc, size_t size, const cas_File *file, size_t block_idx) {
+    snprintf(desc, size, "Data block %zu/%zu (%zu bytes)",
+            block_idx + 1, file->data_block_count, file->data_blocks[block_idx].data_size);
+}
+
+// Helper: Whether a data block is preceded by the 6-byte address header
+static bool hasDataBlockHeader(const cas_File *file, size_t block_idx) {
+    return block_idx == 0 && isBinaryFile(file->file_header.file_type);
+}
+
+// Render every file in the container through the writer, one block at a time
+// Progress goes to log (NULL for quiet)
+static bool renderContainerSerial(WavWriter *writer, const cas_Container *container,
+                                  const WaveformConfig *config, FILE *log) {
     // Process each file in the container
-    for (size_t file_idx = 0; file_idx < container.file_count; file_idx++) {
-        const cas_File *file = &container.files[file_idx];
+    for (size_t file_idx = 0; file_idx < container->file_count; file_idx++) {
+        const cas_File *file = &container->files[file_idx];
         
         // Prepare file marker for later
         char file_marker[256];
-        if (!file->is_custom) {
-            snprintf(file_marker, sizeof(file_marker), "File %zu/%zu: %s \"%.6s\"",
-                    file_idx + 1, container.file_count, getFileTypeString(file),
-                    (char*)file->file_header.file_name);
-        } else {
-            snprintf(file_marker, sizeof(file_marker), "File %zu/%zu: Custom block",
-                    file_idx + 1, container.file_count);
-        }
+        formatFileMarker(file_marker, sizeof(file_marker), file, file_idx, container->file_count);
         
-        if (verbose) {
-            printf("  File %zu/%zu: %s ", file_idx + 1, container.file_count,
+        if (log) {
+            fprintf(log, "  File %zu/%zu: %s ", file_idx + 1, container->file_count,
                    getFileTypeString(file));
             if (!file->is_custom) {
-                printf("\"%.6s\" ", (char*)file->file_header.file_name);
+                fprintf(log, "\"%.6s\" ", (char*)file->file_header.file_name);
             }
             size_t total_blocks = file->is_custom ? file->data_block_count : (file->data_block_count + 1);
-            printf("(%zu blocks)\n", total_blocks);
+            fprintf(log, "(%zu blocks)\n", total_blocks);
         }
         
         // BLOCK 1: File header block (only for non-custom files)
         if (!file->is_custom) {
-            if (verbose) {
-                printf("    Writing file header block...\n");
+            if (log) {
+                fprintf(log, "    Writing file header block...\n");
             }
             
             writeSilence(writer, config->long_silence);
@@ -971,11 +1767,10 @@ bool convertCasToWav(const char *cas_filename, const char *wav_filename,
             
             // STRUCTURE marker: Data block start
             char block_marker[256];
-            snprintf(block_marker, sizeof(block_marker), "Data block %zu/%zu (%zu bytes)",
-                    block_idx + 1, file->data_block_count, block->data_size);
+            formatBlockMarker(block_marker, sizeof(block_marker), file, block_idx);
             
-            if (verbose) {
-                printf("    Writing data block %zu/%zu (%zu bytes)...\n",
+            if (log) {
+                fprintf(log, "    Writing data block %zu/%zu (%zu bytes)...\n",
                        block_idx + 1, file->data_block_count, block->data_size);
             }
             
@@ -1004,26 +1799,772 @@ bool convertCasToWav(const char *cas_filename, const char *wav_filename,
             
             addMarkerIfEnabled(writer, MARKER_STRUCTURE, block_marker);
             
-            // For BINARY/BASIC files, write data block header first
-            if (block_idx == 0 && (isBinaryFile(file->file_header.file_type) ||
-                                   isBasicFile(file->file_header.file_type))) {
+            // For BINARY files, write the address header the parser split off
+            // (BASIC blocks hold all their bytes, as stored in the CAS file)
+            if (hasDataBlockHeader(file, block_idx)) {
                 writeDataBlockHeader(writer, file, config);
             }
             
-            // Write all data bytes in this block
-            for (size_t i = 0; i < block->data_size; i++) {
-                if (!writeByte(writer, block->data[i], config)) {
-                    fprintf(stderr, "Error: Failed to write data byte\n");
-                    closeWavFile(writer);
-                    free(cas_data);
-                    return false;
-                }
+            // Write all data bytes in this block (one table copy per byte)
+            if (!writeBytes(writer, block->data, block->data_size, config)) {
+                fprintf(stderr, "Error: Failed to write data byte\n");
+                return false;
             }
         }
     }
     
     // Add end marker after last block (no actual audio needed)
     addMarkerIfEnabled(writer, MARKER_DETAIL, "End of tape");
+    return true;
+}
+
+// =============================================================================
+// Parallel Rendering - Segment Jobs with Positional Writes
+// =============================================================================
+//
+// Every sample offset is known up front from the tape layout, so the tape
+// is cut into jobs (silence, sync, header and data chunks) that worker
+// threads render into private buffers and pwrite() straight to their
+// final position in the file.
+//
+// The low-pass filter carries state from one sample to the next. Each job
+// starts from a state estimated by filtering the tail of the previous
+// audible job (silence is written unfiltered and leaves the state alone).
+// After all workers finish, the real end state of every job is compared
+// against the start state the next job assumed; any job whose estimate
+// was not exact is rendered again serially, so the output is always
+// identical to the single-threaded writer.
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define PARALLEL_CHUNK_SAMPLES  (4 * 1024 * 1024)  // Target job size when splitting long blocks
+#define LOWPASS_WARMUP_SAMPLES  4096               // Samples used to estimate a job's filter state
+
+// One piece of the tape rendered by a single worker
+typedef struct {
+    TapeSegmentKind kind;
+    size_t start_sample;        // Sample offset in the data chunk
+    size_t sample_count;        // Length in samples
+    uint8_t head[16];           // Bytes encoded before data (file header or address header)
+    size_t head_length;
+    const uint8_t *data;        // Block bytes encoded by this job
+    size_t data_length;
+    double start_state;         // Filter state the job was rendered from
+    double end_state;           // Filter state after the last sample
+} RenderJob;
+
+// Shared state of a parallel render
+typedef struct {
+    RenderJob *jobs;
+    size_t count;
+    size_t capacity;
+    const WaveformCache *cache;
+    const WaveformConfig *config;
+    int fd;
+    off_t data_offset;          // File offset of the first sample
+    uint8_t *dest;              // Mapped data chunk to render into (NULL: pwrite to fd)
+    pthread_mutex_t lock;       // Guards next_job and failed
+    size_t next_job;
+    bool failed;
+} RenderPlan;
+
+// Append an empty job, growing the table as needed (NULL on failure)
+static RenderJob* appendRenderJob(RenderPlan *plan, TapeSegmentKind kind, size_t start_sample) {
+    if (plan->count >= plan->capacity) {
+        size_t new_capacity = plan->capacity ? plan->capacity * 2 : 64;
+        RenderJob *jobs = realloc(plan->jobs, new_capacity * sizeof(RenderJob));
+        if (!jobs) {
+            fprintf(stderr, "Error: Failed to allocate render jobs\n");
+            return NULL;
+        }
+        plan->jobs = jobs;
+        plan->capacity = new_capacity;
+    }
+    
+    RenderJob *job = &plan->jobs[plan->count++];
+    memset(job, 0, sizeof(*job));
+    job->kind = kind;
+    job->start_sample = start_sample;
+    return job;
+}
+
+// Byte i of the sequence a job encodes (head bytes first, then data)
+static inline uint8_t renderJobByte(const RenderJob *job, size_t i) {
+    return (i < job->head_length) ? job->head[i] : job->data[i - job->head_length];
+}
+
+// Split a data segment into jobs of about PARALLEL_CHUNK_SAMPLES each,
+// cutting only at byte boundaries
+static bool appendDataJobs(RenderPlan *plan, const TapeSegment *segment,
+                           const uint8_t *head, size_t head_length,
+                           const uint8_t *data, size_t data_length) {
+    RenderJob *job = appendRenderJob(plan, segment->kind, segment->start_sample);
+    if (!job) {
+        return false;
+    }
+    memcpy(job->head, head, head_length);
+    job->head_length = head_length;
+    job->data = data;
+    
+    size_t position = segment->start_sample;
+    for (size_t i = 0; i < head_length; i++) {
+        job->sample_count += plan->cache->byte_length[head[i]];
+    }
+    
+    for (size_t i = 0; i < data_length; i++) {
+        if (job->sample_count >= PARALLEL_CHUNK_SAMPLES) {
+            position += job->sample_count;
+            job = appendRenderJob(plan, segment->kind, position);
+            if (!job) {
+                return false;
+            }
+            job->data = data + i;
+        }
+        job->data_length++;
+        job->sample_count += plan->cache->byte_length[data[i]];
+    }
+    
+    if (position + job->sample_count != segment->start_sample + segment->sample_count) {
+        fprintf(stderr, "Error: Render jobs do not match the tape layout\n");
+        return false;
+    }
+    return true;
+}
+
+// Turn the tape layout into render jobs
+static bool buildRenderJobs(RenderPlan *plan, const TapeLayout *layout,
+                            const cas_Container *container) {
+    for (size_t i = 0; i < layout->count; i++) {
+        const TapeSegment *segment = &layout->segments[i];
+        const cas_File *file = &container->files[segment->file_index];
+        
+        if (segment->kind == SEGMENT_SILENCE || segment->kind == SEGMENT_SYNC) {
+            RenderJob *job = appendRenderJob(plan, segment->kind, segment->start_sample);
+            if (!job) {
+                return false;
+            }
+            job->sample_count = segment->sample_count;
+            continue;
+        }
+        
+        uint8_t head[16];
+        size_t head_length = 0;
+        const uint8_t *data = NULL;
+        size_t data_length = 0;
+        
+        if (segment->kind == SEGMENT_HEADER) {
+            // Type marker (10 bytes) followed by filename (6 bytes)
+            memcpy(head, file->file_header.file_type, 10);
+            memcpy(head + 10, file->file_header.file_name, 6);
+            head_length = 16;
+        } else {
+            const cas_DataBlock *block = &file->data_blocks[segment->block_index];
+            if (hasDataBlockHeader(file, segment->block_index)) {
+                const cas_DataBlockHeader *header = &file->data_block_header;
+                uint8_t address[6] = {
+                    header->load_address & 0xFF, (header->load_address >> 8) & 0xFF,
+                    header->end_address & 0xFF, (header->end_address >> 8) & 0xFF,
+                    header->exec_address & 0xFF, (header->exec_address >> 8) & 0xFF
+                };
+                memcpy(head, address, sizeof(address));
+                head_length = sizeof(address);
+            }
+            data = block->data;
+            data_length = block->data_size;
+        }
+        
+        if (!appendDataJobs(plan, segment, head, head_length, data, data_length)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// Render a job's unfiltered samples into dest (sample_count samples)
+static void renderJobSamples(const RenderJob *job, const WaveformCache *cache, uint8_t *dest) {
+    switch (job->kind) {
+        case SEGMENT_SILENCE:
+            memset(dest, 128, job->sample_count);
+            break;
+            
+        case SEGMENT_SYNC:
+            fillRepeatedCycle(dest, cache->bit1_cycle, cache->bit1_length, job->sample_count);
+            break;
+            
+        case SEGMENT_HEADER:
+        case SEGMENT_DATA:
+            for (size_t i = 0; i < job->head_length + job->data_length; i++) {
+                uint8_t value = renderJobByte(job, i);
+                memcpy(dest, cache->byte_samples + cache->byte_offset[value],
+                       cache->byte_length[value]);
+                dest += cache->byte_length[value];
+            }
+            break;
+    }
+}
+
+// Render the last count unfiltered samples of an audible job into scratch
+// Returns a pointer to the first of them
+static uint8_t* renderJobTail(const RenderJob *job, const WaveformCache *cache,
+                                    size_t count, uint8_t *scratch) {
+    if (job->kind == SEGMENT_SYNC) {
+        size_t phase = (job->sample_count - count) % cache->bit1_length;
+        for (size_t i = 0; i < count; i++) {
+            scratch[i] = cache->bit1_cycle[phase];
+            if (++phase == cache->bit1_length) {
+                phase = 0;
+            }
+        }
+        return scratch;
+    }
+    
+    // Walk back over whole bytes until they cover count samples
+    size_t end = job->head_length + job->data_length;
+    size_t first = end;
+    size_t covered = 0;
+    while (first > 0 && covered < count) {
+        covered += cache->byte_length[renderJobByte(job, --first)];
+    }
+    
+    uint8_t *dest = scratch;
+    for (size_t i = first; i < end; i++) {
+        uint8_t value = renderJobByte(job, i);
+        memcpy(dest, cache->byte_samples + cache->byte_offset[value], cache->byte_length[value]);
+        dest += cache->byte_length[value];
+    }
+    return scratch + (covered - count);
+}
+
+// Estimate the filter state at the start of a job by filtering the tail
+// of the previous audible job (exact 128.0 if there is none)
+static double estimateStartState(const RenderPlan *plan, size_t index, uint8_t *scratch) {
+    const WaveformConfig *config = plan->config;
+    double state = 128.0;
+    if (!config->enable_lowpass) {
+        return state;
+    }
+    
+    while (index > 0 && plan->jobs[index - 1].kind == SEGMENT_SILENCE) {
+        index--;
+    }
+    if (index == 0) {
+        return state;
+    }
+    
+    const RenderJob *previous = &plan->jobs[index - 1];
+    size_t count = (previous->sample_count < LOWPASS_WARMUP_SAMPLES)
+                 ? previous->sample_count : LOWPASS_WARMUP_SAMPLES;
+    uint8_t *tail = renderJobTail(previous, plan->cache, count, scratch);
+    
+    // Filtered in scratch; the samples themselves are discarded
+    applyLowPassFilter(tail, count, config->sample_rate,
+                       config->lowpass_cutoff_hz, &state);
+    return state;
+}
+
+// Render, filter and write one job starting from the given filter state
+// buffer is grown as needed and reused between jobs; with a mapped file
+// the job is rendered in place and buffer is not used
+static bool renderJob(const RenderPlan *plan, RenderJob *job, double start_state,
+                      uint8_t **buffer, size_t *buffer_size) {
+    uint8_t *samples = plan->dest ? plan->dest + job->start_sample : NULL;
+    if (!samples) {
+        if (job->sample_count > *buffer_size) {
+            uint8_t *grown = realloc(*buffer, job->sample_count);
+            if (!grown) {
+                fprintf(stderr, "Error: Failed to allocate %zu byte render buffer\n", job->sample_count);
+                return false;
+            }
+            *buffer = grown;
+            *buffer_size = job->sample_count;
+        }
+        samples = *buffer;
+    }
+    
+    renderJobSamples(job, plan->cache, samples);
+    
+    // Silence bypasses the filter, exactly like writeSilence()
+    job->start_state = start_state;
+    job->end_state = start_state;
+    if (plan->config->enable_lowpass && job->kind != SEGMENT_SILENCE) {
+        applyLowPassFilter(samples, job->sample_count, plan->config->sample_rate,
+                           plan->config->lowpass_cutoff_hz, &job->end_state);
+    }
+    
+    if (plan->dest) {
+        return true;
+    }
+    
+    // Positional write; pwrite() may write less than asked
+    size_t written = 0;
+    while (written < job->sample_count) {
+        ssize_t result = pwrite(plan->fd, samples + written, job->sample_count - written,
+                                plan->data_offset + (off_t)(job->start_sample + written));
+        if (result <= 0) {
+            fprintf(stderr, "Error: Failed to write samples to WAV file\n");
+            return false;
+        }
+        written += (size_t)result;
+    }
+    
+    return true;
+}
+
+// Worker thread: take jobs in order until none are left
+static void* renderWorker(void *arg) {
+    RenderPlan *plan = arg;
+    const WaveformCache *cache = plan->cache;
+    uint8_t *buffer = NULL;
+    size_t buffer_size = 0;
+    
+    // Warm-up tails are at most LOWPASS_WARMUP_SAMPLES plus one framed byte
+    size_t longest_byte = 11 * (cache->bit0_length + 2 * cache->bit1_length);
+    uint8_t *scratch = malloc(LOWPASS_WARMUP_SAMPLES + longest_byte);
+    bool ok = (scratch != NULL);
+    
+    while (ok) {
+        pthread_mutex_lock(&plan->lock);
+        size_t index = plan->next_job;
+        bool stop = plan->failed || index >= plan->count;
+        if (!stop) {
+            plan->next_job++;
+        }
+        pthread_mutex_unlock(&plan->lock);
+        if (stop) {
+            break;
+        }
+        
+        double state = estimateStartState(plan, index, scratch);
+        ok = renderJob(plan, &plan->jobs[index], state, &buffer, &buffer_size);
+    }
+    
+    if (!ok) {
+        pthread_mutex_lock(&plan->lock);
+        plan->failed = true;
+        pthread_mutex_unlock(&plan->lock);
+    }
+    
+    free(scratch);
+    free(buffer);
+    return NULL;
+}
+
+// Re-render, in order, every job whose assumed start state differs from
+// the actual end state of the audible job before it
+// Returns the number of jobs rendered again, or (size_t)-1 on error
+static size_t repairFilterBoundaries(RenderPlan *plan) {
+    if (!plan->config->enable_lowpass) {
+        return 0;
+    }
+    
+    uint8_t *buffer = NULL;
+    size_t buffer_size = 0;
+    size_t repaired = 0;
+    double state = 128.0;
+    
+    for (size_t i = 0; i < plan->count; i++) {
+        RenderJob *job = &plan->jobs[i];
+        if (job->kind == SEGMENT_SILENCE) {
+            continue;
+        }
+        
+        // Exact comparison: only a bit-identical state gives identical samples
+        if (job->start_state != state) {
+            if (!renderJob(plan, job, state, &buffer, &buffer_size)) {
+                free(buffer);
+                return (size_t)-1;
+            }
+            repaired++;
+        }
+        state = job->end_state;
+    }
+    
+    free(buffer);
+    return repaired;
+}
+
+// Render the container with worker threads writing at precomputed offsets
+// Progress goes to log (NULL for quiet)
+static bool renderContainerParallel(WavWriter *writer, const cas_Container *container,
+                                    const WaveformConfig *config, FILE *log) {
+    if (!writer->cache || writer->format.bits_per_sample != 8) {
+        fprintf(stderr, "Error: Parallel rendering needs the waveform cache and 8-bit output\n");
+        return false;
+    }
+    
+    TapeLayout layout;
+    if (!planTapeLayout(container, config, &layout)) {
+        return false;
+    }
+    
+    // Markers come from the layout instead of the write calls (a mapped
+    // file already has them)
+    if (writer->mapping && writer->buffer_used + layout.total_samples > writer->buffer_size) {
+        reportMappedOverflow(writer);
+        freeTapeLayout(&layout);
+        return false;
+    }
+    if (writer->markers && !writer->mapping && !addLayoutMarkers(&layout, container, config, writer->markers)) {
+        fprintf(stderr, "Error: Failed to add markers\n");
+        freeTapeLayout(&layout);
+        return false;
+    }
+    
+    // Everything written through stdio so far must be on disk before pwrite()
+    if (!flushWavFile(writer) || fflush(writer->file) != 0) {
+        freeTapeLayout(&layout);
+        return false;
+    }
+    
+    RenderPlan plan = {
+        .cache = writer->cache,
+        .config = config,
+        .fd = fileno(writer->file),
+        .data_offset = writer->data_chunk_pos + 4 + (off_t)writer->sample_count,
+        .dest = writer->mapping ? writer->buffer + writer->buffer_used : NULL
+    };
+    pthread_mutex_init(&plan.lock, NULL);
+    
+    bool ok = buildRenderJobs(&plan, &layout, container);
+    
+    size_t thread_count = config->render_threads;
+    if (thread_count > plan.count) {
+        thread_count = plan.count;
+    }
+    if (log && ok) {
+        fprintf(log, "  Rendering %zu segments as %zu jobs on %zu threads\n",
+               layout.count, plan.count, thread_count);
+    }
+    
+    pthread_t *threads = ok ? calloc(thread_count ? thread_count : 1, sizeof(pthread_t)) : NULL;
+    size_t started = 0;
+    if (ok && !threads) {
+        fprintf(stderr, "Error: Failed to allocate render threads\n");
+        ok = false;
+    }
+    
+    while (ok && started < thread_count) {
+        if (pthread_create(&threads[started], NULL, renderWorker, &plan) != 0) {
+            fprintf(stderr, "Error: Failed to start render thread\n");
+            pthread_mutex_lock(&plan.lock);
+            plan.failed = true;
+            pthread_mutex_unlock(&plan.lock);
+            ok = false;
+            break;
+        }
+        started++;
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    ok = ok && !plan.failed;
+    
+    if (ok) {
+        size_t repaired = repairFilterBoundaries(&plan);
+        ok = (repaired != (size_t)-1);
+        if (log && ok && config->enable_lowpass) {
+            fprintf(log, "  Low-pass boundaries re-rendered: %zu\n", repaired);
+        }
+    }
+    
+    if (ok && writer->mapping) {
+        commitSamples(writer, layout.total_samples);
+    } else if (ok) {
+        writer->sample_count += layout.total_samples;
+    }
+    
+    free(threads);
+    free(plan.jobs);
+    pthread_mutex_destroy(&plan.lock);
+    freeTapeLayout(&layout);
+    return ok;
+}
+
+// =============================================================================
+// Tape Synthesis - Random Access Rendering
+// =============================================================================
+//
+// Renders any stretch of the tape on demand from the render jobs of the
+// layout, so a player can synthesize audio in its callback and seek
+// without a WAV file. Output read sequentially from sample 0 is identical
+// to convertCasToWav(); after a seek the low-pass state is estimated from
+// the samples just before the target, as for parallel jobs.
+
+struct TapeSynth {
+    RenderPlan plan;            // Jobs covering the tape (never run by workers)
+    WaveformCache *cache;
+    WaveformConfig config;
+    size_t total_samples;
+    size_t position;            // Next sample to render
+    size_t job;                 // Job containing position
+    size_t byte_index;          // Byte of a header/data job containing position
+    size_t byte_offset;         // Samples already rendered from that byte
+    double lowpass_state;
+};
+
+TapeSynth* createTapeSynth(const cas_Container *container, const WaveformConfig *config,
+                           MarkerList *markers) {
+    if (!container || !config) {
+        fprintf(stderr, "Error: Invalid parameters to createTapeSynth\n");
+        return NULL;
+    }
+    
+    TapeLayout layout;
+    if (!planTapeLayout(container, config, &layout)) {
+        return NULL;
+    }
+    if (markers && !addLayoutMarkers(&layout, container, config, markers)) {
+        fprintf(stderr, "Error: Failed to add markers\n");
+        freeTapeLayout(&layout);
+        return NULL;
+    }
+    
+    TapeSynth *synth = calloc(1, sizeof(TapeSynth));
+    if (!synth) {
+        fprintf(stderr, "Error: Failed to allocate TapeSynth\n");
+        freeTapeLayout(&layout);
+        return NULL;
+    }
+    synth->config = *config;
+    synth->cache = createWaveformCache(config);
+    synth->plan.cache = synth->cache;
+    synth->plan.config = &synth->config;
+    synth->plan.fd = -1;
+    synth->total_samples = layout.total_samples;
+    synth->lowpass_state = 128.0;
+    
+    bool ok = synth->cache && buildRenderJobs(&synth->plan, &layout, container);
+    freeTapeLayout(&layout);
+    if (!ok) {
+        freeTapeSynth(synth);
+        return NULL;
+    }
+    
+    return synth;
+}
+
+void freeTapeSynth(TapeSynth *synth) {
+    if (synth) {
+        free(synth->plan.jobs);
+        freeWaveformCache(synth->cache);
+        free(synth);
+    }
+}
+
+size_t getTapeSynthLength(const TapeSynth *synth) {
+    return synth ? synth->total_samples : 0;
+}
+
+size_t getTapeSynthPosition(const TapeSynth *synth) {
+    return synth ? synth->position : 0;
+}
+
+// Move the cursor to sample without touching the filter state
+static void locateTapeSample(TapeSynth *synth, size_t sample) {
+    const RenderPlan *plan = &synth->plan;
+    
+    // Last job starting at or before sample (binary search)
+    size_t low = 0;
+    size_t high = plan->count;
+    while (high - low > 1) {
+        size_t mid = low + (high - low) / 2;
+        if (plan->jobs[mid].start_sample <= sample) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    
+    synth->position = sample;
+    synth->job = low;
+    synth->byte_index = 0;
+    synth->byte_offset = 0;
+    if (plan->count == 0) {
+        return;
+    }
+    
+    // Header/data jobs: walk whole bytes up to the target
+    const RenderJob *job = &plan->jobs[low];
+    if (job->kind == SEGMENT_HEADER || job->kind == SEGMENT_DATA) {
+        size_t offset = sample - job->start_sample;
+        size_t byte_count = job->head_length + job->data_length;
+        size_t covered = 0;
+        while (synth->byte_index < byte_count) {
+            size_t length = synth->cache->byte_length[renderJobByte(job, synth->byte_index)];
+            if (covered + length > offset) {
+                break;
+            }
+            covered += length;
+            synth->byte_index++;
+        }
+        synth->byte_offset = offset - covered;
+    }
+}
+
+size_t renderTapeSynth(TapeSynth *synth, uint8_t *dest, size_t count) {
+    if (!synth || !dest) {
+        return 0;
+    }
+    
+    const WaveformCache *cache = synth->cache;
+    const WaveformConfig *config = &synth->config;
+    size_t done = 0;
+    
+    while (done < count && synth->job < synth->plan.count) {
+        const RenderJob *job = &synth->plan.jobs[synth->job];
+        size_t job_offset = synth->position - job->start_sample;
+        if (job_offset >= job->sample_count) {
+            synth->job++;
+            synth->byte_index = 0;
+            synth->byte_offset = 0;
+            continue;
+        }
+        
+        uint8_t *out = dest + done;
+        size_t want = count - done;
+        size_t left = job->sample_count - job_offset;
+        size_t n = (want < left) ? want : left;
+        
+        switch (job->kind) {
+            case SEGMENT_SILENCE:
+                memset(out, 128, n);
+                break;
+                
+            case SEGMENT_SYNC: {
+                size_t phase = job_offset % cache->bit1_length;
+                for (size_t i = 0; i < n; ) {
+                    size_t chunk = cache->bit1_length - phase;
+                    if (chunk > n - i) {
+                        chunk = n - i;
+                    }
+                    memcpy(out + i, cache->bit1_cycle + phase, chunk);
+                    i += chunk;
+                    phase = 0;
+                }
+                break;
+            }
+                
+            case SEGMENT_HEADER:
+            case SEGMENT_DATA: {
+                // At most the rest of the current framed byte
+                uint8_t value = renderJobByte(job, synth->byte_index);
+                size_t rest = cache->byte_length[value] - synth->byte_offset;
+                if (n > rest) {
+                    n = rest;
+                }
+                memcpy(out, cache->byte_samples + cache->byte_offset[value] + synth->byte_offset, n);
+                synth->byte_offset += n;
+                if (synth->byte_offset == cache->byte_length[value]) {
+                    synth->byte_index++;
+                    synth->byte_offset = 0;
+                }
+                break;
+            }
+        }
+        
+        // Silence bypasses the filter, exactly like writeSilence()
+        if (config->enable_lowpass && job->kind != SEGMENT_SILENCE) {
+            applyLowPassFilter(out, n, config->sample_rate,
+                               config->lowpass_cutoff_hz, &synth->lowpass_state);
+        }
+        
+        synth->position += n;
+        done += n;
+    }
+    
+    return done;
+}
+
+bool seekTapeSynth(TapeSynth *synth, size_t sample) {
+    if (!synth) {
+        return false;
+    }
+    if (sample > synth->total_samples) {
+        sample = synth->total_samples;
+    }
+    
+    // Estimate the filter state by rendering the samples before the target
+    size_t warmup = 0;
+    if (synth->config.enable_lowpass) {
+        warmup = (sample < LOWPASS_WARMUP_SAMPLES) ? sample : LOWPASS_WARMUP_SAMPLES;
+    }
+    
+    locateTapeSample(synth, sample - warmup);
+    synth->lowpass_state = 128.0;
+    if (warmup > 0) {
+        uint8_t scratch[LOWPASS_WARMUP_SAMPLES];
+        renderTapeSynth(synth, scratch, warmup);
+    }
+    
+    return true;
+}
+
+// Whether the output is an existing FIFO or character device (no seeking)
+static bool isStreamOutput(const char *filename) {
+    struct stat st;
+    return stat(filename, &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISCHR(st.st_mode));
+}
+
+// Sample count and markers of a writer sized up front (a sink or a mapped
+// file). The tape layout gives the exact sample count and the markers;
+// markers stays NULL unless config->enable_markers is set
+static bool planWavOutput(const cas_Container *container, const WaveformConfig *config,
+                          size_t *total_samples, MarkerList **markers) {
+    TapeLayout layout;
+    if (!planTapeLayout(container, config, &layout)) {
+        return false;
+    }
+    
+    *markers = NULL;
+    if (config->enable_markers) {
+        *markers = createMarkerList();
+        if (!*markers || !addLayoutMarkers(&layout, container, config, *markers)) {
+            fprintf(stderr, "Error: Failed to enable markers\n");
+            freeMarkerList(*markers);
+            *markers = NULL;
+            freeTapeLayout(&layout);
+            return false;
+        }
+    }
+    *total_samples = layout.total_samples;
+    freeTapeLayout(&layout);
+    return true;
+}
+
+// Render the whole container through writer, then close it (always)
+// Parallel rendering needs positional writes into a file
+static bool renderAndClose(WavWriter *writer, const cas_Container *container,
+                           const WaveformConfig *config, const WaveformCache *cache,
+                           FILE *log, double *duration_seconds) {
+    // Size the output buffer if the caller asked for a specific size
+    if (config->output_buffer_size && !setWavBufferSize(writer, config->output_buffer_size)) {
+        closeWavFile(writer);
+        return false;
+    }
+    if (config->sample_tap && !tapWavSamples(writer, config->sample_tap)) {
+        closeWavFile(writer);
+        return false;
+    }
+    
+    // Render the bit cycles once up front (or reuse the caller's)
+    if (cache ? !shareWaveformCache(writer, cache) : !enableWaveformCache(writer, config)) {
+        fprintf(stderr, "Error: Failed to build waveform cache\n");
+        closeWavFile(writer);
+        return false;
+    }
+    
+    // Render the tape (in parallel if more than one thread was requested;
+    // a stream cannot take positional writes and a tap takes the samples
+    // in order, so these are always rendered in order)
+    bool rendered = (config->render_threads > 1 && !writer->streaming && !writer->to_tap)
+                  ? renderContainerParallel(writer, container, config, log)
+                  : renderContainerSerial(writer, container, config, log);
+    if (!rendered) {
+        closeWavFile(writer);
+        return false;
+    }
     
     // Calculate duration before closing
     if (duration_seconds) {
@@ -1033,14 +2574,373 @@ bool convertCasToWav(const char *cas_filename, const char *wav_filename,
     // Close WAV file
     if (!closeWavFile(writer)) {
         fprintf(stderr, "Error: Failed to close WAV file\n");
-        free(cas_data);
         return false;
     }
+    return true;
+}
+
+bool convertContainerToWav(const cas_Container *container, const WavSink *sink,
+                           const WaveformConfig *config, const WaveformCache *cache,
+                           FILE *log, double *duration_seconds) {
+    if (!container || !sink || !sink->write || !config) {
+        fprintf(stderr, "Error: Invalid parameters to convertContainerToWav\n");
+        return false;
+    }
+    if (cache && !cacheMatchesConfig(cache, config)) {
+        fprintf(stderr, "Error: Waveform cache was built for different settings\n");
+        return false;
+    }
+    
+    WavFormat format = createDefaultWavFormat();
+    format.sample_rate = config->sample_rate;  // Use sample rate from config
+    size_t total_samples = 0;
+    MarkerList *markers = NULL;
+    WavWriter *writer = planWavOutput(container, config, &total_samples, &markers)
+                      ? createWavSinkWriter(sink, &format, total_samples, markers)
+                      : NULL;
+    if (!writer) {
+        fprintf(stderr, "Error: Failed to create WAV file\n");
+        return false;
+    }
+    return renderAndClose(writer, container, config, cache, log, duration_seconds);
+}
+
+// Stream a container to stdout ("-"), a FIFO or a character device through
+// a descriptor sink: these cannot seek, so the header is sized up front
+static bool convertContainerToStream(const cas_Container *container, const char *wav_filename,
+                                     const WaveformConfig *config, const WaveformCache *cache,
+                                     FILE *log, double *duration_seconds) {
+    bool to_stdout = (strcmp(wav_filename, "-") == 0);
+    int fd = to_stdout ? STDOUT_FILENO : open(wav_filename, O_WRONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create file '%s'\n", wav_filename);
+        return false;
+    }
+    if (to_stdout) {
+        fflush(stdout);  // Nothing buffered may land inside the WAV
+    }
+    
+    WavSink sink = createWavFdSink(fd);
+    bool ok = convertContainerToWav(container, &sink, config, cache, log, duration_seconds);
+    if (!to_stdout && close(fd) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+bool convertContainerToWavFile(const cas_Container *container, const char *wav_filename,
+                               const WaveformConfig *config, const WaveformCache *cache,
+                               bool verbose, double *duration_seconds) {
+    if (!container || !wav_filename || !config) {
+        fprintf(stderr, "Error: Invalid parameters to convertContainerToWavFile\n");
+        return false;
+    }
+    if (cache && !cacheMatchesConfig(cache, config)) {
+        fprintf(stderr, "Error: Waveform cache was built for different settings\n");
+        return false;
+    }
+    
+    // Pipes cannot seek, so they get a pre-sized stream; when the WAV
+    // goes to stdout, progress moves to stderr
+    bool to_stdout = (strcmp(wav_filename, "-") == 0);
+    bool streaming = to_stdout || isStreamOutput(wav_filename);
+    bool mapped = config->map_output && !streaming && !config->sample_tap;
+    FILE *log = verbose ? (to_stdout ? stderr : stdout) : NULL;
+    
+    if (streaming) {
+        return convertContainerToStream(container, wav_filename, config, cache, log,
+                                        duration_seconds);
+    }
+    
+    // Create WAV file with sample rate from config; a mapped file is
+    // preallocated to its final size with every marker already known
+    WavFormat format = createDefaultWavFormat();
+    format.sample_rate = config->sample_rate;  // Use sample rate from config
+    WavWriter *writer = NULL;
+    if (mapped) {
+        size_t total_samples = 0;
+        MarkerList *markers = NULL;
+        if (planWavOutput(container, config, &total_samples, &markers)) {
+            writer = createMappedWavFile(wav_filename, &format, total_samples, markers);
+        }
+    } else {
+        writer = createWavFile(wav_filename, &format);
+    }
+    if (!writer) {
+        fprintf(stderr, "Error: Failed to create WAV file\n");
+        return false;
+    }
+    
+    if (log && mapped) {
+        fprintf(log, "  Output preallocated and mapped: %zu bytes\n", writer->mapping_size);
+    }
+    
+    // Enable markers if requested (mapped files already have all of them)
+    if (config->enable_markers && !mapped) {
+        if (!enableMarkers(writer)) {
+            fprintf(stderr, "Error: Failed to enable markers\n");
+            closeWavFile(writer);
+            return false;
+        }
+    }
+    
+    return renderAndClose(writer, container, config, cache, log, duration_seconds);
+}
+
+// Convert a complete CAS file to WAV audio format
+bool convertCasToWav(const char *cas_filename, const char *wav_filename,
+                     const WaveformConfig *config, bool verbose, double *duration_seconds) {
+    return convertCasToWavCached(cas_filename, wav_filename, config, NULL,
+                                 verbose, duration_seconds);
+}
+
+bool convertCasToWavCached(const char *cas_filename, const char *wav_filename,
+                           const WaveformConfig *config, const WaveformCache *cache,
+                           bool verbose, double *duration_seconds) {
+    if (!cas_filename || !wav_filename || !config) {
+        fprintf(stderr, "Error: Invalid parameters to convertCasToWav\n");
+        return false;
+    }
+    if (cache && !cacheMatchesConfig(cache, config)) {
+        fprintf(stderr, "Error: Waveform cache was built for different settings\n");
+        return false;
+    }
+    
+    // Load CAS file (mapped when it is a regular file)
+    cas_Input input;
+    if (!openCasInput(cas_filename, &input)) {
+        return false;
+    }
+    if (input.size == 0) {
+        fprintf(stderr, "Error: CAS file is empty\n");
+        closeCasInput(&input);
+        return false;
+    }
+    
+    // Parse CAS container (blocks point into the input, which outlives it)
+    cas_Container container;
+    if (!parseCasContainerInPlace(input.data, &container, input.size)) {
+        fprintf(stderr, "Error: Failed to parse CAS file\n");
+        closeCasInput(&input);
+        return false;
+    }
+    
+    bool to_stdout = (strcmp(wav_filename, "-") == 0);
+    if (verbose) {
+        FILE *log = to_stdout ? stderr : stdout;
+        fprintf(log, "Converting '%s' to '%s'...\n", cas_filename,
+                to_stdout ? "<stdout>" : wav_filename);
+        fprintf(log, "  Files in container: %zu\n", container.file_count);
+    }
+    
+    bool ok = convertContainerToWavFile(&container, wav_filename, config, cache,
+                                        verbose, duration_seconds);
+    freeCasContainer(&container);
+    closeCasInput(&input);
+    return ok;
+}
+
+// =============================================================================
+// Tape Layout Planning - Exact Sample Positions
+// =============================================================================
+
+// Append a segment to the layout, growing the table as needed
+static bool appendSegment(TapeLayout *layout, TapeSegmentKind kind, size_t file_idx,
+                          size_t block_idx, bool long_leader, size_t sample_count) {
+    if (layout->count >= layout->capacity) {
+        size_t new_capacity = layout->capacity ? layout->capacity * 2 : 32;
+        TapeSegment *segments = realloc(layout->segments, new_capacity * sizeof(TapeSegment));
+        if (!segments) {
+            fprintf(stderr, "Error: Failed to expand tape layout\n");
+            return false;
+        }
+        layout->segments = segments;
+        layout->capacity = new_capacity;
+    }
+    
+    TapeSegment *segment = &layout->segments[layout->count++];
+    segment->kind = kind;
+    segment->file_index = file_idx;
+    segment->block_index = block_idx;
+    segment->long_leader = long_leader;
+    segment->start_sample = layout->total_samples;
+    segment->sample_count = sample_count;
     
-    free(cas_data);
+    layout->total_samples += sample_count;
     return true;
 }
 
+// Samples needed to encode count bytes with serial framing
+static size_t bytesSampleCount(const uint8_t *data, size_t count,
+                               size_t bit0_samples, size_t bit1_samples) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += framedByteSampleCount(data[i], bit0_samples, bit1_samples);
+    }
+    return total;
+}
+
+// Samples needed for the 6-byte BINARY address header
+static size_t dataBlockHeaderSampleCount(const cas_File *file,
+                                         size_t bit0_samples, size_t bit1_samples) {
+    const cas_DataBlockHeader *header = &file->data_block_header;
+    uint8_t bytes[6] = {
+        header->load_address & 0xFF, (header->load_address >> 8) & 0xFF,
+        header->end_address & 0xFF, (header->end_address >> 8) & 0xFF,
+        header->exec_address & 0xFF, (header->exec_address >> 8) & 0xFF
+    };
+    return bytesSampleCount(bytes, sizeof(bytes), bit0_samples, bit1_samples);
+}
+
+bool planTapeLayout(const cas_Container *container, const WaveformConfig *config,
+                    TapeLayout *layout) {
+    if (!layout) {
+        return false;
+    }
+    layout->segments = NULL;
+    layout->count = 0;
+    layout->capacity = 0;
+    layout->total_samples = 0;
+    
+    if (!container || !config || config->baud_rate == 0) {
+        fprintf(stderr, "Error: Invalid parameters to planTapeLayout\n");
+        return false;
+    }
+    
+    // Same integer arithmetic as writePulse(): a 0-bit is one cycle at
+    // baud_rate, a 1-bit two cycles at 2×baud_rate
+    size_t bit0_samples = config->sample_rate / config->baud_rate;
+    size_t bit1_samples = 2 * (config->sample_rate / (config->baud_rate * 2));
+    if (bit0_samples == 0 || bit1_samples == 0) {
+        fprintf(stderr, "Error: Baud rate %u too high for sample rate %u Hz\n",
+                config->baud_rate, config->sample_rate);
+        return false;
+    }
+    
+    size_t long_silence = silenceSampleCount(config->sample_rate, config->long_silence);
+    size_t short_silence = silenceSampleCount(config->sample_rate, config->short_silence);
+    bool ok = true;
+    
+    // Mirrors the block sequence written by convertCasToWav()
+    for (size_t file_idx = 0; ok && file_idx < container->file_count; file_idx++) {
+        const cas_File *file = &container->files[file_idx];
+        
+        if (!file->is_custom) {
+            ok = appendSegment(layout, SEGMENT_SILENCE, file_idx, 0, true, long_silence) &&
+                 appendSegment(layout, SEGMENT_SYNC, file_idx, 0, true, 8000 * bit1_samples) &&
+                 appendSegment(layout, SEGMENT_HEADER, file_idx, 0, false,
+                               bytesSampleCount(file->file_header.file_type, 10, bit0_samples, bit1_samples) +
+                               bytesSampleCount(file->file_header.file_name, 6, bit0_samples, bit1_samples));
+        }
+        
+        for (size_t block_idx = 0; ok && block_idx < file->data_block_count; block_idx++) {
+            const cas_DataBlock *block = &file->data_blocks[block_idx];
+            
+            // Every custom block gets the long leader, like a new file
+            bool long_leader = file->is_custom;
+            ok = appendSegment(layout, SEGMENT_SILENCE, file_idx, block_idx, long_leader,
+                               long_leader ? long_silence : short_silence) &&
+                 appendSegment(layout, SEGMENT_SYNC, file_idx, block_idx, long_leader,
+                               (long_leader ? 8000 : 2000) * bit1_samples);
+            
+            size_t data_samples = bytesSampleCount(block->data, block->data_size,
+                                                   bit0_samples, bit1_samples);
+            if (hasDataBlockHeader(file, block_idx)) {
+                data_samples += dataBlockHeaderSampleCount(file, bit0_samples, bit1_samples);
+            }
+            ok = ok && appendSegment(layout, SEGMENT_DATA, file_idx, block_idx, false, data_samples);
+        }
+    }
+    
+    if (!ok) {
+        freeTapeLayout(layout);
+    }
+    return ok;
+}
+
+void freeTapeLayout(TapeLayout *layout) {
+    if (layout) {
+        free(layout->segments);
+        layout->segments = NULL;
+        layout->count = 0;
+        layout->capacity = 0;
+        layout->total_samples = 0;
+    }
+}
+
+const char* getSegmentKindString(TapeSegmentKind kind) {
+    switch (kind) {
+        case SEGMENT_SILENCE: return "silence";
+        case SEGMENT_SYNC: return "sync";
+        case SEGMENT_HEADER: return "header";
+        case SEGMENT_DATA: return "data";
+        default: return "unknown";
+    }
+}
+
+bool addLayoutMarkers(const TapeLayout *layout, const cas_Container *container,
+                      const WaveformConfig *config, MarkerList *markers) {
+    if (!layout || !container || !config || !markers) {
+        return false;
+    }
+    
+    char desc[256];
+    for (size_t i = 0; i < layout->count; i++) {
+        const TapeSegment *segment = &layout->segments[i];
+        const cas_File *file = &container->files[segment->file_index];
+        size_t pos = segment->start_sample;
+        bool ok = true;
+        
+        switch (segment->kind) {
+            case SEGMENT_SILENCE:
+                formatSilenceMarker(desc, sizeof(desc),
+                                    segment->long_leader ? config->long_silence
+                                                         : config->short_silence);
+                ok = addMarker(markers, pos, MARKER_DETAIL, desc);
+                break;
+                
+            case SEGMENT_SYNC:
+                formatSyncMarker(desc, sizeof(desc), segment->long_leader ? 8000 : 2000);
+                ok = addMarker(markers, pos, MARKER_DETAIL, desc);
+                break;
+                
+            case SEGMENT_HEADER:
+                formatFileMarker(desc, sizeof(desc), file, segment->file_index, container->file_count);
+                ok = addMarker(markers, pos, MARKER_STRUCTURE, desc) &&
+                     addMarker(markers, pos, MARKER_STRUCTURE, "File header");
+                break;
+                
+            case SEGMENT_DATA:
+                // Custom files have no header block; their file marker
+                // follows the first block's sync
+                if (file->is_custom && segment->block_index == 0) {
+                    formatFileMarker(desc, sizeof(desc), file, segment->file_index, container->file_count);
+                    ok = addMarker(markers, pos, MARKER_STRUCTURE, desc);
+                }
+                formatBlockMarker(desc, sizeof(desc), file, segment->block_index);
+                ok = ok && addMarker(markers, pos, MARKER_STRUCTURE, desc);
+                break;
+        }
+        
+        if (!ok) {
+            return false;
+        }
+    }
+    
+    return addMarker(markers, layout->total_samples, MARKER_DETAIL, "End of tape");
+}
+
+size_t calculateLayoutWavSize(const TapeLayout *layout, const WavFormat *format,
+                              const MarkerList *markers) {
+    if (!layout || !format) {
+        return 0;
+    }
+    
+    size_t header_size = sizeof(WavRiffHeader) + sizeof(WavFmtChunk) + sizeof(WavDataChunk);
+    size_t data_size = layout->total_samples * (format->bits_per_sample / 8);
+    return header_size + data_size + markerChunksSize(markers);
+}
+
 // =============================================================================
 // Audio Estimation - Duration and Size Calculations
 // =============================================================================
@@ -1076,9 +2976,8 @@ double calculateAudioDuration(const void *container_ptr, uint16_t baud_rate,
             // Sync pulses: 2000 1-bits
             total_bits += 2000;
             
-            // Data block header for BINARY/BASIC (first block only)
-            if (block_idx == 0 && (isBinaryFile(file->file_header.file_type) ||
-                                   isBasicFile(file->file_header.file_type))) {
+            // Data block header for BINARY (first block only)
+            if (block_idx == 0 && isBinaryFile(file->file_header.file_type)) {
                 // Data block header: 6 bytes × 11 bits
                 total_bits += 6 * 11;
             }
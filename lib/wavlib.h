@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include "caslib.h"
 
 // =============================================================================
 // WAV File Generation for CAS to WAV Conversion
@@ -113,8 +114,52 @@ typedef struct {
     
     // Marker generation settings
     bool enable_markers;            // Generate cue point markers during conversion
+    
+    // Output settings
+    size_t output_buffer_size;      // WavWriter buffer in bytes (0 = WAV_DEFAULT_BUFFER_SIZE)
+    uint16_t render_threads;        // Worker threads for convertCasToWav (0 or 1 = single-threaded)
+    bool map_output;                // Preallocate and mmap the output file (convertCasToWav)
+    const struct WavSink *sample_tap;  // Also receives every sample in order (NULL = none);
+                                    // rendering is then serial and unmapped (tapWavSamples)
 } WaveformConfig;
 
+// Pre-rendered pulse cycles and framed bytes for one waveform configuration
+// Built once per conversion so writePulse()/writeByte() only copy samples
+typedef struct {
+    uint8_t *bit0_cycle;         // One cycle at baud_rate Hz (a complete 0-bit)
+    size_t bit0_length;          // Samples in bit0_cycle
+    uint8_t *bit1_cycle;         // One cycle at 2×baud_rate Hz (half of a 1-bit)
+    size_t bit1_length;          // Samples in bit1_cycle
+    
+    // Byte symbol table: all 256 framed bytes (START + 8 data + 2 STOP)
+    uint8_t *byte_samples;       // Every framed byte waveform, back to back
+    size_t byte_offset[256];     // Start of each byte value in byte_samples
+    size_t byte_length[256];     // Samples per framed byte value
+    
+    WaveformConfig config;       // Settings the table was rendered with
+} WaveformCache;
+
+// Output buffer sizing (samples are accumulated and flushed in large writes)
+#define WAV_DEFAULT_BUFFER_SIZE  (1024 * 1024)  // 1 MiB
+#define WAV_MIN_BUFFER_SIZE      4096           // Smallest accepted buffer
+#define WAV_BUFFER_ALIGNMENT     4096           // Page-aligned for large writes
+
+// Destination for a WAV produced without a file: receives the WAV in
+// order (header, samples, marker chunks), never asked to seek back
+typedef struct WavSink {
+    // Take the next size bytes; returning false stops the conversion
+    bool (*write)(void *context, const uint8_t *data, size_t size);
+    void *context;
+    bool samples_only;           // Deliver only the samples (no header or marker chunks)
+} WavSink;
+
+// Heap buffer filled by a memory sink (createWavBufferSink)
+typedef struct {
+    uint8_t *data;
+    size_t size;                 // Bytes written so far
+    size_t capacity;
+} WavBuffer;
+
 // WAV file writer context (opaque to user)
 typedef struct {
     FILE *file;
@@ -123,6 +168,20 @@ typedef struct {
     long data_chunk_pos;
     double lowpass_state;        // Filter state (previous output sample)
     MarkerList *markers;         // NULL if markers disabled
+    const WaveformCache *cache;  // NULL if waveform cache disabled
+    WaveformCache *owned_cache;  // Freed on close (NULL for a shared cache)
+    uint8_t *buffer;             // Pending samples not yet written to file
+    size_t buffer_size;          // Capacity of buffer in bytes
+    size_t buffer_used;          // Bytes currently held in buffer
+    bool streaming;              // Header sized up front, no seeking (createWavStream)
+    size_t stream_samples;       // Samples declared in a pre-sized header (stream or mapped)
+    bool close_stream;           // Stream was opened by the library; close it too
+    uint8_t *mapping;            // Whole output file mapped in memory (createMappedWavFile)
+    size_t mapping_size;         // Length of the mapping in bytes
+    WavSink sink;                // Output of a sink writer (createWavSinkWriter)
+    bool to_sink;                // Samples go to sink instead of file
+    WavSink tap;                 // Sees every sample before the output does (tapWavSamples)
+    bool to_tap;
 } WavWriter;
 
 // =============================================================================
@@ -165,6 +224,31 @@ void freeMarkerList(MarkerList *list);
 // Returns false on allocation failure
 bool enableMarkers(WavWriter *writer);
 
+// =============================================================================
+// Waveform Cache
+// =============================================================================
+
+// Render the bit0/bit1 cycles and the 256-entry byte symbol table
+// for the given configuration
+// Returns NULL on error (invalid config or allocation failure)
+WaveformCache* createWaveformCache(const WaveformConfig *config);
+
+// Free waveform cache and its sample buffers
+void freeWaveformCache(WaveformCache *cache);
+
+// Enable the waveform cache for a WAV writer (table-driven encoder mode)
+// Pulses at baud_rate and 2×baud_rate are then copied from the cache and
+// each framed byte is a single copy from the byte table instead of 11
+// writeBit0/writeBit1 calls; output is identical to the uncached path
+// Returns false on error
+bool enableWaveformCache(WavWriter *writer, const WaveformConfig *config);
+
+// Use a cache built by the caller instead of rendering a new one
+// The cache is only read, so one cache can serve any number of writers
+// (also on different threads); it must outlive them
+// Returns false on error
+bool shareWaveformCache(WavWriter *writer, const WaveformCache *cache);
+
 // =============================================================================
 // WAV File Management
 // =============================================================================
@@ -173,14 +257,71 @@ bool enableMarkers(WavWriter *writer);
 // Returns NULL on error
 WavWriter* createWavFile(const char *filename, const WavFormat *format);
 
+// Create a WAV writer on an already open stream (stdout, a pipe or FIFO)
+// The header is written immediately with final sizes, so the writer never
+// seeks: exactly total_samples samples must be written before closing.
+// markers (may be NULL) must already be complete; the writer takes
+// ownership and appends the cue/adtl chunks on close (later marker
+// additions are ignored). The stream is flushed but not closed.
+// Returns NULL on error
+WavWriter* createWavStream(FILE *stream, const WavFormat *format,
+                           size_t total_samples, MarkerList *markers);
+
+// Create a WAV file preallocated to its exact final size and mapped into
+// memory: samples are written straight into the mapping and the header
+// and cue/adtl chunks are filled in place, so nothing is seeked or
+// appended. Same contract as createWavStream(): exactly total_samples
+// samples must be written, and markers (may be NULL) must be complete
+// (the writer takes ownership). Close with closeWavFile().
+// Returns NULL on error
+WavWriter* createMappedWavFile(const char *filename, const WavFormat *format,
+                               size_t total_samples, MarkerList *markers);
+
+// Create a WAV writer on a sink: same contract as createWavStream() (final
+// sizes up front, exactly total_samples samples, markers complete and
+// owned by the writer), but every byte goes to sink->write
+// Returns NULL on error
+WavWriter* createWavSinkWriter(const WavSink *sink, const WavFormat *format,
+                               size_t total_samples, MarkerList *markers);
+
+// Sink appending to buffer, which must start zeroed; the data stays with
+// the caller (release it with freeWavBuffer())
+WavSink createWavBufferSink(WavBuffer *buffer);
+
+// Release the data of a buffer filled by a memory sink
+void freeWavBuffer(WavBuffer *buffer);
+
+// Sink writing to an open file descriptor (file, pipe or socket) at its
+// current position; the descriptor is left open
+WavSink createWavFdSink(int fd);
+
+// Hand every sample to tap as well, in order, as each buffer is flushed
+// (before the output gets it), e.g. to decode the audio while it is
+// written. Only the write function is used. Not for mapped files, whose
+// samples never pass through a buffer; a tap refusing a write fails the
+// conversion
+// Returns false on error
+bool tapWavSamples(WavWriter *writer, const WavSink *tap);
+
 // Close WAV file and finalize headers
 // Returns false on error
 bool closeWavFile(WavWriter *writer);
 
-// Write raw samples directly to WAV file
+// Write raw samples to WAV file (buffered; flushed when the buffer fills
+// and on close)
 // Returns false on error
 bool writeSamples(WavWriter *writer, const uint8_t *samples, size_t count);
 
+// Resize the output buffer (flushes pending samples first)
+// size is clamped to at least WAV_MIN_BUFFER_SIZE; mapped files have no
+// buffer and ignore this
+// Returns false on error
+bool setWavBufferSize(WavWriter *writer, size_t size);
+
+// Write all buffered samples to the file
+// Returns false on error
+bool flushWavFile(WavWriter *writer);
+
 // =============================================================================
 // Audio Processing - Filters
 // =============================================================================
@@ -233,6 +374,10 @@ bool writeBit1(WavWriter *writer, const WaveformConfig *config);
 // (START bit + 8 data bits LSB first + 2 STOP bits = 11 bits total)
 bool writeByte(WavWriter *writer, uint8_t byte, const WaveformConfig *config);
 
+// Write a run of bytes with serial framing (same output as calling
+// writeByte() for each one, but arguments are checked once)
+bool writeBytes(WavWriter *writer, const uint8_t *data, size_t count, const WaveformConfig *config);
+
 // =============================================================================
 // MSX Tape Structure - Cassette Protocol
 // =============================================================================
@@ -251,9 +396,133 @@ bool writeSync(WavWriter *writer, size_t bit_count, const WaveformConfig *config
 // Reads the CAS file, parses its structure, and generates MSX cassette tape audio
 // Returns true on success, false on error
 // If duration_seconds is not NULL, stores the WAV duration in seconds
+// wav_filename "-" streams the WAV to stdout (header sized from the tape
+// layout, no seeking; verbose output goes to stderr); an existing FIFO or
+// character device is streamed the same way
+// With config->render_threads > 1 the tape is rendered by worker threads
+// writing at offsets from the tape layout; the file is identical to the
+// single-threaded output
+// With config->map_output a regular output file is preallocated to its
+// exact size and rendered through a memory mapping (createMappedWavFile)
 bool convertCasToWav(const char *cas_filename, const char *wav_filename, 
                      const WaveformConfig *config, bool verbose, double *duration_seconds);
 
+// convertCasToWav() rendering from a prebuilt waveform cache for config
+// (see shareWaveformCache); cache NULL builds one for this conversion
+// Lets batch conversions on several threads share one set of tables
+bool convertCasToWavCached(const char *cas_filename, const char *wav_filename,
+                           const WaveformConfig *config, const WaveformCache *cache,
+                           bool verbose, double *duration_seconds);
+
+// convertCasToWav() for a container the caller already parsed (the CAS
+// data it points into must stay alive), so the input is never read twice
+// Outputs, threads and mapping behave as for convertCasToWav()
+bool convertContainerToWavFile(const cas_Container *container, const char *wav_filename,
+                               const WaveformConfig *config, const WaveformCache *cache,
+                               bool verbose, double *duration_seconds);
+
+// Convert a parsed container into a sink instead of a file: the header is
+// sized from the tape layout, so the sink only ever receives bytes in
+// order. Rendering is single-threaded (render_threads and map_output are
+// ignored); cache may be NULL. Progress goes to log (NULL for quiet)
+// Returns false on error or when the sink refuses a write
+bool convertContainerToWav(const cas_Container *container, const WavSink *sink,
+                           const WaveformConfig *config, const WaveformCache *cache,
+                           FILE *log, double *duration_seconds);
+
+// =============================================================================
+// Tape Layout Planning - Exact Sample Positions
+// =============================================================================
+//
+// Walks a parsed container with the same integer samples_per_cycle
+// arithmetic as writePulse() and records where every part of the tape
+// starts and how long it is, without rendering any audio. The totals
+// match the sample_count of an actual convertCasToWav() run exactly.
+
+// Kind of audio segment on the tape
+typedef enum {
+    SEGMENT_SILENCE,   // Silence before a header or data block
+    SEGMENT_SYNC,      // Leader of consecutive 1-bits
+    SEGMENT_HEADER,    // File header block (type marker + filename)
+    SEGMENT_DATA       // Data block (address header if any + block bytes)
+} TapeSegmentKind;
+
+// One contiguous segment of the rendered tape
+typedef struct {
+    TapeSegmentKind kind;
+    size_t file_index;          // Index into container->files
+    size_t block_index;         // Data block the segment belongs to (0 for file headers)
+    bool long_leader;           // Silence/sync opening a file (long silence, 8000-bit sync)
+    size_t start_sample;        // Sample offset of the first sample
+    size_t sample_count;        // Length in samples
+} TapeSegment;
+
+// Complete tape layout (segments in playback order)
+typedef struct {
+    TapeSegment *segments;
+    size_t count;
+    size_t capacity;
+    size_t total_samples;       // Sum of all segment lengths
+} TapeLayout;
+
+// Plan the exact tape layout of a container for a waveform configuration
+// Returns false on error (layout is left empty)
+bool planTapeLayout(const cas_Container *container, const WaveformConfig *config,
+                    TapeLayout *layout);
+
+// Free the segment table of a layout
+void freeTapeLayout(TapeLayout *layout);
+
+// Get a human-readable name for a segment kind
+const char* getSegmentKindString(TapeSegmentKind kind);
+
+// Add the markers a conversion would generate for this layout
+// (same descriptions, categories, positions and order)
+// Returns false on allocation failure
+bool addLayoutMarkers(const TapeLayout *layout, const cas_Container *container,
+                      const WaveformConfig *config, MarkerList *markers);
+
+// Calculate the exact WAV file size for a layout
+// Includes the 44-byte header and cue/adtl chunks (markers may be NULL)
+size_t calculateLayoutWavSize(const TapeLayout *layout, const WavFormat *format,
+                              const MarkerList *markers);
+
+// =============================================================================
+// Tape Synthesis - Random Access Rendering
+// =============================================================================
+//
+// Synthesizes tape audio on demand (e.g. inside an audio callback) with no
+// WAV file. Reading sequentially from sample 0 gives exactly the samples
+// convertCasToWav() writes (8-bit unsigned). Seeking is computed from the
+// tape layout; with the low-pass filter enabled, the filter state after a
+// seek is estimated from the samples just before the target.
+
+typedef struct TapeSynth TapeSynth;
+
+// Create a synthesizer for a parsed container
+// The container (and the CAS data it points into) must outlive the synthesizer
+// If markers is not NULL it receives the markers a conversion would write
+// Returns NULL on error
+TapeSynth* createTapeSynth(const cas_Container *container, const WaveformConfig *config,
+                           MarkerList *markers);
+
+// Free a synthesizer
+void freeTapeSynth(TapeSynth *synth);
+
+// Total length of the tape in samples
+size_t getTapeSynthLength(const TapeSynth *synth);
+
+// Sample the next renderTapeSynth() call starts at
+size_t getTapeSynthPosition(const TapeSynth *synth);
+
+// Move to sample (clamped to the tape length)
+// Returns false on error
+bool seekTapeSynth(TapeSynth *synth, size_t sample);
+
+// Render up to count samples from the current position into dest
+// Returns the number of samples rendered (less than count at the end of the tape)
+size_t renderTapeSynth(TapeSynth *synth, uint8_t *dest, size_t count);
+
 // =============================================================================
 // Audio Estimation - Duration and Size Calculations
 // =============================================================================
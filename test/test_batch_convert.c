@@ -0,0 +1,145 @@
+/*
+ * Batch Convert Test - Output Planning
+ * ====================================
+ *
+ * Writes small CAS files to test_batch/a/g.cas, test_batch/a/h.cas and
+ * test_batch/b/g.cas (plus a hard link test_batch/c/link.cas to a/g.cas)
+ * and runs cast convert --batch over list files and a directory.
+ *
+ * Purpose: Verify a batch is refused before anything is written when two
+ *          different inputs would write the same WAV (g.cas from two
+ *          directories with --out-dir) or one file is listed twice under
+ *          another spelling (a/./g.cas, a//g.cas, its absolute path, a
+ *          hard link), and that batches without collisions convert every
+ *          input to its planned WAV.
+ */
+
+#include "../lib/caslib.h"
+#include "../commands/commands.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define BATCH_DIR "test_batch"
+#define LIST_FILE BATCH_DIR "/list.txt"
+#define OUT_DIR   BATCH_DIR "/out"
+
+static bool writeCas(const char *path, uint8_t seed) {
+    uint8_t cas[512];
+    uint8_t code[6 + 120] = {0x00, 0xC0, 0x77, 0xC0, 0x00, 0xC0};
+    for (size_t i = 6; i < sizeof(code); i++) {
+        code[i] = (uint8_t)(i * seed + 3);
+    }
+    size_t len = putFileHeader(cas, 0, FILETYPE_BINARY, "BATCH ");
+    len = putBlock(cas, len, code, sizeof(code));
+
+    FILE *f = fopen(path, "wb");
+    bool ok = f && fwrite(cas, 1, len, f) == len;
+    return (f && fclose(f) == 0) && ok;
+}
+
+// Write the given paths, one per line, as the batch list
+static bool writeList(const char *const *paths, size_t count) {
+    FILE *f = fopen(LIST_FILE, "w");
+    bool ok = f != NULL;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = fprintf(f, "%s\n", paths[i]) > 0;
+    }
+    return (f && fclose(f) == 0) && ok;
+}
+
+// cast convert --batch source [--out-dir out_dir] with the CLI defaults
+static int convertBatch(const char *source, const char *out_dir) {
+    return execute_convert(NULL, NULL, 1200, 43200, WAVE_SINE, 1, 8, 120, 10,
+                           2.0f, 1.0f, false, 6000, false, 0, 2, false,
+                           source, out_dir, false, false);
+}
+
+static bool exists(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+static bool nonEmpty(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && st.st_size > 0;
+}
+
+// A refused batch: error status, and output absent is still absent
+static bool refused(const char *const *paths, size_t count, const char *out_dir,
+                    const char *output) {
+    return writeList(paths, count) && convertBatch(LIST_FILE, out_dir) != 0 && !exists(output);
+}
+
+int main(void) {
+    printf("Batch Convert Test\n");
+    printf("==================\n\n");
+
+    static const char *dirs[] = {BATCH_DIR, BATCH_DIR "/a", BATCH_DIR "/b", BATCH_DIR "/c"};
+    for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+        mkdir(dirs[i], 0755);
+    }
+    // Outputs of an earlier run would hide a refused batch writing them
+    static const char *outputs[] = {OUT_DIR "/g.wav", OUT_DIR "/h.wav", BATCH_DIR "/a/g.wav",
+                                    BATCH_DIR "/a/h.wav", BATCH_DIR "/b/g.wav",
+                                    BATCH_DIR "/c/link.wav"};
+    for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); i++) {
+        unlink(outputs[i]);
+    }
+    rmdir(OUT_DIR);
+    unlink(BATCH_DIR "/c/link.cas");
+    if (!writeCas(BATCH_DIR "/a/g.cas", 7) || !writeCas(BATCH_DIR "/a/h.cas", 11) ||
+        !writeCas(BATCH_DIR "/b/g.cas", 13) ||
+        link(BATCH_DIR "/a/g.cas", BATCH_DIR "/c/link.cas") != 0) {
+        fprintf(stderr, "✗ Cannot write the CAS files\n");
+        return 1;
+    }
+    char *absolute = realpath(BATCH_DIR "/a/g.cas", NULL);
+    if (!absolute) {
+        fprintf(stderr, "✗ Cannot resolve %s\n", BATCH_DIR "/a/g.cas");
+        return 1;
+    }
+
+    int failures = 0;
+
+    // 1. Same name from two directories into one --out-dir
+    const char *same_name[] = {BATCH_DIR "/a/g.cas", BATCH_DIR "/b/g.cas"};
+    bool out_dir = refused(same_name, 2, OUT_DIR, OUT_DIR "/g.wav") && !exists(OUT_DIR);
+    printf("  %-22s: %s\n", "--out-dir same name", out_dir ? "refused" : "NOT REFUSED");
+    if (!out_dir) failures++;
+
+    // 2. One file under another spelling, next to the input
+    static const char *spellings[] = {BATCH_DIR "/a/./g.cas", BATCH_DIR "//a/g.cas",
+                                      "../test/" BATCH_DIR "/a/g.cas", NULL,
+                                      BATCH_DIR "/c/link.cas"};
+    static const char *spelling_names[] = {"a/./g.cas", "a//g.cas", "../test/a/g.cas",
+                                           "Absolute path", "Hard link"};
+    for (size_t i = 0; i < sizeof(spellings) / sizeof(spellings[0]); i++) {
+        const char *twice[] = {BATCH_DIR "/a/g.cas", spellings[i] ? spellings[i] : absolute};
+        bool duplicate = refused(twice, 2, NULL, BATCH_DIR "/a/g.wav") &&
+                         !exists(BATCH_DIR "/c/link.wav");
+        printf("  %-22s: %s\n", spelling_names[i], duplicate ? "refused" : "NOT REFUSED");
+        if (!duplicate) failures++;
+    }
+
+    // 3. No collisions: same names next to their inputs, a directory to --out-dir
+    bool converted = writeList(same_name, 2) && convertBatch(LIST_FILE, NULL) == 0 &&
+                     nonEmpty(BATCH_DIR "/a/g.wav") && nonEmpty(BATCH_DIR "/b/g.wav") &&
+                     convertBatch(BATCH_DIR "/a", OUT_DIR) == 0 &&
+                     nonEmpty(OUT_DIR "/g.wav") && nonEmpty(OUT_DIR "/h.wav");
+    printf("  %-22s: %s\n", "Distinct outputs", converted ? "all converted" : "FAILED");
+    if (!converted) failures++;
+
+    free(absolute);
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d batch check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Batches writing one WAV twice are refused\n");
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * CAS Hash Test - CRC32C and Content Hashes
+ * =========================================
+ *
+ * Checks crc32c() against the CRC32C check value and the table code, then
+ * hashes the files of synthesized CAS images (binary, BASIC, two-block
+ * ASCII and custom files) with hashCasFile() and hashCasContainer().
+ *
+ * Purpose: Verify the hardware and table paths agree, that the 64-bit hash
+ *          does not depend on how bytes are fed and separates inputs that
+ *          differ in one bit, that file and block hashes ignore names,
+ *          padding, trailing zeros and bytes after an ASCII EOF marker but
+ *          not load addresses, and that the hash index finds duplicates.
+ */
+
+#include "../lib/caslib.h"
+#include "../lib/hashlib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// How one tape differs from the reference tape
+typedef struct {
+    bool pad;                // Pad blocks so headers are 8-byte aligned
+    const char *names[3];
+    uint16_t load_address;
+    size_t basic_zeros;      // Extra zeros after the BASIC program
+    uint8_t after_eof;       // Filler after the ASCII EOF marker
+} TapeVariant;
+
+// Pad the block only if the variant does
+static size_t putTapeBlock(uint8_t *buf, size_t pos, const uint8_t *data, size_t length,
+                           const TapeVariant *variant) {
+    return variant->pad ? putBlock(buf, pos, data, length) : putUnpaddedBlock(buf, pos, data, length);
+}
+
+// Binary (120 program bytes), BASIC, two-block ASCII and a custom block
+static size_t buildTape(uint8_t *buf, const TapeVariant *variant) {
+    uint8_t binary[6 + 120];
+    uint16_t load = variant->load_address;
+    uint16_t end = (uint16_t)(load + 119);
+    uint8_t addresses[6] = {load & 0xFF, load >> 8, end & 0xFF, end >> 8, load & 0xFF, load >> 8};
+    memcpy(binary, addresses, 6);
+    for (size_t i = 0; i < 120; i++) {
+        binary[6 + i] = (uint8_t)(i * 13 + 1);
+    }
+
+    uint8_t basic[64] = {0};
+    for (size_t i = 0; i < 40; i++) {
+        basic[i] = (uint8_t)(0x81 + i);
+    }
+    size_t basic_length = 40 + 3 + variant->basic_zeros;  // Program ends in 00 00 00
+
+    uint8_t text[256];
+    memset(text, 'A', sizeof(text));
+    uint8_t last[256];
+    memset(last, variant->after_eof, sizeof(last));
+    memcpy(last, "10 PRINT", 8);
+    last[8] = EOF_MARKER;
+
+    uint8_t custom[33];
+    for (size_t i = 0; i < sizeof(custom); i++) {
+        custom[i] = (uint8_t)(i + 0x40);
+    }
+
+    size_t len = 0;
+    len = putFileHeader(buf, len, FILETYPE_BINARY, variant->names[0]);
+    len = putTapeBlock(buf, len, binary, sizeof(binary), variant);
+    len = putFileHeader(buf, len, FILETYPE_BASIC, variant->names[1]);
+    len = putTapeBlock(buf, len, basic, basic_length, variant);
+    len = putFileHeader(buf, len, FILETYPE_ASCII, variant->names[2]);
+    len = putTapeBlock(buf, len, text, sizeof(text), variant);
+    len = putTapeBlock(buf, len, last, sizeof(last), variant);
+    len = putTapeBlock(buf, len, custom, sizeof(custom), variant);
+    return len;
+}
+
+#define TAPE_FILES 4
+#define TAPE_BLOCKS 5
+
+typedef struct {
+    cas_ContentHash files[TAPE_FILES];
+    cas_ContentHash blocks[TAPE_BLOCKS];
+    uint64_t container;
+} TapeHashes;
+
+static bool hashTape(const TapeVariant *variant, TapeHashes *hashes) {
+    static uint8_t cas[4096];
+    size_t len = buildTape(cas, variant);
+    cas_Container container;
+    if (!parseCasContainerInPlace(cas, &container, len) || container.file_count != TAPE_FILES) {
+        return false;
+    }
+    size_t block = 0;
+    for (size_t i = 0; i < TAPE_FILES; i++) {
+        hashes->files[i] = hashCasFile(&container.files[i], &hashes->blocks[block]);
+        block += container.files[i].data_block_count;
+    }
+    hashes->container = hashCasContainer(&container, hashes->files);
+    freeCasContainer(&container);
+    return block == TAPE_BLOCKS;
+}
+
+static uint64_t hashBytes(const uint8_t *data, size_t size, bool hardware) {
+    cas_Hash hash;
+    initCasHash(&hash, 0);
+    hash.hardware = hash.hardware && hardware;
+    updateCasHash(&hash, data, size);
+    return finishCasHash(&hash);
+}
+
+int main(void) {
+    printf("CAS Hash Test\n");
+    printf("=============\n\n");
+
+    int failures = 0;
+    bool hardware = hasHardwareCrc32c();
+    printf("  CRC32C runs on %s\n\n", hardware ? "the CPU's CRC32 instruction" : "lookup tables");
+
+    // 1. Check value, incremental CRC, hardware against tables
+    static const char check[] = "123456789";
+    bool known = crc32c(0, check, 9) == 0xE3069283u && crc32cPortable(0, check, 9) == 0xE3069283u &&
+                 crc32c(crc32c(0, check, 4), check + 4, 5) == 0xE3069283u;
+    uint8_t bytes[1024];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (uint8_t)((i * 2654435761u) >> 13);
+    }
+    size_t agreed = 0, compared = 0;
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size <= 300; size++) {
+            agreed += crc32c(0, bytes + offset, size) == crc32cPortable(0, bytes + offset, size) &&
+                      hashBytes(bytes + offset, size, true) == hashBytes(bytes + offset, size, false);
+            compared++;
+        }
+    }
+    printf("  %-18s: check value %s, %zu of %zu hardware/table results agree\n", "CRC32C",
+           known ? "0xE3069283" : "WRONG", agreed, compared);
+    if (!known || agreed != compared) failures++;
+
+    // 2. Chunking does not change the hash
+    uint64_t whole = hashBytes(bytes, sizeof(bytes), true);
+    static const size_t chunks[] = {1, 3, 7, 8, 13, 64};
+    size_t same = 0;
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        cas_Hash hash;
+        initCasHash(&hash, 0);
+        for (size_t pos = 0; pos < sizeof(bytes); pos += chunks[c]) {
+            size_t size = sizeof(bytes) - pos < chunks[c] ? sizeof(bytes) - pos : chunks[c];
+            updateCasHash(&hash, bytes + pos, size);
+        }
+        same += finishCasHash(&hash) == whole;
+    }
+    printf("  %-18s: %zu of %zu chunk sizes give the one-shot hash\n", "Chunked input",
+           same, sizeof(chunks) / sizeof(chunks[0]));
+    if (same != sizeof(chunks) / sizeof(chunks[0])) failures++;
+
+    // 3. Distinct inputs: every single-bit flip of 64 bytes, every 2-byte
+    // value and every other length of a zero buffer (indexed, so the table
+    // grows)
+    cas_HashIndex index;
+    if (!initCasHashIndex(&index, 16)) {
+        fprintf(stderr, "✗ Cannot create the hash index\n");
+        return 1;
+    }
+    uint32_t inserted = 0;
+    size_t repeated = 0;
+    uint8_t flipped[64];
+    for (size_t bit = 0; bit <= 64 * 8; bit++) {
+        memcpy(flipped, bytes, sizeof(flipped));
+        if (bit < 64 * 8) {
+            flipped[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        }
+        repeated += insertCasHashIndex(&index, hashBytes(flipped, sizeof(flipped), true), inserted) != inserted;
+        inserted++;
+    }
+    for (uint32_t value = 0; value < 65536; value++) {
+        uint8_t pair[2] = {value & 0xFF, value >> 8};
+        repeated += insertCasHashIndex(&index, hashBytes(pair, 2, true), inserted) != inserted;
+        inserted++;
+    }
+    uint8_t zeros[64] = {0};
+    for (size_t size = 0; size <= sizeof(zeros); size++) {
+        if (size == 2) {
+            continue;  // Already in as a 2-byte value
+        }
+        repeated += insertCasHashIndex(&index, hashBytes(zeros, size, true), inserted) != inserted;
+        inserted++;
+    }
+    printf("  %-18s: %zu of %u hashes repeated (index holds %zu in %zu slots)\n", "Distinct inputs",
+           repeated, inserted, index.count, index.capacity);
+    if (repeated != 0 || index.count != inserted) failures++;
+
+    // A repeated key returns its first value (the unflipped bytes went in
+    // last of the flips); a missing one is not found
+    uint64_t first_key = hashBytes(bytes, 64, true);
+    bool lookups = insertCasHashIndex(&index, first_key, inserted) == 64 * 8 &&
+                   findCasHashIndex(&index, first_key) == 64 * 8 &&
+                   findCasHashIndex(&index, hashBytes(bytes, 65, true)) == CAS_HASH_INDEX_NONE;
+    printf("  %-18s: %s\n", "Duplicate lookup", lookups ? "first value returned" : "WRONG");
+    if (!lookups) failures++;
+    freeCasHashIndex(&index);
+
+    // 4. CAS payloads
+    TapeVariant reference = {
+        .pad = true, .names = {"GAME  ", "LOADER", "README"}, .load_address = 0x9000, .after_eof = EOF_MARKER
+    };
+    TapeVariant unpadded = reference;          // Same tape, headers unaligned
+    unpadded.pad = false;
+    TapeVariant renamed = unpadded;            // Plus other names, zeros and filler
+    renamed.names[0] = "COPY  ";
+    renamed.names[1] = "BAS   ";
+    renamed.names[2] = "TEXT  ";
+    renamed.basic_zeros = 7;
+    renamed.after_eof = 'Z';
+    TapeVariant moved = reference;             // Binary loads elsewhere
+    moved.load_address = 0xC000;
+
+    TapeHashes ref, flat, other, relocated;
+    if (!hashTape(&reference, &ref) || !hashTape(&unpadded, &flat) ||
+        !hashTape(&renamed, &other) || !hashTape(&moved, &relocated)) {
+        fprintf(stderr, "✗ Cannot parse the synthesized tapes\n");
+        return 1;
+    }
+
+    bool sizes = ref.files[0].size == 6 + 120 && ref.files[1].size == 40 &&
+                 ref.files[2].size == 256 + 8 && ref.files[3].size == 33 &&
+                 ref.blocks[0].size == 120 && ref.blocks[2].size == 256 && ref.blocks[3].size == 8;
+    printf("  %-18s: %s\n", "Payload sizes", sizes ? "headers, padding and EOF filler skipped" : "WRONG");
+    if (!sizes) failures++;
+
+    size_t equal_files = 0, equal_blocks = 0;
+    for (size_t i = 0; i < TAPE_FILES; i++) {
+        equal_files += ref.files[i].hash == flat.files[i].hash && ref.files[i].hash == other.files[i].hash;
+    }
+    for (size_t i = 0; i < TAPE_BLOCKS; i++) {
+        equal_blocks += ref.blocks[i].hash == flat.blocks[i].hash && ref.blocks[i].hash == other.blocks[i].hash;
+    }
+    printf("  %-18s: %zu of %d files, %zu of %d blocks unchanged\n", "Padding and names",
+           equal_files, TAPE_FILES, equal_blocks, TAPE_BLOCKS);
+    if (equal_files != TAPE_FILES || equal_blocks != TAPE_BLOCKS) failures++;
+
+    bool addresses = relocated.files[0].hash != ref.files[0].hash &&
+                     relocated.blocks[0].hash == ref.blocks[0].hash &&
+                     relocated.files[1].hash == ref.files[1].hash;
+    printf("  %-18s: %s\n", "Load address", addresses ? "changes the binary file's hash only" : "WRONG");
+    if (!addresses) failures++;
+
+    bool containers = ref.container == flat.container && ref.container != other.container &&
+                      ref.container != relocated.container;
+    printf("  %-18s: %s\n", "Container hash", containers ? "same files and names only" : "WRONG");
+    if (!containers) failures++;
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d CAS hash check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Content hashes skip headers and padding\n");
+    return 0;
+}
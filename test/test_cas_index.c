@@ -0,0 +1,224 @@
+/*
+ * CAS Index Test - Sidecar Index and Random Access
+ * ================================================
+ *
+ * Writes a CAS file (binary, BASIC, two-block ASCII and custom files),
+ * indexes it with buildCasIndex()/saveCasIndex() and reads every file
+ * back with readIndexedFile().
+ *
+ * Purpose: Verify the index records the same files and blocks as a full
+ *          parse, that each indexed read returns the file's headers,
+ *          block offsets and bytes, and that a stale (the CAS file was
+ *          modified) or damaged index is ignored so callers fall back
+ *          to parsing the whole container: a damaged header, file record
+ *          or block record, or a file record pointing where the CAS file
+ *          has no header. Only a file number out of range is an error.
+ */
+
+#include "../lib/caslib.h"
+#include "../lib/indexlib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#define CAS_NAME "test_index.cas"
+
+// Index layout (indexlib.c): header, file records, then block records
+#define INDEX_HEADER_SIZE 48
+#define INDEX_FILE_SIZE   56
+#define INDEX_BLOCK_SIZE  16
+
+static bool writeFile(const char *path, const uint8_t *data, size_t length) {
+    FILE *f = fopen(path, "wb");
+    bool ok = f && fwrite(data, 1, length, f) == length;
+    return (f && fclose(f) == 0) && ok;
+}
+
+// Overwrite length bytes of the index at offset (its header stays valid)
+static bool patchIndex(long offset, const uint8_t *bytes, size_t length) {
+    FILE *f = fopen(CAS_NAME CAS_INDEX_SUFFIX, "r+b");
+    bool ok = f && fseek(f, offset, SEEK_SET) == 0 && fwrite(bytes, 1, length, f) == length;
+    return (f && fclose(f) == 0) && ok;
+}
+
+static bool rebuildIndex(cas_Index *index) {
+    return buildCasIndex(CAS_NAME, index) && saveCasIndex(CAS_NAME, index);
+}
+
+// A damaged index must be ignored quietly, as if there were none
+static bool ignored(void) {
+    cas_Container single;
+    bool indexed = true;
+    return !readIndexedFile(CAS_NAME, 1, &single, &indexed) && !indexed;
+}
+
+// Same headers, sizes and block bytes at the same offsets
+static bool sameFile(const cas_File *a, const cas_File *b) {
+    if (a->is_custom != b->is_custom || a->data_size != b->data_size ||
+        a->data_block_count != b->data_block_count ||
+        memcmp(&a->header, &b->header, sizeof(a->header)) != 0 ||
+        memcmp(&a->file_header, &b->file_header, sizeof(a->file_header)) != 0 ||
+        memcmp(&a->data_block_header, &b->data_block_header, sizeof(a->data_block_header)) != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < a->data_block_count; i++) {
+        const cas_DataBlock *x = &a->data_blocks[i];
+        const cas_DataBlock *y = &b->data_blocks[i];
+        if (x->data_offset != y->data_offset || x->data_size != y->data_size ||
+            memcmp(x->data, y->data, x->data_size) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    printf("CAS Index Test\n");
+    printf("==============\n\n");
+
+    static uint8_t cas[4096];
+    uint8_t bytes[300];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (uint8_t)(i * 13 + 1);
+    }
+    uint8_t text[40];
+    memset(text, 'A', sizeof(text));
+
+    size_t len = 0;
+    len = putFileHeader(cas, len, FILETYPE_BINARY, "BINARY");
+    len = putBlock(cas, len, bytes, 6 + 120);
+    len = putFileHeader(cas, len, FILETYPE_BASIC, "BASIC ");
+    len = putBlock(cas, len, bytes + 50, 90);
+    len = putFileHeader(cas, len, FILETYPE_ASCII, "ASCII ");
+    len = putBlock(cas, len, text, sizeof(text));
+    text[10] = EOF_MARKER;
+    len = putBlock(cas, len, text, sizeof(text));
+    len = putBlock(cas, len, bytes + 7, 33);
+
+    cas_Container container;
+    if (!writeFile(CAS_NAME, cas, len) || !parseCasContainerInPlace(cas, &container, len)) {
+        fprintf(stderr, "✗ Cannot write or parse %s\n", CAS_NAME);
+        return 1;
+    }
+
+    int failures = 0;
+
+    // Build and save
+    cas_Index index;
+    if (!buildCasIndex(CAS_NAME, &index) || !saveCasIndex(CAS_NAME, &index)) {
+        fprintf(stderr, "✗ Cannot build or save the index\n");
+        return 1;
+    }
+    bool built = index.entry_count == container.file_count && index.block_count == 5 &&
+                 index.source_size == len;
+    for (size_t i = 0; built && i < index.entry_count; i++) {
+        const cas_IndexEntry *entry = &index.entries[i];
+        const cas_File *file = &container.files[i];
+        const cas_DataBlock *last = &file->data_blocks[file->data_block_count - 1];
+        built = entry->file.data_block_count == file->data_block_count &&
+                entry->end_offset == last->data_offset + last->data_size &&
+                index.blocks[entry->first_block].data_offset == file->data_blocks[0].data_offset;
+    }
+    printf("  %-16s: %zu files, %zu blocks %s\n", "Build", index.entry_count, index.block_count,
+           built ? "match the parse" : "MISMATCH");
+    if (!built) failures++;
+
+    // Load it back whole
+    cas_Index loaded;
+    bool reloaded = loadCasIndex(CAS_NAME, &loaded) && loaded.entry_count == index.entry_count &&
+                    loaded.block_count == index.block_count &&
+                    memcmp(loaded.blocks, index.blocks, index.block_count * sizeof(cas_IndexBlock)) == 0;
+    for (size_t i = 0; reloaded && i < index.entry_count; i++) {
+        reloaded = loaded.entries[i].header_offset == index.entries[i].header_offset &&
+                   loaded.entries[i].end_offset == index.entries[i].end_offset &&
+                   loaded.entries[i].first_block == index.entries[i].first_block;
+    }
+    printf("  %-16s: %s\n", "Load", reloaded ? "same entries and blocks" : "MISMATCH");
+    if (!reloaded) failures++;
+    freeCasIndex(&loaded);
+    freeCasIndex(&index);
+
+    // Random access to every file
+    size_t matched = 0;
+    for (size_t i = 0; i < container.file_count; i++) {
+        cas_Container single;
+        bool indexed = false;
+        if (readIndexedFile(CAS_NAME, i, &single, &indexed)) {
+            matched += single.file_count == 1 && sameFile(&single.files[0], &container.files[i]);
+            freeCasContainer(&single);
+        }
+    }
+    printf("  %-16s: %zu of %zu files match the parse\n", "Indexed reads", matched, container.file_count);
+    if (matched != container.file_count) failures++;
+
+    // A modified CAS file makes the index stale
+    struct timespec times[2] = {{0, UTIME_OMIT}, {1000000000, 0}};
+    cas_Container single;
+    bool indexed = true;
+    bool stale = utimensat(AT_FDCWD, CAS_NAME, times, 0) == 0 &&
+                 !readIndexedFile(CAS_NAME, 0, &single, &indexed) && !indexed;
+    printf("  %-16s: %s\n", "Stale index", stale ? "ignored" : "USED");
+    if (!stale) failures++;
+
+    // So does a damaged one (rebuilt first so only the damage matters)
+    if (!buildCasIndex(CAS_NAME, &index) || !saveCasIndex(CAS_NAME, &index)) {
+        fprintf(stderr, "✗ Cannot rebuild the index\n");
+        return 1;
+    }
+    freeCasIndex(&index);
+    static const uint8_t garbage[16] = "CASINDEX garbage";
+    indexed = true;
+    bool damaged = writeFile(CAS_NAME CAS_INDEX_SUFFIX, garbage, sizeof(garbage)) &&
+                   !readIndexedFile(CAS_NAME, 0, &single, &indexed) && !indexed &&
+                   !loadCasIndex(CAS_NAME, &loaded);
+    printf("  %-16s: %s\n", "Damaged index", damaged ? "ignored" : "USED");
+    if (!damaged) failures++;
+
+    // Damage past a valid header: a file record ending beyond the CAS file,
+    // a block record outside its file, a file record one byte off its header
+    static const uint8_t far[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F};
+    bool record = rebuildIndex(&index) &&
+                  patchIndex(INDEX_HEADER_SIZE + INDEX_FILE_SIZE + 8, far, sizeof(far)) &&
+                  ignored() && !loadCasIndex(CAS_NAME, &loaded);
+    freeCasIndex(&index);
+    bool block = rebuildIndex(&index);
+    long block_record = block ? INDEX_HEADER_SIZE + (long)index.entry_count * INDEX_FILE_SIZE +
+                                (long)index.entries[1].first_block * INDEX_BLOCK_SIZE : 0;
+    block = block && patchIndex(block_record, far, sizeof(far)) && ignored() &&
+            !loadCasIndex(CAS_NAME, &loaded);
+    freeCasIndex(&index);
+    uint8_t shifted[8];
+    bool moved = rebuildIndex(&index);
+    uint64_t header_offset = moved ? index.entries[1].header_offset + 1 : 0;
+    for (size_t i = 0; i < sizeof(shifted); i++) {
+        shifted[i] = (uint8_t)(header_offset >> (8 * i));
+    }
+    moved = moved && patchIndex(INDEX_HEADER_SIZE + INDEX_FILE_SIZE, shifted, sizeof(shifted)) &&
+            ignored();
+    freeCasIndex(&index);
+    printf("  %-16s: file record %s, block record %s, moved header %s\n", "Damaged records",
+           record ? "ignored" : "USED", block ? "ignored" : "USED", moved ? "ignored" : "USED");
+    if (!record || !block || !moved) failures++;
+
+    // A file number past the end is an error, not a reason to parse
+    indexed = false;
+    bool out_of_range = rebuildIndex(&index) &&
+                        !readIndexedFile(CAS_NAME, container.file_count, &single, &indexed) &&
+                        indexed;
+    freeCasIndex(&index);
+    printf("  %-16s: %s\n", "Out of range", out_of_range ? "reported" : "NOT REPORTED");
+    if (!out_of_range) failures++;
+
+    freeCasContainer(&container);
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d CAS index check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Indexed reads match the full parse\n");
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * CAS Input Test - Mapped Files and Piped Reads
+ * =============================================
+ *
+ * Writes a CAS image to disk, then loads it with openCasInput() twice:
+ * by filename (a regular file, so it is memory-mapped) and as "-" with
+ * stdin redirected to a pipe fed by a child process (read in chunks).
+ *
+ * Purpose: Verify both paths return the same bytes, that only the
+ *          regular file is mapped, that a container parsed in place
+ *          from either input is identical, and that closeCasInput()
+ *          resets the input. The image is larger than the first read
+ *          buffer so the piped path has to grow it.
+ */
+
+#include "../lib/caslib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define IMAGE_BLOCKS 40
+#define BLOCK_SIZE   4096
+
+// Build a CAS image of custom blocks with a recognisable byte pattern
+static uint8_t *buildImage(size_t *size) {
+    *size = IMAGE_BLOCKS * (8 + BLOCK_SIZE);
+    uint8_t *image = malloc(*size);
+    if (!image) {
+        return NULL;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < IMAGE_BLOCKS; i++) {
+        memcpy(image + pos, CAS_HEADER, 8);
+        pos += 8;
+        for (size_t j = 0; j < BLOCK_SIZE; j++) {
+            image[pos++] = (uint8_t)((i * 31 + j) & 0x7F);
+        }
+    }
+    return image;
+}
+
+// Feed the image to stdin through a pipe written by a child process
+static bool redirectStdin(const uint8_t *image, size_t size) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+
+    pid_t child = fork();
+    if (child < 0) {
+        return false;
+    }
+    if (child == 0) {
+        close(fds[0]);
+        size_t written = 0;
+        while (written < size) {
+            ssize_t result = write(fds[1], image + written, size - written);
+            if (result <= 0) {
+                _exit(1);
+            }
+            written += (size_t)result;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    bool ok = dup2(fds[0], STDIN_FILENO) >= 0;
+    close(fds[0]);
+    return ok;
+}
+
+// Parse in place and check the block layout
+static bool checkContainer(const cas_Input *input, const char *label) {
+    cas_Container container;
+    if (!parseCasContainerInPlace(input->data, &container, input->size)) {
+        printf("  ✗ %s: parse failed\n", label);
+        return false;
+    }
+
+    size_t blocks = 0;
+    bool inside = true;
+    for (size_t i = 0; i < container.file_count; i++) {
+        const cas_File *file = &container.files[i];
+        for (size_t j = 0; j < file->data_block_count; j++) {
+            const cas_DataBlock *block = &file->data_blocks[j];
+            blocks++;
+            inside = inside && block->data >= input->data &&
+                     block->data + block->data_size <= input->data + input->size;
+        }
+    }
+    printf("  %s: %zu files, %zu blocks\n", label, container.file_count, blocks);
+    freeCasContainer(&container);
+
+    if (blocks != IMAGE_BLOCKS || !inside) {
+        printf("  ✗ %s: expected %d blocks inside the input\n", label, IMAGE_BLOCKS);
+        return false;
+    }
+    return true;
+}
+
+int main(void) {
+    printf("CAS Input Test - Mapped Files and Piped Reads\n");
+    printf("=============================================\n\n");
+
+    size_t size;
+    uint8_t *image = buildImage(&size);
+    if (!image) {
+        return 1;
+    }
+
+    const char *filename = "test_input.cas";
+    FILE *f = fopen(filename, "wb");
+    if (!f || fwrite(image, 1, size, f) != size || fclose(f) != 0) {
+        printf("✗ Failed to write %s\n", filename);
+        free(image);
+        return 1;
+    }
+    printf("Image: %zu bytes\n\n", size);
+
+    bool ok = true;
+
+    // Regular file: mapped
+    cas_Input file_input;
+    if (!openCasInput(filename, &file_input)) {
+        free(image);
+        return 1;
+    }
+    printf("File input: %zu bytes, %s\n", file_input.size, file_input.mapped ? "mapped" : "read");
+    ok = ok && file_input.mapped && file_input.size == size &&
+         memcmp(file_input.data, image, size) == 0;
+    ok = checkContainer(&file_input, "File input") && ok;
+
+    // Pipe on stdin: read
+    cas_Input pipe_input;
+    if (!redirectStdin(image, size) || !openCasInput("-", &pipe_input)) {
+        closeCasInput(&file_input);
+        free(image);
+        return 1;
+    }
+    wait(NULL);
+    printf("Pipe input: %zu bytes, %s\n", pipe_input.size, pipe_input.mapped ? "mapped" : "read");
+    ok = ok && !pipe_input.mapped && pipe_input.size == size &&
+         memcmp(pipe_input.data, image, size) == 0;
+    ok = checkContainer(&pipe_input, "Pipe input") && ok;
+
+    closeCasInput(&file_input);
+    closeCasInput(&pipe_input);
+    ok = ok && file_input.data == NULL && file_input.size == 0 &&
+         pipe_input.data == NULL && !pipe_input.mapped;
+
+    // A missing file is an error, not an empty input
+    cas_Input missing;
+    ok = ok && !openCasInput("test_input_missing.cas", &missing);
+
+    free(image);
+    printf("\n%s\n", ok ? "✓ Both inputs match the image" : "✗ Inputs differ");
+    return ok ? 0 : 1;
+}
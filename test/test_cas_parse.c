@@ -0,0 +1,148 @@
+/*
+ * CAS Parse Test - Zero-Copy and Copying Parses
+ * =============================================
+ * 
+ * Parses one synthesized CAS image (binary, BASIC, two-block ASCII and
+ * custom files) with parseCasContainer() and parseCasContainerInPlace().
+ * 
+ * Purpose: Verify both parses find the same files and blocks, that
+ *          in-place blocks point into the source buffer at their
+ *          data_offset, that copied blocks live in the container's own
+ *          arena (which grows by exactly the block bytes), and that
+ *          freeCasContainer() releases it. A second image without
+ *          padding checks that the header scanner finds headers at
+ *          unaligned offsets past partial matches.
+ */
+
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Check block counts and contents; in place blocks must view the source
+static int checkContainer(const char *label, const cas_Container *container,
+                          const uint8_t *source, size_t length, bool in_place) {
+    static const size_t expected_blocks[] = {1, 1, 2, 1};
+    int failures = 0;
+    
+    if (container->file_count != 4) {
+        printf("  %-14s: %zu files (expected 4)\n", label, container->file_count);
+        return 1;
+    }
+    
+    size_t total_blocks = 0;
+    for (size_t i = 0; i < container->file_count; i++) {
+        const cas_File *file = &container->files[i];
+        if (file->data_block_count != expected_blocks[i]) {
+            failures++;
+        }
+        for (size_t j = 0; j < file->data_block_count; j++) {
+            const cas_DataBlock *block = &file->data_blocks[j];
+            bool inside = block->data >= source && block->data < source + length;
+            if (block->data_offset + block->data_size > length ||
+                memcmp(block->data, source + block->data_offset, block->data_size) != 0 ||
+                (in_place ? block->data != source + block->data_offset : inside)) {
+                failures++;
+            }
+            total_blocks++;
+        }
+    }
+    
+    printf("  %-14s: %zu files, %zu blocks, data %s\n", label, container->file_count, total_blocks,
+           failures ? "MISMATCH" : (in_place ? "viewed in place" : "copied"));
+    return failures;
+}
+
+int main(void) {
+    printf("CAS Parse Test\n");
+    printf("==============\n\n");
+    
+    static uint8_t cas[4096];
+    uint8_t bytes[300];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (uint8_t)(i * 13 + 1);
+    }
+    uint8_t text[40];
+    memset(text, 'A', sizeof(text));
+    
+    size_t len = 0;
+    len = putFileHeader(cas, len, FILETYPE_BINARY, "BINARY");
+    len = putBlock(cas, len, bytes, 6 + 120);            // Address header + code
+    len = putFileHeader(cas, len, FILETYPE_BASIC, "BASIC ");
+    len = putBlock(cas, len, bytes + 50, 90);
+    len = putFileHeader(cas, len, FILETYPE_ASCII, "ASCII ");
+    len = putBlock(cas, len, text, sizeof(text));
+    text[10] = EOF_MARKER;
+    len = putBlock(cas, len, text, sizeof(text));
+    len = putBlock(cas, len, bytes + 7, 33);             // Custom block
+    
+    int failures = 0;
+    
+    cas_Container copied;
+    if (!parseCasContainer(cas, &copied, len)) {
+        fprintf(stderr, "✗ parseCasContainer failed\n");
+        return 1;
+    }
+    failures += checkContainer("Copying parse", &copied, cas, len, false);
+    
+    cas_Container viewed;
+    if (!parseCasContainerInPlace(cas, &viewed, len)) {
+        fprintf(stderr, "✗ parseCasContainerInPlace failed\n");
+        return 1;
+    }
+    failures += checkContainer("In-place parse", &viewed, cas, len, true);
+    
+    // Both parses fit their arena; the copy adds exactly the block bytes
+    cas_ContainerStats copied_stats;
+    cas_ContainerStats viewed_stats;
+    getCasContainerStats(&copied, &copied_stats);
+    getCasContainerStats(&viewed, &viewed_stats);
+    size_t block_bytes = 0;
+    for (size_t i = 0; i < viewed.file_count; i++) {
+        for (size_t j = 0; j < viewed.files[i].data_block_count; j++) {
+            block_bytes += viewed.files[i].data_blocks[j].data_size;
+        }
+    }
+    bool arena_ok = copied_stats.block_count == 5 && viewed_stats.block_count == 5 &&
+                    copied_stats.arena_used <= copied_stats.arena_capacity &&
+                    viewed_stats.arena_used <= viewed_stats.arena_capacity &&
+                    copied_stats.arena_used == viewed_stats.arena_used + block_bytes &&
+                    (uint8_t*)copied.files == copied.arena.base;
+    printf("  %-14s: %zu bytes copied, %zu viewed %s\n", "Arena", copied_stats.arena_used,
+           viewed_stats.arena_used, arena_ok ? "(as expected)" : "MISMATCH");
+    if (!arena_ok) failures++;
+    
+    // Unpadded custom blocks put headers at odd offsets; the data holds
+    // 0x1F bytes and a header prefix that must not be taken for a header
+    static const uint8_t tricky[] = {0x1F, 0x1F, 0xA6, 0xDE, 0xBA, 0xCC, 0x13, 0x7D, 0x1F, 0x00, 0x55, 0x1F};
+    uint8_t odd[64];
+    size_t odd_len = 0;
+    for (int i = 0; i < 3; i++) {
+        memcpy(odd + odd_len, CAS_HEADER, 8);
+        memcpy(odd + odd_len + 8, tricky, sizeof(tricky) - (size_t)i);
+        odd_len += 8 + sizeof(tricky) - (size_t)i;
+    }
+    cas_Container unaligned;
+    bool found = parseCasContainerInPlace(odd, &unaligned, odd_len) && unaligned.file_count == 3;
+    for (size_t i = 0; found && i < 3; i++) {
+        found = unaligned.files[i].data_blocks[0].data_size == sizeof(tricky) - i;
+    }
+    printf("  %-14s: %s\n", "Unaligned", found ? "3 headers at odd offsets found" : "MISSED");
+    if (!found) failures++;
+    freeCasContainer(&unaligned);
+    
+    freeCasContainer(&copied);
+    freeCasContainer(&viewed);
+    bool released = !copied.files && copied.file_count == 0 && !copied.arena.base &&
+                    !viewed.files && viewed.file_count == 0 && !viewed.arena.base;
+    printf("  %-14s: %s\n", "Free", released ? "containers reset" : "NOT RESET");
+    if (!released) failures++;
+    
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d CAS parse check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Zero-copy and copying parses agree\n");
+    return 0;
+}
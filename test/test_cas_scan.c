@@ -0,0 +1,284 @@
+/*
+ * CAS Scan Test - Parallel Walk and Catalog Records
+ * =================================================
+ *
+ * Builds a small archive tree under test_scan/: a binary and a BASIC file
+ * at the top, a two-block ASCII file one level down, a custom block two
+ * levels down, an empty .cas file and a text file. Walks it with
+ * walkCasFiles() on one and on four threads, then runs execute_scan() for
+ * NDJSON and CSV records.
+ *
+ * Purpose: Verify the walk recurses into subdirectories, visits every CAS
+ *          file exactly once whatever the thread count and skips other
+ *          files; that cast scan writes one record per tape file, the same
+ *          records on one thread as on four; and that a CAS file without
+ *          tape data and a missing path are counted and reported as
+ *          failures.
+ */
+
+#include "../lib/caslib.h"
+#include "../lib/cmdlib.h"
+#include "../commands/commands.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define SCAN_DIR    "test_scan"
+#define EMPTY_CAS   SCAN_DIR "/sub/empty.cas"
+#define ERROR_LOG   "test_scan.err"
+#define TAPE_FILES  4   // Tape files in the valid CAS files
+#define CAS_FILES   4   // CAS files in the tree, the empty one included
+
+static const char *cas_paths[CAS_FILES] = {
+    SCAN_DIR "/a.cas", SCAN_DIR "/sub/b.cas", SCAN_DIR "/sub/deep/c.cas", EMPTY_CAS
+};
+
+static bool writeFile(const char *path, const uint8_t *data, size_t length) {
+    FILE *f = fopen(path, "wb");
+    bool ok = f && fwrite(data, 1, length, f) == length;
+    return f && fclose(f) == 0 && ok;
+}
+
+// The archive tree; returns the total size of its CAS files
+static size_t buildTree(void) {
+    mkdir(SCAN_DIR, 0755);
+    mkdir(SCAN_DIR "/sub", 0755);
+    mkdir(SCAN_DIR "/sub/deep", 0755);
+
+    static uint8_t cas[2048];
+    uint8_t binary[6 + 64] = {0x00, 0xC0, 0x3F, 0xC0, 0x00, 0xC0};
+    for (size_t i = 0; i < 64; i++) {
+        binary[6 + i] = (uint8_t)(i * 5 + 1);
+    }
+    uint8_t basic[40];
+    for (size_t i = 0; i < sizeof(basic); i++) {
+        basic[i] = (uint8_t)(0x81 + i);
+    }
+    size_t len = putFileHeader(cas, 0, FILETYPE_BINARY, "GAME  ");
+    len = putBlock(cas, len, binary, sizeof(binary));
+    len = putFileHeader(cas, len, FILETYPE_BASIC, "LOADER");
+    len = putBlock(cas, len, basic, sizeof(basic));
+    size_t total = len;
+    bool ok = writeFile(cas_paths[0], cas, len);
+
+    uint8_t text[256], eof[256];
+    memset(text, 'A', sizeof(text));
+    memset(eof, 0x1A, sizeof(eof));
+    len = putFileHeader(cas, 0, FILETYPE_ASCII, "NOTES ");
+    len = putBlock(cas, len, text, sizeof(text));
+    len = putBlock(cas, len, eof, sizeof(eof));
+    total += len;
+    ok = ok && writeFile(cas_paths[1], cas, len);
+
+    len = putBlock(cas, 0, binary, 33);
+    total += len;
+    ok = ok && writeFile(cas_paths[2], cas, len);
+
+    ok = ok && writeFile(EMPTY_CAS, cas, 0) &&
+         writeFile(SCAN_DIR "/sub/readme.txt", (const uint8_t *)"not a tape\n", 11);
+    return ok ? total : 0;
+}
+
+// =============================================================================
+// Walk
+// =============================================================================
+
+typedef struct {
+    pthread_mutex_t lock;
+    const char *visited[2 * CAS_FILES];
+    size_t count;
+    size_t tape_files;
+} WalkLog;
+
+static bool logVisit(void *context, const char *path, const cas_Container *container,
+                     size_t input_size) {
+    (void)input_size;
+    WalkLog *log = context;
+    pthread_mutex_lock(&log->lock);
+    for (size_t i = 0; i < CAS_FILES; i++) {
+        if (strcmp(path, cas_paths[i]) == 0 && log->count < 2 * CAS_FILES) {
+            log->visited[log->count++] = cas_paths[i];
+        }
+    }
+    log->tape_files += container->file_count;
+    pthread_mutex_unlock(&log->lock);
+    return true;
+}
+
+static bool checkWalk(uint16_t threads, size_t cas_bytes) {
+    WalkLog log = {.lock = PTHREAD_MUTEX_INITIALIZER};
+    char *paths[] = {SCAN_DIR};
+    CasWalkStats stats;
+    walkCasFiles(paths, 1, threads, logVisit, &log, &stats);
+
+    // Each CAS file once: the text file is skipped, nothing twice
+    size_t distinct = 0;
+    for (size_t i = 0; i < CAS_FILES; i++) {
+        size_t seen = 0;
+        for (size_t j = 0; j < log.count; j++) {
+            seen += log.visited[j] == cas_paths[i];
+        }
+        distinct += seen == 1;
+    }
+    bool ok = distinct == CAS_FILES && log.count == CAS_FILES && stats.containers == CAS_FILES &&
+              stats.failed == 0 && stats.bytes == cas_bytes && log.tape_files == TAPE_FILES &&
+              !stats.out_of_memory;
+    char label[32];
+    snprintf(label, sizeof(label), "Walk, %u thread%s", threads, threads == 1 ? "" : "s");
+    printf("  %-22s: %zu of %d CAS files once, %zu tape files, %llu bytes\n", label, distinct,
+           CAS_FILES, log.tape_files, (unsigned long long)stats.bytes);
+    return ok;
+}
+
+// =============================================================================
+// Scan Records
+// =============================================================================
+
+// Run execute_scan() with its error messages in ERROR_LOG
+static int scanTo(char **paths, size_t path_count, bool csv, const char *output, uint16_t threads) {
+    fflush(stderr);
+    int saved = dup(STDERR_FILENO);
+    int log = open(ERROR_LOG, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (saved < 0 || log < 0) {
+        return -1;
+    }
+    dup2(log, STDERR_FILENO);
+    close(log);
+    int result = execute_scan(paths, path_count, csv, output, threads, 1200, false);
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    return result;
+}
+
+static int compareLines(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+// Lines of a file, sorted (records come out in completion order)
+static char** sortedLines(const char *path, size_t *count, char **text) {
+    size_t size;
+    uint8_t *data = readFile(path, &size);
+    *count = 0;
+    *text = NULL;
+    if (!data) {
+        return NULL;
+    }
+    char *copy = malloc(size + 1);
+    char **lines = malloc((size + 1) * sizeof(char *));
+    if (!copy || !lines) {
+        free(data);
+        free(copy);
+        free(lines);
+        return NULL;
+    }
+    memcpy(copy, data, size);
+    copy[size] = '\0';
+    free(data);
+    for (char *line = strtok(copy, "\n"); line; line = strtok(NULL, "\n")) {
+        lines[(*count)++] = line;
+    }
+    qsort(lines, *count, sizeof(char *), compareLines);
+    *text = copy;
+    return lines;
+}
+
+static bool logHas(const char *needle) {
+    size_t size;
+    uint8_t *data = readFile(ERROR_LOG, &size);
+    char *text = data ? realloc(data, size + 1) : NULL;
+    if (!text) {
+        free(data);
+        return false;
+    }
+    text[size] = '\0';
+    bool found = strstr(text, needle) != NULL;
+    free(text);
+    return found;
+}
+
+static bool checkRecords(void) {
+    char *paths[] = {SCAN_DIR};
+    int serial_result = scanTo(paths, 1, false, "test_scan_1.ndjson", 1);
+    int parallel_result = scanTo(paths, 1, false, "test_scan_4.ndjson", 4);
+    bool reported = logHas("Error: '" EMPTY_CAS "' holds no tape files") &&
+                    logHas("Scanned 3 CAS file(s) holding 4 tape file(s)") && logHas("(1 failed)");
+
+    size_t serial_count, parallel_count;
+    char *serial_text, *parallel_text;
+    char **serial = sortedLines("test_scan_1.ndjson", &serial_count, &serial_text);
+    char **parallel = sortedLines("test_scan_4.ndjson", &parallel_count, &parallel_text);
+    bool same = serial && parallel && serial_count == parallel_count;
+    for (size_t i = 0; same && i < serial_count; i++) {
+        same = strcmp(serial[i], parallel[i]) == 0;
+    }
+    bool binary = false;
+    for (size_t i = 0; parallel && i < parallel_count; i++) {
+        binary = binary || (strstr(parallel[i], "\"path\":\"" SCAN_DIR "/a.cas\",\"index\":1") &&
+                            strstr(parallel[i], "\"type\":\"BINARY\",\"name\":\"GAME\"") &&
+                            strstr(parallel[i], "\"load\":\"0xC000\",\"end\":\"0xC03F\""));
+    }
+    free(serial);
+    free(parallel);
+    free(serial_text);
+    free(parallel_text);
+
+    bool ok = serial_result == 1 && parallel_result == 1 && reported && same &&
+              parallel_count == TAPE_FILES && binary;
+    printf("  %-22s: %zu records, %s on 1 and 4 threads, empty file %s, exit %d\n",
+           "NDJSON records", parallel_count, same ? "same" : "DIFFERENT",
+           reported ? "reported" : "NOT REPORTED", parallel_result);
+
+    // CSV: the header, then one row per tape file
+    int csv_result = scanTo(paths, 1, true, "test_scan.csv", 4);
+    size_t csv_count;
+    char *csv_text;
+    char **rows = sortedLines("test_scan.csv", &csv_count, &csv_text);
+    // strtok() ended the first line in place, so the text starts with it
+    bool header = csv_text && strcmp(csv_text, "path,index,files,type,name,load,end,exec,size,"
+                                               "blocks,duration") == 0;
+    free(rows);
+    free(csv_text);
+    bool csv_ok = csv_result == 1 && header && csv_count == TAPE_FILES + 1;
+    printf("  %-22s: %zu lines (header %s)\n", "CSV records", csv_count,
+           header ? "first" : "MISSING");
+
+    // A path that does not exist fails on its own; the rest are scanned
+    char *missing[] = {SCAN_DIR "/sub/b.cas", SCAN_DIR "/missing.cas"};
+    int missing_result = scanTo(missing, 2, false, "test_scan_missing.ndjson", 2);
+    bool missing_ok = missing_result == 1 && logHas("Cannot access '" SCAN_DIR "/missing.cas'") &&
+                      logHas("Scanned 1 CAS file(s) holding 1 tape file(s)") &&
+                      logHas("(1 failed)");
+    printf("  %-22s: %s\n", "Missing path", missing_ok ? "reported" : "NOT REPORTED");
+
+    return ok && csv_ok && missing_ok;
+}
+
+int main(void) {
+    printf("CAS Scan Test\n");
+    printf("=============\n\n");
+
+    size_t cas_bytes = buildTree();
+    if (cas_bytes == 0) {
+        fprintf(stderr, "✗ Cannot build the %s tree\n", SCAN_DIR);
+        return 1;
+    }
+
+    int failures = 0;
+    if (!checkWalk(1, cas_bytes)) failures++;
+    if (!checkWalk(4, cas_bytes)) failures++;
+    if (!checkRecords()) failures++;
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d scan check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Scans find every CAS file once and report the invalid ones\n");
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * CAS Stream Test - Push Parser Fed in Chunks
+ * ===========================================
+ *
+ * Feeds one synthesized CAS image (binary, BASIC, two-block ASCII and
+ * unpadded custom files) to the streaming parser in chunks of 1, 3, 7,
+ * 64 bytes and all at once, and rebuilds every block from the events.
+ *
+ * Purpose: Verify that chunk boundaries never change the result: each
+ *          run must report the same files, block offsets, sizes and
+ *          bytes as parseCasContainerInPlace(), with CAS headers split
+ *          across chunks. An ASCII file cut off before its EOF marker
+ *          must start but never end, and make the parse fail.
+ */
+
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_BLOCKS 16
+
+// Blocks rebuilt from stream events
+typedef struct {
+    size_t files_started;
+    size_t files_ended;
+    size_t block_count;
+    size_t offsets[MAX_BLOCKS];
+    size_t sizes[MAX_BLOCKS];
+    uint8_t bytes[4096];      // All block bytes, back to back
+    size_t byte_count;
+    size_t next_offset;       // Where the next data span must start
+    bool spans_ok;
+} StreamLog;
+
+static bool onFileStart(void *context, const cas_File *file, size_t offset) {
+    (void)file;
+    (void)offset;
+    ((StreamLog *)context)->files_started++;
+    return true;
+}
+
+static bool onBlockStart(void *context, const cas_File *file, const cas_Header *header, size_t offset) {
+    (void)file;
+    StreamLog *log = context;
+    if (log->block_count >= MAX_BLOCKS || memcmp(header->bytes, CAS_HEADER, 8) != 0) {
+        return false;
+    }
+    log->offsets[log->block_count++] = offset;
+    log->next_offset = offset;
+    return true;
+}
+
+static bool onBlockData(void *context, const uint8_t *data, size_t size, size_t offset) {
+    StreamLog *log = context;
+    if (offset != log->next_offset || log->byte_count + size > sizeof(log->bytes)) {
+        log->spans_ok = false;
+        return false;
+    }
+    memcpy(log->bytes + log->byte_count, data, size);
+    log->byte_count += size;
+    log->next_offset += size;
+    return true;
+}
+
+static bool onBlockEnd(void *context, size_t size) {
+    StreamLog *log = context;
+    log->sizes[log->block_count - 1] = size;
+    return true;
+}
+
+static bool onFileEnd(void *context, const cas_File *file) {
+    (void)file;
+    ((StreamLog *)context)->files_ended++;
+    return true;
+}
+
+static const cas_StreamCallbacks log_callbacks = {
+    .file_start = onFileStart,
+    .block_start = onBlockStart,
+    .block_data = onBlockData,
+    .block_end = onBlockEnd,
+    .file_end = onFileEnd
+};
+
+// Feed data in chunks of chunk bytes (0: all at once)
+static bool streamImage(const uint8_t *data, size_t length, size_t chunk, StreamLog *log) {
+    memset(log, 0, sizeof(*log));
+    log->spans_ok = true;
+
+    cas_StreamParser *parser = createCasStreamParser(&log_callbacks, log);
+    if (!parser) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t pos = 0; pos < length; ) {
+        size_t piece = (chunk == 0 || chunk > length - pos) ? length - pos : chunk;
+        ok = feedCasStreamParser(parser, data + pos, piece) && ok;
+        pos += piece;
+    }
+    ok = finishCasStreamParser(parser) && ok;
+    ok = ok && getCasStreamOffset(parser) == length;
+    freeCasStreamParser(parser);
+    return ok;
+}
+
+// Compare the rebuilt blocks with the in-place container
+static int checkLog(const StreamLog *log, const cas_Container *container, const uint8_t *source) {
+    size_t block = 0;
+    size_t byte = 0;
+    int failures = 0;
+
+    for (size_t i = 0; i < container->file_count; i++) {
+        const cas_File *file = &container->files[i];
+        for (size_t j = 0; j < file->data_block_count; j++, block++) {
+            const cas_DataBlock *expected = &file->data_blocks[j];
+            if (block >= log->block_count ||
+                log->offsets[block] != expected->data_offset ||
+                log->sizes[block] != expected->data_size ||
+                memcmp(log->bytes + byte, source + expected->data_offset, expected->data_size) != 0) {
+                failures++;
+            }
+            byte += expected->data_size;
+        }
+    }
+    if (block != log->block_count || byte != log->byte_count || !log->spans_ok ||
+        log->files_started != container->file_count || log->files_ended != container->file_count) {
+        failures++;
+    }
+    return failures;
+}
+
+int main(void) {
+    printf("CAS Stream Test\n");
+    printf("===============\n\n");
+
+    static uint8_t cas[4096];
+    uint8_t bytes[300];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (uint8_t)(i * 13 + 1);
+    }
+    uint8_t text[40];
+    memset(text, 'A', sizeof(text));
+
+    // The custom blocks hold a header prefix and sit at odd offsets
+    static const uint8_t tricky[] = {0x1F, 0x1F, 0xA6, 0xDE, 0xBA, 0xCC, 0x13, 0x7D, 0x1F, 0x00, 0x55, 0x1F};
+    size_t len = 0;
+    len = putFileHeader(cas, len, FILETYPE_BINARY, "BINARY");
+    len = putBlock(cas, len, bytes, 6 + 120);
+    len = putFileHeader(cas, len, FILETYPE_BASIC, "BASIC ");
+    len = putBlock(cas, len, bytes + 50, 90);
+    len = putFileHeader(cas, len, FILETYPE_ASCII, "ASCII ");
+    len = putBlock(cas, len, text, sizeof(text));
+    text[10] = EOF_MARKER;
+    len = putBlock(cas, len, text, sizeof(text));
+    len = putUnpaddedBlock(cas, len, tricky, sizeof(tricky));
+    len = putUnpaddedBlock(cas, len, tricky, sizeof(tricky) - 1);
+
+    cas_Container container;
+    if (!parseCasContainerInPlace(cas, &container, len)) {
+        fprintf(stderr, "✗ parseCasContainerInPlace failed\n");
+        return 1;
+    }
+
+    int failures = 0;
+    static const size_t chunks[] = {1, 3, 7, 64, 0};
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        StreamLog log;
+        bool ok = streamImage(cas, len, chunks[i], &log);
+        int mismatches = checkLog(&log, &container, cas);
+        char label[32] = "One chunk";
+        if (chunks[i]) {
+            snprintf(label, sizeof(label), "%zu-byte chunks", chunks[i]);
+        }
+        printf("  %-15s: %zu files, %zu blocks, %s\n", label, log.files_ended, log.block_count,
+               (ok && mismatches == 0) ? "match" : "MISMATCH");
+        if (!ok || mismatches) failures++;
+    }
+
+    // Cut the image inside the second ASCII block, before its EOF marker
+    size_t ascii_start = container.files[2].data_blocks[0].data_offset - 32;
+    size_t cut = container.files[2].data_blocks[1].data_offset + 5;
+    StreamLog log;
+    printf("  (a parse error is expected next)\n");
+    fflush(stdout);
+    bool ok = streamImage(cas + ascii_start, cut - ascii_start, 5, &log);
+    bool dropped = !ok && log.files_started == 1 && log.files_ended == 0 && log.block_count == 2;
+    printf("  %-15s: %s\n", "Truncated ASCII", dropped ? "started, never ended, parse failed" : "NOT DROPPED");
+    if (!dropped) failures++;
+
+    freeCasContainer(&container);
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d CAS stream check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Chunked streams match the whole-buffer parse\n");
+    return 0;
+}
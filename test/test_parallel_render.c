@@ -0,0 +1,114 @@
+/*
+ * Parallel Render Test - Multi-threaded CAS to WAV
+ * ================================================
+ * 
+ * Converts a synthesized CAS file (binary file with a 40 KB block, so
+ * the block is split across several render jobs, plus a custom block)
+ * single-threaded and with worker threads:
+ * 1. test_parallel.cas    - synthesized input
+ * 2. test_parallel_1.wav  - reference (render_threads = 1)
+ * 3. test_parallel_n.wav  - worker threads writing at layout offsets
+ * 
+ * Purpose: Verify threaded output is byte-identical, including across
+ *          low-pass filter boundaries (a very low cutoff forces the
+ *          serial repair of mis-estimated filter states).
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Compare two files byte by byte
+static bool filesIdentical(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    bool same = fa && fb;
+    
+    while (same) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) {
+            same = false;
+        } else if (ca == EOF) {
+            break;
+        }
+    }
+    
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+int main(void) {
+    printf("Parallel Render Test\n");
+    printf("====================\n\n");
+    
+    // Binary file: header block, then address header + 40000 bytes
+    static uint8_t cas[48 * 1024];
+    static uint8_t payload[6 + 40000];
+    uint8_t header[16];
+    memset(header, 0xD0, 10);
+    memcpy(header + 10, "PARTST", 6);
+    payload[0] = 0x00; payload[1] = 0x90;   // Load address
+    payload[2] = 0x40; payload[3] = 0x2C;   // End address
+    payload[4] = 0x00; payload[5] = 0x90;   // Exec address
+    for (size_t i = 6; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 31 + (i >> 7));
+    }
+    
+    size_t len = 0;
+    len = putBlock(cas, len, header, sizeof(header));
+    len = putBlock(cas, len, payload, sizeof(payload));
+    len = putBlock(cas, len, payload + 1000, 77);   // Custom block
+    
+    FILE *f = fopen("test_parallel.cas", "wb");
+    if (!f || fwrite(cas, 1, len, f) != len) {
+        fprintf(stderr, "✗ Cannot write test_parallel.cas\n");
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    
+    const uint16_t cutoffs[] = {0, 6000, 50};   // 0 = low-pass off
+    const uint16_t thread_counts[] = {2, 5};
+    int failures = 0;
+    
+    for (size_t c = 0; c < sizeof(cutoffs) / sizeof(cutoffs[0]); c++) {
+        WaveformConfig config = createWaveform(WAVE_SINE, 120);
+        config.enable_markers = true;
+        config.enable_lowpass = (cutoffs[c] != 0);
+        config.lowpass_cutoff_hz = cutoffs[c] ? cutoffs[c] : 6000;
+        config.render_threads = 1;
+        
+        if (!convertCasToWav("test_parallel.cas", "test_parallel_1.wav", &config, false, NULL)) {
+            fprintf(stderr, "✗ Single-threaded conversion failed\n");
+            return 1;
+        }
+        
+        for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+            config.render_threads = thread_counts[t];
+            bool ok = convertCasToWav("test_parallel.cas", "test_parallel_n.wav", &config, false, NULL) &&
+                      filesIdentical("test_parallel_1.wav", "test_parallel_n.wav");
+            
+            if (cutoffs[c]) {
+                printf("  low-pass %4u Hz, %u threads: %s\n", cutoffs[c], thread_counts[t],
+                       ok ? "identical" : "MISMATCH");
+            } else {
+                printf("  low-pass  off,    %u threads: %s\n", thread_counts[t],
+                       ok ? "identical" : "MISMATCH");
+            }
+            if (!ok) failures++;
+        }
+    }
+    
+    printf("\n");
+    if (failures) {
+        fprintf(stderr, "✗ %d configuration(s) differ\n", failures);
+        return 1;
+    }
+    printf("✓ Threaded output matches single-threaded output\n");
+    return 0;
+}
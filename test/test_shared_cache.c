@@ -0,0 +1,139 @@
+/*
+ * Shared Cache Test - Concurrent Conversions From One Waveform Table
+ * ==================================================================
+ * 
+ * Converts a synthesized CAS file once with convertCasToWav() and then
+ * on four threads at the same time, all rendering from one WaveformCache
+ * (as `cast convert --batch` does):
+ * 1. test_shared.cas      - synthesized input
+ * 2. test_shared_ref.wav  - reference (cache built by the conversion)
+ * 3. test_shared_N.wav    - concurrent conversions sharing the cache
+ * 
+ * Purpose: Verify a shared, read-only cache gives byte-identical output
+ *          from concurrent conversions and that a cache built for other
+ *          settings is rejected.
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#define THREAD_COUNT 4
+
+typedef struct {
+    const WaveformConfig *config;
+    const WaveformCache *cache;
+    char output[32];
+    bool ok;
+} Conversion;
+
+// Compare two files byte by byte
+static bool filesIdentical(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    bool same = fa && fb;
+    
+    while (same) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) {
+            same = false;
+        } else if (ca == EOF) {
+            break;
+        }
+    }
+    
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+static void* convertThread(void *arg) {
+    Conversion *conversion = arg;
+    conversion->ok = convertCasToWavCached("test_shared.cas", conversion->output,
+                                           conversion->config, conversion->cache,
+                                           false, NULL);
+    return NULL;
+}
+
+int main(void) {
+    printf("Shared Cache Test\n");
+    printf("=================\n\n");
+    
+    // ASCII file: header block and one data block
+    static uint8_t cas[4096];
+    static uint8_t text[1024];
+    uint8_t header[16];
+    memset(header, 0xEA, 10);
+    memcpy(header + 10, "SHARED", 6);
+    for (size_t i = 0; i < sizeof(text); i++) {
+        text[i] = (uint8_t)(' ' + (i * 7) % 90);
+    }
+    text[sizeof(text) - 1] = 0x1A;   // ASCII end of file
+    
+    size_t len = 0;
+    len = putBlock(cas, len, header, sizeof(header));
+    len = putBlock(cas, len, text, sizeof(text));
+    
+    FILE *f = fopen("test_shared.cas", "wb");
+    if (!f || fwrite(cas, 1, len, f) != len) {
+        fprintf(stderr, "✗ Cannot write test_shared.cas\n");
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    
+    WaveformConfig config = createWaveform(WAVE_TRAPEZOID, 110);
+    config.enable_lowpass = true;
+    config.enable_markers = true;
+    if (!convertCasToWav("test_shared.cas", "test_shared_ref.wav", &config, false, NULL)) {
+        fprintf(stderr, "✗ Reference conversion failed\n");
+        return 1;
+    }
+    
+    WaveformCache *cache = createWaveformCache(&config);
+    if (!cache) {
+        fprintf(stderr, "✗ Cannot build waveform cache\n");
+        return 1;
+    }
+    
+    // All threads read the same table at once
+    Conversion conversions[THREAD_COUNT];
+    pthread_t threads[THREAD_COUNT];
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        conversions[i].config = &config;
+        conversions[i].cache = cache;
+        snprintf(conversions[i].output, sizeof(conversions[i].output), "test_shared_%d.wav", i + 1);
+        pthread_create(&threads[i], NULL, convertThread, &conversions[i]);
+    }
+    
+    int failures = 0;
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+        bool same = conversions[i].ok &&
+                    filesIdentical("test_shared_ref.wav", conversions[i].output);
+        printf("  %s: %s\n", conversions[i].output, same ? "identical" : "MISMATCH");
+        if (!same) failures++;
+    }
+    
+    // A table rendered for another waveform must not be used
+    WaveformConfig other = config;
+    other.type = WAVE_SQUARE;
+    bool rejected = !convertCasToWavCached("test_shared.cas", "test_shared_1.wav",
+                                           &other, cache, false, NULL);
+    printf("  Mismatched cache: %s\n", rejected ? "rejected" : "NOT DETECTED");
+    if (!rejected) failures++;
+    
+    freeWaveformCache(cache);
+    
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d shared cache check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Concurrent conversions sharing one cache match the reference\n");
+    return 0;
+}
@@ -0,0 +1,403 @@
+/*
+ * Tape Decode Test - WAV to CAS Round Trip
+ * ========================================
+ *
+ * Converts one synthesized CAS file (binary, BASIC, two-block ASCII and
+ * custom blocks) with convertCasToWav() at several baud rates, sample rates
+ * and waveforms, decodes each WAV with decodeWavFile() and compares the
+ * decoded CAS image with the original byte for byte. Then decodes a
+ * degraded copy of the 1200 baud recording: resampled to 44.1 kHz, inverted,
+ * at a quarter of the level, with DC offset and noise, 4% fast, written as
+ * the second channel of a 16-bit stereo WAV (test_decode_rip.wav) and fed
+ * in odd-sized chunks. Both WAVs are also decoded with worker threads, and
+ * a 50 Hz WAV must be rejected with and without them.
+ *
+ * Purpose: Verify the decoder finds leaders, measures the baud rate and
+ *          deframes bytes without being told the tape's settings, and that
+ *          its CAS output matches the original tape exactly.
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "../lib/decodelib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAS_FILE "test_decode.cas"
+#define WAV_FILE "test_decode.wav"
+#define RIP_FILE "test_decode_rip.wav"
+#define LOW_FILE "test_decode_low.wav"
+
+// Binary (every byte value), BASIC, two-block ASCII and a custom block
+static size_t buildTape(uint8_t *buf) {
+    uint8_t binary[6 + 512];
+    uint8_t addresses[6] = {0x00, 0x90, 0xFF, 0x91, 0x00, 0x90};
+    memcpy(binary, addresses, 6);
+    for (size_t i = 0; i < 512; i++) {
+        binary[6 + i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    uint8_t basic[48] = {0};
+    for (size_t i = 0; i < 45; i++) {
+        basic[i] = (uint8_t)(0x80 + i * 3);
+    }
+
+    uint8_t text[256];
+    for (size_t i = 0; i < sizeof(text); i++) {
+        text[i] = (uint8_t)(' ' + i % 90);
+    }
+    uint8_t last[256];
+    memset(last, EOF_MARKER, sizeof(last));
+    memcpy(last, "10 PRINT \"DONE\"\r\n", 17);
+
+    uint8_t custom[40];
+    for (size_t i = 0; i < sizeof(custom); i++) {
+        custom[i] = (uint8_t)(0xF0 - i);
+    }
+
+    size_t len = 0;
+    len = putFileHeader(buf, len, FILETYPE_BINARY, "GAME  ");
+    len = putBlock(buf, len, binary, sizeof(binary));
+    len = putFileHeader(buf, len, FILETYPE_BASIC, "LOADER");
+    len = putBlock(buf, len, basic, sizeof(basic));
+    len = putFileHeader(buf, len, FILETYPE_ASCII, "README");
+    len = putBlock(buf, len, text, sizeof(text));
+    len = putBlock(buf, len, last, sizeof(last));
+    len = putBlock(buf, len, custom, sizeof(custom));
+    return len;
+}
+
+#define TAPE_BLOCKS 8
+
+// Count blocks as the decoder reports them
+static bool countBlock(void *context, const TapeBlock *block, const uint8_t *data) {
+    (void)block;
+    (void)data;
+    (*(size_t *)context)++;
+    return true;
+}
+
+// Compare a finished decode with the original tape
+static bool checkDecode(const char *label, TapeDecoder *decoder, size_t reported,
+                        const uint8_t *cas, size_t cas_size, uint16_t baud_rate) {
+    if (!decoder) {
+        printf("  %-28s: decode failed\n", label);
+        return false;
+    }
+    size_t image_size, block_count;
+    const uint8_t *image = getTapeDecoderImage(decoder, &image_size);
+    const TapeBlock *blocks = getTapeDecoderBlocks(decoder, &block_count);
+
+    size_t errors = 0, baud_off = 0;
+    for (size_t i = 0; i < block_count; i++) {
+        errors += blocks[i].error;
+        baud_off += blocks[i].baud_rate < baud_rate * 0.9 || blocks[i].baud_rate > baud_rate * 1.1;
+    }
+    size_t mismatch = 0;
+    while (mismatch < image_size && mismatch < cas_size && image[mismatch] == cas[mismatch]) {
+        mismatch++;
+    }
+
+    cas_Container container;
+    bool parsed = buildTapeDecoderContainer(decoder, &container);
+    size_t files = parsed ? container.file_count : 0;
+    if (parsed) {
+        freeCasContainer(&container);
+    }
+
+    bool ok = image_size == cas_size && mismatch == cas_size && block_count == TAPE_BLOCKS &&
+              reported == block_count && errors == 0 && baud_off == 0 && files == 4;
+    if (ok) {
+        printf("  %-28s: %zu blocks at %u baud, %zu bytes identical\n", label, block_count,
+               blocks[0].baud_rate, image_size);
+    } else {
+        printf("  %-28s: %zu blocks (%zu reported, %zu errors, %zu off baud), %zu files, "
+               "%zu of %zu bytes match\n", label, block_count, reported, errors, baud_off, files,
+               mismatch, cas_size);
+    }
+    freeTapeDecoder(decoder);
+    return ok;
+}
+
+// Decode path with worker threads and compare with a serial decode: same
+// image and blocks, block positions within 1 ms (a fresh decoder may catch
+// one leader cycle more than one coming out of the silence before it)
+static bool checkParallel(const char *label, const char *path, uint16_t channel,
+                          uint16_t threads) {
+    TapeDecoderConfig config = {0};
+    TapeDecoder *serial = decodeWavFile(path, channel, &config);
+    size_t reported = 0;
+    config.threads = threads;
+    config.block_end = countBlock;
+    config.context = &reported;
+    TapeDecoder *parallel = decodeWavFile(path, channel, &config);
+    if (!serial || !parallel) {
+        printf("  %-28s: decode failed\n", label);
+        freeTapeDecoder(serial);
+        freeTapeDecoder(parallel);
+        return false;
+    }
+
+    size_t serial_size, parallel_size, serial_count, parallel_count;
+    const uint8_t *serial_image = getTapeDecoderImage(serial, &serial_size);
+    const uint8_t *parallel_image = getTapeDecoderImage(parallel, &parallel_size);
+    const TapeBlock *a = getTapeDecoderBlocks(serial, &serial_count);
+    const TapeBlock *b = getTapeDecoderBlocks(parallel, &parallel_count);
+    bool same_image = serial_size == parallel_size &&
+                      memcmp(serial_image, parallel_image, serial_size) == 0;
+    long long tolerance = (long long)(getTapeDecoderSampleRate(serial) / 1000);
+    size_t same_blocks = 0;
+    for (size_t i = 0; i < serial_count && i < parallel_count; i++) {
+        same_blocks += a[i].size == b[i].size && a[i].error == b[i].error &&
+                       a[i].image_offset == b[i].image_offset && a[i].baud_rate == b[i].baud_rate &&
+                       llabs((long long)a[i].leader_start - (long long)b[i].leader_start) <= tolerance &&
+                       llabs((long long)a[i].data_start - (long long)b[i].data_start) <= tolerance &&
+                       llabs((long long)a[i].end - (long long)b[i].end) <= tolerance;
+    }
+    bool ok = same_image && serial_count == TAPE_BLOCKS && parallel_count == serial_count &&
+              same_blocks == serial_count && reported == parallel_count &&
+              getTapeDecoderPosition(parallel) == getTapeDecoderPosition(serial);
+    printf("  %-28s: %zu of %zu blocks match serial decode, image %s\n", label, same_blocks,
+           serial_count, same_image ? "identical" : "DIFFERS");
+    freeTapeDecoder(serial);
+    freeTapeDecoder(parallel);
+    return ok;
+}
+
+typedef struct {
+    const char *label;
+    WaveformType type;
+    uint16_t baud_rate;
+    uint32_t sample_rate;
+    uint16_t lowpass_hz;     // 0 = off
+} DecodeCase;
+
+static const DecodeCase cases[] = {
+    {"1200 baud sine 43.2 kHz", WAVE_SINE, 1200, 43200, 0},
+    {"1200 baud sine 48 kHz LPF", WAVE_SINE, 1200, 48000, 3000},
+    {"2400 baud square 28.8 kHz", WAVE_SQUARE, 2400, 28800, 0},
+    {"2400 baud triangle 14.4 kHz", WAVE_TRIANGLE, 2400, 14400, 0},
+    {"3600 baud trapezoid 36 kHz", WAVE_TRAPEZOID, 3600, 36000, 0},
+};
+
+// Read one channel of a WAV as 16-bit samples
+static int16_t* readSamples(const char *path, uint16_t channel, size_t *count, uint32_t *sample_rate) {
+    WavReader reader;
+    if (!openWavReader(path, channel, &reader)) {
+        return NULL;
+    }
+    size_t capacity = 1 << 20;
+    int16_t *samples = malloc(capacity * sizeof(int16_t));
+    size_t size = 0, got;
+    while (samples && (got = readWavReader(&reader, samples + size, capacity - size)) > 0) {
+        size += got;
+        if (size == capacity) {
+            capacity *= 2;
+            int16_t *grown = realloc(samples, capacity * sizeof(int16_t));
+            if (!grown) {
+                free(samples);
+                samples = NULL;
+            }
+            samples = grown;
+        }
+    }
+    *count = size;
+    *sample_rate = reader.sample_rate;
+    closeWavReader(&reader);
+    return samples;
+}
+
+static void putLE(uint8_t *p, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+#define RIP_RATE 44100
+
+// A worn 44.1 kHz recording of samples: inverted, quiet, off-center, noisy
+// and 4% fast, on the right channel of a 16-bit stereo WAV (the left one is
+// noise)
+static bool writeRip(const char *path, const int16_t *samples, size_t count, uint32_t sample_rate) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    double step = 1.04 * sample_rate / RIP_RATE;  // Source samples per output sample
+    size_t frames = (size_t)((count - 1) / step);
+    uint8_t header[44];
+    memcpy(header, "RIFF", 4);
+    putLE(header + 4, (uint32_t)(36 + frames * 4), 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    putLE(header + 16, 16, 4);
+    putLE(header + 20, 1, 2);                   // PCM
+    putLE(header + 22, 2, 2);                   // Stereo
+    putLE(header + 24, RIP_RATE, 4);
+    putLE(header + 28, RIP_RATE * 4, 4);
+    putLE(header + 32, 4, 2);
+    putLE(header + 34, 16, 2);
+    memcpy(header + 36, "data", 4);
+    putLE(header + 40, (uint32_t)(frames * 4), 4);
+    bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+
+    uint32_t noise = 12345;
+    for (size_t i = 0; ok && i < frames; i++) {
+        double t = i * step;
+        size_t k = (size_t)t;
+        double x = samples[k] + (samples[k + 1] - samples[k]) * (t - k);
+        noise = noise * 1103515245u + 12345u;
+        int noise_left = (int)(noise >> 16) % 1200 - 600;
+        noise = noise * 1103515245u + 12345u;
+        int noise_right = (int)(noise >> 16) % 1200 - 600;
+        int right = (int)(-x / 4) + 3000 + noise_right;
+        uint8_t frame[4];
+        putLE(frame, (uint32_t)(int16_t)noise_left, 2);
+        putLE(frame + 2, (uint32_t)(int16_t)right, 2);
+        ok = fwrite(frame, 1, sizeof(frame), f) == sizeof(frame);
+    }
+    return fclose(f) == 0 && ok;
+}
+
+// Ten seconds of a 50 Hz 8-bit mono WAV: far below any tape signal
+static bool writeLowRate(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    const uint32_t rate = 50, frames = 500;
+    uint8_t header[44];
+    memcpy(header, "RIFF", 4);
+    putLE(header + 4, 36 + frames, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    putLE(header + 16, 16, 4);
+    putLE(header + 20, 1, 2);                   // PCM
+    putLE(header + 22, 1, 2);                   // Mono
+    putLE(header + 24, rate, 4);
+    putLE(header + 28, rate, 4);
+    putLE(header + 32, 1, 2);
+    putLE(header + 34, 8, 2);
+    memcpy(header + 36, "data", 4);
+    putLE(header + 40, frames, 4);
+    bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+    for (uint32_t i = 0; ok && i < frames; i++) {
+        ok = fputc(i % 2 ? 0x40 : 0xC0, f) != EOF;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+int main(void) {
+    printf("Tape Decode Test\n");
+    printf("================\n\n");
+
+    static uint8_t cas[8192];
+    size_t cas_size = buildTape(cas);
+    FILE *f = fopen(CAS_FILE, "wb");
+    if (!f || fwrite(cas, 1, cas_size, f) != cas_size || fclose(f) != 0) {
+        fprintf(stderr, "✗ Cannot write %s\n", CAS_FILE);
+        return 1;
+    }
+
+    int failures = 0;
+    TapeDecoderConfig config = {.block_end = countBlock};
+
+    // 1. Clean conversions
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        WaveformConfig wave = createWaveform(cases[c].type, 120);
+        wave.baud_rate = cases[c].baud_rate;
+        wave.sample_rate = cases[c].sample_rate;
+        wave.long_silence = 0.5f;
+        wave.short_silence = 0.25f;
+        wave.enable_lowpass = cases[c].lowpass_hz != 0;
+        wave.lowpass_cutoff_hz = cases[c].lowpass_hz;
+        if (!convertCasToWav(CAS_FILE, WAV_FILE, &wave, false, NULL)) {
+            fprintf(stderr, "✗ Cannot convert %s (%s)\n", CAS_FILE, cases[c].label);
+            return 1;
+        }
+        size_t reported = 0;
+        config.context = &reported;
+        TapeDecoder *decoder = decodeWavFile(WAV_FILE, 0, &config);
+        if (!checkDecode(cases[c].label, decoder, reported, cas, cas_size, cases[c].baud_rate)) {
+            failures++;
+        }
+    }
+
+    // 2. A worn rip of the default tape, read from the right channel
+    WaveformConfig wave = createDefaultWaveform();
+    if (!convertCasToWav(CAS_FILE, WAV_FILE, &wave, false, NULL)) {
+        fprintf(stderr, "✗ Cannot convert %s\n", CAS_FILE);
+        return 1;
+    }
+    size_t count;
+    uint32_t sample_rate;
+    int16_t *samples = readSamples(WAV_FILE, 0, &count, &sample_rate);
+    if (!samples || count < 2 || !writeRip(RIP_FILE, samples, count, sample_rate)) {
+        fprintf(stderr, "✗ Cannot write %s\n", RIP_FILE);
+        free(samples);
+        return 1;
+    }
+    free(samples);
+
+    size_t reported = 0;
+    config.context = &reported;
+    TapeDecoder *decoder = decodeWavFile(RIP_FILE, 1, &config);
+    if (!checkDecode("Worn rip, 16-bit stereo", decoder, reported, cas, cas_size, 1248)) {
+        failures++;
+    }
+
+    // 3. The same channel fed in odd-sized chunks
+    samples = readSamples(RIP_FILE, 1, &count, &sample_rate);
+    reported = 0;
+    config.sample_rate = sample_rate;
+    decoder = samples ? createTapeDecoder(&config) : NULL;
+    bool ok = decoder != NULL;
+    for (size_t pos = 0; ok && pos < count; pos += 777) {
+        ok = feedTapeDecoder(decoder, samples + pos, count - pos < 777 ? count - pos : 777);
+    }
+    free(samples);
+    if (!ok || !finishTapeDecoder(decoder)) {
+        freeTapeDecoder(decoder);
+        decoder = NULL;
+    }
+    if (!checkDecode("777-sample chunks", decoder, reported, cas, cas_size, 1248)) {
+        failures++;
+    }
+
+    // The left channel holds only noise
+    decoder = decodeWavFile(RIP_FILE, 0, &config);
+    size_t noise_blocks = 0;
+    if (decoder) {
+        getTapeDecoderBlocks(decoder, &noise_blocks);
+    }
+    printf("  %-28s: %zu blocks\n", "Noise channel", noise_blocks);
+    if (!decoder || noise_blocks != 0) failures++;
+    freeTapeDecoder(decoder);
+
+    // 4. Worker threads: the files split at their silences
+    if (!checkParallel("Mono, 3 threads", WAV_FILE, 0, 3)) failures++;
+    if (!checkParallel("Worn rip, 8 threads", RIP_FILE, 1, 8)) failures++;
+
+    // 5. Not a WAV file
+    bool rejected = decodeWavFile(CAS_FILE, 0, &config) == NULL;
+    printf("  %-28s: %s\n", "CAS file as input", rejected ? "rejected" : "ACCEPTED");
+    if (!rejected) failures++;
+
+    // 6. A sample rate too low to decode, serially and on threads
+    for (uint16_t threads = 1; threads <= 4; threads += 3) {
+        TapeDecoderConfig low = {.threads = threads};
+        rejected = writeLowRate(LOW_FILE) && decodeWavFile(LOW_FILE, 0, &low) == NULL;
+        char label[32];
+        snprintf(label, sizeof(label), "50 Hz WAV, %u thread%s", threads, threads > 1 ? "s" : "");
+        printf("  %-28s: %s\n", label, rejected ? "rejected" : "ACCEPTED");
+        if (!rejected) failures++;
+    }
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d tape decode check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Decoded tapes match the original CAS file\n");
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * Tape Layout Test - Exact Sample Planning
+ * ========================================
+ * 
+ * Builds a small CAS file (binary file, two-block ASCII file, a custom
+ * block and a BASIC file), plans its tape layout and converts it for
+ * several profiles:
+ * 1. test_layout.cas - synthesized input
+ * 2. test_layout.wav - real conversion with cue markers
+ * 
+ * Purpose: Verify the planned sample total matches the rendered audio and
+ *          calculateLayoutWavSize() predicts the WAV file size to the byte,
+ *          markers included. Only binary files get the 6-byte address
+ *          header on tape: BASIC blocks hold exactly their CAS bytes.
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define BASIC_BYTES 88  // BASIC program bytes (no address header, no padding)
+
+// Append a data block of length bytes from seed, padded with 0x1A
+static size_t putDataBlock(uint8_t *buf, size_t pos, size_t length, uint8_t seed) {
+    uint8_t data[512];
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(seed + i * 7);
+    }
+    return putFilledBlock(buf, pos, data, length, 0x1A);
+}
+
+static long fileSize(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+int main(void) {
+    printf("Tape Layout Test\n");
+    printf("================\n\n");
+    
+    // Synthesize the CAS file
+    static uint8_t cas[4096];
+    size_t len = 0;
+    len = putFileHeader(cas, len, FILETYPE_BINARY, "BINTST");
+    len = putDataBlock(cas, len, 6 + 300, 0x11);   // Address header + payload
+    len = putFileHeader(cas, len, FILETYPE_ASCII, "ASCTST");
+    len = putDataBlock(cas, len, 256, 0x41);
+    len = putDataBlock(cas, len, 256, 0x61);
+    len = putDataBlock(cas, len, 123, 0xF3);       // Custom block (no type marker)
+    len = putFileHeader(cas, len, FILETYPE_BASIC, "BASTST");
+    len = putDataBlock(cas, len, BASIC_BYTES, 0x81);
+    
+    FILE *f = fopen("test_layout.cas", "wb");
+    if (!f || fwrite(cas, 1, len, f) != len) {
+        fprintf(stderr, "✗ Cannot write test_layout.cas\n");
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    
+    cas_Container container = {0};
+    if (!parseCasContainer(cas, &container, len)) {
+        fprintf(stderr, "✗ Cannot parse synthesized CAS file\n");
+        return 1;
+    }
+    
+    const uint16_t bauds[] = {1200, 2400, 3600};
+    const uint32_t rates[] = {43200, 43200, 36000};
+    const WaveformType types[] = {WAVE_SINE, WAVE_TRAPEZOID, WAVE_SQUARE};
+    int failures = 0;
+    
+    for (size_t i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+        WaveformConfig config = createWaveform(types[i], 120);
+        config.baud_rate = bauds[i];
+        config.sample_rate = rates[i];
+        config.enable_markers = true;
+        
+        WavFormat fmt = createDefaultWavFormat();
+        fmt.sample_rate = config.sample_rate;
+        
+        TapeLayout layout;
+        MarkerList *markers = createMarkerList();
+        bool ok = markers && planTapeLayout(&container, &config, &layout);
+        if (!ok) {
+            fprintf(stderr, "✗ Planning failed at %u baud\n", bauds[i]);
+            freeMarkerList(markers);
+            failures++;
+            continue;
+        }
+        ok = addLayoutMarkers(&layout, &container, &config, markers);
+        
+        double duration = 0.0;
+        ok = ok && convertCasToWav("test_layout.cas", "test_layout.wav", &config, false, &duration);
+        
+        size_t rendered = (size_t)(duration * config.sample_rate + 0.5);
+        size_t predicted = calculateLayoutWavSize(&layout, &fmt, markers);
+        long actual = fileSize("test_layout.wav");
+        
+        printf("  %4u baud @ %5u Hz: %zu segments, %zu samples (rendered %zu), "
+               "WAV %zu bytes (actual %ld)\n",
+               bauds[i], rates[i], layout.count, layout.total_samples, rendered,
+               predicted, actual);
+        
+        if (!ok || rendered != layout.total_samples || actual < 0 || (size_t)actual != predicted) {
+            printf("    MISMATCH\n");
+            failures++;
+        }
+        
+        freeTapeLayout(&layout);
+        freeMarkerList(markers);
+    }
+    
+    // The BASIC file (the last one) renders its own bytes only: 11 bits of
+    // 36 samples each at 1200 baud and 43200 Hz, and as many in the estimate
+    WaveformConfig config = createWaveform(WAVE_SINE, 120);
+    TapeLayout layout;
+    if (planTapeLayout(&container, &config, &layout)) {
+        size_t basic = container.file_count - 1;
+        size_t basic_samples = 0;
+        for (size_t i = 0; i < layout.count; i++) {
+            const TapeSegment *segment = &layout.segments[i];
+            if (segment->kind == SEGMENT_DATA && segment->file_index == basic) {
+                basic_samples += segment->sample_count;
+            }
+        }
+        cas_Container without_basic = container;
+        without_basic.file_count--;
+        double estimate = calculateAudioDuration(&container, config.baud_rate,
+                                                 config.long_silence, config.short_silence) -
+                          calculateAudioDuration(&without_basic, config.baud_rate,
+                                                 config.long_silence, config.short_silence);
+        double expected = config.long_silence + config.short_silence +
+                          (8000 + 16 * 11 + 2000 + BASIC_BYTES * 11) / (double)config.baud_rate;
+        printf("  BASIC data block: %zu bytes on tape, estimated %.3f s (expected %.3f s)\n",
+               basic_samples / (11 * 36), estimate, expected);
+        if (basic_samples != BASIC_BYTES * 11 * 36 || fabs(estimate - expected) > 1e-9) {
+            printf("    MISMATCH\n");
+            failures++;
+        }
+        freeTapeLayout(&layout);
+    } else {
+        fprintf(stderr, "✗ Planning failed for the BASIC check\n");
+        failures++;
+    }
+    
+    freeCasContainer(&container);
+    
+    printf("\n");
+    if (failures) {
+        fprintf(stderr, "✗ %d configuration(s) differ from the plan\n", failures);
+        return 1;
+    }
+    printf("✓ Planned layout matches the rendered WAV exactly\n");
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Tape Synth Test - On-the-fly Rendering and Seeking
+ * ==================================================
+ * 
+ * Converts a synthesized CAS file (binary file, ASCII file and a custom
+ * block) to test_synth.wav, then renders the same tape with the tape
+ * synthesizer:
+ * 1. Sequentially from sample 0 in odd-sized pieces (like an audio callback)
+ * 2. After seeking into silence, sync, the middle of a framed byte and the end
+ * 
+ * Purpose: Verify synthesized audio matches the converted WAV sample for
+ *          sample, with and without the low-pass filter.
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Read the samples of a WAV written by convertCasToWav() (44-byte header)
+static uint8_t* readWavSamples(const char *filename, size_t count) {
+    FILE *f = fopen(filename, "rb");
+    uint8_t *samples = malloc(count);
+    bool ok = f && samples && fseek(f, 44, SEEK_SET) == 0 &&
+              fread(samples, 1, count, f) == count;
+    if (f) fclose(f);
+    if (!ok) {
+        free(samples);
+        return NULL;
+    }
+    return samples;
+}
+
+// Render count samples from position and compare with the WAV samples
+static bool checkRange(TapeSynth *synth, const uint8_t *expected, size_t position, size_t count) {
+    uint8_t buffer[4096];
+    if (!seekTapeSynth(synth, position)) {
+        return false;
+    }
+    while (count > 0) {
+        size_t piece = (count < 997) ? count : 997;
+        size_t rendered = renderTapeSynth(synth, buffer, piece);
+        if (rendered != piece || memcmp(buffer, expected + position, piece) != 0) {
+            return false;
+        }
+        position += piece;
+        count -= piece;
+    }
+    return true;
+}
+
+int main(void) {
+    printf("Tape Synth Test\n");
+    printf("===============\n\n");
+    
+    static uint8_t cas[4096];
+    uint8_t header[16];
+    uint8_t payload[6 + 700];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 13 + 5);
+    }
+    
+    size_t len = 0;
+    memset(header, 0xD0, 10);
+    memcpy(header + 10, "SYNBIN", 6);
+    len = putFilledBlock(cas, len, header, sizeof(header), 0x1A);
+    len = putFilledBlock(cas, len, payload, sizeof(payload), 0x1A);
+    memset(header, 0xEA, 10);
+    memcpy(header + 10, "SYNASC", 6);
+    len = putFilledBlock(cas, len, header, sizeof(header), 0x1A);
+    len = putFilledBlock(cas, len, payload + 100, 256, 0x1A);
+    len = putFilledBlock(cas, len, payload + 300, 55, 0x1A);   // Custom block
+    
+    FILE *f = fopen("test_synth.cas", "wb");
+    if (!f || fwrite(cas, 1, len, f) != len) {
+        fprintf(stderr, "✗ Cannot write test_synth.cas\n");
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    
+    cas_Container container = {0};
+    if (!parseCasContainer(cas, &container, len)) {
+        fprintf(stderr, "✗ Cannot parse synthesized CAS file\n");
+        return 1;
+    }
+    
+    int failures = 0;
+    for (int lowpass = 0; lowpass <= 1; lowpass++) {
+        WaveformConfig config = createWaveform(WAVE_TRAPEZOID, 120);
+        config.baud_rate = 2400;
+        config.enable_lowpass = lowpass;
+        
+        MarkerList *markers = createMarkerList();
+        TapeSynth *synth = createTapeSynth(&container, &config, markers);
+        if (!synth || !convertCasToWav("test_synth.cas", "test_synth.wav", &config, false, NULL)) {
+            fprintf(stderr, "✗ Cannot create synthesizer or reference WAV\n");
+            return 1;
+        }
+        
+        size_t total = getTapeSynthLength(synth);
+        uint8_t *expected = readWavSamples("test_synth.wav", total);
+        if (!expected) {
+            fprintf(stderr, "✗ Reference WAV is shorter than the synthesized tape\n");
+            return 1;
+        }
+        
+        // Marker positions give seek targets inside every kind of segment
+        bool sequential = checkRange(synth, expected, 0, total);
+        bool seeks = true;
+        for (size_t i = 0; i + 1 < markers->count; i++) {
+            size_t position = markers->markers[i].sample_position + 123;
+            size_t count = (total - position < 20000) ? total - position : 20000;
+            seeks = seeks && checkRange(synth, expected, position, count);
+        }
+        
+        uint8_t tail[16];
+        seekTapeSynth(synth, total + 100);
+        bool end = (renderTapeSynth(synth, tail, sizeof(tail)) == 0);
+        
+        printf("  low-pass %-3s: %zu samples, %zu markers; sequential %s, seeks %s, end %s\n",
+               lowpass ? "on" : "off", total, markers->count,
+               sequential ? "identical" : "MISMATCH", seeks ? "identical" : "MISMATCH",
+               end ? "ok" : "MISMATCH");
+        if (!sequential || !seeks || !end) failures++;
+        
+        free(expected);
+        freeMarkerList(markers);
+        freeTapeSynth(synth);
+    }
+    
+    freeCasContainer(&container);
+    
+    printf("\n");
+    if (failures) {
+        fprintf(stderr, "✗ Synthesized audio differs from the converted WAV\n");
+        return 1;
+    }
+    printf("✓ Synthesized tape matches the converted WAV\n");
+    return 0;
+}
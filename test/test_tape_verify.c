@@ -0,0 +1,254 @@
+/*
+ * Tape Verify Test - Round-Trip Checking While Rendering
+ * ======================================================
+ *
+ * Renders a short tape (binary file, two-block ASCII file, custom block)
+ * with every audio profile and decodes the samples through a TapeVerifier
+ * tapped into the writer. Then renders it against verifiers built from
+ * altered copies of the tape: one byte changed, one block more, one less;
+ * at 43200 Hz / 2400 baud and at 46800 Hz / 1200 baud, where a 0-bit (39
+ * samples) is not two 1-bit cycles (2 x 19) and framed bytes differ in
+ * length by value.
+ *
+ * Purpose: Verify every profile (including compact-extreme and turbo-3600)
+ *          decodes back to the bytes it was rendered from, and that a
+ *          difference is reported as the exact file, block, byte offset
+ *          and sample where it first occurs.
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "../lib/presetlib.h"
+#include "../lib/verifylib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHANGED_BYTE 50  // Offset in the binary file's data (after the address header)
+
+// Binary file, ASCII file in two blocks, custom block; with_extra adds a
+// second custom block at the end
+static size_t buildTape(uint8_t *buf, bool with_extra) {
+    uint8_t header[16];
+    memcpy(header, FILETYPE_BINARY, 10);
+    memcpy(header + 10, "VERIFY", 6);
+    uint8_t binary[6 + 120] = {0x00, 0xC0, 0x77, 0xC0, 0x00, 0xC0};
+    for (size_t i = 0; i < 120; i++) {
+        binary[6 + i] = (uint8_t)(i * 29 + 3);
+    }
+
+    size_t len = 0;
+    len = putBlock(buf, len, header, sizeof(header));
+    len = putBlock(buf, len, binary, sizeof(binary));
+
+    memcpy(header, FILETYPE_ASCII, 10);
+    memcpy(header + 10, "NOTES ", 6);
+    uint8_t text[256];
+    for (size_t i = 0; i < sizeof(text); i++) {
+        text[i] = (uint8_t)('A' + i % 26);
+    }
+    uint8_t eof[256];
+    memset(eof, 0x1A, sizeof(eof));
+    len = putBlock(buf, len, header, sizeof(header));
+    len = putBlock(buf, len, text, sizeof(text));
+    len = putBlock(buf, len, eof, sizeof(eof));
+
+    uint8_t custom[40];
+    for (size_t i = 0; i < sizeof(custom); i++) {
+        custom[i] = (uint8_t)(0x5A ^ i);
+    }
+    len = putBlock(buf, len, custom, sizeof(custom));
+    if (with_extra) {
+        len = putBlock(buf, len, custom, 16);
+    }
+    return len;
+}
+
+// Render rendered through a verifier built from expected
+static bool renderVerified(const cas_Container *rendered, const cas_Container *expected,
+                           const WaveformConfig *config, TapeVerifyResult *result) {
+    TapeVerifier *verifier = createTapeVerifier(expected, config);
+    if (!verifier) {
+        return false;
+    }
+    WaveformConfig tapped = *config;
+    tapped.sample_tap = getTapeVerifierSink(verifier);
+
+    WavBuffer wav = {0};
+    WavSink sink = createWavBufferSink(&wav);
+    bool ok = convertContainerToWav(rendered, &sink, &tapped, NULL, NULL, NULL) &&
+              finishTapeVerifier(verifier, result);
+    freeWavBuffer(&wav);
+    freeTapeVerifier(verifier);
+    return ok;
+}
+
+// Samples of count framed bytes (START, 8 data bits, 2 STOP bits): a
+// 0-bit is one cycle at baud_rate, a 1-bit two cycles at twice that
+static uint64_t framedSamples(const uint8_t *bytes, size_t count, const WaveformConfig *config) {
+    uint64_t bit0 = config->sample_rate / config->baud_rate;
+    uint64_t bit1 = 2 * (config->sample_rate / (2 * config->baud_rate));
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        int ones = __builtin_popcount(bytes[i]);
+        total += (uint64_t)(9 - ones) * bit0 + (uint64_t)(ones + 2) * bit1;
+    }
+    return total;
+}
+
+// Where the layout puts data block block_index of file file_index
+static const TapeSegment* findDataSegment(const TapeLayout *layout, size_t file_index,
+                                          size_t block_index) {
+    for (size_t i = 0; i < layout->count; i++) {
+        const TapeSegment *segment = &layout->segments[i];
+        if (segment->kind == SEGMENT_DATA && segment->file_index == file_index &&
+            segment->block_index == block_index) {
+            return segment;
+        }
+    }
+    return NULL;
+}
+
+// One altered tape: the first difference must be reported at where, at
+// most slack samples after where->sample (the decoder places extra blocks)
+static bool checkDifference(const char *name, const cas_Container *rendered,
+                            const cas_Container *expected, const WaveformConfig *config,
+                            const TapeVerifyResult *where, uint64_t slack) {
+    TapeVerifyResult result;
+    if (!renderVerified(rendered, expected, config, &result)) {
+        printf("  %-24s: verification failed to run\n", name);
+        return false;
+    }
+    printf("  %-24s: %s in file %zu, %s %zu, byte %zu (expected %d, found %d), sample %llu\n",
+           name, getTapeVerifyStatusString(result.status), result.file_index,
+           result.header_block ? "header" : "block", result.block_index, result.byte_offset,
+           result.expected, result.found, (unsigned long long)result.sample);
+    return result.status == where->status && result.file_index == where->file_index &&
+           result.header_block == where->header_block && result.block_index == where->block_index &&
+           result.byte_offset == where->byte_offset && result.expected == where->expected &&
+           result.found == where->found && result.sample >= where->sample &&
+           result.sample <= where->sample + slack;
+}
+
+// Altered tapes against the original at one rate
+static int checkAlteredTapes(const cas_Container *original, const cas_Container *altered,
+                             const cas_Container *extended, uint32_t sample_rate,
+                             uint16_t baud_rate) {
+    WaveformConfig config = createDefaultWaveform();
+    config.sample_rate = sample_rate;
+    config.baud_rate = baud_rate;
+    config.long_silence = 0.2f;
+    config.short_silence = 0.1f;
+    printf("  %u Hz, %u baud:\n", sample_rate, baud_rate);
+
+    TapeLayout layout;
+    if (!planTapeLayout(extended, &config, &layout)) {
+        printf("  Cannot plan the tape\n");
+        return 1;
+    }
+    const TapeSegment *binary = findDataSegment(&layout, 0, 0);
+    const TapeSegment *extra = findDataSegment(&layout, original->file_count, 0);
+    if (!binary || !extra) {
+        freeTapeLayout(&layout);
+        printf("  Tape layout lacks a data block\n");
+        return 1;
+    }
+
+    // The changed byte starts after the address header and the bytes before it
+    const cas_File *file = &original->files[0];
+    const uint8_t *byte = file->data_blocks[0].data + CHANGED_BYTE;
+    uint8_t addresses[6] = {
+        file->data_block_header.load_address & 0xFF, file->data_block_header.load_address >> 8,
+        file->data_block_header.end_address & 0xFF, file->data_block_header.end_address >> 8,
+        file->data_block_header.exec_address & 0xFF, file->data_block_header.exec_address >> 8
+    };
+    int failures = 0;
+    TapeVerifyResult where = {
+        .status = VERIFY_BYTE_DIFFERS, .file_index = 0, .block_index = 0,
+        .byte_offset = 6 + CHANGED_BYTE, .expected = *byte ^ 0xFF, .found = *byte,
+        .sample = binary->start_sample + framedSamples(addresses, 6, &config) +
+                  framedSamples(file->data_blocks[0].data, CHANGED_BYTE, &config)
+    };
+    if (!checkDifference("One byte changed", original, altered, &config, &where, 0)) failures++;
+
+    // The extended tape starts like the original, so the extra block is
+    // planned where the original ends
+    where = (TapeVerifyResult){
+        .status = VERIFY_BLOCK_MISSING, .file_index = original->file_count, .block_index = 0,
+        .byte_offset = 0, .expected = 0x5A, .found = -1, .sample = extra->start_sample
+    };
+    if (!checkDifference("Block missing from WAV", original, extended, &config, &where, 0)) {
+        failures++;
+    }
+
+    where = (TapeVerifyResult){
+        .status = VERIFY_EXTRA_BLOCK, .file_index = original->file_count, .block_index = 0,
+        .byte_offset = 0, .expected = -1, .found = 0x5A, .sample = extra->start_sample
+    };
+    if (!checkDifference("Extra block in WAV", extended, original, &config, &where,
+                         extra->sample_count)) failures++;
+
+    freeTapeLayout(&layout);
+    return failures;
+}
+
+int main(void) {
+    printf("Tape Verify Test\n");
+    printf("================\n\n");
+
+    static uint8_t tape[2048], changed[2048], longer[2048];
+    size_t tape_size = buildTape(tape, false);
+    memcpy(changed, tape, tape_size);
+    size_t longer_size = buildTape(longer, true);
+
+    cas_Container original, altered, extended;
+    if (!parseCasContainerInPlace(tape, &original, tape_size) ||
+        !parseCasContainerInPlace(longer, &extended, longer_size)) {
+        fprintf(stderr, "✗ Cannot parse the test tape\n");
+        return 1;
+    }
+    // Change one data byte of the binary file (file 0, data block 0)
+    const uint8_t *byte = original.files[0].data_blocks[0].data + CHANGED_BYTE;
+    changed[byte - tape] ^= 0xFF;
+    if (!parseCasContainerInPlace(changed, &altered, tape_size)) {
+        fprintf(stderr, "✗ Cannot parse the altered tape\n");
+        return 1;
+    }
+
+    int failures = 0;
+
+    // 1. Every profile decodes back to the original bytes
+    for (size_t i = 0; i < getProfileCount(); i++) {
+        const AudioProfile *profile = getProfileByIndex(i);
+        WaveformConfig config = createDefaultWaveform();
+        applyProfile(&config, profile);
+        config.long_silence = 0.2f;  // Keep the test short
+        config.short_silence = 0.1f;
+
+        TapeVerifyResult result;
+        bool ok = renderVerified(&original, &original, &config, &result) &&
+                  result.status == VERIFY_MATCH && result.blocks_decoded == result.blocks_expected;
+        printf("  %-24s: %zu/%zu blocks, %s\n", profile->name, ok ? result.blocks_decoded : 0,
+               ok ? result.blocks_expected : 0, ok ? "match" : "MISMATCH");
+        if (!ok) failures++;
+    }
+    printf("\n");
+
+    // 2. Altered tapes report their first difference, at the sample it was
+    // rendered at (46800 Hz: bytes of different values differ in length)
+    failures += checkAlteredTapes(&original, &altered, &extended, 43200, 2400);
+    failures += checkAlteredTapes(&original, &altered, &extended, 46800, 1200);
+
+    freeCasContainer(&original);
+    freeCasContainer(&altered);
+    freeCasContainer(&extended);
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d tape verify check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Rendered tapes verify against their source\n");
+    return 0;
+}
@@ -1,5 +1,8 @@
 #include "test_utils.h"
+#include "../lib/caslib.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Silence/leader duration constants
 #define SILENCE_LONG_HEADER  2.0f
@@ -39,3 +42,47 @@ bool setTrapezoidRiseTime(WaveformConfig *config, uint8_t rise_percent) {
     config->trapezoid_rise_percent = rise_percent;
     return true;
 }
+
+size_t putUnpaddedBlock(uint8_t *buf, size_t pos, const uint8_t *data, size_t length) {
+    memcpy(buf + pos, CAS_HEADER, sizeof(CAS_HEADER));
+    pos += sizeof(CAS_HEADER);
+    memcpy(buf + pos, data, length);
+    return pos + length;
+}
+
+size_t putFilledBlock(uint8_t *buf, size_t pos, const uint8_t *data, size_t length, uint8_t fill) {
+    pos = putUnpaddedBlock(buf, pos, data, length);
+    while (pos % 8) {
+        buf[pos++] = fill;
+    }
+    return pos;
+}
+
+size_t putBlock(uint8_t *buf, size_t pos, const uint8_t *data, size_t length) {
+    return putFilledBlock(buf, pos, data, length, 0x00);
+}
+
+size_t putFileHeader(uint8_t *buf, size_t pos, const uint8_t *type, const char *name) {
+    uint8_t header[16];
+    memcpy(header, type, 10);
+    memcpy(header + 10, name, 6);
+    return putUnpaddedBlock(buf, pos, header, sizeof(header));
+}
+
+uint8_t* readFile(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = length > 0 ? malloc((size_t)length) : NULL;
+    if (data && fread(data, 1, (size_t)length, f) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = data ? (size_t)length : 0;
+    return data;
+}
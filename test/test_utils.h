@@ -1,6 +1,8 @@
 #ifndef TEST_UTILS_H
 #define TEST_UTILS_H
 
+#include <stdint.h>
+#include <stddef.h>
 #include "../lib/wavlib.h"
 
 // Test utility functions for creating waveform configurations
@@ -14,4 +16,23 @@ WaveformConfig createWaveform(WaveformType type, uint8_t amplitude);
 // Returns false if waveform type is not trapezoid
 bool setTrapezoidRiseTime(WaveformConfig *config, uint8_t rise_percent);
 
+// CAS fixtures: each helper appends to buf at pos and returns the new length
+
+// Append a block: CAS header, length bytes of data, then zeros up to the
+// next 8-byte boundary
+size_t putBlock(uint8_t *buf, size_t pos, const uint8_t *data, size_t length);
+
+// Append a block padded with fill instead of zeros
+size_t putFilledBlock(uint8_t *buf, size_t pos, const uint8_t *data, size_t length, uint8_t fill);
+
+// Append a block with no padding (the next CAS header follows directly)
+size_t putUnpaddedBlock(uint8_t *buf, size_t pos, const uint8_t *data, size_t length);
+
+// Append a file header block: 10-byte type marker, then the 6-byte name
+// (24 bytes with its CAS header, so alignment is kept without padding)
+size_t putFileHeader(uint8_t *buf, size_t pos, const uint8_t *type, const char *name);
+
+// Read a whole file into a malloc'd buffer; NULL if missing or empty
+uint8_t* readFile(const char *path, size_t *size);
+
 #endif // TEST_UTILS_H
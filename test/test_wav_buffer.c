@@ -0,0 +1,187 @@
+/*
+ * WAV Buffer Test - Output Buffer Sizes
+ * =====================================
+ *
+ * Converts one tape (binary file, two-block ASCII file, custom block) with
+ * cue markers and the low-pass filter at several output buffer sizes:
+ * 1. test_buffer_default.wav - WAV_DEFAULT_BUFFER_SIZE (1 MiB)
+ * 2. test_buffer_4096.wav    - WAV_MIN_BUFFER_SIZE
+ * 3. test_buffer_odd.wav     - 4133 bytes (not a multiple of any cycle)
+ * 4. test_buffer_small.wav   - 100 bytes, clamped to the minimum
+ * Then writes the same samples twice through a WavWriter, once resizing
+ * the buffer between writes while samples are pending:
+ * 5. test_buffer_resize.wav / test_buffer_steady.wav
+ *
+ * Purpose: Verify the buffer size (cast convert -B) changes how samples
+ *          are written, never which: every size gives a byte-identical
+ *          file, sizes below the minimum are clamped, and a resize flushes
+ *          the pending samples to the file before replacing the buffer.
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAS_FILE   "test_buffer.cas"
+#define ODD_SIZE   4133
+#define SMALL_SIZE 100
+
+static bool writeCas(void) {
+    static uint8_t cas[2048];
+    uint8_t binary[6 + 300] = {0x00, 0xC0, 0x2B, 0xC1, 0x00, 0xC0};
+    for (size_t i = 0; i < 300; i++) {
+        binary[6 + i] = (uint8_t)(i * 37 + 11);
+    }
+    uint8_t text[256], eof[256];
+    for (size_t i = 0; i < sizeof(text); i++) {
+        text[i] = (uint8_t)('a' + i % 26);
+    }
+    memset(eof, 0x1A, sizeof(eof));
+    memcpy(eof, "END", 3);
+
+    size_t len = putFileHeader(cas, 0, FILETYPE_BINARY, "BUFFER");
+    len = putBlock(cas, len, binary, sizeof(binary));
+    len = putFileHeader(cas, len, FILETYPE_ASCII, "TEXT  ");
+    len = putBlock(cas, len, text, sizeof(text));
+    len = putBlock(cas, len, eof, sizeof(eof));
+    len = putBlock(cas, len, binary + 6, 77);
+
+    FILE *f = fopen(CAS_FILE, "wb");
+    bool ok = f && fwrite(cas, 1, len, f) == len;
+    return (f && fclose(f) == 0) && ok;
+}
+
+static WaveformConfig filteredConfig(void) {
+    WaveformConfig config = createDefaultWaveform();
+    config.enable_markers = true;
+    config.enable_lowpass = true;
+    config.lowpass_cutoff_hz = 6000;
+    config.long_silence = 0.5f;  // Keep the files small
+    config.short_silence = 0.25f;
+    return config;
+}
+
+static bool sameFiles(const char *a, const char *b) {
+    size_t a_size, b_size;
+    uint8_t *a_data = readFile(a, &a_size);
+    uint8_t *b_data = readFile(b, &b_size);
+    bool same = a_data && b_data && a_size == b_size && memcmp(a_data, b_data, a_size) == 0;
+    free(a_data);
+    free(b_data);
+    return same;
+}
+
+// =============================================================================
+// Resizing While Samples Are Pending
+// =============================================================================
+
+// One step of the sequence: samples to write, then the buffer size to
+// switch to (0: keep it)
+typedef struct {
+    size_t sync_bits;
+    size_t byte_count;
+    size_t resize_to;
+} WriteStep;
+
+static const WriteStep steps[] = {
+    {120, 40, 5000},
+    {0, 90, SMALL_SIZE},              // Clamped to WAV_MIN_BUFFER_SIZE
+    {333, 17, WAV_DEFAULT_BUFFER_SIZE},
+    {50, 200, ODD_SIZE},
+    {0, 3, 0},
+};
+
+// Write the steps' samples; with resize, switch buffer sizes between them
+// and check each switch left nothing pending and everything in the file
+static bool writeSteps(const char *filename, const WaveformConfig *config, bool resize,
+                       size_t *resizes) {
+    WavFormat format = createDefaultWavFormat();
+    WavWriter *writer = createWavFile(filename, &format);
+    if (!writer || !enableWaveformCache(writer, config)) {
+        if (writer) {
+            closeWavFile(writer);
+        }
+        return false;
+    }
+    long data_start = ftell(writer->file);
+
+    uint8_t bytes[256];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (uint8_t)(i * 73 + 5);
+    }
+    bool ok = resize ? setWavBufferSize(writer, WAV_MIN_BUFFER_SIZE) : true;
+    *resizes = 0;
+    for (size_t i = 0; ok && i < sizeof(steps) / sizeof(steps[0]); i++) {
+        const WriteStep *step = &steps[i];
+        ok = writeSync(writer, step->sync_bits, config) &&
+             writeBytes(writer, bytes, step->byte_count, config) &&
+             writeSilence(writer, 0.01f);
+        if (!ok || !resize || step->resize_to == 0) {
+            continue;
+        }
+        bool pending = writer->buffer_used > 0;
+        size_t expected = step->resize_to < WAV_MIN_BUFFER_SIZE ? WAV_MIN_BUFFER_SIZE
+                                                                : step->resize_to;
+        ok = setWavBufferSize(writer, step->resize_to) && writer->buffer_used == 0 &&
+             writer->buffer_size == expected &&
+             ftell(writer->file) - data_start == (long)writer->sample_count;
+        *resizes += ok && pending;
+    }
+    return closeWavFile(writer) && ok;
+}
+
+int main(void) {
+    printf("WAV Buffer Test\n");
+    printf("===============\n\n");
+
+    if (!writeCas()) {
+        fprintf(stderr, "✗ Cannot write %s\n", CAS_FILE);
+        return 1;
+    }
+
+    int failures = 0;
+    WaveformConfig config = filteredConfig();
+
+    // 1. Whole conversions at each buffer size against the default
+    if (!convertCasToWav(CAS_FILE, "test_buffer_default.wav", &config, false, NULL)) {
+        fprintf(stderr, "✗ Cannot convert %s\n", CAS_FILE);
+        return 1;
+    }
+    static const struct {
+        const char *name;
+        const char *filename;
+        size_t size;
+    } sizes[] = {
+        {"4 KiB minimum", "test_buffer_4096.wav", WAV_MIN_BUFFER_SIZE},
+        {"Odd size (4133)", "test_buffer_odd.wav", ODD_SIZE},
+        {"100 bytes (clamped)", "test_buffer_small.wav", SMALL_SIZE},
+    };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        WaveformConfig sized = config;
+        sized.output_buffer_size = sizes[i].size;
+        bool same = convertCasToWav(CAS_FILE, sizes[i].filename, &sized, false, NULL) &&
+                    sameFiles(sizes[i].filename, "test_buffer_default.wav");
+        printf("  %-22s: %s\n", sizes[i].name, same ? "identical to 1 MiB" : "DIFFERENT");
+        if (!same) failures++;
+    }
+
+    // 2. Resizing between writes flushes what is pending
+    size_t resizes = 0, unused;
+    bool resized = writeSteps("test_buffer_resize.wav", &config, true, &resizes) &&
+                   writeSteps("test_buffer_steady.wav", &config, false, &unused) &&
+                   sameFiles("test_buffer_resize.wav", "test_buffer_steady.wav");
+    printf("  %-22s: %zu resizes with samples pending, %s\n", "Resize mid-stream", resizes,
+           resized ? "identical to one buffer" : "DIFFERENT");
+    if (!resized || resizes != 4) failures++;
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d buffer check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Every buffer size writes the same WAV\n");
+    return 0;
+}
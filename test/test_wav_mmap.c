@@ -0,0 +1,116 @@
+/*
+ * Mapped WAV Test - Preallocated, Memory-Mapped Output
+ * ====================================================
+ * 
+ * Writes the same audio and markers twice:
+ * 1. test_mmap_file.wav   - createWavFile() (buffered, sizes patched on close)
+ * 2. test_mmap_mapped.wav - createMappedWavFile() (preallocated, samples
+ *                           written into the mapping, header and marker
+ *                           chunks filled in place)
+ * 
+ * Purpose: Verify the mapped backend is byte-identical to the buffered
+ *          writer, marker chunks included, that the file has its final
+ *          size from the start, and that writing more or fewer samples
+ *          than declared is reported as an error.
+ */
+
+#include "../lib/wavlib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Labels match the markers writeSilence()/writeSync() generate
+static const char *labels[] = {"Silence (0.1s)", "Sync short (200 bits)", "Data"};
+
+// Write silence, a sync and a few bytes, recording where each part starts
+static bool writeAudio(WavWriter *writer, const WaveformConfig *config, size_t *positions) {
+    static const uint8_t data[] = {0x1F, 0xA6, 0xDE, 0xBA, 0xCC, 0x13, 0x7D, 0x74};
+    
+    positions[0] = writer->sample_count;
+    bool ok = writeSilence(writer, 0.1f);
+    positions[1] = writer->sample_count;
+    ok = ok && writeSync(writer, 200, config);
+    positions[2] = writer->sample_count;
+    return ok && writeBytes(writer, data, sizeof(data), config);
+}
+
+// Compare two files byte by byte
+static bool filesIdentical(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    bool same = fa && fb;
+    
+    while (same) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) {
+            same = false;
+        } else if (ca == EOF) {
+            break;
+        }
+    }
+    
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+static long fileSize(const char *filename) {
+    struct stat st;
+    return stat(filename, &st) == 0 ? (long)st.st_size : -1;
+}
+
+int main(void) {
+    printf("Mapped WAV Test\n");
+    printf("===============\n\n");
+    
+    WaveformConfig config = createWaveform(WAVE_SINE, 120);
+    config.enable_lowpass = true;
+    WavFormat fmt = createDefaultWavFormat();
+    size_t positions[3];
+    
+    // Reference file: silence/sync markers are added by the writer while
+    // writing, the data marker by hand; sizes are patched on close
+    WavWriter *writer = createWavFile("test_mmap_file.wav", &fmt);
+    bool ok = writer && enableMarkers(writer) && writeAudio(writer, &config, positions) &&
+              addMarker(writer->markers, positions[2], MARKER_DETAIL, labels[2]);
+    size_t total_samples = writer ? writer->sample_count : 0;
+    ok = writer && closeWavFile(writer) && ok;
+    printf("  File writer:   %zu samples %s\n", total_samples, ok ? "written" : "FAILED");
+    if (!ok) return 1;
+    
+    // Mapped file: everything declared up front, the file is full size
+    // before the first sample is written
+    MarkerList *markers = createMarkerList();
+    for (size_t i = 0; markers && i < 3; i++) {
+        addMarker(markers, positions[i], MARKER_DETAIL, labels[i]);
+    }
+    writer = createMappedWavFile("test_mmap_mapped.wav", &fmt, total_samples, markers);
+    long preallocated = fileSize("test_mmap_mapped.wav");
+    ok = writer && writeAudio(writer, &config, positions) && closeWavFile(writer);
+    
+    bool sized = (preallocated == fileSize("test_mmap_file.wav"));
+    printf("  Preallocated:  %ld bytes %s\n", preallocated, sized ? "(final size)" : "(WRONG SIZE)");
+    
+    bool same = ok && filesIdentical("test_mmap_file.wav", "test_mmap_mapped.wav");
+    printf("  Mapped writer: %s\n", same ? "identical to file writer" : "MISMATCH");
+    
+    // Writing past the declared length fails; so does closing short
+    writer = createMappedWavFile("test_mmap_mapped.wav", &fmt, total_samples - 1, NULL);
+    bool overflow = writer && !writeAudio(writer, &config, positions);
+    if (writer) closeWavFile(writer);
+    writer = createMappedWavFile("test_mmap_mapped.wav", &fmt, total_samples + 1, NULL);
+    bool short_ok = writer && writeAudio(writer, &config, positions);
+    bool rejected = short_ok && !closeWavFile(writer);
+    printf("  Overflow:      %s\n", overflow ? "rejected on write" : "NOT DETECTED");
+    printf("  Short file:    %s\n", rejected ? "rejected on close" : "NOT DETECTED");
+    
+    printf("\n");
+    if (!sized || !same || !overflow || !rejected) {
+        fprintf(stderr, "✗ Mapped WAV test failed\n");
+        return 1;
+    }
+    printf("✓ Mapped files match buffered WAV files\n");
+    return 0;
+}
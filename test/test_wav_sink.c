@@ -0,0 +1,160 @@
+/*
+ * WAV Sink Test - Conversion Without Output Files
+ * ===============================================
+ *
+ * Converts one synthesized CAS file (binary, ASCII and custom blocks, with
+ * low-pass filter and markers) with convertCasToWav() as the reference
+ * (test_sink_ref.wav), then converts the parsed container again with
+ * convertContainerToWav() into:
+ * 1. a memory buffer (createWavBufferSink)
+ * 2. a file descriptor (createWavFdSink) - test_sink_fd.wav
+ * 3. a callback that only takes the samples
+ *
+ * Purpose: Verify every sink receives exactly the bytes of the reference
+ *          file (the samples-only callback: exactly its data chunk), and
+ *          that a sink refusing a write fails the conversion.
+ */
+
+#include "../lib/wavlib.h"
+#include "../lib/caslib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define WAV_HEADER_BYTES 44
+
+// Samples-only callback: compare each span with the reference data chunk
+typedef struct {
+    const uint8_t *expected;
+    size_t expected_size;
+    size_t received;
+    size_t spans;
+    bool same;
+} SampleCheck;
+
+static bool checkSamples(void *context, const uint8_t *data, size_t size) {
+    SampleCheck *check = context;
+    if (check->received + size > check->expected_size ||
+        memcmp(check->expected + check->received, data, size) != 0) {
+        check->same = false;
+    }
+    check->received += size;
+    check->spans++;
+    return true;
+}
+
+static bool refuseWrite(void *context, const uint8_t *data, size_t size) {
+    (void)context;
+    (void)data;
+    (void)size;
+    return false;
+}
+
+int main(void) {
+    printf("WAV Sink Test\n");
+    printf("=============\n\n");
+
+    static uint8_t cas[4096];
+    uint8_t header[16];
+    uint8_t payload[6 + 900];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    size_t len = 0;
+    memcpy(header, FILETYPE_BINARY, 10);
+    memcpy(header + 10, "SNKBIN", 6);
+    len = putBlock(cas, len, header, sizeof(header));
+    len = putBlock(cas, len, payload, sizeof(payload));
+    memcpy(header, FILETYPE_ASCII, 10);
+    memcpy(header + 10, "SNKASC", 6);
+    len = putBlock(cas, len, header, sizeof(header));
+    payload[200] = EOF_MARKER;
+    len = putBlock(cas, len, payload, 256);
+    len = putBlock(cas, len, payload + 300, 41);   // Custom block
+
+    FILE *f = fopen("test_sink.cas", "wb");
+    if (!f || fwrite(cas, 1, len, f) != len) {
+        fprintf(stderr, "✗ Cannot write test_sink.cas\n");
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    WaveformConfig config = createWaveform(WAVE_SINE, 120);
+    config.enable_lowpass = true;
+    config.lowpass_cutoff_hz = 6000;
+    config.enable_markers = true;
+
+    size_t ref_size = 0;
+    uint8_t *ref = NULL;
+    cas_Container container;
+    if (!convertCasToWav("test_sink.cas", "test_sink_ref.wav", &config, false, NULL) ||
+        !(ref = readFile("test_sink_ref.wav", &ref_size)) ||
+        !parseCasContainerInPlace(cas, &container, len)) {
+        fprintf(stderr, "✗ Cannot create the reference WAV or parse the CAS image\n");
+        return 1;
+    }
+
+    int failures = 0;
+
+    // 1. Memory buffer
+    WavBuffer buffer = {0};
+    WavSink sink = createWavBufferSink(&buffer);
+    double duration = 0.0;
+    bool memory = convertContainerToWav(&container, &sink, &config, NULL, NULL, &duration) &&
+                  buffer.size == ref_size && memcmp(buffer.data, ref, ref_size) == 0;
+    printf("  %-14s: %zu bytes, %.2f s %s\n", "Memory sink", buffer.size, duration,
+           memory ? "identical to file" : "MISMATCH");
+    if (!memory) failures++;
+    freeWavBuffer(&buffer);
+
+    // 2. File descriptor
+    int fd = open("test_sink_fd.wav", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    sink = createWavFdSink(fd);
+    bool written = fd >= 0 && convertContainerToWav(&container, &sink, &config, NULL, NULL, NULL);
+    if (fd >= 0) close(fd);
+    size_t fd_size = 0;
+    uint8_t *fd_data = written ? readFile("test_sink_fd.wav", &fd_size) : NULL;
+    bool descriptor = fd_data && fd_size == ref_size && memcmp(fd_data, ref, ref_size) == 0;
+    printf("  %-14s: %zu bytes %s\n", "Fd sink", fd_size, descriptor ? "identical to file" : "MISMATCH");
+    if (!descriptor) failures++;
+    free(fd_data);
+
+    // 3. Samples only: the reference data chunk, nothing else
+    uint32_t data_size = (uint32_t)ref[40] | ((uint32_t)ref[41] << 8) |
+                         ((uint32_t)ref[42] << 16) | ((uint32_t)ref[43] << 24);
+    SampleCheck check = {
+        .expected = ref + WAV_HEADER_BYTES,
+        .expected_size = data_size,
+        .same = true
+    };
+    WavSink samples = {.write = checkSamples, .context = &check, .samples_only = true};
+    bool raw = convertContainerToWav(&container, &samples, &config, NULL, NULL, NULL) &&
+               check.same && check.received == data_size;
+    printf("  %-14s: %zu samples in %zu spans %s\n", "Samples only", check.received, check.spans,
+           raw ? "match the data chunk" : "MISMATCH");
+    if (!raw) failures++;
+
+    // 4. A sink that refuses its first write stops the conversion
+    WavSink refusing = {.write = refuseWrite};
+    printf("  (a write error is expected next)\n");
+    fflush(stdout);
+    bool stopped = !convertContainerToWav(&container, &refusing, &config, NULL, NULL, NULL);
+    printf("  %-14s: %s\n", "Refused write", stopped ? "conversion failed" : "NOT REPORTED");
+    if (!stopped) failures++;
+
+    freeCasContainer(&container);
+    free(ref);
+
+    printf("\n");
+    if (failures > 0) {
+        fprintf(stderr, "✗ %d WAV sink check(s) failed\n", failures);
+        return 1;
+    }
+    printf("✓ Sinks receive the same WAV as a converted file\n");
+    return 0;
+}
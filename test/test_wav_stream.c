@@ -0,0 +1,107 @@
+/*
+ * WAV Stream Test - Pre-sized Headers Without Seeking
+ * ===================================================
+ * 
+ * Writes the same audio and markers twice:
+ * 1. test_stream_file.wav - createWavFile() (sizes patched on close)
+ * 2. test_stream_pipe.wav - createWavStream() into a pipe (`cat`),
+ *                           so any seek would fail
+ * 
+ * Purpose: Verify a stream sized up front is byte-identical to a regular
+ *          WAV file, marker chunks included, and that closing a stream
+ *          with the wrong sample count is reported as an error.
+ */
+
+#include "../lib/wavlib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Labels match the markers writeSilence()/writeSync() generate
+static const char *labels[] = {"Silence (0.1s)", "Sync short (200 bits)", "Data"};
+
+// Write silence, a sync and a few bytes, recording where each part starts
+static bool writeAudio(WavWriter *writer, const WaveformConfig *config, size_t *positions) {
+    static const uint8_t data[] = {0x1F, 0xA6, 0xDE, 0xBA, 0xCC, 0x13, 0x7D, 0x74};
+    
+    positions[0] = writer->sample_count;
+    bool ok = writeSilence(writer, 0.1f);
+    positions[1] = writer->sample_count;
+    ok = ok && writeSync(writer, 200, config);
+    positions[2] = writer->sample_count;
+    return ok && writeBytes(writer, data, sizeof(data), config);
+}
+
+// Compare two files byte by byte
+static bool filesIdentical(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    bool same = fa && fb;
+    
+    while (same) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) {
+            same = false;
+        } else if (ca == EOF) {
+            break;
+        }
+    }
+    
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+int main(void) {
+    printf("WAV Stream Test\n");
+    printf("===============\n\n");
+    
+    WaveformConfig config = createWaveform(WAVE_SINE, 120);
+    config.enable_lowpass = true;
+    WavFormat fmt = createDefaultWavFormat();
+    size_t positions[3];
+    
+    // Reference file: silence/sync markers are added by the writer while
+    // writing, the data marker by hand; sizes are patched on close
+    WavWriter *writer = createWavFile("test_stream_file.wav", &fmt);
+    bool ok = writer && enableMarkers(writer) && writeAudio(writer, &config, positions) &&
+              addMarker(writer->markers, positions[2], MARKER_DETAIL, labels[2]);
+    size_t total_samples = writer ? writer->sample_count : 0;
+    ok = writer && closeWavFile(writer) && ok;
+    printf("  File writer:   %zu samples %s\n", total_samples, ok ? "written" : "FAILED");
+    if (!ok) return 1;
+    
+    // Stream: everything declared up front, written through a pipe
+    MarkerList *markers = createMarkerList();
+    for (size_t i = 0; markers && i < 3; i++) {
+        addMarker(markers, positions[i], MARKER_DETAIL, labels[i]);
+    }
+    FILE *pipe = popen("cat > test_stream_pipe.wav", "w");
+    if (!pipe) {
+        fprintf(stderr, "✗ Cannot open pipe\n");
+        return 1;
+    }
+    writer = createWavStream(pipe, &fmt, total_samples, markers);
+    ok = writer && writeAudio(writer, &config, positions) && closeWavFile(writer);
+    ok = (pclose(pipe) == 0) && ok;
+    
+    bool same = ok && filesIdentical("test_stream_file.wav", "test_stream_pipe.wav");
+    printf("  Stream writer: %s\n", same ? "identical to file writer" : "MISMATCH");
+    
+    // A stream whose length disagrees with its header must fail on close
+    FILE *sink = fopen("/dev/null", "wb");
+    writer = sink ? createWavStream(sink, &fmt, total_samples + 1, NULL) : NULL;
+    bool short_ok = writer && writeAudio(writer, &config, positions);
+    bool rejected = short_ok && !closeWavFile(writer);
+    if (sink) fclose(sink);
+    printf("  Short stream:  %s\n", rejected ? "rejected on close" : "NOT DETECTED");
+    
+    printf("\n");
+    if (!same || !rejected) {
+        fprintf(stderr, "✗ WAV stream test failed\n");
+        return 1;
+    }
+    printf("✓ Streams match regular WAV files without seeking\n");
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Waveform Cache Test - Pre-rendered Pulse Cycles
+ * ===============================================
+ * 
+ * Encodes the same byte sequence twice for every waveform type:
+ * 1. test_cache_off.wav - pulses rendered per call (no cache)
+ * 2. test_cache_on.wav  - pulses copied from the waveform cache
+ * 
+ * Purpose: Verify the cached pulses and the byte symbol table produce
+ *          byte-identical audio for every waveform type, with and without
+ *          the low-pass filter.
+ */
+
+#include "../lib/wavlib.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+// Encode a fixed pattern (sync + all 256 byte values, twice) into filename
+static bool encodePattern(const char *filename, const WaveformConfig *config, bool use_cache) {
+    WavFormat fmt = createDefaultWavFormat();
+    fmt.sample_rate = config->sample_rate;
+    
+    WavWriter *writer = createWavFile(filename, &fmt);
+    if (!writer) {
+        return false;
+    }
+    
+    if (use_cache && !enableWaveformCache(writer, config)) {
+        closeWavFile(writer);
+        return false;
+    }
+    
+    // Reference output is built pulse by pulse; the cached run uses the
+    // leader generator and the byte table
+    bool ok = true;
+    if (use_cache) {
+        ok = writeSync(writer, 50, config);
+    } else {
+        for (int i = 0; ok && i < 50; i++) {
+            ok = writeBit1(writer, config);
+        }
+    }
+    
+    uint8_t all_bytes[256];
+    for (int byte = 0; byte < 256; byte++) {
+        all_bytes[byte] = (uint8_t)byte;
+        ok = ok && writeByte(writer, (uint8_t)byte, config);
+    }
+    if (use_cache) {
+        ok = ok && writeBytes(writer, all_bytes, sizeof(all_bytes), config);
+    } else {
+        for (int byte = 0; ok && byte < 256; byte++) {
+            ok = writeByte(writer, (uint8_t)byte, config);
+        }
+    }
+    
+    return closeWavFile(writer) && ok;
+}
+
+// Compare two files byte by byte
+static bool filesIdentical(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb");
+    FILE *fb = fopen(b, "rb");
+    bool same = fa && fb;
+    
+    while (same) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) {
+            same = false;
+        } else if (ca == EOF) {
+            break;
+        }
+    }
+    
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+int main(void) {
+    printf("Waveform Cache Test\n");
+    printf("===================\n\n");
+    
+    static const uint8_t custom[] = {128, 200, 255, 200, 128, 56, 0, 56};
+    const WaveformType types[] = {WAVE_SINE, WAVE_SQUARE, WAVE_TRIANGLE, WAVE_TRAPEZOID, WAVE_CUSTOM};
+    const char *names[] = {"sine", "square", "triangle", "trapezoid", "custom"};
+    const uint16_t bauds[] = {1200, 2400};
+    int failures = 0;
+    
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        for (size_t b = 0; b < sizeof(bauds) / sizeof(bauds[0]); b++) {
+            for (int lowpass = 0; lowpass <= 1; lowpass++) {
+                WaveformConfig config = createWaveform(types[t], 120);
+                config.baud_rate = bauds[b];
+                config.sample_rate = 45600;  // 2400 baud: 0-bit 19 samples, 1-bit 2×9
+                config.custom_samples = custom;
+                config.custom_length = sizeof(custom);
+                config.enable_lowpass = lowpass;
+                
+                bool ok = encodePattern("test_cache_off.wav", &config, false) &&
+                          encodePattern("test_cache_on.wav", &config, true) &&
+                          filesIdentical("test_cache_off.wav", "test_cache_on.wav");
+                
+                printf("  %-10s %4u baud, low-pass %-3s: %s\n", names[t], bauds[b],
+                       lowpass ? "on" : "off", ok ? "identical" : "MISMATCH");
+                if (!ok) failures++;
+            }
+        }
+    }
+    
+    printf("\n");
+    if (failures) {
+        fprintf(stderr, "✗ %d configuration(s) differ\n", failures);
+        return 1;
+    }
+    printf("✓ Cached output matches uncached output for all waveforms\n");
+    return 0;
+}